@@ -59,6 +59,7 @@
 
 #include <cdogs/ammo.h>
 #include <cdogs/campaigns.h>
+#include <cdogs/char_pic_cache.h>
 #include <cdogs/character_class.h>
 #include <cdogs/collision.h>
 #include <cdogs/config_io.h>
@@ -84,6 +85,8 @@
 #include <cdogs/player_template.h>
 #include <cdogs/sounds.h>
 #include <cdogs/SDL_JoystickButtonNames/SDL_joystickbuttonnames.h>
+#include <cdogs/replay.h>
+#include <cdogs/thread_pool.h>
 #include <cdogs/triggers.h>
 #include <cdogs/utils.h>
 
@@ -160,6 +163,13 @@ static void PrintHelp(void)
 		"    --shakemult=n    Screen shaking multiplier (0 = disable).\n"
 	);
 
+	printf("%s\n",
+		"Replay Options:\n"
+		"    --record=file    Record the next mission played to file.\n"
+		"    --replay=file    Play back a recorded mission as fast as possible.\n"
+		"    --norender       Don't draw anything while playing back.\n"
+	);
+
 	printf(
 		"Logging: logging is enabled per module and set at certain levels.\n"
 		"Log modules are: "
@@ -197,6 +207,14 @@ static void PrintHelp(void)
 		);
 }
 
+// Log how long a phase of startup loading took; returns the current time
+static Uint32 LogLoadTime(const char *phase, const Uint32 start)
+{
+	const Uint32 now = SDL_GetTicks();
+	LOG(LM_MAIN, LL_INFO, "Loaded %s in %ums", phase, now - start);
+	return now;
+}
+
 int main(int argc, char *argv[])
 {
 	int wait = 0;
@@ -207,11 +225,13 @@ int main(int argc, char *argv[])
 	memset(&campaigns, 0, sizeof campaigns);
 	int err = 0;
 	const char *loadCampaign = NULL;
+	const char *replayFile = NULL;
 	ENetAddress connectAddr;
 	memset(&connectAddr, 0, sizeof connectAddr);
 
 	srand((unsigned int)time(NULL));
 	LogInit();
+	ReplayInit(&gReplay);
 
 	PrintTitle();
 
@@ -269,6 +289,9 @@ int main(int argc, char *argv[])
 			{"connect",		required_argument,	NULL,	'x'},
 			{"debug",		required_argument,	NULL,	'd'},
 			{"log",			required_argument,	NULL,	1000},
+			{"record",		required_argument,	NULL,	1001},
+			{"replay",		required_argument,	NULL,	1002},
+			{"norender",	no_argument,		NULL,	1003},
 			{"help",		no_argument,		NULL,	'h'},
 			{0,				0,					NULL,	0}
 		};
@@ -344,6 +367,18 @@ int main(int argc, char *argv[])
 					}
 				}
 				break;
+			case 1001:
+				if (!ReplayRecord(&gReplay, optarg))
+				{
+					printf("Error: cannot record replay to %s\n", optarg);
+				}
+				break;
+			case 1002:
+				replayFile = optarg;
+				break;
+			case 1003:
+				gReplay.NoRender = true;
+				break;
 			case 'x':
 				if (enet_address_set_host(&connectAddr, optarg) != 0)
 				{
@@ -389,11 +424,22 @@ int main(int argc, char *argv[])
 	LOG(LM_MAIN, LL_INFO, "data dir(%s)", buf);
 	LOG(LM_MAIN, LL_INFO, "config dir(%s)", GetConfigFilePath(""));
 
+	int workerThreads = ConfigGetInt(&gConfig, "Game.WorkerThreads");
+	if (workerThreads == 0)
+	{
+		// Leave a core for the main thread
+		workerThreads = CLAMP(SDL_GetCPUCount() - 1, 0, 7);
+	}
+	// Start workers early; asset files are decoded in parallel
+	ThreadPoolInit(&gThreadPool, workerThreads);
+
+	Uint32 loadTicks = SDL_GetTicks();
 	SoundInitialize(&gSoundDevice, "sounds");
 	if (!gSoundDevice.isInitialised)
 	{
 		LOG(LM_MAIN, LL_ERROR, "Sound initialization failed!");
 	}
+	loadTicks = LogLoadTime("sounds", loadTicks);
 
 	LoadHighScores();
 
@@ -411,6 +457,8 @@ int main(int argc, char *argv[])
 		getchar();
 	}
 	PicManagerInit(&gPicManager);
+	gPicManager.DecodeOnUse =
+		ConfigGetBool(&gConfig, "Graphics.DecodePicsOnUse");
 	GraphicsInit(&gGraphicsDevice, &gConfig);
 	GraphicsInitialize(&gGraphicsDevice);
 	if (!gGraphicsDevice.IsInitialized)
@@ -426,8 +474,13 @@ int main(int argc, char *argv[])
 		err = EXIT_FAILURE;
 		goto bail;
 	}
+	loadTicks = SDL_GetTicks();
 	FontLoadFromJSON(&gFont, "graphics/font.png", "graphics/font.json");
 	PicManagerLoad(&gPicManager, "graphics");
+	loadTicks = LogLoadTime("graphics", loadTicks);
+	CharPicCacheInit(
+		&gCharPicCache,
+		ConfigGetInt(&gConfig, "Graphics.CharPicCacheSize") * 1024);
 
 	ParticleClassesInit(&gParticleClasses, "data/particles.json");
 	AmmoInitialize(&gAmmo, "data/ammo.json");
@@ -441,12 +494,36 @@ int main(int argc, char *argv[])
 		&gPickupClasses, "data/pickups.json", &gAmmo, &gGunDescriptions);
 	MapObjectsInit(
 		&gMapObjects, "data/map_objects.json", &gAmmo, &gGunDescriptions);
+	loadTicks = LogLoadTime("data files", loadTicks);
 	CollisionSystemInit(&gCollisionSystem);
 	CampaignInit(&gCampaign);
 	LoadAllCampaigns(&campaigns);
+	LogLoadTime("campaign list", loadTicks);
 	PlayerDataInit(&gPlayerDatas);
 
 	debug(D_NORMAL, ">> Entering main loop\n");
+	if (replayFile != NULL)
+	{
+		if (!ReplayLoad(&gReplay, replayFile))
+		{
+			err = EXIT_FAILURE;
+			goto bail;
+		}
+		gCampaign.Entry.Mode = (GameMode)gReplay.Campaign.GameMode;
+		CampaignEntry entry;
+		if (!CampaignEntryTryLoad(
+				&entry, gReplay.Campaign.Path, gCampaign.Entry.Mode) ||
+			!CampaignLoad(&gCampaign, &entry))
+		{
+			LOG(LM_MAIN, LL_ERROR, "Failed to load campaign %s",
+				gReplay.Campaign.Path);
+			err = EXIT_FAILURE;
+			goto bail;
+		}
+		LOG(LM_MAIN, LL_INFO, "Playing replay");
+		ScreenReplay();
+		goto bail;
+	}
 	// Attempt to pre-load campaign if requested
 	if (loadCampaign != NULL)
 	{
@@ -477,6 +554,8 @@ int main(int argc, char *argv[])
 
 bail:
 	debug(D_NORMAL, ">> Shutting down...\n");
+	// Actors refer to the map, so finish the mission first
+	MissionOptionsTerminate(&gMission);
 	MapTerminate(&gMap);
 	PlayerDataTerminate(&gPlayerDatas);
 	MapObjectsTerminate(&gMapObjects);
@@ -486,13 +565,15 @@ bail:
 	WeaponTerminate(&gGunDescriptions);
 	BulletTerminate(&gBulletClasses);
 	CharacterClassesTerminate(&gCharacterClasses);
-	MissionOptionsTerminate(&gMission);
 	NetClientTerminate(&gNetClient);
 	atexit(enet_deinitialize);
 	EventTerminate(&gEventHandlers);
 	GraphicsTerminate(&gGraphicsDevice);
 	CampaignTerminate(&gCampaign);
 
+	ReplayTerminate(&gReplay);
+	ThreadPoolTerminate(&gThreadPool);
+	CharPicCacheTerminate(&gCharPicCache);
 	PicManagerTerminate(&gPicManager);
 	FontTerminate(&gFont);
 	AutosaveSave(&gAutosave, GetConfigFilePath(AUTOSAVE_FILE));
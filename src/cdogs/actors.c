@@ -240,7 +240,8 @@ bool TryMoveActor(TActor *actor, Vec2i pos)
 					// Tell the server that we want to melee something
 					GameEvent e = GameEventNew(GAME_EVENT_ACTOR_MELEE);
 					e.u.Melee.UID = actor->uid;
-					strcpy(e.u.Melee.BulletClass, gun->Gun->Bullet->Name);
+					e.u.Melee.BulletClassId =
+						BulletClassId(gun->Gun->Bullet);
 					e.u.Melee.TargetKind = target->kind;
 					switch (target->kind)
 					{
@@ -266,7 +267,7 @@ bool TryMoveActor(TActor *actor, Vec2i pos)
 					{
 						e.u.Melee.HitType = (int)HIT_NONE;
 					}
-					GameEventsEnqueue(&gGameEvents, e);
+					GameEventsEnqueue(&gGameEvents, &e);
 				}
 				return false;
 			}
@@ -447,7 +448,7 @@ static void CheckTrigger(const Vec2i tilePos)
 			GameEvent e = GameEventNew(GAME_EVENT_TRIGGER);
 			e.u.TriggerEvent.ID = (*tp)->id;
 			e.u.TriggerEvent.Tile = Vec2i2Net(tilePos);
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 	CA_FOREACH_END()
 }
@@ -496,7 +497,7 @@ static void CheckRescue(const TActor *a)
 			other->flags &= ~FLAGS_PRISONER;
 			GameEvent e = GameEventNew(GAME_EVENT_RESCUE_CHARACTER);
 			e.u.Rescue.UID = other->uid;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 			UpdateMissionObjective(
 				&gMission, other->tileItem.flags, OBJECTIVE_RESCUE, 1);
 		}
@@ -565,8 +566,7 @@ void ActorReplaceGun(const NActorReplaceGun rg)
 {
 	TActor *a = ActorGetByUID(rg.UID);
 	if (a == NULL || !a->isInUse) return;
-	const GunDescription *gun = StrGunDescription(rg.Gun);
-	CASSERT(gun != NULL, "cannot find gun");
+	const GunDescription *gun = IdGunDescription(rg.GunId);
 	// If player already has gun, don't do anything
 	if (ActorHasGun(a, gun))
 	{
@@ -646,7 +646,7 @@ void Shoot(TActor *actor)
 			e.u.UseAmmo.PlayerUID = actor->PlayerUID;
 			e.u.UseAmmo.AmmoId = gun->Gun->AmmoId;
 			e.u.UseAmmo.Amount = 1;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 		else if (gun->Gun->Cost != 0)
 		{
@@ -654,7 +654,7 @@ void Shoot(TActor *actor)
 			GameEvent e = GameEventNew(GAME_EVENT_SCORE);
 			e.u.Score.PlayerUID = actor->PlayerUID;
 			e.u.Score.Score = -gun->Gun->Cost;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 	}
 }
@@ -673,7 +673,7 @@ static bool ActorTryChangeDirection(
 		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_DIR);
 		e.u.ActorDir.UID = actor->uid;
 		e.u.ActorDir.Dir = (int32_t)dir;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 		// Change direction immediately because this affects shooting
 		actor->direction = dir;
 	}
@@ -692,7 +692,7 @@ int ActorTryShoot(TActor *actor, int cmd)
 		GameEvent e = GameEventNew(GAME_EVENT_GUN_STATE);
 		e.u.GunState.ActorUID = actor->uid;
 		e.u.GunState.State = GUNSTATE_READY;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 	return willShoot;
 }
@@ -719,7 +719,7 @@ void CommandActor(TActor * actor, int cmd, int ticks)
 				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_STATE);
 				e.u.ActorState.UID = actor->uid;
 				e.u.ActorState.State = (int32_t)ACTORANIMATION_IDLE;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 			}
 		}
 	}
@@ -739,7 +739,7 @@ void CommandActor(TActor * actor, int cmd, int ticks)
 				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_PICKUP_ALL);
 				e.u.ActorPickupAll.UID = actor->uid;
 				e.u.ActorPickupAll.PickupAll = true;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 			}
 			actor->PickupAll = true;
 		}
@@ -752,7 +752,7 @@ void CommandActor(TActor * actor, int cmd, int ticks)
 			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_PICKUP_ALL);
 			e.u.ActorPickupAll.UID = actor->uid;
 			e.u.ActorPickupAll.PickupAll = false;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 		actor->PickupAll = false;
 	}
@@ -792,7 +792,7 @@ static bool ActorTryMove(TActor *actor, int cmd, int hasShot, int ticks)
 			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_STATE);
 			e.u.ActorState.UID = actor->uid;
 			e.u.ActorState.State = (int32_t)ACTORANIMATION_WALKING;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 	}
 	else
@@ -802,7 +802,7 @@ static bool ActorTryMove(TActor *actor, int cmd, int hasShot, int ticks)
 			GameEvent e = GameEventNew(GAME_EVENT_ACTOR_STATE);
 			e.u.ActorState.UID = actor->uid;
 			e.u.ActorState.State = (int32_t)ACTORANIMATION_IDLE;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 	}
 
@@ -813,7 +813,7 @@ static bool ActorTryMove(TActor *actor, int cmd, int hasShot, int ticks)
 		e.u.ActorMove.UID = actor->uid;
 		e.u.ActorMove.Pos = Vec2i2Net(actor->Pos);
 		e.u.ActorMove.MoveVel = Vec2i2Net(actor->MoveVel);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 
 	return willMove;
@@ -843,7 +843,7 @@ void SlideActor(TActor *actor, int cmd)
 	if (cmd & CMD_UP)			vel.y = -SLIDE_Y * 256;
 	else if (cmd & CMD_DOWN)	vel.y = SLIDE_Y * 256;
 	e.u.ActorSlide.Vel = Vec2i2Net(vel);
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 	
 	actor->slideLock = SLIDE_LOCK;
 }
@@ -894,11 +894,11 @@ void UpdateAllActors(int ticks)
 					e.u.ActorImpulse.UID = actor->uid;
 					e.u.ActorImpulse.Vel = Vec2i2Net(v);
 					e.u.ActorImpulse.Pos = Vec2i2Net(actor->Pos);
-					GameEventsEnqueue(&gGameEvents, e);
+					GameEventsEnqueue(&gGameEvents, &e);
 					e.u.ActorImpulse.UID = collidingActor->uid;
 					e.u.ActorImpulse.Vel = Vec2i2Net(Vec2iScale(v, -1));
 					e.u.ActorImpulse.Pos = Vec2i2Net(collidingActor->Pos);
-					GameEventsEnqueue(&gGameEvents, e);
+					GameEventsEnqueue(&gGameEvents, &e);
 				}
 			}
 		}
@@ -1008,17 +1008,16 @@ static void ActorDie(TActor *actor)
 	// Add a blood pool
 	GameEvent e = GameEventNew(GAME_EVENT_MAP_OBJECT_ADD);
 	e.u.MapObjectAdd.UID = ObjsGetNextUID();
-	strcpy(
-		e.u.MapObjectAdd.MapObjectClass,
-		RandomBloodMapObject(&gMapObjects)->Name);
+	e.u.MapObjectAdd.MapObjectId =
+		MapObjectIndex(RandomBloodMapObject(&gMapObjects));
 	e.u.MapObjectAdd.Pos = Vec2i2Net(Vec2iFull2Real(actor->Pos));
 	e.u.MapObjectAdd.TileItemFlags = TILEITEM_IS_WRECK;
 	e.u.MapObjectAdd.Health = 0;
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 
 	e = GameEventNew(GAME_EVENT_ACTOR_DIE);
 	e.u.ActorDie.UID = actor->uid;
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 }
 static bool IsUnarmedBot(const TActor *actor);
 static void ActorAddAmmoPickup(const TActor *actor)
@@ -1047,7 +1046,9 @@ static void ActorAddAmmoPickup(const TActor *actor)
 			GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
 			e.u.AddPickup.UID = PickupsGetNextUID();
 			const Ammo *a = AmmoGetById(&gAmmo, w->Gun->AmmoId);
-			sprintf(e.u.AddPickup.PickupClass, "ammo_%s", a->Name);
+			char buf[256];
+			sprintf(buf, "ammo_%s", a->Name);
+			e.u.AddPickup.PickupClassId = StrPickupClassId(buf);
 			e.u.AddPickup.IsRandomSpawned = false;
 			e.u.AddPickup.SpawnerUID = -1;
 			e.u.AddPickup.TileItemFlags = 0;
@@ -1056,7 +1057,7 @@ static void ActorAddAmmoPickup(const TActor *actor)
 				RAND_INT(-TILE_WIDTH, TILE_WIDTH) / 2,
 				RAND_INT(-TILE_HEIGHT, TILE_HEIGHT) / 2);
 			e.u.AddPickup.Pos = Vec2i2Net(Vec2iAdd(Vec2iFull2Real(actor->Pos), offset));
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		CA_FOREACH_END()
 	}
 
@@ -1079,12 +1080,14 @@ static void ActorAddGunPickup(const TActor *actor)
 		}
 		GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
 		e.u.AddPickup.UID = PickupsGetNextUID();
-		sprintf(e.u.AddPickup.PickupClass, "gun_%s", w->Gun->name);
+		char buf[256];
+		sprintf(buf, "gun_%s", w->Gun->name);
+		e.u.AddPickup.PickupClassId = StrPickupClassId(buf);
 		e.u.AddPickup.IsRandomSpawned = false;
 		e.u.AddPickup.SpawnerUID = -1;
 		e.u.AddPickup.TileItemFlags = 0;
 		e.u.AddPickup.Pos = Vec2i2Net(Vec2iFull2Real(actor->Pos));
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 }
 static bool IsUnarmedBot(const TActor *actor)
@@ -1211,7 +1214,7 @@ TActor *ActorAdd(NActorAdd aa)
 			{
 				GameEvent e = GameEventNew(GAME_EVENT_RESCUE_CHARACTER);
 				e.u.Rescue.UID = aa.UID;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 				UpdateMissionObjective(
 					&gMission, actor->tileItem.flags, OBJECTIVE_RESCUE, 1);
 			}
@@ -52,6 +52,7 @@
 #include <stdlib.h>
 
 #include "actor_placement.h"
+#include "ai_think.h"
 #include "ai_utils.h"
 #include "collision.h"
 #include "config.h"
@@ -63,11 +64,15 @@
 #include "handle_game_events.h"
 #include "mission.h"
 #include "net_util.h"
+#include "path_cache.h"
 #include "sys_specifics.h"
+#include "thread_pool.h"
 #include "utils.h"
+#include "visibility_cache.h"
 
 static int gBaddieCount = 0;
 static int gAreGoodGuysPresent = 0;
+AIScheduler gAIScheduler;
 
 
 static bool IsFacingPlayer(TActor *actor, direction_e d)
@@ -89,12 +94,21 @@ static bool IsFacingPlayer(TActor *actor, direction_e d)
 
 #define Distance(a,b) CHEBYSHEV_DISTANCE(a->x, a->y, b->x, b->y)
 
+// Returns -1 if there are no players
+static int GetClosestPlayerDistance(const Vec2i fullPos)
+{
+	const TActor *closestPlayer = AIGetClosestPlayer(fullPos);
+	if (closestPlayer == NULL)
+	{
+		return -1;
+	}
+	return CHEBYSHEV_DISTANCE(
+		fullPos.x, fullPos.y, closestPlayer->Pos.x, closestPlayer->Pos.y);
+}
 static bool IsCloseToPlayer(const Vec2i fullPos, const int fullDistance)
 {
-	TActor *closestPlayer = AIGetClosestPlayer(fullPos);
-	return closestPlayer && CHEBYSHEV_DISTANCE(
-		fullPos.x, fullPos.y,
-		closestPlayer->Pos.x, closestPlayer->Pos.y) < fullDistance;
+	const int distance = GetClosestPlayerDistance(fullPos);
+	return distance >= 0 && distance < fullDistance;
 }
 
 static bool CanSeeAPlayer(const TActor *a)
@@ -108,18 +122,16 @@ static bool CanSeeAPlayer(const TActor *a)
 		const TActor *player = ActorGetByUID(p->ActorUID);
 		const Vec2i playerRealPos = Vec2iFull2Real(player->Pos);
 		// Can see player if:
-		// - Clear line of sight, and
-		// - If they are close, or if facing and they are not too far
-		if (!AIHasClearShot(realPos, playerRealPos))
-		{
-			continue;
-		}
+		// - If they are close, or if facing and they are not too far, and
+		// - Clear line of sight
+		// Check the line last as it is the most expensive
 		const int distance = CHEBYSHEV_DISTANCE(
 			realPos.x, realPos.y, playerRealPos.x, playerRealPos.y);
 		const bool isClose = distance < 16 * 4;
 		const bool isNotTooFar = distance < 16 * 30;
-		if (isClose ||
-			(isNotTooFar && AIIsFacing(a, player->Pos, a->direction)))
+		if ((isClose ||
+			(isNotTooFar && AIIsFacing(a, player->Pos, a->direction))) &&
+			AIHasClearShot(realPos, playerRealPos))
 		{
 			return true;
 		}
@@ -186,13 +198,14 @@ static bool IsDirectionOK(TActor *a, int dir)
 static int BrightWalk(TActor * actor, int roll)
 {
 	const CharBot *bot = ActorGetCharacter(actor)->bot;
-	if (!!(actor->flags & FLAGS_VISIBLE) && roll < bot->probabilityToTrack)
+	if (!!(actor->aiContext->Flags & FLAGS_VISIBLE) &&
+		roll < bot->probabilityToTrack)
 	{
-		actor->flags &= ~FLAGS_DETOURING;
+		actor->aiContext->Flags &= ~FLAGS_DETOURING;
 		return AIHuntClosest(actor);
 	}
 
-	if (actor->flags & FLAGS_TRYRIGHT)
+	if (actor->aiContext->Flags & FLAGS_TRYRIGHT)
 	{
 		if (IsDirectionOK(actor, (actor->direction + 7) % 8))
 		{
@@ -200,7 +213,7 @@ static int BrightWalk(TActor * actor, int roll)
 			actor->turns--;
 			if (actor->turns == 0)
 			{
-				actor->flags &= ~FLAGS_DETOURING;
+				actor->aiContext->Flags &= ~FLAGS_DETOURING;
 			}
 		}
 		else if (!IsDirectionOK(actor, actor->direction))
@@ -208,7 +221,7 @@ static int BrightWalk(TActor * actor, int roll)
 			actor->direction = (actor->direction + 1) % 8;
 			actor->turns++;
 			if (actor->turns == 4) {
-				actor->flags &=
+				actor->aiContext->Flags &=
 				    ~(FLAGS_DETOURING | FLAGS_TRYRIGHT);
 				actor->turns = 0;
 			}
@@ -221,14 +234,14 @@ static int BrightWalk(TActor * actor, int roll)
 			actor->direction = (actor->direction + 1) % 8;
 			actor->turns--;
 			if (actor->turns == 0)
-				actor->flags &= ~FLAGS_DETOURING;
+				actor->aiContext->Flags &= ~FLAGS_DETOURING;
 		}
 		else if (!IsDirectionOK(actor, actor->direction))
 		{
 			actor->direction = (actor->direction + 7) % 8;
 			actor->turns++;
 			if (actor->turns == 4) {
-				actor->flags &=
+				actor->aiContext->Flags &=
 				    ~(FLAGS_DETOURING | FLAGS_TRYRIGHT);
 				actor->turns = 0;
 			}
@@ -240,11 +253,11 @@ static int BrightWalk(TActor * actor, int roll)
 static int WillFire(TActor * actor, int roll)
 {
 	const CharBot *bot = ActorGetCharacter(actor)->bot;
-	if ((actor->flags & FLAGS_VISIBLE) != 0 &&
+	if ((actor->aiContext->Flags & FLAGS_VISIBLE) != 0 &&
 		ActorCanFire(actor) &&
 		roll < bot->probabilityToShoot)
 	{
-		if ((actor->flags & FLAGS_GOOD_GUY) != 0)
+		if ((actor->aiContext->Flags & FLAGS_GOOD_GUY) != 0)
 			return 1;	//!FacingPlayer( actor);
 		else if (gAreGoodGuysPresent)
 		{
@@ -260,9 +273,9 @@ static int WillFire(TActor * actor, int roll)
 
 void Detour(TActor * actor)
 {
-	actor->flags |= FLAGS_DETOURING;
+	actor->aiContext->Flags |= FLAGS_DETOURING;
 	actor->turns = 1;
-	if (actor->flags & FLAGS_TRYRIGHT)
+	if (actor->aiContext->Flags & FLAGS_TRYRIGHT)
 		actor->direction =
 		    (CmdToDirection(actor->lastCmd) + 1) % 8;
 	else
@@ -288,42 +301,51 @@ static bool DidPlayerShoot(void)
 }
 
 static int Follow(TActor *a);
+typedef struct
+{
+	int DelayModifier;
+	int RollLimit;
+} BadGuyThinkData;
+static int BadGuyThink(TActor *actor, void *data);
 void CommandBadGuys(int ticks)
 {
 	int count = 0;
-	int delayModifier;
-	int rollLimit;
+	BadGuyThinkData data;
 
 	switch (ConfigGetEnum(&gConfig, "Game.Difficulty"))
 	{
 	case DIFFICULTY_VERYEASY:
-		delayModifier = 4;
-		rollLimit = 300;
+		data.DelayModifier = 4;
+		data.RollLimit = 300;
 		break;
 	case DIFFICULTY_EASY:
-		delayModifier = 2;
-		rollLimit = 200;
+		data.DelayModifier = 2;
+		data.RollLimit = 200;
 		break;
 	case DIFFICULTY_HARD:
-		delayModifier = 1;
-		rollLimit = 75;
+		data.DelayModifier = 1;
+		data.RollLimit = 75;
 		break;
 	case DIFFICULTY_VERYHARD:
-		delayModifier = 1;
-		rollLimit = 50;
+		data.DelayModifier = 1;
+		data.RollLimit = 50;
 		break;
 	default:
-		delayModifier = 1;
-		rollLimit = 100;
+		data.DelayModifier = 1;
+		data.RollLimit = 100;
 		break;
 	}
 
+	// Pick which actors think this frame
+	AIThink think;
+	AIThinkInit(&think, BadGuyThink, &data);
+	AISchedulerNextFrame(&gAIScheduler);
+	VisibilityCacheNextFrame(&gVisibilityCache);
 	CA_FOREACH(TActor, actor, gActors)
 		if (!actor->isInUse)
 		{
 			continue;
 		}
-		const CharBot *bot = ActorGetCharacter(actor)->bot;
 		if (!(actor->PlayerUID >= 0 || (actor->flags & FLAGS_PRISONER)))
 		{
 			if ((actor->flags & (FLAGS_VICTIM | FLAGS_GOOD_GUY)) != 0)
@@ -332,157 +354,53 @@ void CommandBadGuys(int ticks)
 			}
 
 			count++;
-			int cmd = 0;
 
-			// Wake up if it can see a player
-			if ((actor->flags & FLAGS_SLEEPING) &&
-				actor->aiContext->Delay == 0)
+			// Only re-plan when the scheduler says so; otherwise carry on
+			// with the last command, without firing
+			bool decide = true;
+			if (!actor->dead)
 			{
-				if (CanSeeAPlayer(actor))
-				{
-					actor->flags &= ~FLAGS_SLEEPING;
-					ActorSetAIState(actor, AI_STATE_NONE);
-				}
-				actor->aiContext->Delay = bot->actionDelay * delayModifier;
-				// Randomly change direction
-				int newDir = (int)actor->direction + ((rand() % 2) * 2 - 1);
-				if (newDir < (int)DIRECTION_UP)
-				{
-					newDir = (int)DIRECTION_UPLEFT;
-				}
-				if (newDir == (int)DIRECTION_COUNT)
-				{
-					newDir = (int)DIRECTION_UP;
-				}
-				cmd = DirectionToCmd((int)newDir);
+				const int distance = GetClosestPlayerDistance(actor->Pos);
+				const AIPriority priority = AISchedulerGetPriority(
+					distance < 0 ? -1 : (distance >> 8) / TILE_WIDTH);
+				decide = AISchedulerShouldDecide(
+					&gAIScheduler, &actor->aiContext->NextDecision,
+					actor->uid, priority);
 			}
-			// Go to sleep if the player's too far away
-			if (!(actor->flags & FLAGS_SLEEPING) &&
-				actor->aiContext->Delay == 0 &&
-				!(actor->flags & FLAGS_AWAKEALWAYS))
+			int cmd = 0;
+			if (!decide && !(actor->flags & FLAGS_SLEEPING))
 			{
-				if (!IsCloseToPlayer(actor->Pos, (40 * 16) << 8))
-				{
-					actor->flags |= FLAGS_SLEEPING;
-					ActorSetAIState(actor, AI_STATE_IDLE);
-				}
+				cmd = actor->lastCmd & ~CMD_BUTTON1;
 			}
-
-			if (!actor->dead && !(actor->flags & FLAGS_SLEEPING))
-			{
-				bool bypass = false;
-				const int roll = rand() % rollLimit;
-				if (actor->flags & FLAGS_FOLLOWER)
-				{
-					cmd = Follow(actor);
-				}
-				else if (!!(actor->flags & FLAGS_SNEAKY) &&
-					!!(actor->flags & FLAGS_VISIBLE) &&
-					DidPlayerShoot())
-				{
-					cmd = AIHuntClosest(actor) | CMD_BUTTON1;
-					if (actor->flags & FLAGS_RUNS_AWAY)
-					{
-						// Turn back and shoot for running away characters
-						cmd = AIReverseDirection(cmd);
-					}
-					bypass = true;
-					ActorSetAIState(actor, AI_STATE_HUNT);
-				}
-				else if (actor->flags & FLAGS_DETOURING)
-				{
-					cmd = BrightWalk(actor, roll);
-					ActorSetAIState(actor, AI_STATE_TRACK);
-				}
-				else if (actor->flags & FLAGS_RESCUED)
-				{
-					// If we haven't completed all objectives, act as follower
-					if (!CanCompleteMission(&gMission))
-					{
-						cmd = Follow(actor);
-					}
-					else
-					{
-						// Run towards exit
-						const Vec2i exitPos = MapGetExitPos(&gMap);
-						cmd = AIGoto(actor, exitPos, false);
-					}
-				}
-				else if (actor->aiContext->Delay > 0)
-				{
-					cmd = actor->lastCmd & ~CMD_BUTTON1;
-				}
-				else
-				{
-					if (roll < bot->probabilityToTrack)
-					{
-						cmd = AIHuntClosest(actor);
-						ActorSetAIState(actor, AI_STATE_HUNT);
-					}
-					else if (roll < bot->probabilityToMove)
-					{
-						cmd = DirectionToCmd(rand() & 7);
-						ActorSetAIState(actor, AI_STATE_TRACK);
-					}
-					else
-					{
-						cmd = 0;
-					}
-					actor->aiContext->Delay = bot->actionDelay * delayModifier;
-				}
-				if (!bypass)
-				{
-					if (WillFire(actor, roll))
-					{
-						cmd |= CMD_BUTTON1;
-						if (!!(actor->flags & FLAGS_FOLLOWER) &&
-							(actor->flags & FLAGS_GOOD_GUY))
-						{
-							// Shoot in a random direction away
-							for (int j = 0; j < 10; j++)
-							{
-								direction_e d =
-									(direction_e)(rand() % DIRECTION_COUNT);
-								if (!IsFacingPlayer(actor, d))
-								{
-									cmd = DirectionToCmd(d) | CMD_BUTTON1;
-									break;
-								}
-							}
-						}
-						if (actor->flags & FLAGS_RUNS_AWAY)
-						{
-							// Turn back and shoot for running away characters
-							cmd |= AIReverseDirection(AIHuntClosest(actor));
-						}
-						ActorSetAIState(actor, AI_STATE_HUNT);
-					}
-					else
-					{
-						if ((actor->flags & FLAGS_VISIBLE) == 0)
-						{
-							// I think this is some hack to make sure invisible enemies don't fire so much
-							ActorGetGun(actor)->lock = 40;
-						}
-						if (cmd && !IsDirectionOK(actor, CmdToDirection(cmd)) &&
-							(actor->flags & FLAGS_DETOURING) == 0)
-						{
-							Detour(actor);
-							cmd = 0;
-							ActorSetAIState(actor, AI_STATE_TRACK);
-						}
-					}
-				}
-			}
-			actor->aiContext->Delay =
-				MAX(0, actor->aiContext->Delay - ticks);
-			CommandActor(actor, cmd, ticks);
+			AIThinkAdd(&think, actor, decide, cmd);
 		}
 		else if ((actor->flags & FLAGS_PRISONER) != 0)
 		{
-			CommandActor(actor, 0, ticks);
+			AIThinkAdd(&think, actor, false, 0);
+		}
+	CA_FOREACH_END()
+
+	// Think in parallel, then act in UID order
+	PathCacheFreeze(&gPathCache);
+	VisibilityCacheFreeze(&gVisibilityCache);
+	AIThinkRun(&think, &gThreadPool, (unsigned int)rand());
+	VisibilityCacheThaw(&gVisibilityCache);
+	PathCacheThaw(&gPathCache);
+	CA_FOREACH(const AIThinkItem, item, think.Items)
+		TActor *actor = item->Actor;
+		if (item->Think)
+		{
+			actor->flags = actor->aiContext->Flags;
 		}
+		if (!(actor->flags & FLAGS_PRISONER))
+		{
+			actor->aiContext->Delay =
+				MAX(0, actor->aiContext->Delay - ticks);
+		}
+		CommandActor(actor, item->Cmd, ticks);
 	CA_FOREACH_END()
+	AIThinkTerminate(&think);
+
 	if (gMission.missionData->Enemies.size > 0 &&
 		gMission.missionData->EnemyDensity > 0 &&
 		count < MAX(1, (gMission.missionData->EnemyDensity * ConfigGetInt(&gConfig, "Game.EnemyDensity")) / 100))
@@ -498,10 +416,163 @@ void CommandBadGuys(int ticks)
 		aa.FullPos = PlaceAwayFromPlayers(&gMap);
 		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
 		e.u.ActorAdd = aa;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 		gBaddieCount++;
 	}
 }
+// Runs on worker threads; see ai_think.h for what is safe to do here
+static int BadGuyThink(TActor *actor, void *data)
+{
+	const BadGuyThinkData *td = data;
+	const CharBot *bot = ActorGetCharacter(actor)->bot;
+	unsigned int *seed = &actor->aiContext->RandSeed;
+	int cmd = 0;
+	// Other actors read our flags while thinking, so change a copy and
+	// apply it when acting
+	actor->aiContext->Flags = actor->flags;
+
+	// Wake up if it can see a player
+	if ((actor->aiContext->Flags & FLAGS_SLEEPING) &&
+		actor->aiContext->Delay == 0)
+	{
+		if (CanSeeAPlayer(actor))
+		{
+			actor->aiContext->Flags &= ~FLAGS_SLEEPING;
+			ActorSetAIState(actor, AI_STATE_NONE);
+		}
+		actor->aiContext->Delay = bot->actionDelay * td->DelayModifier;
+		// Randomly change direction
+		int newDir = (int)actor->direction + ((RandNext(seed) % 2) * 2 - 1);
+		if (newDir < (int)DIRECTION_UP)
+		{
+			newDir = (int)DIRECTION_UPLEFT;
+		}
+		if (newDir == (int)DIRECTION_COUNT)
+		{
+			newDir = (int)DIRECTION_UP;
+		}
+		cmd = DirectionToCmd((int)newDir);
+	}
+	// Go to sleep if the player's too far away
+	if (!(actor->aiContext->Flags & FLAGS_SLEEPING) &&
+		actor->aiContext->Delay == 0 &&
+		!(actor->aiContext->Flags & FLAGS_AWAKEALWAYS))
+	{
+		if (!IsCloseToPlayer(actor->Pos, (40 * 16) << 8))
+		{
+			actor->aiContext->Flags |= FLAGS_SLEEPING;
+			ActorSetAIState(actor, AI_STATE_IDLE);
+		}
+	}
+
+	if (!actor->dead && !(actor->aiContext->Flags & FLAGS_SLEEPING))
+	{
+		bool bypass = false;
+		const int roll = RandNext(seed) % td->RollLimit;
+		if (actor->aiContext->Flags & FLAGS_FOLLOWER)
+		{
+			cmd = Follow(actor);
+		}
+		else if (!!(actor->aiContext->Flags & FLAGS_SNEAKY) &&
+			!!(actor->aiContext->Flags & FLAGS_VISIBLE) &&
+			DidPlayerShoot())
+		{
+			cmd = AIHuntClosest(actor) | CMD_BUTTON1;
+			if (actor->aiContext->Flags & FLAGS_RUNS_AWAY)
+			{
+				// Turn back and shoot for running away characters
+				cmd = AIReverseDirection(cmd);
+			}
+			bypass = true;
+			ActorSetAIState(actor, AI_STATE_HUNT);
+		}
+		else if (actor->aiContext->Flags & FLAGS_DETOURING)
+		{
+			cmd = BrightWalk(actor, roll);
+			ActorSetAIState(actor, AI_STATE_TRACK);
+		}
+		else if (actor->aiContext->Flags & FLAGS_RESCUED)
+		{
+			// If we haven't completed all objectives, act as follower
+			if (!CanCompleteMission(&gMission))
+			{
+				cmd = Follow(actor);
+			}
+			else
+			{
+				// Run towards exit
+				const Vec2i exitPos = MapGetExitPos(&gMap);
+				cmd = AIGoto(actor, exitPos, false);
+			}
+		}
+		else if (actor->aiContext->Delay > 0)
+		{
+			cmd = actor->lastCmd & ~CMD_BUTTON1;
+		}
+		else
+		{
+			if (roll < bot->probabilityToTrack)
+			{
+				cmd = AIHuntClosest(actor);
+				ActorSetAIState(actor, AI_STATE_HUNT);
+			}
+			else if (roll < bot->probabilityToMove)
+			{
+				cmd = DirectionToCmd(RandNext(seed) & 7);
+				ActorSetAIState(actor, AI_STATE_TRACK);
+			}
+			else
+			{
+				cmd = 0;
+			}
+			actor->aiContext->Delay = bot->actionDelay * td->DelayModifier;
+		}
+		if (!bypass)
+		{
+			if (WillFire(actor, roll))
+			{
+				cmd |= CMD_BUTTON1;
+				if (!!(actor->aiContext->Flags & FLAGS_FOLLOWER) &&
+					(actor->aiContext->Flags & FLAGS_GOOD_GUY))
+				{
+					// Shoot in a random direction away
+					for (int j = 0; j < 10; j++)
+					{
+						direction_e d =
+							(direction_e)(RandNext(seed) % DIRECTION_COUNT);
+						if (!IsFacingPlayer(actor, d))
+						{
+							cmd = DirectionToCmd(d) | CMD_BUTTON1;
+							break;
+						}
+					}
+				}
+				if (actor->aiContext->Flags & FLAGS_RUNS_AWAY)
+				{
+					// Turn back and shoot for running away characters
+					cmd |= AIReverseDirection(AIHuntClosest(actor));
+				}
+				ActorSetAIState(actor, AI_STATE_HUNT);
+			}
+			else
+			{
+				if ((actor->aiContext->Flags & FLAGS_VISIBLE) == 0)
+				{
+					// I think this is some hack to make sure invisible enemies don't fire so much
+					ActorGetGun(actor)->lock = 40;
+				}
+				if (cmd && !IsDirectionOK(actor, CmdToDirection(cmd)) &&
+					(actor->aiContext->Flags & FLAGS_DETOURING) == 0)
+				{
+					Detour(actor);
+					cmd = 0;
+					ActorSetAIState(actor, AI_STATE_TRACK);
+				}
+			}
+		}
+	}
+	return cmd;
+}
 static int Follow(TActor *a)
 {
 	// If we are a rescue objective and we are in the exit
@@ -511,8 +582,8 @@ static int Follow(TActor *a)
 	if (CharacterIsPrisoner(store, ch) && CanCompleteMission(&gMission) &&
 		MapIsTileInExit(&gMap, &a->tileItem))
 	{
-		a->flags &= ~FLAGS_FOLLOWER;
-		a->flags |= FLAGS_RESCUED;
+		a->aiContext->Flags &= ~FLAGS_FOLLOWER;
+		a->aiContext->Flags |= FLAGS_RESCUED;
 		return 0;
 	}
 	else if (IsCloseToPlayer(a->Pos, 32 << 8))
@@ -547,7 +618,7 @@ void InitializeBadGuys(void)
 				aa.FullPos = PlaceAwayFromPlayers(&gMap);
 				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
 				e.u.ActorAdd = aa;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 
 				// Process the events that actually place the actors
 				HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -576,7 +647,7 @@ void InitializeBadGuys(void)
 				}
 				GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
 				e.u.ActorAdd = aa;
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 
 				// Process the events that actually place the actors
 				HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -586,6 +657,8 @@ void InitializeBadGuys(void)
 
 	gBaddieCount = gMission.index * 4;
 	gAreGoodGuysPresent = 0;
+	AISchedulerInit(
+		&gAIScheduler, ConfigGetInt(&gConfig, "Game.AIDecisionsPerFrame"));
 }
 
 void CreateEnemies(void)
@@ -611,7 +684,7 @@ void CreateEnemies(void)
 		aa.Health = CharacterGetStartingHealth(c, true);
 		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_ADD);
 		e.u.ActorAdd = aa;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 		gBaddieCount++;
 
 		// Process the events that actually place the actors
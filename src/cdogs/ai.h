@@ -50,6 +50,9 @@
 #define __AI
 
 #include "actors.h"
+#include "ai_scheduler.h"
+
+extern AIScheduler gAIScheduler;
 
 void InitializeBadGuys(void);
 void CreateEnemies(void);
@@ -93,6 +93,12 @@ typedef struct
 	// Delay in executing consecutive actions;
 	// Used to let the AI perform one action for a set amount of time
 	int Delay;
+	// Scheduler frame at which to next make a full decision
+	int NextDecision;
+	// Random sequence for thinking in parallel; see AIThinkRun
+	unsigned int RandSeed;
+	// Actor flags as changed by thinking, applied when acting
+	int Flags;
 	AIState State;
 
 	// Counters to moderate amount of chatter
@@ -28,9 +28,13 @@
 */
 #include "ai_coop.h"
 
+#include "ai_think.h"
 #include "ai_utils.h"
 #include "gamedata.h"
+#include "path_cache.h"
 #include "pickup.h"
+#include "thread_pool.h"
+#include "visibility_cache.h"
 
 // How many ticks to stay in one confusion state
 #define CONFUSION_STATE_TICKS_MIN 25
@@ -64,7 +68,8 @@ int AICoopGetCmd(TActor *actor, const int ticks)
 		{
 			actor->aiContext->Delay =
 				CONFUSION_STATE_TICKS_MIN +
-				(rand() % CONFUSION_STATE_TICKS_RANGE);
+				(RandNext(&actor->aiContext->RandSeed) %
+				CONFUSION_STATE_TICKS_RANGE);
 			if (s->Type == AI_CONFUSION_CONFUSED)
 			{
 				s->Type = AI_CONFUSION_CORRECT;
@@ -74,7 +79,7 @@ int AICoopGetCmd(TActor *actor, const int ticks)
 				ActorSetAIState(actor, AI_STATE_CONFUSED);
 				s->Type = AI_CONFUSION_CONFUSED;
 				// Generate the confused action
-				s->Cmd = rand() &
+				s->Cmd = RandNext(&actor->aiContext->RandSeed) &
 					(CMD_LEFT | CMD_RIGHT | CMD_UP | CMD_DOWN |
 					CMD_BUTTON1 | CMD_BUTTON2);
 			}
@@ -109,6 +114,46 @@ int AICoopGetCmd(TActor *actor, const int ticks)
 	return cmd;
 }
 
+static int AICoopThink(TActor *actor, void *data);
+void AICoopGetCmds(TActor **actors, int *cmds, const int n, int ticks)
+{
+	if (n == 0)
+	{
+		return;
+	}
+	AIThink think;
+	AIThinkInit(&think, AICoopThink, &ticks);
+	for (int i = 0; i < n; i++)
+	{
+		// Create contexts up front so the workers don't write to the actors
+		if (actors[i]->aiContext == NULL)
+		{
+			actors[i]->aiContext = AIContextNew();
+		}
+		AIThinkAdd(&think, actors[i], true, 0);
+	}
+	PathCacheFreeze(&gPathCache);
+	VisibilityCacheFreeze(&gVisibilityCache);
+	AIThinkRun(&think, &gThreadPool, (unsigned int)rand());
+	VisibilityCacheThaw(&gVisibilityCache);
+	PathCacheThaw(&gPathCache);
+	CA_FOREACH(const AIThinkItem, item, think.Items)
+		for (int i = 0; i < n; i++)
+		{
+			if (actors[i] == item->Actor)
+			{
+				cmds[i] = item->Cmd;
+			}
+		}
+	CA_FOREACH_END()
+	AIThinkTerminate(&think);
+}
+// Runs on worker threads; see ai_think.h for what is safe to do here
+static int AICoopThink(TActor *actor, void *data)
+{
+	return AICoopGetCmd(actor, *(const int *)data);
+}
+
 static int SmartGoto(TActor *actor, Vec2i pos, int minDistance2);
 static bool TryCompleteNearbyObjective(
 	TActor *actor, const TActor *closestPlayer,
@@ -622,7 +667,7 @@ static void FindObjectivesSortedByDistance(
 		// Check if the pickup is actually accessible
 		// This is because random spawning may cause some pickups to be spawned
 		// in inaccessible areas
-		if (MapGetTile(&gMap, Vec2iToTile(co.Pos))->flags & MAPTILE_NO_WALK)
+		if (!MapTileCanWalk(&gMap, Vec2iToTile(co.Pos)))
 		{
 			continue;
 		}
@@ -31,6 +31,9 @@
 #include "actors.h"
 
 int AICoopGetCmd(TActor *actor, const int ticks);
+// Decide the commands of a number of AI players, thinking in parallel
+// cmds: output, in the same order as actors
+void AICoopGetCmds(TActor **actors, int *cmds, const int n, int ticks);
 void AICoopSelectWeapons(
 	PlayerData *p, const int player, const CArray *weapons);
 void AICoopOnPickupGun(TActor *a, const int gunId);
@@ -0,0 +1,96 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "ai_scheduler.h"
+
+#include <string.h>
+
+
+void AISchedulerInit(AIScheduler *s, const int maxDecisions)
+{
+	memset(s, 0, sizeof *s);
+	s->MaxDecisions = maxDecisions;
+}
+
+void AISchedulerNextFrame(AIScheduler *s)
+{
+	s->Frame++;
+	s->LastDecided = s->Decided;
+	s->LastSkipped = s->Skipped;
+	s->LastDeferred = s->Deferred;
+	s->Decided = 0;
+	s->Skipped = 0;
+	s->Deferred = 0;
+}
+
+AIPriority AISchedulerGetPriority(const int distance)
+{
+	if (distance < 0 || distance >= AI_SCHEDULER_NEAR_TILES)
+	{
+		return AI_PRIORITY_FAR;
+	}
+	if (distance >= AI_SCHEDULER_CLOSE_TILES)
+	{
+		return AI_PRIORITY_NEAR;
+	}
+	return AI_PRIORITY_CLOSE;
+}
+
+bool AISchedulerShouldDecide(
+	AIScheduler *s, int *nextFrame, const int uid, const AIPriority priority)
+{
+	int interval = 1;
+	switch (priority)
+	{
+	case AI_PRIORITY_FAR:
+		interval = AI_SCHEDULER_FAR_INTERVAL;
+		break;
+	case AI_PRIORITY_NEAR:
+		interval = AI_SCHEDULER_NEAR_INTERVAL;
+		break;
+	default:
+		break;
+	}
+	if (priority != AI_PRIORITY_CLOSE)
+	{
+		if (s->Frame < *nextFrame)
+		{
+			s->Skipped++;
+			return false;
+		}
+		// Stays due, so it decides on the next frame with spare budget
+		if (s->MaxDecisions > 0 && s->Decided >= s->MaxDecisions)
+		{
+			s->Deferred++;
+			return false;
+		}
+	}
+	s->Decided++;
+	// Next due on the actor's own slot, offset by its UID
+	*nextFrame = s->Frame + interval - (s->Frame + uid) % interval;
+	return true;
+}
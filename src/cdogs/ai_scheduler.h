@@ -0,0 +1,79 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+// How far from the closest player, in tiles, actors are still re-planned
+// every frame; about half a screen
+#define AI_SCHEDULER_CLOSE_TILES 12
+// Beyond this, actors would normally be asleep
+#define AI_SCHEDULER_NEAR_TILES 40
+
+// How often an actor re-plans, by how close it is to the action
+typedef enum
+{
+	AI_PRIORITY_FAR,	// every AI_SCHEDULER_FAR_INTERVAL frames
+	AI_PRIORITY_NEAR,	// every AI_SCHEDULER_NEAR_INTERVAL frames
+	AI_PRIORITY_CLOSE	// every frame, regardless of the budget
+} AIPriority;
+#define AI_SCHEDULER_NEAR_INTERVAL 4
+#define AI_SCHEDULER_FAR_INTERVAL 16
+
+// Spreads bad guy decisions across frames
+// Everything here depends only on the game state, never on the wall clock,
+// so that the AI's use of the random sequence replays identically
+typedef struct
+{
+	// Maximum number of decisions per frame for actors that aren't close;
+	// 0 for no limit
+	int MaxDecisions;
+	int Frame;
+	// Counts for the frame being simulated, and for the last whole frame:
+	// full decisions made, actors not due to decide, and actors that were
+	// due but were put off to a later frame by the budget
+	int Decided;
+	int Skipped;
+	int Deferred;
+	int LastDecided;
+	int LastSkipped;
+	int LastDeferred;
+} AIScheduler;
+
+void AISchedulerInit(AIScheduler *s, const int maxDecisions);
+// Start scheduling a new frame
+void AISchedulerNextFrame(AIScheduler *s);
+// distance: to the closest player in tiles, or negative if there is none
+AIPriority AISchedulerGetPriority(const int distance);
+// Whether an actor should make a full decision this frame; if not, it should
+// carry on with a cheap behaviour
+// nextFrame: the actor's own state, the frame at which it is next due;
+// initially 0, which is always due
+// uid: used to stagger actors so that they don't all decide together
+bool AISchedulerShouldDecide(
+	AIScheduler *s, int *nextFrame, const int uid, const AIPriority priority);
@@ -0,0 +1,84 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "ai_think.h"
+
+#include <stdlib.h>
+
+
+void AIThinkInit(AIThink *t, AIThinkFunc func, void *data)
+{
+	CArrayInit(&t->Items, sizeof(AIThinkItem));
+	t->Func = func;
+	t->Data = data;
+}
+void AIThinkTerminate(AIThink *t)
+{
+	CArrayTerminate(&t->Items);
+}
+
+void AIThinkAdd(AIThink *t, TActor *a, const bool think, const int cmd)
+{
+	AIThinkItem item;
+	item.Actor = a;
+	item.Think = think;
+	item.Cmd = think ? 0 : cmd;
+	CArrayPushBack(&t->Items, &item);
+}
+
+static void Think(void *data, const int index);
+static int CompareItemUIDs(const void *v1, const void *v2);
+void AIThinkRun(AIThink *t, ThreadPool *tp, const unsigned int seed)
+{
+	CA_FOREACH(const AIThinkItem, item, t->Items)
+		if (item->Think)
+		{
+			// Give each actor a different sequence, that doesn't depend on
+			// which thread it runs on
+			item->Actor->aiContext->RandSeed =
+				seed ^ ((unsigned int)item->Actor->uid * 0x9E3779B9u);
+		}
+	CA_FOREACH_END()
+	ThreadPoolRun(tp, Think, t, (int)t->Items.size);
+	qsort(
+		t->Items.data, t->Items.size, t->Items.elemSize, CompareItemUIDs);
+}
+static void Think(void *data, const int index)
+{
+	AIThink *t = data;
+	AIThinkItem *item = CArrayGet(&t->Items, index);
+	if (item->Think)
+	{
+		item->Cmd = t->Func(item->Actor, t->Data);
+	}
+}
+static int CompareItemUIDs(const void *v1, const void *v2)
+{
+	const AIThinkItem *i1 = v1;
+	const AIThinkItem *i2 = v2;
+	return i1->Actor->uid - i2->Actor->uid;
+}
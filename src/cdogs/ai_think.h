@@ -0,0 +1,69 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include "actors.h"
+#include "c_array.h"
+#include "thread_pool.h"
+
+// Two phase AI update:
+// - think: decide commands, in parallel across a thread pool
+// - act: the caller applies the commands serially, in UID order
+// Thinking must only write to the actor's own state and AI context, and
+// must only use the actor's own random sequence (AIContext.RandSeed), so
+// that results are the same regardless of the number of threads.
+// Other actors read the actor's flags while thinking, so changes to them go
+// in AIContext.Flags and are applied when acting.
+
+// Decide a command for an actor
+typedef int (*AIThinkFunc)(TActor *a, void *data);
+
+typedef struct
+{
+	TActor *Actor;
+	bool Think;
+	// Command to apply; decided by the think phase if Think is set
+	int Cmd;
+} AIThinkItem;
+
+typedef struct
+{
+	CArray Items;	// of AIThinkItem
+	AIThinkFunc Func;
+	void *Data;
+} AIThink;
+
+void AIThinkInit(AIThink *t, AIThinkFunc func, void *data);
+void AIThinkTerminate(AIThink *t);
+// Add an actor to the frame; if it doesn't think, cmd is applied as is
+void AIThinkAdd(AIThink *t, TActor *a, const bool think, const int cmd);
+// Run the think phase, then sort the items by UID ready for acting
+// seed: seeds each thinking actor's random sequence, along with its UID
+void AIThinkRun(AIThink *t, ThreadPool *tp, const unsigned int seed);
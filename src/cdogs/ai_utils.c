@@ -56,6 +56,8 @@
 #include "map.h"
 #include "objs.h"
 #include "path_cache.h"
+#include "spatial_query.h"
+#include "visibility_cache.h"
 #include "weapon.h"
 
 
@@ -80,36 +82,46 @@ TActor *AIGetClosestPlayer(Vec2i fullpos)
 	return closestPlayer;
 }
 
+typedef struct
+{
+	const TActor *From;
+	bool (*CompFunc)(const TActor *, const TActor *);
+} ClosestActorData;
+static bool IsClosestActorCandidate(
+	const ThingId *tid, const TTileItem *ti, void *data)
+{
+	UNUSED(ti);
+	const ClosestActorData *d = data;
+	const TActor *a = CArrayGet(&gActors, tid->Id);
+	if (!a->isInUse || a->dead)
+	{
+		return false;
+	}
+	// Never target invulnerables or civilians
+	if (a->flags & (FLAGS_INVULNERABLE | FLAGS_PENALTY))
+	{
+		return false;
+	}
+	return d->CompFunc(a, d->From);
+}
 static TActor *AIGetClosestActor(
 	const Vec2i fromPos, const TActor *from,
 	bool (*compFunc)(const TActor *, const TActor *))
 {
-	// Search all the actors and find the closest one that
-	// satisfies the condition
-	TActor *closest = NULL;
-	int minDistance = -1;
-	CA_FOREACH(TActor, a, gActors)
-		if (!a->isInUse || a->dead)
-		{
-			continue;
-		}
-		// Never target invulnerables or civilians
-		if (a->flags & (FLAGS_INVULNERABLE | FLAGS_PENALTY))
-		{
-			continue;
-		}
-		if (compFunc(a, from))
-		{
-			int distance = CHEBYSHEV_DISTANCE(
-				fromPos.x, fromPos.y, a->Pos.x, a->Pos.y);
-			if (!closest || distance < minDistance)
-			{
-				minDistance = distance;
-				closest = a;
-			}
-		}
-	CA_FOREACH_END()
-	return closest;
+	// Find the closest actor that satisfies the condition
+	ClosestActorData data;
+	data.From = from;
+	data.CompFunc = compFunc;
+	SpatialQuery q =
+		SpatialQueryNew(fromPos, SPATIAL_QUERY_KIND(KIND_CHARACTER));
+	q.Filter = IsClosestActorCandidate;
+	q.FilterData = &data;
+	SpatialQueryResult r;
+	if (SpatialQueryNearest(&gMap, &q, &r, 1) == 0)
+	{
+		return NULL;
+	}
+	return CArrayGet(&gActors, r.Id.Id);
 }
 
 static bool IsGood(const TActor *a, const TActor *b)
@@ -202,13 +214,28 @@ int AIReverseDirection(int cmd)
 typedef bool (*IsBlockedFunc)(void *, Vec2i);
 static bool AIHasClearLine(
 	Vec2i from, Vec2i to, IsBlockedFunc isBlockedFunc);
+static bool AIHasClearLineCached(
+	const Vec2i from, const Vec2i to, IsBlockedFunc isBlockedFunc,
+	const VisibilityKind kind);
 static bool IsPosNoWalk(void *data, Vec2i pos);
 static bool IsPosNoWalkAroundObjects(void *data, Vec2i pos);
 bool AIHasClearPath(
 	const Vec2i from, const Vec2i to, const bool ignoreObjects)
 {
-	IsBlockedFunc f = ignoreObjects ? IsPosNoWalk : IsPosNoWalkAroundObjects;
-	return AIHasClearLine(from, to, f);
+	if (ignoreObjects)
+	{
+		return AIHasClearLineCached(from, to, IsPosNoWalk, VISIBILITY_WALK);
+	}
+	// Actors move every frame, so these can't be cached
+	return AIHasClearLine(from, to, IsPosNoWalkAroundObjects);
+}
+static bool AIHasClearLineCached(
+	const Vec2i from, const Vec2i to, IsBlockedFunc isBlockedFunc,
+	const VisibilityKind kind)
+{
+	// Most lines in the open are known to be clear without walking them
+	return VisibilityCacheIsClear(&gVisibilityCache, from, to, kind) ||
+		AIHasClearLine(from, to, isBlockedFunc);
 }
 static bool AIHasClearLine(
 	Vec2i from, Vec2i to, IsBlockedFunc isBlockedFunc)
@@ -224,26 +251,10 @@ static bool AIHasClearLine(
 static bool IsTileWalkableOrOpenable(Map *map, Vec2i pos);
 bool IsTileWalkable(Map *map, const Vec2i pos)
 {
-	if (!IsTileWalkableOrOpenable(map, pos))
-	{
-		return false;
-	}
 	// Check if tile has a dangerous (explosive) item on it
 	// For AI, we don't want to shoot it, so just walk around
-	Tile *t = MapGetTile(map, pos);
-	CA_FOREACH(ThingId, tid, t->things)
-		// Only look for explosive objects
-		if (tid->Kind != KIND_OBJECT)
-		{
-			continue;
-		}
-		const TObject *o = CArrayGet(&gObjs, tid->Id);
-		if (ObjIsDangerous(o))
-		{
-			return false;
-		}
-	CA_FOREACH_END()
-	return true;
+	return IsTileWalkableOrOpenable(map, pos) &&
+		!(MapGetTileBlockers(map, pos) & TILE_BLOCKER_DANGEROUS);
 }
 static bool IsPosNoWalk(void *data, Vec2i pos)
 {
@@ -251,42 +262,26 @@ static bool IsPosNoWalk(void *data, Vec2i pos)
 }
 bool IsTileWalkableAroundObjects(Map *map, const Vec2i pos)
 {
-	if (!IsTileWalkableOrOpenable(map, pos))
+	// Check if tile has any item on it, apart from debris
+	int blockers = TILE_BLOCKER_OBJECT;
+	switch (gCollisionSystem.allyCollision)
 	{
-		return false;
+	case ALLYCOLLISION_NORMAL:
+		blockers |= TILE_BLOCKER_CHARACTER;
+		break;
+	case ALLYCOLLISION_REPEL:
+		// TODO: implement
+		// Need to know collision team of player
+		// to know if collision will result in repelling
+		break;
+	case ALLYCOLLISION_NONE:
+		break;
+	default:
+		CASSERT(false, "unknown collision type");
+		break;
 	}
-	// Check if tile has any item on it
-	Tile *t = MapGetTile(map, pos);
-	CA_FOREACH(ThingId, tid, t->things)
-		if (tid->Kind == KIND_OBJECT)
-		{
-			// Check that the object is not debris
-			const TObject *o = CArrayGet(&gObjs, tid->Id);
-			if (!TileItemIsDebris(&o->tileItem))
-			{
-				return false;
-			}
-		}
-		else if (tid->Kind == KIND_CHARACTER)
-		{
-			switch (gCollisionSystem.allyCollision)
-			{
-			case ALLYCOLLISION_NORMAL:
-				return false;
-			case ALLYCOLLISION_REPEL:
-				// TODO: implement
-				// Need to know collision team of player
-				// to know if collision will result in repelling
-				break;
-			case ALLYCOLLISION_NONE:
-				continue;
-			default:
-				CASSERT(false, "unknown collision type");
-				break;
-			}
-		}
-	CA_FOREACH_END()
-	return true;
+	return IsTileWalkableOrOpenable(map, pos) &&
+		!(MapGetTileBlockers(map, pos) & blockers);
 }
 static bool IsPosNoWalkAroundObjects(void *data, Vec2i pos)
 {
@@ -294,12 +289,11 @@ static bool IsPosNoWalkAroundObjects(void *data, Vec2i pos)
 }
 static bool IsTileWalkableOrOpenable(Map *map, Vec2i pos)
 {
-	const Tile *tile = MapGetTile(map, pos);
-	if (tile == NULL)
+	if (!MapIsTileIn(map, pos))
 	{
 		return false;
 	}
-	const int tileFlags = tile->flags;
+	const int tileFlags = MapGetTileFlags(map, pos);
 	if (!(tileFlags & MAPTILE_NO_WALK))
 	{
 		return true;
@@ -328,26 +322,26 @@ bool AIHasClearShot(const Vec2i from, const Vec2i to)
 	const int pad = 2;
 	fromOffset.x = from.x - (ACTOR_W + pad) / 2;
 	if (Vec2iToTile(fromOffset).x >= 0 &&
-		!AIHasClearLine(fromOffset, to, IsPosNoSee))
+		!AIHasClearLineCached(fromOffset, to, IsPosNoSee, VISIBILITY_SEE))
 	{
 		return false;
 	}
 	fromOffset.x = from.x + (ACTOR_W + pad) / 2;
 	if (Vec2iToTile(fromOffset).x < gMap.Size.x &&
-		!AIHasClearLine(fromOffset, to, IsPosNoSee))
+		!AIHasClearLineCached(fromOffset, to, IsPosNoSee, VISIBILITY_SEE))
 	{
 		return false;
 	}
 	fromOffset.x = from.x;
 	fromOffset.y = from.y - (ACTOR_H + pad) / 2;
 	if (Vec2iToTile(fromOffset).y >= 0 &&
-		!AIHasClearLine(fromOffset, to, IsPosNoSee))
+		!AIHasClearLineCached(fromOffset, to, IsPosNoSee, VISIBILITY_SEE))
 	{
 		return false;
 	}
 	fromOffset.y = from.y + (ACTOR_H + pad) / 2;
 	if (Vec2iToTile(fromOffset).y < gMap.Size.y &&
-		!AIHasClearLine(fromOffset, to, IsPosNoSee))
+		!AIHasClearLineCached(fromOffset, to, IsPosNoSee, VISIBILITY_SEE))
 	{
 		return false;
 	}
@@ -355,7 +349,7 @@ bool AIHasClearShot(const Vec2i from, const Vec2i to)
 }
 static bool IsPosNoSee(void *data, Vec2i pos)
 {
-	return MapGetTile(data, Vec2iToTile(pos))->flags & MAPTILE_NO_SEE;
+	return !MapTileCanSee(data, Vec2iToTile(pos));
 }
 
 TObject *AIGetObjectRunningInto(TActor *a, int cmd)
@@ -28,6 +28,7 @@
 #include "algorithms.h"
 
 #include <math.h>
+#include <string.h>
 
 
 typedef struct
@@ -289,3 +290,82 @@ bool CFloodFill(Vec2i v, FloodFillData *data)
 	}
 	return false;
 }
+
+// The automaton runs on copies of the grid with a border of walls 2 tiles
+// thick, so that neighbour counts need no bounds checks
+#define CAVE_BORDER 2
+void CaveCellularAutomaton(
+	uint8_t *walls, const Vec2i size, const int r1, const int r2,
+	const int generations)
+{
+	if (generations <= 0 || size.x <= 0 || size.y <= 0)
+	{
+		return;
+	}
+	const int w = size.x + 2 * CAVE_BORDER;
+	const int h = size.y + 2 * CAVE_BORDER;
+	uint8_t *cells[2];
+	CMALLOC(cells[0], w * h);
+	CMALLOC(cells[1], w * h);
+	memset(cells[0], 1, w * h);
+	memset(cells[1], 1, w * h);
+	// Horizontal sums of walls over windows of 3 and 5 tiles
+	uint8_t *sum3, *sum5;
+	CMALLOC(sum3, w * h);
+	CMALLOC(sum5, w * h);
+	for (int y = 0; y < size.y; y++)
+	{
+		memcpy(
+			cells[0] + (y + CAVE_BORDER) * w + CAVE_BORDER,
+			walls + y * size.x, size.x);
+	}
+
+	int cur = 0;
+	for (int i = 0; i < generations; i++)
+	{
+		const uint8_t *src = cells[cur];
+		uint8_t *dst = cells[1 - cur];
+		for (int y = 0; y < h; y++)
+		{
+			const uint8_t *row = src + y * w;
+			uint8_t *s3 = sum3 + y * w;
+			uint8_t *s5 = sum5 + y * w;
+			for (int x = CAVE_BORDER; x < w - CAVE_BORDER; x++)
+			{
+				s3[x] = (uint8_t)(row[x - 1] + row[x] + row[x + 1]);
+				s5[x] = (uint8_t)(s3[x] + row[x - 2] + row[x + 2]);
+			}
+		}
+		// Vertical sums of those give the counts over squares
+		for (int y = CAVE_BORDER; y < h - CAVE_BORDER; y++)
+		{
+			const uint8_t *a3 = sum3 + (y - 1) * w;
+			const uint8_t *b3 = sum3 + y * w;
+			const uint8_t *c3 = sum3 + (y + 1) * w;
+			const uint8_t *a5 = sum5 + (y - 2) * w;
+			const uint8_t *b5 = sum5 + (y - 1) * w;
+			const uint8_t *c5 = sum5 + y * w;
+			const uint8_t *d5 = sum5 + (y + 1) * w;
+			const uint8_t *e5 = sum5 + (y + 2) * w;
+			uint8_t *out = dst + y * w;
+			for (int x = CAVE_BORDER; x < w - CAVE_BORDER; x++)
+			{
+				const int count1 = a3[x] + b3[x] + c3[x];
+				const int count2 = a5[x] + b5[x] + c5[x] + d5[x] + e5[x];
+				out[x] = (uint8_t)(count1 >= r1 || count2 <= r2);
+			}
+		}
+		cur = 1 - cur;
+	}
+
+	for (int y = 0; y < size.y; y++)
+	{
+		memcpy(
+			walls + y * size.x,
+			cells[cur] + (y + CAVE_BORDER) * w + CAVE_BORDER, size.x);
+	}
+	CFREE(cells[0]);
+	CFREE(cells[1]);
+	CFREE(sum3);
+	CFREE(sum5);
+}
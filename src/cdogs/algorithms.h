@@ -29,6 +29,7 @@
 #define __ALGORITHMS
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "vector.h"
 
@@ -57,4 +58,12 @@ typedef struct
 } FloodFillData;
 bool CFloodFill(Vec2i v, FloodFillData *data);
 
+// Run generations of the cave cellular automaton over a grid of walls (1)
+// and floors (0). A tile becomes a wall if the number of walls within 1
+// distance is at least R1, OR the number of walls within 2 distance is at
+// most R2; otherwise it becomes a floor. Outside the grid counts as walls.
+void CaveCellularAutomaton(
+	uint8_t *walls, const Vec2i size, const int r1, const int r2,
+	const int generations);
+
 #endif
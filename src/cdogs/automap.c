@@ -213,7 +213,8 @@ static void DrawMap(
 			for (x = 0; x < gMap.Size.x; x++)
 			{
 				Tile *tile = MapGetTile(map, Vec2iNew(x, y));
-				if (!(tile->flags & MAPTILE_IS_NOTHING) &&
+				const int tileFlags = MapGetTileFlags(map, Vec2iNew(x, y));
+				if (!(tileFlags & MAPTILE_IS_NOTHING) &&
 					(tile->isVisited || (flags & AUTOMAP_FLAGS_SHOWALL)))
 				{
 					int j;
@@ -223,15 +224,15 @@ static void DrawMap(
 							mapPos.x + x*scale + j,
 							mapPos.y + y*scale + i);
 						color_t color = colorRoom;
-						if (tile->flags & MAPTILE_IS_WALL)
+						if (tileFlags & MAPTILE_IS_WALL)
 						{
 							color = colorWall;
 						}
-						else if (tile->flags & MAPTILE_NO_WALK)
+						else if (tileFlags & MAPTILE_NO_WALK)
 						{
 							color = DoorColor(x, y);
 						}
-						else if (tile->flags & MAPTILE_IS_NORMAL_FLOOR)
+						else if (tileFlags & MAPTILE_IS_NORMAL_FLOOR)
 						{
 							color = colorFloor;
 						}
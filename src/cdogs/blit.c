@@ -159,7 +159,7 @@ void BlitBackground(
 			}
 			if ((isTransparent && *current) ||  !isTransparent)
 			{
-				Uint32 *target = gGraphicsDevice.buf + yoff + xoff;
+				Uint32 *target = device->buf + yoff + xoff;
 				if (tint != NULL)
 				{
 					const color_t targetColor = PIXEL2COLOR(*target);
@@ -334,6 +334,22 @@ void BlitCharMultichannel(
 		}
 	}
 }
+Pic PicCharMultichannel(const Pic *pic, const CharColors *masks)
+{
+	Pic p = PicCopy(pic);
+	for (int i = 0; i < p.size.x * p.size.y; i++)
+	{
+		Uint32 *current = p.Data + i;
+		if (*current == 0)
+		{
+			continue;
+		}
+		const color_t color = PIXEL2COLOR(*current);
+		*current = PixelMult(
+			*current, COLOR2PIXEL(CharColorsGetChannelMask(masks, color.a)));
+	}
+	return p;
+}
 static color_t CharColorsGetChannelMask(
 	const CharColors *c, const uint8_t alpha)
 {
@@ -88,6 +88,8 @@ void BlitCharMultichannel(
 	const Pic *pic,
 	const Vec2i pos,
 	const CharColors *masks);
+// Make a copy of the pic recoloured as BlitCharMultichannel would
+Pic PicCharMultichannel(const Pic *pic, const CharColors *masks);
 void BlitBlend(
 	GraphicsDevice *g, const Pic *pic, Vec2i pos, const color_t blend);
 void BlitPicHighlight(
@@ -54,11 +54,11 @@
 #include "collision.h"
 #include "drawtools.h"
 #include "game_events.h"
-#include "json_utils.h"
 #include "log.h"
 #include "net_util.h"
 #include "objs.h"
 #include "screen_shake.h"
+#include "yajl_utils.h"
 
 BulletClasses gBulletClasses;
 
@@ -87,6 +87,31 @@ BulletClass *StrBulletClass(const char *s)
 	CASSERT(false, "cannot parse bullet name");
 	return NULL;
 }
+BulletClass *IdBulletClass(const int i)
+{
+	CASSERT(
+		i >= 0 &&
+		i < (int)gBulletClasses.Classes.size +
+		(int)gBulletClasses.CustomClasses.size,
+		"Bullet class index out of bounds");
+	if (i < (int)gBulletClasses.Classes.size)
+	{
+		return CArrayGet(&gBulletClasses.Classes, i);
+	}
+	return CArrayGet(
+		&gBulletClasses.CustomClasses, i - gBulletClasses.Classes.size);
+}
+int BulletClassId(const BulletClass *b)
+{
+	const int idx = CArrayIndexOf(&gBulletClasses.Classes, b);
+	if (idx >= 0)
+	{
+		return idx;
+	}
+	const int customIdx = CArrayIndexOf(&gBulletClasses.CustomClasses, b);
+	CASSERT(customIdx >= 0, "cannot find bullet class");
+	return (int)gBulletClasses.Classes.size + customIdx;
+}
 
 // Draw functions
 
@@ -299,7 +324,7 @@ bool UpdateBullet(TMobileObject *obj, const int ticks)
 			b.u.BulletBounce.BounceVel = Vec2i2Net(bounceVel);
 			obj->vel = bounceVel;
 		}
-		GameEventsEnqueue(&gGameEvents, b);
+		GameEventsEnqueue(&gGameEvents, &b);
 		if (!alive)
 		{
 			return false;
@@ -460,8 +485,6 @@ static HitType GetHitType(
 
 
 #define VERSION 1
-static void LoadBullet(
-	BulletClass *b, json_t *node, const BulletClass *defaultBullet);
 void BulletInitialize(BulletClasses *bullets)
 {
 	memset(bullets, 0, sizeof *bullets);
@@ -469,42 +492,83 @@ void BulletInitialize(BulletClasses *bullets)
 	CArrayInit(&bullets->CustomClasses, sizeof(BulletClass));
 }
 static void BulletClassFree(BulletClass *b);
-void BulletLoadJSON(
-	BulletClasses *bullets, CArray *classes, json_t *bulletNode)
+static void BulletGunNamesFree(BulletGunNames *n);
+
+// Bullets are streamed from file one field at a time
+typedef struct
+{
+	BulletClasses *bullets;
+	CArray *classes;
+	bool isDefault;
+	bool skip;
+	BulletClass b;
+	CPicFields pic;
+	int speed;
+	bool hasSpeed;
+	bool hasSpeedLow;
+	bool hasSpeedHigh;
+	int range;
+	bool hasRange;
+	bool hasRangeLow;
+	bool hasRangeHigh;
+	bool hasHitSounds;
+} BulletLoader;
+static bool LoadBulletHeader(void *data, const char *key, const char *value);
+static void LoadBulletBegin(void *data, const char *section);
+static void LoadBulletField(
+	void *data, const char *key, const int index, const char *value);
+static void LoadBulletEnd(void *data);
+bool BulletLoadFile(
+	BulletClasses *bullets, CArray *classes, const char *path)
 {
 	LOG(LM_MAP, LL_DEBUG, "loading bullets");
-	int version;
-	LoadInt(&version, bulletNode, "Version");
-	if (version > VERSION || version <= 0)
-	{
-		CASSERT(false, "cannot read bullets file version");
-		return;
-	}
-
-	// Defaults
-	json_t *defaultNode = json_find_first_label(bulletNode, "DefaultBullet");
-	if (defaultNode != NULL)
+	BulletLoader l;
+	memset(&l, 0, sizeof l);
+	l.bullets = bullets;
+	l.classes = classes;
+	const YAJLStreamHandler h =
 	{
-		BulletClassFree(&bullets->Default);
-		LoadBullet(&bullets->Default, defaultNode->child, NULL);
-	}
-
-	json_t *bulletsNode = json_find_first_label(bulletNode, "Bullets")->child;
-	for (json_t *child = bulletsNode->child; child; child = child->next)
+		&l,
+		LoadBulletHeader,
+		LoadBulletBegin,
+		LoadBulletField,
+		LoadBulletEnd
+	};
+	const bool ok = YAJLStreamFile(path, NULL, &h);
+	// Left over if loading failed part way
+	BulletClassFree(&l.b);
+	CPicFieldsTerminate(&l.pic);
+	return ok;
+}
+static bool LoadBulletHeader(void *data, const char *key, const char *value)
+{
+	UNUSED(data);
+	if (strcmp(key, "Version") == 0)
 	{
-		BulletClass b;
-		LoadBullet(&b, child, &bullets->Default);
-		CArrayPushBack(classes, &b);
+		const int version = value != NULL ? atoi(value) : 0;
+		if (version > VERSION || version <= 0)
+		{
+			CASSERT(false, "cannot read bullets file version");
+			return false;
+		}
 	}
-
-	bullets->root = bulletNode;
+	return true;
 }
-static void LoadBullet(
-	BulletClass *b, json_t *node, const BulletClass *defaultBullet)
+static void LoadBulletBegin(void *data, const char *section)
 {
+	BulletLoader *l = data;
+	BulletClass *b = &l->b;
+	l->isDefault = strcmp(section, "DefaultBullet") == 0;
+	l->skip = !l->isDefault && strcmp(section, "Bullets") != 0;
+	if (l->skip)
+	{
+		return;
+	}
 	memset(b, 0, sizeof *b);
-	if (defaultBullet != NULL)
+	if (!l->isDefault)
 	{
+		// The default bullet must come before the bullets that use it
+		const BulletClass *defaultBullet = &l->bullets->Default;
 		memcpy(b, defaultBullet, sizeof *b);
 		if (defaultBullet->Name != NULL)
 		{
@@ -527,88 +591,210 @@ static void LoadBullet(
 		memset(&b->OutOfRangeGuns, 0, sizeof b->OutOfRangeGuns);
 		memset(&b->HitGuns, 0, sizeof b->HitGuns);
 		memset(&b->ProximityGuns, 0, sizeof b->ProximityGuns);
+		b->gunNames = NULL;
 	}
-
-	char *tmp;
-
-	tmp = NULL;
-	LoadStr(&tmp, node, "Name");
-	if (tmp != NULL)
+	l->hasSpeed = l->hasSpeedLow = l->hasSpeedHigh = false;
+	l->hasRange = l->hasRangeLow = l->hasRangeHigh = false;
+	l->hasHitSounds = false;
+}
+static BulletGunNames *GetGunNames(BulletClass *b);
+static void AddGunName(CArray *names, const char *name);
+static void LoadBulletField(
+	void *data, const char *key, const int index, const char *value)
+{
+	BulletLoader *l = data;
+	BulletClass *b = &l->b;
+	if (l->skip || value == NULL)
+	{
+		return;
+	}
+	if (strncmp(key, "Pic/", strlen("Pic/")) == 0)
+	{
+		CPicFieldsLoad(&l->pic, key + strlen("Pic/"), index, value);
+	}
+	else if (strncmp(key, "HitSounds/", strlen("HitSounds/")) == 0)
+	{
+		if (!l->hasHitSounds)
+		{
+			CFREE(b->HitSound.Object);
+			b->HitSound.Object = NULL;
+			CFREE(b->HitSound.Flesh);
+			b->HitSound.Flesh = NULL;
+			CFREE(b->HitSound.Wall);
+			b->HitSound.Wall = NULL;
+			l->hasHitSounds = true;
+		}
+		char **sound = NULL;
+		if (strcmp(key, "HitSounds/Object") == 0)
+		{
+			sound = &b->HitSound.Object;
+		}
+		else if (strcmp(key, "HitSounds/Flesh") == 0)
+		{
+			sound = &b->HitSound.Flesh;
+		}
+		else if (strcmp(key, "HitSounds/Wall") == 0)
+		{
+			sound = &b->HitSound.Wall;
+		}
+		if (sound != NULL)
+		{
+			CFREE(*sound);
+			CSTRDUP(*sound, value);
+		}
+	}
+	else if (strcmp(key, "Name") == 0)
 	{
 		CFREE(b->Name);
-		b->Name = tmp;
+		CSTRDUP(b->Name, value);
+	}
+	else if (strcmp(key, "ShadowSize") == 0)
+	{
+		if (index == 0) b->ShadowSize.x = atoi(value);
+		else if (index == 1) b->ShadowSize.y = atoi(value);
+	}
+	else if (strcmp(key, "Delay") == 0)
+	{
+		b->Delay = atoi(value);
+	}
+	else if (strcmp(key, "Speed") == 0)
+	{
+		l->speed = atoi(value);
+		l->hasSpeed = true;
+	}
+	else if (strcmp(key, "SpeedLow") == 0)
+	{
+		b->SpeedLow = atoi(value);
+		l->hasSpeedLow = true;
+	}
+	else if (strcmp(key, "SpeedHigh") == 0)
+	{
+		b->SpeedHigh = atoi(value);
+		l->hasSpeedHigh = true;
+	}
+	else if (strcmp(key, "SpeedScale") == 0)
+	{
+		b->SpeedScale = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "Friction") == 0)
+	{
+		b->Friction = atoi(value);
+	}
+	else if (strcmp(key, "Range") == 0)
+	{
+		l->range = atoi(value);
+		l->hasRange = true;
+	}
+	else if (strcmp(key, "RangeLow") == 0)
+	{
+		b->RangeLow = atoi(value);
+		l->hasRangeLow = true;
+	}
+	else if (strcmp(key, "RangeHigh") == 0)
+	{
+		b->RangeHigh = atoi(value);
+		l->hasRangeHigh = true;
 	}
-	if (json_find_first_label(node, "Pic"))
+	else if (strcmp(key, "Power") == 0)
 	{
-		CPicLoadJSON(&b->CPic, json_find_first_label(node, "Pic")->child);
+		b->Power = atoi(value);
 	}
-	LoadVec2i(&b->ShadowSize, node, "ShadowSize");
-	LoadInt(&b->Delay, node, "Delay");
-	if (json_find_first_label(node, "Speed"))
+	else if (strcmp(key, "Size") == 0)
 	{
-		LoadInt(&b->SpeedLow, node, "Speed");
-		b->SpeedHigh = b->SpeedLow;
+		if (index == 0) b->Size.x = atoi(value);
+		else if (index == 1) b->Size.y = atoi(value);
 	}
-	LoadInt(&b->SpeedLow, node, "SpeedLow");
-	LoadInt(&b->SpeedHigh, node, "SpeedHigh");
-	b->SpeedLow = MIN(b->SpeedLow, b->SpeedHigh);
+	else if (strcmp(key, "Special") == 0)
+	{
+		b->Special = StrSpecialDamage(value);
+	}
+	else if (strcmp(key, "HurtAlways") == 0)
+	{
+		b->HurtAlways = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "Persists") == 0)
+	{
+		b->Persists = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "Spark") == 0)
+	{
+		b->Spark = StrParticleClass(&gParticleClasses, value);
+	}
+	else if (strcmp(key, "WallBounces") == 0)
+	{
+		b->WallBounces = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "HitsObjects") == 0)
+	{
+		b->HitsObjects = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "Falling/GravityFactor") == 0)
+	{
+		b->Falling.GravityFactor = atoi(value);
+	}
+	else if (strcmp(key, "Falling/FallsDown") == 0)
+	{
+		b->Falling.FallsDown = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "Falling/DestroyOnDrop") == 0)
+	{
+		b->Falling.DestroyOnDrop = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "Falling/Bounces") == 0)
+	{
+		b->Falling.Bounces = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "Falling/DropGuns") == 0)
+	{
+		AddGunName(&GetGunNames(b)->DropGuns, value);
+	}
+	else if (strcmp(key, "OutOfRangeGuns") == 0)
+	{
+		AddGunName(&GetGunNames(b)->OutOfRangeGuns, value);
+	}
+	else if (strcmp(key, "HitGuns") == 0)
+	{
+		AddGunName(&GetGunNames(b)->HitGuns, value);
+	}
+	else if (strcmp(key, "ProximityGuns") == 0)
+	{
+		AddGunName(&GetGunNames(b)->ProximityGuns, value);
+	}
+	else if (strcmp(key, "SeekFactor") == 0)
+	{
+		b->SeekFactor = atoi(value);
+	}
+	else if (strcmp(key, "Erratic") == 0)
+	{
+		b->Erratic = strcmp(value, "true") == 0;
+	}
+}
+static void LoadBulletEnd(void *data)
+{
+	BulletLoader *l = data;
+	BulletClass *b = &l->b;
+	if (l->skip)
+	{
+		return;
+	}
+	CPicLoadFields(&b->CPic, &l->pic);
+	// "Speed"/"Range" set both ends; "...Low"/"...High" override them
+	if (l->hasSpeed)
+	{
+		if (!l->hasSpeedLow) b->SpeedLow = l->speed;
+		if (!l->hasSpeedHigh) b->SpeedHigh = l->speed;
+	}
+	int low = MIN(b->SpeedLow, b->SpeedHigh);
 	b->SpeedHigh = MAX(b->SpeedLow, b->SpeedHigh);
-	LoadBool(&b->SpeedScale, node, "SpeedScale");
-	LoadInt(&b->Friction, node, "Friction");
-	if (json_find_first_label(node, "Range"))
+	b->SpeedLow = low;
+	if (l->hasRange)
 	{
-		LoadInt(&b->RangeLow, node, "Range");
-		b->RangeHigh = b->RangeLow;
+		if (!l->hasRangeLow) b->RangeLow = l->range;
+		if (!l->hasRangeHigh) b->RangeHigh = l->range;
 	}
-	LoadInt(&b->RangeLow, node, "RangeLow");
-	LoadInt(&b->RangeHigh, node, "RangeHigh");
-	b->RangeLow = MIN(b->RangeLow, b->RangeHigh);
+	low = MIN(b->RangeLow, b->RangeHigh);
 	b->RangeHigh = MAX(b->RangeLow, b->RangeHigh);
-	LoadInt(&b->Power, node, "Power");
-	LoadVec2i(&b->Size, node, "Size");
-	tmp = NULL;
-	LoadStr(&tmp, node, "Special");
-	if (tmp != NULL)
-	{
-		b->Special = StrSpecialDamage(tmp);
-		CFREE(tmp);
-	}
-	LoadBool(&b->HurtAlways, node, "HurtAlways");
-	LoadBool(&b->Persists, node, "Persists");
-	tmp = NULL;
-	LoadStr(&tmp, node, "Spark");
-	if (tmp != NULL)
-	{
-		b->Spark = StrParticleClass(&gParticleClasses, tmp);
-		CFREE(tmp);
-	}
-	if (json_find_first_label(node, "HitSounds"))
-	{
-		json_t *hitSounds = json_find_first_label(node, "HitSounds")->child;
-		CFREE(b->HitSound.Object);
-		b->HitSound.Object = NULL;
-		LoadStr(&b->HitSound.Object, hitSounds, "Object");
-		CFREE(b->HitSound.Flesh);
-		b->HitSound.Flesh = NULL;
-		LoadStr(&b->HitSound.Flesh, hitSounds, "Flesh");
-		CFREE(b->HitSound.Wall);
-		b->HitSound.Wall = NULL;
-		LoadStr(&b->HitSound.Wall, hitSounds, "Wall");
-	}
-	LoadBool(&b->WallBounces, node, "WallBounces");
-	LoadBool(&b->HitsObjects, node, "HitsObjects");
-	if (json_find_first_label(node, "Falling"))
-	{
-		json_t *falling = json_find_first_label(node, "Falling")->child;
-		LoadInt(&b->Falling.GravityFactor, falling, "GravityFactor");
-		LoadBool(&b->Falling.FallsDown, falling, "FallsDown");
-		LoadBool(&b->Falling.DestroyOnDrop, falling, "DestroyOnDrop");
-		LoadBool(&b->Falling.Bounces, falling, "Bounces");
-	}
-	LoadInt(&b->SeekFactor, node, "SeekFactor");
-	LoadBool(&b->Erratic, node, "Erratic");
-
-	b->node = node;
+	b->RangeLow = low;
 
 	LOG(LM_MAP, LL_DEBUG,
 		"loaded bullet name(%s) shadowSize(%d, %d) delay(%d) speed(%d-%d)...",
@@ -635,46 +821,81 @@ static void LoadBullet(
 		b->Falling.FallsDown ? "true" : "false",
 		b->Falling.DestroyOnDrop ? "true" : "false");
 	LOG(LM_MAP, LL_DEBUG,
-		"...dropGuns(%d) seekFactor(%d) erratic(%s)...",
-		(int)b->Falling.DropGuns.size, b->SeekFactor,
-		b->Erratic ? "true" : "false");
-	LOG(LM_MAP, LL_DEBUG,
-		"...outOfRangeGuns(%d) hitGuns(%d) proximityGuns(%d)",
-		(int)b->OutOfRangeGuns.size,
-		(int)b->HitGuns.size,
-		(int)b->ProximityGuns.size);
+		"...seekFactor(%d) erratic(%s)",
+		b->SeekFactor, b->Erratic ? "true" : "false");
+
+	if (l->isDefault)
+	{
+		BulletClassFree(&l->bullets->Default);
+		BulletGunNamesFree(b->gunNames);
+		CFREE(b->gunNames);
+		b->gunNames = NULL;
+		memcpy(&l->bullets->Default, b, sizeof *b);
+	}
+	else
+	{
+		CArrayPushBack(l->classes, b);
+	}
+	// Ownership of the strings has moved
+	memset(b, 0, sizeof *b);
+}
+static BulletGunNames *GetGunNames(BulletClass *b)
+{
+	if (b->gunNames == NULL)
+	{
+		CCALLOC(b->gunNames, sizeof *b->gunNames);
+		CArrayInit(&b->gunNames->DropGuns, sizeof(char *));
+		CArrayInit(&b->gunNames->OutOfRangeGuns, sizeof(char *));
+		CArrayInit(&b->gunNames->HitGuns, sizeof(char *));
+		CArrayInit(&b->gunNames->ProximityGuns, sizeof(char *));
+	}
+	return b->gunNames;
+}
+static void AddGunName(CArray *names, const char *name)
+{
+	char *s;
+	CSTRDUP(s, name);
+	CArrayPushBack(names, &s);
 }
 static void BulletClassesLoadWeapons(CArray *classes);
 void BulletLoadWeapons(BulletClasses *bullets)
 {
 	BulletClassesLoadWeapons(&bullets->Classes);
 	BulletClassesLoadWeapons(&bullets->CustomClasses);
-	json_free_value(&bullets->root);
 }
+static void LoadBulletGuns(CArray *guns, const CArray *names);
 static void BulletClassesLoadWeapons(CArray *classes)
 {
 	for (int i = 0; i < (int)classes->size; i++)
 	{
 		BulletClass *b = CArrayGet(classes, i);
-		if (b->node == NULL)
+		if (b->gunNames == NULL)
 		{
 			continue;
 		}
 
-		if (json_find_first_label(b->node, "Falling"))
-		{
-			LoadBulletGuns(
-				&b->Falling.DropGuns,
-				json_find_first_label(b->node, "Falling")->child,
-				"DropGuns");
-		}
-		LoadBulletGuns(&b->OutOfRangeGuns, b->node, "OutOfRangeGuns");
-		LoadBulletGuns(&b->HitGuns, b->node, "HitGuns");
-		LoadBulletGuns(&b->ProximityGuns, b->node, "ProximityGuns");
+		LoadBulletGuns(&b->Falling.DropGuns, &b->gunNames->DropGuns);
+		LoadBulletGuns(&b->OutOfRangeGuns, &b->gunNames->OutOfRangeGuns);
+		LoadBulletGuns(&b->HitGuns, &b->gunNames->HitGuns);
+		LoadBulletGuns(&b->ProximityGuns, &b->gunNames->ProximityGuns);
 
-		b->node = NULL;
+		BulletGunNamesFree(b->gunNames);
+		CFREE(b->gunNames);
+		b->gunNames = NULL;
 	}
 }
+static void LoadBulletGuns(CArray *guns, const CArray *names)
+{
+	if (names->size == 0)
+	{
+		return;
+	}
+	CArrayInit(guns, sizeof(const GunDescription *));
+	CA_FOREACH(const char *, name, *names)
+		const GunDescription *g = StrGunDescription(*name);
+		CArrayPushBack(guns, &g);
+	CA_FOREACH_END()
+}
 void BulletTerminate(BulletClasses *bullets)
 {
 	BulletClassFree(&bullets->Default);
@@ -701,6 +922,27 @@ static void BulletClassFree(BulletClass *b)
 	CArrayTerminate(&b->HitGuns);
 	CArrayTerminate(&b->Falling.DropGuns);
 	CArrayTerminate(&b->ProximityGuns);
+	BulletGunNamesFree(b->gunNames);
+	CFREE(b->gunNames);
+}
+static void GunNamesFree(CArray *names);
+static void BulletGunNamesFree(BulletGunNames *n)
+{
+	if (n == NULL)
+	{
+		return;
+	}
+	GunNamesFree(&n->DropGuns);
+	GunNamesFree(&n->OutOfRangeGuns);
+	GunNamesFree(&n->HitGuns);
+	GunNamesFree(&n->ProximityGuns);
+}
+static void GunNamesFree(CArray *names)
+{
+	CA_FOREACH(char *, name, *names)
+		CFREE(*name);
+	CA_FOREACH_END()
+	CArrayTerminate(names);
 }
 
 void BulletAdd(const NAddBullet add)
@@ -729,7 +971,7 @@ void BulletAdd(const NAddBullet add)
 	}
 	memset(obj, 0, sizeof *obj);
 	obj->UID = add.UID;
-	obj->bulletClass = StrBulletClass(add.BulletClass);
+	obj->bulletClass = IdBulletClass(add.BulletClassId);
 	obj->x = pos.x;
 	obj->y = pos.y;
 	obj->z = add.MuzzleHeight;
@@ -48,8 +48,6 @@
 */
 #pragma once
 
-#include <json/json.h>
-
 #include "proto/msg.pb.h"
 
 #include "particle.h"
@@ -58,6 +56,14 @@
 
 struct MobileObject;
 typedef bool (*BulletUpdateFunc)(struct MobileObject *, int);
+// Names of the guns a bullet fires, held until the guns are loaded
+typedef struct
+{
+	CArray DropGuns;	// of char *
+	CArray OutOfRangeGuns;	// of char *
+	CArray HitGuns;	// of char *
+	CArray ProximityGuns;	// of char *
+} BulletGunNames;
 typedef struct
 {
 	char *Name;
@@ -96,23 +102,26 @@ typedef struct
 	CArray HitGuns;	// of const GunDescription *
 	CArray ProximityGuns;	// of const GunDescription *
 
-	// Temporary JSON object for two-step bullet loading
-	json_t *node;
+	// Temporary gun names for two-step bullet loading
+	BulletGunNames *gunNames;
 } BulletClass;
 typedef struct
 {
 	CArray Classes;	// of BulletClass
 	BulletClass Default;
 	CArray CustomClasses;	// of BulletClass
-	json_t *root;
 } BulletClasses;
 extern BulletClasses gBulletClasses;
 
 BulletClass *StrBulletClass(const char *s);
+// IDs index the built-in classes then the custom ones, for sending bullet
+// classes over the network without names
+BulletClass *IdBulletClass(const int i);
+int BulletClassId(const BulletClass *b);
 
 void BulletInitialize(BulletClasses *bullets);
-void BulletLoadJSON(
-	BulletClasses *bullets, CArray *classes, json_t *bulletNode);
+bool BulletLoadFile(
+	BulletClasses *bullets, CArray *classes, const char *path);
 // 2-step initialisation since bullet and weapon reference each other
 void BulletLoadWeapons(BulletClasses *bullets);
 void BulletClassesClear(CArray *classes);
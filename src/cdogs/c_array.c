@@ -124,6 +124,16 @@ void *CArrayGet(const CArray *a, int idx)
 	CASSERT(idx >= 0 && idx < (int)a->size, "array index out of bounds");
 	return &((char *)a->data)[idx * a->elemSize];
 }
+int CArrayIndexOf(const CArray *a, const void *elem)
+{
+	const char *p = elem;
+	const char *data = a->data;
+	if (a->size == 0 || p < data || p >= data + a->size * a->elemSize)
+	{
+		return -1;
+	}
+	return (int)((p - data) / a->elemSize);
+}
 
 void CArrayClear(CArray *a)
 {
@@ -165,12 +175,12 @@ void CArrayFillZero(CArray *a)
 	memset(a->data, 0, a->size * a->elemSize);
 }
 
-void CArrayShuffle(CArray *a)
+void CArrayShuffle(CArray *a, unsigned int *seed)
 {
 	void *buf;
 	CMALLOC(buf, a->elemSize);
 	CA_FOREACH(void, e, *a)
-		const int j = rand() % (_ca_index + 1);
+		const int j = RandNext(seed) % (_ca_index + 1);
 		void *je = CArrayGet(a, j);
 		// Swap index and j elements
 		memcpy(buf, e, a->elemSize);
@@ -45,11 +45,14 @@ void CArrayInsert(CArray *a, int index, void *elem);
 void CArrayDelete(CArray *a, int index);
 void CArrayResize(CArray *a, const size_t size, const void *value);
 void *CArrayGet(const CArray *a, int index);	// gets address
+// Index of an element from its address, or -1 if it is not in the array
+int CArrayIndexOf(const CArray *a, const void *elem);
 void CArrayClear(CArray *a);
 void CArrayRemoveIf(CArray *a, bool(*removeIf)(const void *));
 void CArrayFill(CArray *a, const void *elem);
 void CArrayFillZero(CArray *a);
-void CArrayShuffle(CArray *a);
+// Shuffle using the private random sequence in seed; see RandNext
+void CArrayShuffle(CArray *a, unsigned int *seed);
 void CArrayTerminate(CArray *a);
 
 // Convenience macro for looping through a CArray
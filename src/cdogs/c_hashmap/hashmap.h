@@ -8,6 +8,7 @@
  */
 #pragma once
 
+#define MAP_EXISTS -4	/* Key already present */
 #define MAP_MISSING -3  /* No such element */
 #define MAP_FULL -2 	/* Hashmap is full */
 #define MAP_OMEM -1 	/* Out of Memory */
@@ -47,12 +48,15 @@ map_t hashmap_new(void);
 int hashmap_iterate(map_t in, PFany f, any_t item);
 
 /*
- * Add an element to the hashmap. Return MAP_OK or MAP_OMEM.
+ * Add an element to the hashmap. Return MAP_OK, MAP_OMEM, or MAP_EXISTS if
+ * the key is already present, in which case the existing value is kept and
+ * the caller still owns value.
  */
 int hashmap_put(map_t in, const char* key, any_t value);
 
 /*
  * Get an element from the hashmap. Return MAP_OK or MAP_MISSING.
+ * On MAP_MISSING, arg is set to NULL.
  */
 int hashmap_get(const map_t in, const char* key, any_t *arg);
 
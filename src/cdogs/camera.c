@@ -32,6 +32,7 @@
 #include "events.h"
 #include "font.h"
 #include "los.h"
+#include "particle.h"
 #include "player.h"
 
 
@@ -40,8 +41,12 @@
 void CameraInit(Camera *camera)
 {
 	memset(camera, 0, sizeof *camera);
-	DrawBufferInit(
-		&camera->Buffer, Vec2iNew(X_TILES, Y_TILES), &gGraphicsDevice);
+	for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+	{
+		DrawBufferInit(
+			&camera->Buffers[i], Vec2iNew(X_TILES, Y_TILES),
+			&camera->ViewDevices[i]);
+	}
 	camera->lastPosition = Vec2iZero();
 	HUDInit(&camera->HUD, &gGraphicsDevice, &gMission);
 	camera->shake = ScreenShakeZero();
@@ -49,7 +54,10 @@ void CameraInit(Camera *camera)
 
 void CameraTerminate(Camera *camera)
 {
-	DrawBufferTerminate(&camera->Buffer);
+	for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+	{
+		DrawBufferTerminate(&camera->Buffers[i]);
+	}
 	HUDTerminate(&camera->HUD);
 }
 
@@ -114,9 +122,16 @@ void CameraUpdate(Camera *camera, const int ticks, const int ms)
 	camera->shake = ScreenShakeUpdate(camera->shake, ticks);
 }
 
+typedef struct
+{
+	DrawBuffer *Buffers[MAX_LOCAL_PLAYERS];
+	Vec2i Offsets[MAX_LOCAL_PLAYERS];
+	int Count;
+} CameraViews;
 static void FollowPlayer(Vec2i *pos, const int playerUID);
-static void DoBuffer(
-	DrawBuffer *b, Vec2i center, int w, Vec2i noise, Vec2i offset);
+static void AddView(
+	CameraViews *views, Camera *camera,
+	Vec2i center, int w, Vec2i noise, Vec2i offset);
 void CameraDraw(
 	Camera *camera, const input_device_e pausingDevice,
 	const bool controllerUnplugged)
@@ -134,6 +149,11 @@ void CameraDraw(
 		GraphicsGetMemSize(&gGraphicsDevice.cachedConfig));
 
 	const Vec2i noise = ScreenShakeGetDelta(camera->shake);
+	// Views are prepared one at a time, as they share the map's LOS, and
+	// then drawn together
+	CameraViews views;
+	views.Count = 0;
+	ParticleBudgetClearViews(&gParticles.Budget);
 
 	GraphicsResetBlitClip(&gGraphicsDevice);
 	if (numLocalPlayersAlive == 0)
@@ -183,10 +203,10 @@ void CameraDraw(
 		{
 			FollowPlayer(&camera->lastPosition, camera->FollowPlayerUID);
 		}
-		DoBuffer(
-			&camera->Buffer,
-			camera->lastPosition,
+		AddView(
+			&views, camera, camera->lastPosition,
 			X_TILES, noise, centerOffset);
+		DrawBuffersDraw(views.Buffers, views.Offsets, views.Count);
 		SoundSetEars(camera->lastPosition);
 	}
 	else
@@ -251,10 +271,10 @@ void CameraDraw(
 				CA_FOREACH_END()
 			}
 
-			DoBuffer(
-				&camera->Buffer,
-				camera->lastPosition,
+			AddView(
+				&views, camera, camera->lastPosition,
 				X_TILES, noise, centerOffset);
+			DrawBuffersDraw(views.Buffers, views.Offsets, views.Count);
 			SoundSetEars(earPos);
 		}
 		else if (numLocalPlayers == 2)
@@ -285,12 +305,12 @@ void CameraDraw(
 				}
 
 				LOSCalcFrom(&gMap, Vec2iToTile(camera->lastPosition), false);
-				DoBuffer(
-					&camera->Buffer,
-					camera->lastPosition,
+				AddView(
+					&views, camera, camera->lastPosition,
 					X_TILES_HALF, noise, centerOffsetPlayer);
 				SoundSetEarsSide(idx == 0, camera->lastPosition);
 			}
+			DrawBuffersDraw(views.Buffers, views.Offsets, views.Count);
 			Draw_Line(w / 2 - 1, 0, w / 2 - 1, h - 1, colorBlack);
 			Draw_Line(w / 2, 0, w / 2, h - 1, colorBlack);
 		}
@@ -310,9 +330,12 @@ void CameraDraw(
 				}
 				Vec2i centerOffsetPlayer = centerOffset;
 				const int clipLeft = (idx & 1) ? w / 2 : 0;
-				const int clipTop = (idx < 2) ? 0 : h / 2 - 1;
+				// Note: keep the views apart so they can be drawn at the
+				// same time; the rows either side of the split are covered
+				// by the divider
+				const int clipTop = (idx < 2) ? 0 : h / 2;
 				const int clipRight = (idx & 1) ? w - 1 : (w / 2) - 1;
-				const int clipBottom = (idx < 2) ? h / 2 : h - 1;
+				const int clipBottom = (idx < 2) ? h / 2 - 1 : h - 1;
 				isLocalPlayerAlive[idx] = IsPlayerAliveOrDying(p);
 				if (!isLocalPlayerAlive[idx])
 				{
@@ -336,9 +359,8 @@ void CameraDraw(
 					centerOffsetPlayer.y += h / 4;
 				}
 				LOSCalcFrom(&gMap, Vec2iToTile(camera->lastPosition), false);
-				DoBuffer(
-					&camera->Buffer,
-					camera->lastPosition,
+				AddView(
+					&views, camera, camera->lastPosition,
 					X_TILES_HALF, noise, centerOffsetPlayer);
 
 				// Set the sound "ears"
@@ -362,6 +384,7 @@ void CameraDraw(
 					SoundSetEarsSide(!isLeft, camera->lastPosition);
 				}
 			}
+			DrawBuffersDraw(views.Buffers, views.Offsets, views.Count);
 			Draw_Line(w / 2 - 1, 0, w / 2 - 1, h - 1, colorBlack);
 			Draw_Line(w / 2, 0, w / 2, h - 1, colorBlack);
 			Draw_Line(0, h / 2 - 1, w - 1, h / 2 - 1, colorBlack);
@@ -446,15 +469,29 @@ static void FollowPlayer(Vec2i *pos, const int playerUID)
 	if (a == NULL) return;
 	*pos = Vec2iFull2Real(a->Pos);
 }
-static void DoBuffer(
-	DrawBuffer *b, Vec2i center, int w, Vec2i noise, Vec2i offset)
+// Set up the next view from the map's current LOS, to be drawn later
+static void AddView(
+	CameraViews *views, Camera *camera,
+	Vec2i center, int w, Vec2i noise, Vec2i offset)
 {
+	const int i = views->Count;
+	CASSERT(i < MAX_LOCAL_PLAYERS, "too many camera views");
+	// Snapshot the device with the view's clipping
+	camera->ViewDevices[i] = gGraphicsDevice;
+	DrawBuffer *b = &camera->Buffers[i];
 	DrawBufferSetFromMap(b, &gMap, Vec2iAdd(center, noise), w);
+	const Rect2i view = {
+		Vec2iNew(b->xTop, b->yTop),
+		Vec2iNew(b->Size.x * TILE_WIDTH, b->Size.y * TILE_HEIGHT)
+	};
+	ParticleBudgetAddView(&gParticles.Budget, view);
 	if (gPlayerDatas.size > 0)
 	{
 		DrawBufferFix(b);
 	}
-	DrawBufferDraw(b, offset, NULL);
+	views->Buffers[i] = b;
+	views->Offsets[i] = offset;
+	views->Count++;
 }
 
 bool CameraIsSingleScreen(void)
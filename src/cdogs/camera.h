@@ -41,7 +41,10 @@ typedef enum
 
 typedef struct
 {
-	DrawBuffer Buffer;
+	// One buffer per split screen view, each drawing to its own copy of
+	// the graphics device clipped to the view
+	DrawBuffer Buffers[MAX_LOCAL_PLAYERS];
+	GraphicsDevice ViewDevices[MAX_LOCAL_PLAYERS];
 	Vec2i lastPosition;
 	HUD HUD;
 	ScreenShake shake;
@@ -63,15 +63,19 @@ bool CampaignEntryTryLoad(
 	{
 		return false;
 	}
+	CampaignEntryInitScanned(entry, path, mode, buf, numMissions);
+	CFREE(buf);
+	return true;
+}
+void CampaignEntryInitScanned(
+	CampaignEntry *entry, const char *path, GameMode mode,
+	const char *title, const int numMissions)
+{
 	// cap length of title
-	size_t maxLen = 70;
-	if (strlen(buf) > maxLen)
-	{
-		buf[maxLen] = '\0';
-	}
-	char title[256];
-	sprintf(title, "%s (%d)", buf, numMissions);
-	CampaignEntryInit(entry, title, mode);
+	const int maxLen = 70;
+	char titleBuf[256];
+	sprintf(titleBuf, "%.*s (%d)", maxLen, title, numMissions);
+	CampaignEntryInit(entry, titleBuf, mode);
 	CSTRDUP(entry->Filename, PathGetBasename(path));
 	// Get relative path for the campaign entry, so when we transmit it to
 	// network clients they can load it regardless of install path
@@ -82,8 +86,6 @@ bool CampaignEntryTryLoad(
 	RelPath(pathBuf, path, dataDirBuf);
 	CSTRDUP(entry->Path, pathBuf);
 	entry->NumMissions = numMissions;
-	CFREE(buf);
-	return true;
 }
 void CampaignEntryTerminate(CampaignEntry *entry)
 {
@@ -43,4 +43,8 @@ void CampaignEntryInit(CampaignEntry *entry, const char *title, GameMode mode);
 void CampaignEntryCopy(CampaignEntry *dst, CampaignEntry *src);
 bool CampaignEntryTryLoad(
 	CampaignEntry *entry, const char *path, GameMode mode);
+// Initialise from the results of scanning a campaign file
+void CampaignEntryInitScanned(
+	CampaignEntry *entry, const char *path, GameMode mode,
+	const char *title, const int numMissions);
 void CampaignEntryTerminate(CampaignEntry *entry);
@@ -0,0 +1,239 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "campaign_index.h"
+
+#include <inttypes.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <json/json.h>
+
+#include "json_utils.h"
+#include "log.h"
+#include "sys_config.h"
+#include "utils.h"
+
+#define VERSION 1
+
+
+void CampaignIndexInit(CampaignIndex *ci)
+{
+	memset(ci, 0, sizeof *ci);
+	CArrayInit(&ci->Entries, sizeof(CampaignIndexEntry));
+}
+void CampaignIndexTerminate(CampaignIndex *ci)
+{
+	CA_FOREACH(CampaignIndexEntry, e, ci->Entries)
+		CFREE(e->Path);
+		CFREE(e->Title);
+	CA_FOREACH_END()
+	CArrayTerminate(&ci->Entries);
+}
+
+static uint64_t LoadUInt64(json_t *node, const char *name)
+{
+	json_t *child = json_find_first_label(node, name);
+	if (child == NULL || child->child == NULL)
+	{
+		return 0;
+	}
+	return strtoull(child->child->text, NULL, 10);
+}
+void CampaignIndexLoad(CampaignIndex *ci, const char *filename)
+{
+	json_t *root = NULL;
+	FILE *f = fopen(filename, "r");
+	if (f == NULL)
+	{
+		// No index yet; everything will be scanned
+		goto bail;
+	}
+	if (json_stream_parse(f, &root) != JSON_OK)
+	{
+		LOG(LM_MAIN, LL_WARN, "Error parsing campaign index %s", filename);
+		goto bail;
+	}
+	int version = 0;
+	LoadInt(&version, root, "Version");
+	json_t *campaigns = json_find_first_label(root, "Campaigns");
+	if (version != VERSION || campaigns == NULL || campaigns->child == NULL)
+	{
+		goto bail;
+	}
+	for (json_t *child = campaigns->child->child; child; child = child->next)
+	{
+		CampaignIndexEntry e;
+		memset(&e, 0, sizeof e);
+		e.Path = GetString(child, "Path");
+		int mode = GAME_MODE_NORMAL;
+		LoadInt(&mode, child, "Mode");
+		e.Mode = (GameMode)mode;
+		e.MTime = LoadUInt64(child, "MTime");
+		e.Size = LoadUInt64(child, "Size");
+		e.Title = GetString(child, "Title");
+		LoadInt(&e.NumMissions, child, "Missions");
+		if (e.Path == NULL || e.Title == NULL)
+		{
+			CFREE(e.Path);
+			CFREE(e.Title);
+			continue;
+		}
+		CArrayPushBack(&ci->Entries, &e);
+	}
+	LOG(LM_MAIN, LL_DEBUG, "Loaded campaign index with %d entries",
+		(int)ci->Entries.size);
+
+bail:
+	json_free_value(&root);
+	if (f != NULL)
+	{
+		fclose(f);
+	}
+}
+static void AddUInt64Pair(json_t *parent, const char *name, const uint64_t n)
+{
+	char buf[32];
+	sprintf(buf, "%" PRIu64, n);
+	json_insert_pair_into_object(parent, name, json_new_number(buf));
+}
+void CampaignIndexSave(CampaignIndex *ci, const char *filename)
+{
+	// Drop campaigns that weren't found this time
+	for (int i = (int)ci->Entries.size - 1; i >= 0; i--)
+	{
+		CampaignIndexEntry *e = CArrayGet(&ci->Entries, i);
+		if (!e->IsUsed)
+		{
+			CFREE(e->Path);
+			CFREE(e->Title);
+			CArrayDelete(&ci->Entries, i);
+			ci->IsDirty = true;
+		}
+	}
+	if (!ci->IsDirty)
+	{
+		return;
+	}
+
+	json_t *root = json_new_object();
+	AddIntPair(root, "Version", VERSION);
+	json_t *campaigns = json_new_array();
+	CA_FOREACH(const CampaignIndexEntry, e, ci->Entries)
+		json_t *node = json_new_object();
+		AddStringPair(node, "Path", e->Path);
+		AddIntPair(node, "Mode", (int)e->Mode);
+		AddUInt64Pair(node, "MTime", e->MTime);
+		AddUInt64Pair(node, "Size", e->Size);
+		AddStringPair(node, "Title", e->Title);
+		AddIntPair(node, "Missions", e->NumMissions);
+		json_insert_child(campaigns, node);
+	CA_FOREACH_END()
+	json_insert_pair_into_object(root, "Campaigns", campaigns);
+	if (TrySaveJSONFile(root, filename))
+	{
+		ci->IsDirty = false;
+	}
+	json_free_value(&root);
+}
+
+static bool StatCampaign(const char *path, uint64_t *mtime, uint64_t *size)
+{
+	// Archives are directories, whose mtimes don't change when the files
+	// inside are edited; use the file that is scanned instead
+	char buf[CDOGS_PATH_MAX];
+	if (strcmp(StrGetFileExt(path), "cdogscpn") == 0 ||
+		strcmp(StrGetFileExt(path), "CDOGSCPN") == 0)
+	{
+		sprintf(buf, "%s/campaign.json", path);
+		path = buf;
+	}
+	struct stat st;
+	if (stat(path, &st) != 0)
+	{
+		return false;
+	}
+	*mtime = (uint64_t)st.st_mtime;
+	*size = (uint64_t)st.st_size;
+	return true;
+}
+static CampaignIndexEntry *FindEntry(
+	CampaignIndex *ci, const char *path, const GameMode mode)
+{
+	CA_FOREACH(CampaignIndexEntry, e, ci->Entries)
+		if (e->Mode == mode && strcmp(e->Path, path) == 0)
+		{
+			return e;
+		}
+	CA_FOREACH_END()
+	return NULL;
+}
+const CampaignIndexEntry *CampaignIndexFind(
+	CampaignIndex *ci, const char *path, const GameMode mode)
+{
+	CampaignIndexEntry *e = FindEntry(ci, path, mode);
+	if (e == NULL)
+	{
+		return NULL;
+	}
+	uint64_t mtime, size;
+	if (!StatCampaign(path, &mtime, &size) ||
+		mtime != e->MTime || size != e->Size)
+	{
+		return NULL;
+	}
+	e->IsUsed = true;
+	return e;
+}
+void CampaignIndexUpdate(
+	CampaignIndex *ci, const char *path, const GameMode mode,
+	const char *title, const int numMissions)
+{
+	uint64_t mtime, size;
+	if (!StatCampaign(path, &mtime, &size))
+	{
+		return;
+	}
+	CampaignIndexEntry *e = FindEntry(ci, path, mode);
+	if (e == NULL)
+	{
+		CampaignIndexEntry en;
+		memset(&en, 0, sizeof en);
+		CSTRDUP(en.Path, path);
+		en.Mode = mode;
+		CArrayPushBack(&ci->Entries, &en);
+		e = CArrayGet(&ci->Entries, (int)ci->Entries.size - 1);
+	}
+	CFREE(e->Title);
+	CSTRDUP(e->Title, title);
+	e->MTime = mtime;
+	e->Size = size;
+	e->NumMissions = numMissions;
+	e->IsUsed = true;
+	ci->IsDirty = true;
+}
@@ -0,0 +1,69 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdint.h>
+
+#include "c_array.h"
+#include "game_mode.h"
+
+#define CAMPAIGN_INDEX_FILE "campaigns.json"
+
+// Cached scan results for a campaign file, so that unchanged campaigns
+// don't need to be parsed when listing them
+typedef struct
+{
+	char *Path;
+	GameMode Mode;
+	// Modification time and size of the file that was scanned;
+	// for campaign archives this is the campaign.json inside
+	uint64_t MTime;
+	uint64_t Size;
+	char *Title;
+	int NumMissions;
+	// Whether the campaign was seen this run; stale entries aren't saved
+	bool IsUsed;
+} CampaignIndexEntry;
+typedef struct
+{
+	CArray Entries;	// of CampaignIndexEntry
+	bool IsDirty;
+} CampaignIndex;
+
+void CampaignIndexInit(CampaignIndex *ci);
+void CampaignIndexTerminate(CampaignIndex *ci);
+void CampaignIndexLoad(CampaignIndex *ci, const char *filename);
+// Saves if there have been any changes since loading
+void CampaignIndexSave(CampaignIndex *ci, const char *filename);
+
+// Get the cached entry for a campaign, if the file hasn't changed since
+const CampaignIndexEntry *CampaignIndexFind(
+	CampaignIndex *ci, const char *path, const GameMode mode);
+void CampaignIndexUpdate(
+	CampaignIndex *ci, const char *path, const GameMode mode,
+	const char *title, const int numMissions);
@@ -32,10 +32,12 @@
 
 #include <tinydir/tinydir.h>
 
+#include <cdogs/campaign_index.h>
 #include <cdogs/files.h>
 #include <cdogs/log.h>
 #include <cdogs/map_new.h>
 #include <cdogs/mission.h>
+#include <cdogs/thread_pool.h>
 #include <cdogs/utils.h>
 
 
@@ -71,7 +73,8 @@ void CampaignSettingTerminate(CampaignSetting *setting)
 	memset(setting, 0, sizeof *setting);
 
 	// Unload previous custom data
-	SoundClear(&gSoundDevice.customSounds);
+	SoundClear(
+		gSoundDevice.customSounds, &gSoundDevice.customSoundNames);
 	PicManagerClearCustom(&gPicManager);
 	ParticleClassesClear(&gParticleClasses.CustomClasses);
 	AmmoClassesClear(&gAmmo.CustomAmmo);
@@ -87,7 +90,7 @@ static void CampaignListInit(campaign_list_t *list);
 static void CampaignListTerminate(campaign_list_t *list);
 static void LoadCampaignsFromFolder(
 	campaign_list_t *list, const char *name, const char *path,
-	const GameMode mode);
+	const GameMode mode, CampaignIndex *ci);
 static void LoadQuickPlayEntry(CampaignEntry *entry);
 
 void LoadAllCampaigns(custom_campaigns_t *campaigns)
@@ -97,13 +100,19 @@ void LoadAllCampaigns(custom_campaigns_t *campaigns)
 	CampaignListInit(&campaigns->campaignList);
 	CampaignListInit(&campaigns->dogfightList);
 
+	// Use cached titles and mission counts for unchanged campaigns
+	CampaignIndex ci;
+	CampaignIndexInit(&ci);
+	CampaignIndexLoad(&ci, GetConfigFilePath(CAMPAIGN_INDEX_FILE));
+
 	GetDataFilePath(buf, CDOGS_CAMPAIGN_DIR);
 	LOG(LM_MAIN, LL_INFO, "Load campaigns from dir %s...", buf);
 	LoadCampaignsFromFolder(
 		&campaigns->campaignList,
 		"",
 		buf,
-		GAME_MODE_NORMAL);
+		GAME_MODE_NORMAL,
+		&ci);
 
 	GetDataFilePath(buf, CDOGS_DOGFIGHT_DIR);
 	LOG(LM_MAIN, LL_INFO, "Load dogfights from dir %s...", buf);
@@ -111,7 +120,11 @@ void LoadAllCampaigns(custom_campaigns_t *campaigns)
 		&campaigns->dogfightList,
 		"",
 		buf,
-		GAME_MODE_DOGFIGHT);
+		GAME_MODE_DOGFIGHT,
+		&ci);
+
+	CampaignIndexSave(&ci, GetConfigFilePath(CAMPAIGN_INDEX_FILE));
+	CampaignIndexTerminate(&ci);
 
 	LOG(LM_MAIN, LL_INFO, "Load quick play...");
 	LoadQuickPlayEntry(&campaigns->quickPlayEntry);
@@ -153,9 +166,27 @@ static void LoadQuickPlayEntry(CampaignEntry *entry)
 	entry->Mode = GAME_MODE_QUICK_PLAY;
 }
 
+// Campaign files in a folder, which are scanned in parallel if they
+// aren't in the index
+typedef struct
+{
+	char Path[CDOGS_PATH_MAX];
+	bool IsCached;
+	char *Title;
+	int NumMissions;
+	bool OK;
+} CampaignScan;
+static void ScanCampaign(void *data, const int index)
+{
+	CampaignScan *s = CArrayGet(data, index);
+	if (!s->IsCached)
+	{
+		s->OK = MapNewScan(s->Path, &s->Title, &s->NumMissions) == 0;
+	}
+}
 static void LoadCampaignsFromFolder(
 	campaign_list_t *list, const char *name, const char *path,
-	const GameMode mode)
+	const GameMode mode, CampaignIndex *ci)
 {
 	tinydir_dir dir;
 	int i;
@@ -167,6 +198,9 @@ static void LoadCampaignsFromFolder(
 		return;
 	}
 
+	CArray scans;
+	CArrayInit(&scans, sizeof(CampaignScan));
+	int numToScan = 0;
 	for (i = 0; i < (int)dir.n_files; i++)
 	{
 		tinydir_file file;
@@ -183,20 +217,55 @@ static void LoadCampaignsFromFolder(
 		{
 			campaign_list_t subFolder;
 			CampaignListInit(&subFolder);
-			LoadCampaignsFromFolder(&subFolder, file.name, file.path, mode);
+			LoadCampaignsFromFolder(
+				&subFolder, file.name, file.path, mode, ci);
 			CArrayPushBack(&list->subFolders, &subFolder);
 		}
 		else if ((file.is_reg || isArchive) && file.name[0] != '~')
 		{
-			CampaignEntry entry;
-			if (CampaignEntryTryLoad(&entry, file.path, mode))
+			CampaignScan s;
+			memset(&s, 0, sizeof s);
+			strcpy(s.Path, file.path);
+			const CampaignIndexEntry *e =
+				CampaignIndexFind(ci, file.path, mode);
+			if (e != NULL)
 			{
-				CArrayPushBack(&list->list, &entry);
+				s.IsCached = s.OK = true;
+				CSTRDUP(s.Title, e->Title);
+				s.NumMissions = e->NumMissions;
 			}
+			else
+			{
+				numToScan++;
+			}
+			CArrayPushBack(&scans, &s);
 		}
 	}
 
 	tinydir_close(&dir);
+
+	if (numToScan > 0)
+	{
+		LOG(LM_MAIN, LL_DEBUG, "Scanning %d campaigns in %s",
+			numToScan, path);
+		ThreadPoolRun(&gThreadPool, ScanCampaign, &scans, (int)scans.size);
+	}
+	CA_FOREACH(CampaignScan, s, scans)
+		if (s->OK)
+		{
+			CampaignEntry entry;
+			CampaignEntryInitScanned(
+				&entry, s->Path, mode, s->Title, s->NumMissions);
+			CArrayPushBack(&list->list, &entry);
+			if (!s->IsCached)
+			{
+				CampaignIndexUpdate(
+					ci, s->Path, mode, s->Title, s->NumMissions);
+			}
+		}
+		CFREE(s->Title);
+	CA_FOREACH_END()
+	CArrayTerminate(&scans);
 }
 
 Mission *CampaignGetCurrentMission(CampaignOptions *campaign)
@@ -208,9 +277,13 @@ Mission *CampaignGetCurrentMission(CampaignOptions *campaign)
 	return CArrayGet(&campaign->Setting.Missions, campaign->MissionIndex);
 }
 
+unsigned int CampaignMissionSeed(const CampaignOptions *campaign)
+{
+	return 10 * campaign->MissionIndex + campaign->seed;
+}
 void CampaignSeedRandom(const CampaignOptions *campaign)
 {
-	const unsigned int seed = 10 * campaign->MissionIndex + campaign->seed;
+	const unsigned int seed = CampaignMissionSeed(campaign);
 	debug(D_NORMAL, "Seeding with %u\n", seed);
 	srand(seed);
 }
@@ -81,6 +81,8 @@ void LoadAllCampaigns(custom_campaigns_t *campaigns);
 void UnloadAllCampaigns(custom_campaigns_t *campaigns);
 
 Mission *CampaignGetCurrentMission(CampaignOptions *campaign);
+// Seed for the current mission, from the campaign seed and mission index
+unsigned int CampaignMissionSeed(const CampaignOptions *campaign);
 void CampaignSeedRandom(const CampaignOptions *campaign);
 
 void CampaignAndMissionSetup(
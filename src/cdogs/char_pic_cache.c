@@ -0,0 +1,276 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "char_pic_cache.h"
+
+#include <string.h>
+
+#include "log.h"
+
+// Must be a power of two
+#define CHAR_PIC_CACHE_BUCKETS 1024
+
+CharPicCache gCharPicCache;
+
+
+void CharPicCacheInit(CharPicCache *c, const size_t budget)
+{
+	memset(c, 0, sizeof *c);
+	CArrayInit(&c->entries, sizeof(CharPicCacheEntry));
+	CArrayInit(&c->freeEntries, sizeof(int));
+	CArrayInit(&c->pendingFree, sizeof(Uint32 *));
+	CMALLOC(c->buckets, CHAR_PIC_CACHE_BUCKETS * sizeof *c->buckets);
+	for (int i = 0; i < CHAR_PIC_CACHE_BUCKETS; i++)
+	{
+		c->buckets[i] = -1;
+	}
+	c->head = c->tail = -1;
+	c->Budget = budget;
+	c->mutex = SDL_CreateMutex();
+}
+void CharPicCacheTerminate(CharPicCache *c)
+{
+	CharPicCacheClear(c);
+	CArrayTerminate(&c->entries);
+	CArrayTerminate(&c->freeEntries);
+	CArrayTerminate(&c->pendingFree);
+	CFREE(c->buckets);
+	c->buckets = NULL;
+	if (c->mutex != NULL)
+	{
+		SDL_DestroyMutex(c->mutex);
+		c->mutex = NULL;
+	}
+}
+
+void CharPicCacheClear(CharPicCache *c)
+{
+	if (c->buckets == NULL)
+	{
+		return;
+	}
+	LOG(LM_GFX, LL_DEBUG,
+		"char pic cache: %d hits %d misses %d evictions, %dKB",
+		c->Hits, c->Misses, c->Evictions, (int)(c->Size / 1024));
+	CA_FOREACH(CharPicCacheEntry, e, c->entries)
+		if (e->IsUsed)
+		{
+			PicFree(&e->Pic);
+		}
+	CA_FOREACH_END()
+	CArrayClear(&c->entries);
+	CArrayClear(&c->freeEntries);
+	for (int i = 0; i < CHAR_PIC_CACHE_BUCKETS; i++)
+	{
+		c->buckets[i] = -1;
+	}
+	c->head = c->tail = -1;
+	c->Size = 0;
+	c->Hits = c->Misses = c->Evictions = 0;
+}
+
+static int CharPicHash(const Pic *pic, const CharColors *colors)
+{
+	// FNV-1a over the pic address and the colours
+	uint32_t h = 2166136261u;
+	const uintptr_t p = (uintptr_t)pic;
+	for (size_t i = 0; i < sizeof p; i++)
+	{
+		h ^= (uint32_t)((p >> (i * 8)) & 0xFF);
+		h *= 16777619u;
+	}
+	const uint8_t *b = (const uint8_t *)colors;
+	for (size_t i = 0; i < sizeof *colors; i++)
+	{
+		h ^= b[i];
+		h *= 16777619u;
+	}
+	return (int)(h & (CHAR_PIC_CACHE_BUCKETS - 1));
+}
+static size_t PicMemSize(const Pic *pic)
+{
+	return pic->size.x * pic->size.y * sizeof *pic->Data;
+}
+
+static const Pic *Get(
+	CharPicCache *c, const Pic *pic, const CharColors *colors);
+bool CharPicCacheGet(
+	CharPicCache *c, Pic *out, const Pic *pic, const CharColors *colors)
+{
+	if (c->Budget == 0 || c->buckets == NULL || PicIsNone(pic) ||
+		PicMemSize(pic) > c->Budget)
+	{
+		return false;
+	}
+	SDL_LockMutex(c->mutex);
+	*out = *Get(c, pic, colors);
+	SDL_UnlockMutex(c->mutex);
+	return true;
+}
+static void LRUUnlink(CharPicCache *c, const int idx);
+static void LRUPushFront(CharPicCache *c, const int idx);
+static void Evict(CharPicCache *c, const int idx);
+static const Pic *Get(
+	CharPicCache *c, const Pic *pic, const CharColors *colors)
+{
+	const size_t picSize = PicMemSize(pic);
+
+	// Search through existing cache for the pic
+	const int bucket = CharPicHash(pic, colors);
+	for (int i = c->buckets[bucket]; i >= 0;)
+	{
+		CharPicCacheEntry *e = CArrayGet(&c->entries, i);
+		if (e->Src == pic && memcmp(&e->Colors, colors, sizeof *colors) == 0)
+		{
+			c->Hits++;
+			LRUUnlink(c, i);
+			LRUPushFront(c, i);
+			return &e->Pic;
+		}
+		i = e->HashNext;
+	}
+
+	// Not found; make room and recolour the pic now
+	c->Misses++;
+	while (c->Size + picSize > c->Budget && c->tail >= 0)
+	{
+		Evict(c, c->tail);
+	}
+	int idx;
+	if (c->freeEntries.size > 0)
+	{
+		idx = *(int *)CArrayGet(&c->freeEntries, (int)c->freeEntries.size - 1);
+		CArrayDelete(&c->freeEntries, (int)c->freeEntries.size - 1);
+	}
+	else
+	{
+		CharPicCacheEntry blank;
+		memset(&blank, 0, sizeof blank);
+		CArrayPushBack(&c->entries, &blank);
+		idx = (int)c->entries.size - 1;
+	}
+	CharPicCacheEntry *e = CArrayGet(&c->entries, idx);
+	e->Src = pic;
+	e->Colors = *colors;
+	e->Pic = PicCharMultichannel(pic, colors);
+	e->IsUsed = true;
+	e->HashNext = c->buckets[bucket];
+	c->buckets[bucket] = idx;
+	LRUPushFront(c, idx);
+	c->Size += picSize;
+	return &e->Pic;
+}
+static void LRUUnlink(CharPicCache *c, const int idx)
+{
+	CharPicCacheEntry *e = CArrayGet(&c->entries, idx);
+	if (e->Prev >= 0)
+	{
+		((CharPicCacheEntry *)CArrayGet(&c->entries, e->Prev))->Next = e->Next;
+	}
+	else
+	{
+		c->head = e->Next;
+	}
+	if (e->Next >= 0)
+	{
+		((CharPicCacheEntry *)CArrayGet(&c->entries, e->Next))->Prev = e->Prev;
+	}
+	else
+	{
+		c->tail = e->Prev;
+	}
+	e->Prev = e->Next = -1;
+}
+static void LRUPushFront(CharPicCache *c, const int idx)
+{
+	CharPicCacheEntry *e = CArrayGet(&c->entries, idx);
+	e->Prev = -1;
+	e->Next = c->head;
+	if (c->head >= 0)
+	{
+		((CharPicCacheEntry *)CArrayGet(&c->entries, c->head))->Prev = idx;
+	}
+	c->head = idx;
+	if (c->tail < 0)
+	{
+		c->tail = idx;
+	}
+}
+static void Evict(CharPicCache *c, const int idx)
+{
+	CharPicCacheEntry *e = CArrayGet(&c->entries, idx);
+	LRUUnlink(c, idx);
+	// Remove from hash bucket chain
+	int *link = &c->buckets[CharPicHash(e->Src, &e->Colors)];
+	while (*link != idx)
+	{
+		CharPicCacheEntry *prev = CArrayGet(&c->entries, *link);
+		link = &prev->HashNext;
+	}
+	*link = e->HashNext;
+	c->Size -= PicMemSize(&e->Pic);
+	if (c->concurrentDraws > 0)
+	{
+		CArrayPushBack(&c->pendingFree, &e->Pic.Data);
+	}
+	else
+	{
+		PicFree(&e->Pic);
+	}
+	e->IsUsed = false;
+	CArrayPushBack(&c->freeEntries, &idx);
+	c->Evictions++;
+}
+
+void CharPicCacheBeginConcurrent(CharPicCache *c)
+{
+	if (c->mutex == NULL)
+	{
+		return;
+	}
+	SDL_LockMutex(c->mutex);
+	c->concurrentDraws++;
+	SDL_UnlockMutex(c->mutex);
+}
+void CharPicCacheEndConcurrent(CharPicCache *c)
+{
+	if (c->mutex == NULL)
+	{
+		return;
+	}
+	SDL_LockMutex(c->mutex);
+	c->concurrentDraws--;
+	CASSERT(c->concurrentDraws >= 0, "unbalanced concurrent draws");
+	if (c->concurrentDraws == 0)
+	{
+		CA_FOREACH(Uint32 *, data, c->pendingFree)
+			CFREE(*data);
+		CA_FOREACH_END()
+		CArrayClear(&c->pendingFree);
+	}
+	SDL_UnlockMutex(c->mutex);
+}
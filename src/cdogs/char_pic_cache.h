@@ -0,0 +1,92 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stddef.h>
+
+#include <SDL_thread.h>
+
+#include "blit.h"
+#include "c_array.h"
+
+typedef struct
+{
+	const Pic *Src;
+	CharColors Colors;
+	Pic Pic;
+	// LRU list, most recently used at head; -1 for none
+	int Prev;
+	int Next;
+	// Hash bucket chain; -1 for none
+	int HashNext;
+	bool IsUsed;
+} CharPicCacheEntry;
+
+typedef struct
+{
+	CArray entries;	// of CharPicCacheEntry
+	CArray freeEntries;	// of int
+	int *buckets;
+	SDL_mutex *mutex;
+	// While drawing concurrently, evicted pixels may still be in use;
+	// defer freeing them until all concurrent draws end
+	int concurrentDraws;
+	CArray pendingFree;	// of Uint32 *
+	int head;
+	int tail;
+	// Memory budget for cached pixels, in bytes; 0 to disable
+	size_t Budget;
+	size_t Size;
+	int Hits;
+	int Misses;
+	int Evictions;
+} CharPicCache;
+
+// Cache of character pics pre-recoloured with their CharColors,
+// so that crowds of characters can be drawn with plain blits instead of
+// recolouring every pixel, every frame.
+// Cached pics are evicted least-recently-used first to stay within budget.
+extern CharPicCache gCharPicCache;
+
+void CharPicCacheInit(CharPicCache *c, const size_t budget);
+void CharPicCacheTerminate(CharPicCache *c);
+
+// Clear all entries in cache
+// This is done when the source pics may be freed, e.g. custom pics
+void CharPicCacheClear(CharPicCache *c);
+
+// Get the pic recoloured with colors, recolouring and caching it if needed
+// Returns false if the cache is disabled or the pic cannot fit
+// Note: the pic data is only valid until the next call, unless within a
+// concurrent draw
+bool CharPicCacheGet(
+	CharPicCache *c, Pic *out, const Pic *pic, const CharColors *colors);
+
+// Bracket draws that may get pics from multiple threads
+void CharPicCacheBeginConcurrent(CharPicCache *c);
+void CharPicCacheEndConcurrent(CharPicCache *c);
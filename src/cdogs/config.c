@@ -315,19 +315,20 @@ int ConfigGetVersion(FILE *f)
 
 Config *ConfigGet(Config *c, const char *name)
 {
-	char *nameCopy;
-	CSTRDUP(nameCopy, name);
-	char *pch = strtok(nameCopy, ".");
+	// Walk the dotted name without strtok, so this is reentrant
+	const char *pch = name;
 	while (pch != NULL)
 	{
+		const char *dot = strchr(pch, '.');
+		const size_t len = dot != NULL ? (size_t)(dot - pch) : strlen(pch);
 		if (c->Type != CONFIG_TYPE_GROUP)
 		{
 			CASSERT(false, "Invalid config type");
-			goto bail;
+			break;
 		}
 		bool found = false;
 		CA_FOREACH(Config, child, c->u.Group)
-			if (strcmp(child->Name, pch) == 0)
+			if (strncmp(child->Name, pch, len) == 0 && child->Name[len] == '\0')
 			{
 				c = child;
 				found = true;
@@ -337,12 +338,10 @@ Config *ConfigGet(Config *c, const char *name)
 		if (!found)
 		{
 			CASSERT(false, "Config not found");
-			goto bail;
+			break;
 		}
-		pch = strtok(NULL, ".");
+		pch = dot != NULL ? dot + 1 : NULL;
 	}
-bail:
-	CFREE(nameCopy);
 	return c;
 }
 
@@ -539,6 +538,10 @@ Config ConfigDefault(void)
 	ConfigGroupAdd(&game, ConfigNewInt("FPS", 70, 10, 120, 10, NULL, NULL));
 	ConfigGroupAdd(&game,
 		ConfigNewInt("EnemyDensity", 100, 25, 200, 25, NULL, PercentStr));
+	// Full bad guy decisions per frame, for those not close to players;
+	// 0 for no limit
+	ConfigGroupAdd(&game, ConfigNewInt(
+		"AIDecisionsPerFrame", 32, 0, 256, 4, NULL, ZeroUnlimitedStr));
 	ConfigGroupAdd(&game,
 		ConfigNewInt("NonPlayerHP", 100, 25, 200, 25, NULL, PercentStr));
 	ConfigGroupAdd(&game,
@@ -565,6 +568,9 @@ Config ConfigDefault(void)
 	ConfigGroupAdd(&game, ConfigNewEnum(
 		"LaserSight", LASER_SIGHT_NONE, LASER_SIGHT_NONE, LASER_SIGHT_ALL,
 		StrLaserSight, LaserSightStr));
+	// Extra threads for parallel work such as drawing; 0 for automatic
+	ConfigGroupAdd(&game,
+		ConfigNewInt("WorkerThreads", 0, 0, 16, 1, NULL, NULL));
 	ConfigGroupAdd(&root, game);
 
 	Config dm = ConfigNewGroup("Deathmatch");
@@ -608,6 +614,30 @@ Config ConfigDefault(void)
 	ConfigGroupAdd(&gfx, ConfigNewEnum(
 		"Gore", GORE_LOW, GORE_NONE, GORE_HIGH, StrGoreAmount, GoreAmountStr));
 	ConfigGroupAdd(&gfx, ConfigNewBool("Brass", true));
+	ConfigGroupAdd(&gfx, ConfigNewInt("MaxParticles",
+#ifdef __GCWZERO__
+		1024
+#else
+		4096
+#endif
+		, 256, 16384, 256, NULL, NULL));
+	// Memory budget for recoloured character pics, in KB
+	ConfigGroupAdd(&gfx, ConfigNewInt("CharPicCacheSize",
+#ifdef __GCWZERO__
+		1024
+#else
+		4096
+#endif
+		, 0, 65536, 512, NULL, NULL));
+	// Decode pics when first drawn instead of at startup; starts faster and
+	// uses less memory, but can hitch when a new pic first appears
+	ConfigGroupAdd(&gfx, ConfigNewBool("DecodePicsOnUse",
+#ifdef __GCWZERO__
+		true
+#else
+		false
+#endif
+		));
 	ConfigGroupAdd(&root, gfx);
 
 	Config input = ConfigNewGroup("Input");
@@ -50,6 +50,7 @@ void NamedPicFree(NamedPic *n)
 {
 	PicFree(&n->pic);
 	CFREE(n->name);
+	CFREE(n->path);
 }
 
 
@@ -57,6 +58,8 @@ void NamedSpritesInit(NamedSprites *ns, const char *name)
 {
 	CSTRDUP(ns->name, name);
 	CArrayInit(&ns->pics, sizeof(Pic));
+	ns->path = NULL;
+	ns->spriteSize = Vec2iZero();
 }
 void NamedSpritesFree(NamedSprites *ns)
 {
@@ -65,6 +68,7 @@ void NamedSpritesFree(NamedSprites *ns)
 		return;
 	}
 	CFREE(ns->name);
+	CFREE(ns->path);
 	for (int i = 0; i < (int)ns->pics.size; i++)
 	{
 		PicFree(CArrayGet(&ns->pics, i));
@@ -143,6 +147,103 @@ bail:
 	// TODO: return error
 	return;
 }
+void CPicFieldsLoad(
+	CPicFields *f, const char *key, const int index, const char *value)
+{
+	if (value == NULL)
+	{
+		return;
+	}
+	f->Set = true;
+	if (strcmp(key, "Type") == 0)
+	{
+		CFREE(f->Type);
+		CSTRDUP(f->Type, value);
+	}
+	else if (strcmp(key, "Pic") == 0 || strcmp(key, "Sprites") == 0)
+	{
+		CFREE(f->Name);
+		CSTRDUP(f->Name, value);
+	}
+	else if (strcmp(key, "Count") == 0)
+	{
+		f->Count = atoi(value);
+	}
+	else if (strcmp(key, "TicksPerFrame") == 0)
+	{
+		f->TicksPerFrame = atoi(value);
+	}
+	else if (strcmp(key, "Mask") == 0)
+	{
+		CFREE(f->Mask);
+		CSTRDUP(f->Mask, value);
+	}
+	else if (strcmp(key, "Tint") == 0)
+	{
+		f->HasTint = true;
+		switch (index)
+		{
+		case 0: f->Tint.h = atof(value); break;
+		case 1: f->Tint.s = atof(value); break;
+		case 2: f->Tint.v = atof(value); break;
+		default: break;
+		}
+	}
+}
+void CPicLoadFields(CPic *p, CPicFields *f)
+{
+	if (!f->Set)
+	{
+		goto bail;
+	}
+	if (f->Type == NULL || f->Name == NULL)
+	{
+		LOG(LM_GFX, LL_ERROR, "cannot load pic");
+		goto bail;
+	}
+	p->Type = StrPicType(f->Type);
+	switch (p->Type)
+	{
+	case PICTYPE_NORMAL:
+		p->u.Pic = PicManagerGetPic(&gPicManager, f->Name);
+		break;
+	case PICTYPE_DIRECTIONAL:
+		p->u.Sprites = &PicManagerGetSprites(&gPicManager, f->Name)->pics;
+		break;
+	case PICTYPE_ANIMATED:	// fallthrough
+	case PICTYPE_ANIMATED_RANDOM:
+		p->u.Animated.Sprites =
+			&PicManagerGetSprites(&gPicManager, f->Name)->pics;
+		p->u.Animated.Count = f->Count;
+		// Set safe default ticks per frame 1;
+		// if 0 then this leads to infinite loop when animating
+		p->u.Animated.TicksPerFrame = MAX(f->TicksPerFrame, 1);
+		break;
+	default:
+		CASSERT(false, "unknown pic type");
+		break;
+	}
+	p->UseMask = true;
+	p->u1.Mask = colorWhite;
+	if (f->Mask != NULL)
+	{
+		p->u1.Mask = StrColor(f->Mask);
+	}
+	else if (f->HasTint)
+	{
+		p->UseMask = false;
+		p->u1.Tint = f->Tint;
+	}
+bail:
+	CPicFieldsTerminate(f);
+}
+void CPicFieldsTerminate(CPicFields *f)
+{
+	CFREE(f->Type);
+	CFREE(f->Name);
+	CFREE(f->Mask);
+	memset(f, 0, sizeof *f);
+}
 void CPicUpdate(CPic *p, const int ticks)
 {
 	switch (p->Type)
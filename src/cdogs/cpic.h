@@ -37,11 +37,16 @@ typedef struct
 {
 	Pic pic;
 	char *name;
+	// Image file to decode on first use; NULL if decoded
+	char *path;
 } NamedPic;
 typedef struct
 {
 	CArray pics;	// of Pic
 	char *name;
+	// Image file to decode on first use; NULL if decoded
+	char *path;
+	Vec2i spriteSize;
 } NamedSprites;
 
 typedef enum
@@ -89,6 +94,24 @@ void NamedSpritesInit(NamedSprites *ns, const char *name);
 void NamedSpritesFree(NamedSprites *ns);
 
 void CPicLoadJSON(CPic *p, json_t *node);
+// CPic fields streamed one at a time (see YAJLStreamFile), with keys relative
+// to the pic object; turned into a CPic once the whole object has been read
+typedef struct
+{
+	bool Set;
+	char *Type;
+	char *Name;	// "Pic" or "Sprites"
+	int Count;
+	int TicksPerFrame;
+	char *Mask;
+	bool HasTint;
+	HSV Tint;
+} CPicFields;
+void CPicFieldsLoad(
+	CPicFields *f, const char *key, const int index, const char *value);
+// Frees the fields; the pic is unchanged if no fields were loaded
+void CPicLoadFields(CPic *p, CPicFields *f);
+void CPicFieldsTerminate(CPicFields *f);
 void CPicUpdate(CPic *p, const int ticks);
 const Pic *CPicGetPic(const CPic *p, const int idx);
 void CPicDraw(
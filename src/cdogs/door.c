@@ -101,15 +101,15 @@ void MapAddDoorGroup(
 		Tile *tile = MapGetTile(map, vI);
 		tile->picAlt = doorPic;
 		tile->pic = GetDoorBasePic(&gPicManager, m->DoorStyle, isHorizontal);
-		tile->flags = DOOR_TILE_FLAGS;
+		MapSetTileFlags(map, vI, DOOR_TILE_FLAGS);
 		if (isHorizontal)
 		{
 			const Vec2i vB = Vec2iAdd(vI, dAside);
 			Tile *tileB = MapGetTile(map, vB);
-			CASSERT(TileCanWalk(MapGetTile(
-				map, Vec2iNew(vI.x - dAside.x, vI.y - dAside.y))),
+			CASSERT(MapTileCanWalk(
+				map, Vec2iNew(vI.x - dAside.x, vI.y - dAside.y)),
 				"map gen error: entrance should be clear");
-			CASSERT(TileCanWalk(tileB),
+			CASSERT(MapTileCanWalk(map, vB),
 				"map gen error: entrance should be clear");
 			// Change the tile below to shadow, cast by this door
 			const bool isFloor = IMapGet(map, vB) == MAP_FLOOR;
@@ -169,7 +169,7 @@ static TWatch *CreateCloseDoorWatch(
 	const bool isHorizontal, const int doorGroupCount,
 	const char *picAltName)
 {
-	TWatch *w = WatchNew();
+	TWatch *w = MapNewWatch(map);
 	const Vec2i dv = Vec2iNew(isHorizontal ? 1 : 0, isHorizontal ? 0 : 1);
 	const Vec2i dAside = Vec2iNew(dv.y, dv.x);
 
@@ -210,9 +210,11 @@ static TWatch *CreateCloseDoorWatch(
 		a->a.Event = GameEventNew(GAME_EVENT_TILE_SET);
 		a->a.Event.u.TileSet.Pos = Vec2i2Net(vI);
 		a->a.Event.u.TileSet.Flags = DOOR_TILE_FLAGS;
+		a->a.Event.u.TileSet.has_PicName = true;
 		strcpy(
 			a->a.Event.u.TileSet.PicName,
 			GetDoorBasePic(&gPicManager, m->DoorStyle, isHorizontal)->name);
+		a->a.Event.u.TileSet.has_PicAltName = true;
 		strcpy(a->a.Event.u.TileSet.PicAltName, picAltName);
 	}
 
@@ -229,6 +231,7 @@ static TWatch *CreateCloseDoorWatch(
 			const Vec2i vI2 = Vec2iNew(vI.x + dAside.x, vI.y + dAside.y);
 			a->a.Event.u.TileSet.Pos = Vec2i2Net(vI2);
 			const bool isFloor = IMapGet(map, vI2) == MAP_FLOOR;
+			a->a.Event.u.TileSet.has_PicName = true;
 			strcpy(
 				a->a.Event.u.TileSet.PicName,
 				PicManagerGetMaskedStylePic(
@@ -270,12 +273,14 @@ static Trigger *CreateOpenDoorTrigger(
 		a->a.Event.u.TileSet.Pos = Vec2i2Net(vI);
 		a->a.Event.u.TileSet.Flags =
 			(isHorizontal || i > 0) ? 0 : MAPTILE_OFFSET_PIC;
+		a->a.Event.u.TileSet.has_PicName = true;
 		strcpy(
 			a->a.Event.u.TileSet.PicName,
 			GetDoorBasePic(&gPicManager, m->DoorStyle, isHorizontal)->name);
 		if (!isHorizontal && i == 0)
 		{
 			// special door cavity picture
+			a->a.Event.u.TileSet.has_PicAltName = true;
 			strcpy(
 				a->a.Event.u.TileSet.PicAltName,
 				GetDoorPic(&gPicManager, m->DoorStyle, "wall", false)->name);
@@ -295,6 +300,7 @@ static Trigger *CreateOpenDoorTrigger(
 			a->a.Event = GameEventNew(GAME_EVENT_TILE_SET);
 			const bool isFloor = IMapGet(map, vIAside) == MAP_FLOOR;
 			a->a.Event.u.TileSet.Pos = Vec2i2Net(vIAside);
+			a->a.Event.u.TileSet.has_PicName = true;
 			strcpy(
 				a->a.Event.u.TileSet.PicName,
 				PicManagerGetMaskedStylePic(
@@ -53,6 +53,7 @@
 
 #include "actors.h"
 #include "algorithms.h"
+#include "char_pic_cache.h"
 #include "config.h"
 #include "draw_actor.h"
 #include "drawtools.h"
@@ -64,6 +65,7 @@
 #include "draw.h"
 #include "blit.h"
 #include "pic_manager.h"
+#include "thread_pool.h"
 
 
 // Three types of tile drawing, based on line of sight:
@@ -76,7 +78,7 @@ typedef enum
 	TILE_LOS_FOG,
 	TILE_LOS_NONE
 } TileLOS;
-static TileLOS GetTileLOS(const Tile *tile, const bool useFog)
+static TileLOS GetTileLOS(const DrawTile *tile, const bool useFog)
 {
 	if (!tile->isVisited)
 	{
@@ -88,7 +90,7 @@ static TileLOS GetTileLOS(const Tile *tile, const bool useFog)
 	}
 	return TILE_LOS_NORMAL;
 }
-void DrawWallColumn(int y, Vec2i pos, Tile *tile)
+void DrawWallColumn(GraphicsDevice *g, int y, Vec2i pos, DrawTile *tile)
 {
 	const bool useFog = ConfigGetBool(&gConfig, "Game.Fog");
 	while (y >= 0 && (tile->flags & MAPTILE_IS_WALL))
@@ -96,10 +98,10 @@ void DrawWallColumn(int y, Vec2i pos, Tile *tile)
 		switch (GetTileLOS(tile, useFog))
 		{
 		case TILE_LOS_NORMAL:
-			Blit(&gGraphicsDevice, &tile->pic->pic, pos);
+			Blit(g, &tile->pic->pic, pos);
 			break;
 		case TILE_LOS_FOG:
-			BlitMasked(&gGraphicsDevice, &tile->pic->pic, pos, colorFog, false);
+			BlitMasked(g, &tile->pic->pic, pos, colorFog, false);
 			break;
 		case TILE_LOS_NONE:
 		default:
@@ -113,13 +115,101 @@ void DrawWallColumn(int y, Vec2i pos, Tile *tile)
 }
 
 
+// Maximum number of bands to split the view into for drawing in parallel
+#define DRAW_BANDS_MAX 8
+// Don't split the view into bands shorter than this
+#define DRAW_BAND_MIN_HEIGHT (TILE_HEIGHT * 4)
+
+static void DrawExtra(DrawBuffer *b, Vec2i offset, GrafxDrawExtra *extra);
+
+void DrawBufferDraw(DrawBuffer *b, Vec2i offset, GrafxDrawExtra *extra)
+{
+	DrawBuffersDraw(&b, &offset, 1);
+	// Draw editor-only things
+	if (extra)
+	{
+		DrawExtra(b, offset, extra);
+	}
+}
+
+typedef struct
+{
+	DrawBuffer **buffers;
+	const Vec2i *offsets;
+	int bands;
+} DrawBandData;
+static void DrawBand(void *data, const int index);
+static void DrawWorld(DrawBuffer *b, const Vec2i offset);
+void DrawBuffersDraw(DrawBuffer **buffers, const Vec2i *offsets, const int n)
+{
+	// Split each view into horizontal bands, enough to keep all threads busy
+	const int concurrency = ThreadPoolConcurrency(&gThreadPool);
+	int bands = MIN((concurrency + n - 1) / n, DRAW_BANDS_MAX);
+	for (int i = 0; i < n; i++)
+	{
+		const BlitClipping *clip = &buffers[i]->g->clipping;
+		const int height = clip->bottom - clip->top + 1;
+		bands = MIN(bands, height / DRAW_BAND_MIN_HEIGHT);
+	}
+	bands = MAX(bands, 1);
+	// The display lists are shared by all bands of a view
+	for (int i = 0; i < n; i++)
+	{
+		DrawBufferBuildDisplayLists(buffers[i]);
+	}
+	if (n * bands > 1 && concurrency > 1)
+	{
+		// Draw all the bands of all the views in parallel.
+		// Each band draws the whole view clipped to itself, so the draw
+		// order (and result) is the same as drawing in one go.
+		DrawBandData data;
+		data.buffers = buffers;
+		data.offsets = offsets;
+		data.bands = bands;
+		CharPicCacheBeginConcurrent(&gCharPicCache);
+		ThreadPoolRun(&gThreadPool, DrawBand, &data, n * bands);
+		CharPicCacheEndConcurrent(&gCharPicCache);
+	}
+	else
+	{
+		for (int i = 0; i < n; i++)
+		{
+			DrawWorld(buffers[i], offsets[i]);
+		}
+	}
+	// Draw actor chatter; text is drawn to the main device so clip it to
+	// each view in turn
+	const BlitClipping clip = gGraphicsDevice.clipping;
+	for (int i = 0; i < n; i++)
+	{
+		gGraphicsDevice.clipping = buffers[i]->g->clipping;
+		DrawChatters(buffers[i], offsets[i]);
+	}
+	gGraphicsDevice.clipping = clip;
+}
+
+static void DrawBand(void *data, const int index)
+{
+	const DrawBandData *d = data;
+	const DrawBuffer *view = d->buffers[index / d->bands];
+	const int band = index % d->bands;
+	// Draw with a copy of the device and buffer, clipped to the band
+	GraphicsDevice g = *view->g;
+	const int height = g.clipping.bottom - g.clipping.top + 1;
+	const int bandHeight = (height + d->bands - 1) / d->bands;
+	g.clipping.top += band * bandHeight;
+	g.clipping.bottom =
+		MIN(g.clipping.top + bandHeight - 1, g.clipping.bottom);
+	DrawBuffer b = *view;
+	b.g = &g;
+	DrawWorld(&b, d->offsets[index / d->bands]);
+}
+
 static void DrawFloor(DrawBuffer *b, Vec2i offset);
 static void DrawDebris(DrawBuffer *b, Vec2i offset);
 static void DrawWallsAndThings(DrawBuffer *b, Vec2i offset);
 static void DrawObjectiveHighlights(DrawBuffer *b, Vec2i offset);
-static void DrawExtra(DrawBuffer *b, Vec2i offset, GrafxDrawExtra *extra);
-
-void DrawBufferDraw(DrawBuffer *b, Vec2i offset, GrafxDrawExtra *extra)
+static void DrawWorld(DrawBuffer *b, const Vec2i offset)
 {
 	// First draw the floor tiles (which do not obstruct anything)
 	DrawFloor(b, offset);
@@ -129,20 +219,13 @@ void DrawBufferDraw(DrawBuffer *b, Vec2i offset, GrafxDrawExtra *extra)
 	DrawWallsAndThings(b, offset);
 	// Draw objective highlights, for visible and always-visible objectives
 	DrawObjectiveHighlights(b, offset);
-	// Draw actor chatter
-	DrawChatters(b, offset);
-	// Draw editor-only things
-	if (extra)
-	{
-		DrawExtra(b, offset, extra);
-	}
 }
 
 static void DrawFloor(DrawBuffer *b, Vec2i offset)
 {
 	int x, y;
 	Vec2i pos;
-	const Tile *tile = &b->tiles[0][0];
+	const DrawTile *tile = &b->tiles[0][0];
 	const bool useFog = ConfigGetBool(&gConfig, "Game.Fog");
 	for (y = 0, pos.y = b->dy + offset.y;
 		 y < Y_TILES;
@@ -158,11 +241,11 @@ static void DrawFloor(DrawBuffer *b, Vec2i offset)
 				switch (GetTileLOS(tile, useFog))
 				{
 				case TILE_LOS_NORMAL:
-					Blit(&gGraphicsDevice, &tile->pic->pic, pos);
+					Blit(b->g, &tile->pic->pic, pos);
 					break;
 				case TILE_LOS_FOG:
 					BlitMasked(
-						&gGraphicsDevice,
+						b->g,
 						&tile->pic->pic,
 						pos,
 						colorFog,
@@ -181,31 +264,13 @@ static void DrawFloor(DrawBuffer *b, Vec2i offset)
 
 static void DrawThing(DrawBuffer *b, const TTileItem *t, const Vec2i offset);
 
+static void DrawDisplayListRow(
+	DrawBuffer *b, const DisplayList *dl, const int row, const Vec2i offset);
 static void DrawDebris(DrawBuffer *b, Vec2i offset)
 {
-	Tile *tile = &b->tiles[0][0];
 	for (int y = 0; y < Y_TILES; y++)
 	{
-		CArrayClear(&b->displaylist);
-		for (int x = 0; x < b->Size.x; x++, tile++)
-		{
-			if (tile->flags & MAPTILE_OUT_OF_SIGHT)
-			{
-				continue;
-			}
-			CA_FOREACH(ThingId, tid, tile->things)
-				const TTileItem *ti = ThingIdGetTileItem(tid);
-				if (TileItemIsDebris(ti))
-				{
-					CArrayPushBack(&b->displaylist, &ti);
-				}
-			CA_FOREACH_END()
-		}
-		DrawBufferSortDisplayList(b);
-		CA_FOREACH(const TTileItem *, tp, b->displaylist)
-			DrawThing(b, *tp, offset);
-		CA_FOREACH_END()
-		tile += X_TILES - b->Size.x;
+		DrawDisplayListRow(b, &b->debris, y, offset);
 	}
 }
 
@@ -213,12 +278,11 @@ static void DrawDebris(DrawBuffer *b, Vec2i offset)
 static void DrawWallsAndThings(DrawBuffer *b, Vec2i offset)
 {
 	Vec2i pos;
-	Tile *tile = &b->tiles[0][0];
+	DrawTile *tile = &b->tiles[0][0];
 	pos.y = b->dy + WALL_OFFSET_Y + offset.y;
 	const bool useFog = ConfigGetBool(&gConfig, "Game.Fog");
 	for (int y = 0; y < Y_TILES; y++, pos.y += TILE_HEIGHT)
 	{
-		CArrayClear(&b->displaylist);
 		pos.x = b->dx + offset.x;
 		for (int x = 0; x < b->Size.x; x++, tile++, pos.x += TILE_WIDTH)
 		{
@@ -226,7 +290,7 @@ static void DrawWallsAndThings(DrawBuffer *b, Vec2i offset)
 			{
 				if (!(tile->flags & MAPTILE_DELAY_DRAW))
 				{
-					DrawWallColumn(y, pos, tile);
+					DrawWallColumn(b->g, y, pos, tile);
 				}
 			}
 			else if (tile->flags & MAPTILE_OFFSET_PIC)
@@ -244,11 +308,11 @@ static void DrawWallsAndThings(DrawBuffer *b, Vec2i offset)
 				switch (GetTileLOS(tile, useFog))
 				{
 				case TILE_LOS_NORMAL:
-					Blit(&gGraphicsDevice, &tile->picAlt->pic, doorPos);
+					Blit(b->g, &tile->picAlt->pic, doorPos);
 					break;
 				case TILE_LOS_FOG:
 					BlitMasked(
-						&gGraphicsDevice,
+						b->g,
 						&tile->picAlt->pic,
 						doorPos,
 						colorFog,
@@ -260,29 +324,22 @@ static void DrawWallsAndThings(DrawBuffer *b, Vec2i offset)
 					break;
 				}
 			}
-
-			// Draw the items that are in LOS
-			if (tile->flags & MAPTILE_OUT_OF_SIGHT)
-			{
-				continue;
-			}
-			CA_FOREACH(ThingId, tid, tile->things)
-				const TTileItem *ti = ThingIdGetTileItem(tid);
-				// Don't draw debris, they are drawn later
-				if (TileItemIsDebris(ti))
-				{
-					continue;
-				}
-				CArrayPushBack(&b->displaylist, &ti);
-			CA_FOREACH_END()
 		}
-		DrawBufferSortDisplayList(b);
-		CA_FOREACH(const TTileItem *, tp, b->displaylist)
-			DrawThing(b, *tp, offset);
-		CA_FOREACH_END()
+		// Draw the items that are in LOS
+		DrawDisplayListRow(b, &b->things, y, offset);
 		tile += X_TILES - b->Size.x;
 	}
 }
+static void DrawDisplayListRow(
+	DrawBuffer *b, const DisplayList *dl, const int row, const Vec2i offset)
+{
+	int count;
+	const DisplayListEntry *e = DisplayListGetRow(dl, row, &count);
+	for (int i = 0; i < count; i++, e++)
+	{
+		DrawThing(b, e->Item, offset);
+	}
+}
 static void DrawThing(DrawBuffer *b, const TTileItem *t, const Vec2i offset)
 {
 	const Vec2i picPos = Vec2iNew(
@@ -290,7 +347,7 @@ static void DrawThing(DrawBuffer *b, const TTileItem *t, const Vec2i offset)
 
 	if (!Vec2iIsZero(t->ShadowSize))
 	{
-		DrawShadow(&gGraphicsDevice, picPos, t->ShadowSize);
+		DrawShadow(b->g, picPos, t->ShadowSize);
 	}
 
 	if (t->CPicFunc)
@@ -302,28 +359,29 @@ static void DrawThing(DrawBuffer *b, const TTileItem *t, const Vec2i offset)
 	{
 		Vec2i picOffset;
 		const Pic *pic = t->getPicFunc(t->id, &picOffset);
-		Blit(&gGraphicsDevice, pic, Vec2iAdd(picPos, picOffset));
+		Blit(b->g, pic, Vec2iAdd(picPos, picOffset));
 	}
 	else if (t->kind == KIND_CHARACTER)
 	{
 		TActor *a = CArrayGet(&gActors, t->id);
 		ActorPics pics;
 		GetCharacterPicsFromActor(&pics, a);
-		DrawActorPics(&pics, picPos, RadiansToDirection(a->DrawRadians));
+		DrawActorPics(
+			b->g, &pics, picPos, RadiansToDirection(a->DrawRadians));
 		// Draw weapon indicators
-		DrawLaserSight(&pics, a, picPos);
+		DrawLaserSight(b->g, &pics, a, picPos);
 	}
 	else
 	{
-		(*(t->drawFunc))(picPos, &t->drawData);
+		(*(t->drawFunc))(b->g, picPos, &t->drawData);
 	}
 }
 
 static void DrawObjectiveHighlight(
-	TTileItem *ti, Tile *tile, DrawBuffer *b, Vec2i offset);
+	TTileItem *ti, DrawTile *tile, DrawBuffer *b, Vec2i offset);
 static void DrawObjectiveHighlights(DrawBuffer *b, Vec2i offset)
 {
-	Tile *tile = &b->tiles[0][0];
+	DrawTile *tile = &b->tiles[0][0];
 	for (int y = 0; y < Y_TILES; y++)
 	{
 		for (int x = 0; x < b->Size.x; x++, tile++)
@@ -338,7 +396,7 @@ static void DrawObjectiveHighlights(DrawBuffer *b, Vec2i offset)
 	}
 }
 static void DrawObjectiveHighlight(
-	TTileItem *ti, Tile *tile, DrawBuffer *b, Vec2i offset)
+	TTileItem *ti, DrawTile *tile, DrawBuffer *b, Vec2i offset)
 {
 	if (!(ti->flags & TILEITEM_OBJECTIVE))
 	{
@@ -371,15 +429,14 @@ static void DrawObjectiveHighlight(
 	{
 		Vec2i picOffset;
 		const Pic *pic = ti->getPicFunc(ti->id, &picOffset);
-		BlitPicHighlight(
-			&gGraphicsDevice, pic, Vec2iAdd(pos, picOffset), color);
+		BlitPicHighlight(b->g, pic, Vec2iAdd(pos, picOffset), color);
 	}
 	else if (ti->kind == KIND_CHARACTER)
 	{
 		TActor *a = CArrayGet(&gActors, ti->id);
 		ActorPics pics;
 		GetCharacterPicsFromActor(&pics, a);
-		DrawActorHighlight(&pics, pos, color, a->direction);
+		DrawActorHighlight(b->g, &pics, pos, color, a->direction);
 	}
 }
 
@@ -401,7 +458,7 @@ static void DrawExtra(DrawBuffer *b, Vec2i offset, GrafxDrawExtra *extra)
 static void DrawEditorTiles(DrawBuffer *b, const Vec2i offset)
 {
 	Vec2i pos;
-	Tile *tile = &b->tiles[0][0];
+	DrawTile *tile = &b->tiles[0][0];
 	pos.y = b->dy + offset.y;
 	for (int y = 0; y < Y_TILES; y++, pos.y += TILE_HEIGHT)
 	{
@@ -460,7 +517,7 @@ static void DrawSpawnerName(
 	const TObject *obj, DrawBuffer *b, const Vec2i offset);
 static void DrawObjectNames(DrawBuffer *b, const Vec2i offset)
 {
-	const Tile *tile = &b->tiles[0][0];
+	const DrawTile *tile = &b->tiles[0][0];
 	for (int y = 0; y < Y_TILES; y++)
 	{
 		for (int x = 0; x < b->Size.x; x++, tile++)
@@ -53,3 +53,6 @@
 #include "grafx_bg.h"
 
 void DrawBufferDraw(DrawBuffer *b, Vec2i offset, GrafxDrawExtra *extra);
+// Draw several views at once, e.g. split screens, in parallel.
+// Each buffer should have its own graphics device, clipped to its view.
+void DrawBuffersDraw(DrawBuffer **buffers, const Vec2i *offsets, const int n);
@@ -64,6 +64,7 @@
 #include "pics.h"
 #include "draw.h"
 #include "blit.h"
+#include "char_pic_cache.h"
 #include "pic_manager.h"
 
 #define NECK_OFFSET 13
@@ -240,14 +241,18 @@ static Character *ActorGetCharacterMutable(TActor *a)
 }
 
 static void DrawBody(GraphicsDevice *g, const ActorPics *pics, const Vec2i pos);
+static void BlitCharPic(
+	GraphicsDevice *g, const Pic *pic, const Vec2i pos,
+	const CharColors *colors);
 void DrawActorPics(
-	const ActorPics *pics, const Vec2i picPos, const direction_e d)
+	GraphicsDevice *g, const ActorPics *pics, const Vec2i picPos,
+	const direction_e d)
 {
 	if (pics->IsDead)
 	{
 		if (pics->IsDying)
 		{
-			DrawBody(&gGraphicsDevice, pics, picPos);
+			DrawBody(g, pics, picPos);
 		}
 	}
 	else
@@ -255,7 +260,7 @@ void DrawActorPics(
 		// Draw shadow
 		if (!pics->IsTransparent)
 		{
-			DrawShadow(&gGraphicsDevice, picPos, Vec2iNew(8, 6));
+			DrawShadow(g, picPos, Vec2iNew(8, 6));
 		}
 		for (int i = 0; i < 3; i++)
 		{
@@ -281,25 +286,25 @@ void DrawActorPics(
 			if (pics->IsTransparent)
 			{
 				BlitBackground(
-					&gGraphicsDevice, picp, drawPos, pics->Tint, true);
+					g, picp, drawPos, pics->Tint, true);
 			}
 			else if (pics->Mask != NULL)
 			{
-				BlitMasked(&gGraphicsDevice, picp, drawPos, *pics->Mask, true);
+				BlitMasked(g, picp, drawPos, *pics->Mask, true);
 			}
 			else
 			{
-				BlitCharMultichannel(
-					&gGraphicsDevice, picp, drawPos, pics->Colors);
+				BlitCharPic(g, picp, drawPos, pics->Colors);
 			}
 		}
 	}
 }
 static void DrawLaserSightSingle(
-	const Vec2i from, const double radians, const int range,
-	const color_t color);
+	GraphicsDevice *g, const Vec2i from, const double radians,
+	const int range, const color_t color);
 void DrawLaserSight(
-	const ActorPics *pics, const TActor *a, const Vec2i picPos)
+	GraphicsDevice *device, const ActorPics *pics, const TActor *a,
+	const Vec2i picPos)
 {
 	// Don't draw if dead or transparent
 	if (pics->IsDead || pics->IsTransparent) return;
@@ -323,27 +328,29 @@ void DrawLaserSight(
 		(g->Spread.Count - 1) * g->Spread.Width / 2 + g->Recoil / 2;
 	if (spreadHalf > 0)
 	{
-		DrawLaserSightSingle(muzzlePos, radians - spreadHalf, range, color);
-		DrawLaserSightSingle(muzzlePos, radians + spreadHalf, range, color);
+		DrawLaserSightSingle(
+			device, muzzlePos, radians - spreadHalf, range, color);
+		DrawLaserSightSingle(
+			device, muzzlePos, radians + spreadHalf, range, color);
 	}
 	else
 	{
-		DrawLaserSightSingle(muzzlePos, radians, range, color);
+		DrawLaserSightSingle(device, muzzlePos, radians, range, color);
 	}
 }
 static void DrawLaserSightSingle(
-	const Vec2i from, const double radians, const int range,
-	const color_t color)
+	GraphicsDevice *g, const Vec2i from, const double radians,
+	const int range, const color_t color)
 {
 	double x, y;
 	GetVectorsForRadians(radians, &x, &y);
 	const Vec2i to = Vec2iAdd(
 		from, Vec2iNew((int)round(x * range), (int)round(y * range)));
-	DrawLine(from, to, color);
+	DrawLine(g, from, to, color);
 }
 
 void DrawActorHighlight(
-	const ActorPics *pics, const Vec2i pos, const color_t color,
+	GraphicsDevice *g, const ActorPics *pics, const Vec2i pos, const color_t color,
 	const direction_e d)
 {
 	// Do not highlight dead, dying or transparent characters
@@ -353,18 +360,18 @@ void DrawActorHighlight(
 	}
 	const Vec2i headPos = GetActorDrawOffset(
 		pos, pics->Head, BODY_PART_HEAD, d);
-	BlitPicHighlight(&gGraphicsDevice, pics->Head, headPos, color);
+	BlitPicHighlight(g, pics->Head, headPos, color);
 	if (pics->Body != NULL)
 	{
 		const Vec2i bodyPos = GetActorDrawOffset(
 			pos, pics->Body, BODY_PART_BODY, d);
-		BlitPicHighlight(&gGraphicsDevice, pics->Body, bodyPos, color);
+		BlitPicHighlight(g, pics->Body, bodyPos, color);
 	}
 	if (pics->Gun != NULL)
 	{
 		const Vec2i gunPos = GetActorDrawOffset(
 			pos, pics->Gun, BODY_PART_GUN, d);
-		BlitPicHighlight(&gGraphicsDevice, pics->Gun, gunPos, color);
+		BlitPicHighlight(g, pics->Gun, gunPos, color);
 	}
 }
 
@@ -372,7 +379,7 @@ static void DrawChatter(
 	const TTileItem *ti, DrawBuffer *b, const Vec2i offset);
 void DrawChatters(DrawBuffer *b, const Vec2i offset)
 {
-	const Tile *tile = &b->tiles[0][0];
+	const DrawTile *tile = &b->tiles[0][0];
 	for (int y = 0; y < Y_TILES; y++)
 	{
 		for (int x = 0; x < b->Size.x; x++, tile++)
@@ -438,7 +445,7 @@ void DrawCharacterSimple(
 	ActorPics pics;
 	GetCharacterPics(
 		&pics, c, d, STATE_IDLE, NULL, GUNSTATE_READY, false, NULL, NULL, 0);
-	DrawActorPics(&pics, pos, d);
+	DrawActorPics(&gGraphicsDevice, &pics, pos, d);
 	if (hilite)
 	{
 		FontCh('>', Vec2iAdd(pos, Vec2iNew(-8, -16)));
@@ -456,7 +463,7 @@ void DrawHead(
 	const Pic *head = GetHeadPic(c->Class, dir, state);
 	const Vec2i drawPos = Vec2iMinus(pos, Vec2iNew(
 		head->size.x / 2, head->size.y / 2));
-	BlitCharMultichannel(&gGraphicsDevice, head, drawPos, &c->Colors);
+	BlitCharPic(&gGraphicsDevice, head, drawPos, &c->Colors);
 }
 static void DrawBody(GraphicsDevice *g, const ActorPics *pics, const Vec2i pos)
 {
@@ -466,3 +473,18 @@ static void DrawBody(GraphicsDevice *g, const ActorPics *pics, const Vec2i pos)
 	const color_t mask = pics->Mask != NULL ? *pics->Mask : colorWhite;
 	BlitMasked(g, pics->Body, drawPos, mask, true);
 }
+static void BlitCharPic(
+	GraphicsDevice *g, const Pic *pic, const Vec2i pos,
+	const CharColors *colors)
+{
+	// Use the pre-recoloured pic if possible, which can be blitted directly
+	Pic cached;
+	if (CharPicCacheGet(&gCharPicCache, &cached, pic, colors))
+	{
+		BlitBackground(g, &cached, pos, NULL, true);
+	}
+	else
+	{
+		BlitCharMultichannel(g, pic, pos, colors);
+	}
+}
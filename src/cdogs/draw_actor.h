@@ -85,9 +85,11 @@ void DrawChatters(DrawBuffer *b, const Vec2i offset);
 
 void GetCharacterPicsFromActor(ActorPics *pics, TActor *a);
 void DrawActorPics(
-	const ActorPics *pics, const Vec2i picPos, const direction_e d);
+	GraphicsDevice *g, const ActorPics *pics, const Vec2i picPos,
+	const direction_e d);
 void DrawLaserSight(
-	const ActorPics *pics, const TActor *a, const Vec2i picPos);
+	GraphicsDevice *g, const ActorPics *pics, const TActor *a,
+	const Vec2i picPos);
 void DrawActorHighlight(
-	const ActorPics *pics, const Vec2i pos, const color_t color,
+	GraphicsDevice *g, const ActorPics *pics, const Vec2i pos, const color_t color,
 	const direction_e d);
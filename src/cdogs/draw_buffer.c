@@ -49,11 +49,26 @@
 #include "draw_buffer.h"
 
 #include <assert.h>
+#include <string.h>
 
 #include "algorithms.h"
 #include "los.h"
 
 
+static void DisplayListInit(DisplayList *dl)
+{
+	CArrayInit(&dl->entries, sizeof(DisplayListEntry));
+	CArrayReserve(&dl->entries, 32);
+	CArrayInit(&dl->rowStarts, sizeof(int));
+	CArrayInit(&dl->scratch, sizeof(DisplayListEntry));
+}
+static void DisplayListTerminate(DisplayList *dl)
+{
+	CArrayTerminate(&dl->entries);
+	CArrayTerminate(&dl->rowStarts);
+	CArrayTerminate(&dl->scratch);
+}
+
 void DrawBufferInit(DrawBuffer *b, Vec2i size, GraphicsDevice *g)
 {
 	debug(D_MAX, "Initialising draw buffer %dx%d\n", size.x, size.y);
@@ -65,22 +80,23 @@ void DrawBufferInit(DrawBuffer *b, Vec2i size, GraphicsDevice *g)
 		b->tiles[i] = b->tiles[0] + i * size.y;
 	}
 	b->g = g;
-	CArrayInit(&b->displaylist, sizeof(const TTileItem *));
-	CArrayReserve(&b->displaylist, 32);
+	DisplayListInit(&b->debris);
+	DisplayListInit(&b->things);
 	debug(D_MAX, "Initialised draw buffer %dx%d\n", size.x, size.y);
 }
 void DrawBufferTerminate(DrawBuffer *b)
 {
 	CFREE(b->tiles[0]);
 	CFREE(b->tiles);
-	CArrayTerminate(&b->displaylist);
+	DisplayListTerminate(&b->debris);
+	DisplayListTerminate(&b->things);
 }
 
 void DrawBufferSetFromMap(
 	DrawBuffer *buffer, Map *map, Vec2i origin, int width)
 {
 	int x, y;
-	Tile *bufTile;
+	DrawTile *bufTile;
 
 	buffer->Size = Vec2iNew(width, buffer->OrigSize.y);
 
@@ -109,13 +125,20 @@ void DrawBufferSetFromMap(
 			x < buffer->xStart + buffer->Size.x;
 			x++, bufTile++)
 		{
-			if (x >= 0 && x < map->Size.x && y >= 0 && y < map->Size.y)
+			const Vec2i pos = Vec2iNew(x, y);
+			const Tile *t = MapGetTile(map, pos);
+			memset(bufTile, 0, sizeof *bufTile);
+			bufTile->flags = MapGetTileFlags(map, pos);
+			if (t != NULL)
 			{
-				*bufTile = *MapGetTile(map, Vec2iNew(x, y));
+				bufTile->pic = t->pic;
+				bufTile->picAlt = t->picAlt;
+				bufTile->isVisited = t->isVisited;
+				bufTile->things = t->things;
 			}
 			else
 			{
-				*bufTile = TileNone();
+				CArrayInit(&bufTile->things, sizeof(ThingId));
 			}
 		}
 		bufTile += buffer->OrigSize.x - buffer->Size.x;
@@ -125,8 +148,8 @@ void DrawBufferSetFromMap(
 // Set visibility and draw order for wall/door columns
 void DrawBufferFix(DrawBuffer *buffer)
 {
-	Tile *tile = &buffer->tiles[0][0];
-	Tile *tileBelow = &buffer->tiles[0][0] + X_TILES;
+	DrawTile *tile = &buffer->tiles[0][0];
+	DrawTile *tileBelow = &buffer->tiles[0][0] + X_TILES;
 	for (int y = 0; y < Y_TILES - 1; y++)
 	{
 		for (int x = 0; x < buffer->Size.x; x++, tile++, tileBelow++)
@@ -166,26 +189,111 @@ void DrawBufferFix(DrawBuffer *buffer)
 	}
 }
 
-static int CompareY(const void *v1, const void *v2);
-void DrawBufferSortDisplayList(DrawBuffer *buffer)
+static void DisplayListAdd(
+	DisplayList *dl, const int row, const int yTop, const TTileItem *t);
+static void DisplayListSort(DisplayList *dl, const int rows);
+void DrawBufferBuildDisplayLists(DrawBuffer *buffer)
+{
+	CArrayClear(&buffer->debris.entries);
+	CArrayClear(&buffer->things.entries);
+	const DrawTile *tile = &buffer->tiles[0][0];
+	for (int y = 0; y < Y_TILES; y++)
+	{
+		for (int x = 0; x < buffer->Size.x; x++, tile++)
+		{
+			if (tile->flags & MAPTILE_OUT_OF_SIGHT)
+			{
+				continue;
+			}
+			CA_FOREACH(ThingId, tid, tile->things)
+				const TTileItem *ti = ThingIdGetTileItem(tid);
+				DisplayListAdd(
+					TileItemIsDebris(ti) ? &buffer->debris : &buffer->things,
+					y, buffer->yTop, ti);
+			CA_FOREACH_END()
+		}
+		tile += X_TILES - buffer->Size.x;
+	}
+	DisplayListSort(&buffer->debris, Y_TILES);
+	DisplayListSort(&buffer->things, Y_TILES);
+}
+static void DisplayListAdd(
+	DisplayList *dl, const int row, const int yTop, const TTileItem *t)
 {
-	qsort(
-		buffer->displaylist.data,
-		buffer->displaylist.size,
-		buffer->displaylist.elemSize,
-		CompareY);
+	// Sort key: tile row in the high bits, y within the view in the low bits
+	DisplayListEntry e;
+	const int y = CLAMP(t->y - yTop + 0x8000, 0, 0xFFFF);
+	e.Key = ((Uint32)row << 16) | (Uint32)y;
+	e.Item = t;
+	CArrayPushBack(&dl->entries, &e);
 }
-static int CompareY(const void *v1, const void *v2)
+static void DisplayListSort(DisplayList *dl, const int rows)
 {
-	const TTileItem * const *t1 = v1;
-	const TTileItem * const *t2 = v2;
-	if ((*t1)->y < (*t2)->y)
+	const int n = (int)dl->entries.size;
+	DisplayListEntry *entries = dl->entries.data;
+	// Things rarely move between frames, so the list is often sorted already
+	bool isSorted = true;
+	for (int i = 1; i < n && isSorted; i++)
 	{
-		return -1;
+		isSorted = entries[i - 1].Key <= entries[i].Key;
 	}
-	else if ((*t1)->y >(*t2)->y)
+	if (!isSorted)
 	{
-		return 1;
+		// Stable LSD radix sort, a byte at a time,
+		// skipping bytes that are the same for all keys
+		CArrayResize(&dl->scratch, n, NULL);
+		DisplayListEntry *src = entries;
+		DisplayListEntry *dst = dl->scratch.data;
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			int counts[256];
+			memset(counts, 0, sizeof counts);
+			for (int i = 0; i < n; i++)
+			{
+				counts[(src[i].Key >> shift) & 0xFF]++;
+			}
+			if (counts[(src[0].Key >> shift) & 0xFF] == n)
+			{
+				continue;
+			}
+			int total = 0;
+			for (int i = 0; i < 256; i++)
+			{
+				const int c = counts[i];
+				counts[i] = total;
+				total += c;
+			}
+			for (int i = 0; i < n; i++)
+			{
+				dst[counts[(src[i].Key >> shift) & 0xFF]++] = src[i];
+			}
+			DisplayListEntry *tmp = src;
+			src = dst;
+			dst = tmp;
+		}
+		if (src != entries)
+		{
+			memcpy(entries, src, n * sizeof *src);
+		}
+	}
+	// Find where each row starts
+	CArrayResize(&dl->rowStarts, rows + 1, NULL);
+	int *rowStarts = dl->rowStarts.data;
+	int i = 0;
+	for (int row = 0; row <= rows; row++)
+	{
+		while (i < n && (int)(entries[i].Key >> 16) < row)
+		{
+			i++;
+		}
+		rowStarts[row] = i;
 	}
-	return 0;
+}
+
+const DisplayListEntry *DisplayListGetRow(
+	const DisplayList *dl, const int row, int *count)
+{
+	const int *rowStarts = dl->rowStarts.data;
+	*count = rowStarts[row + 1] - rowStarts[row];
+	return (const DisplayListEntry *)dl->entries.data + rowStarts[row];
 }
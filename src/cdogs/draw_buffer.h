@@ -51,6 +51,30 @@
 
 #include "map.h"
 
+// A map tile copied for drawing, with its flags alongside
+typedef struct
+{
+	NamedPic *pic;
+	NamedPic *picAlt;
+	int flags;	// MapTileFlags, including the draw-only ones
+	bool isVisited;
+	CArray things;	// of ThingId; shallow copy of the map tile's
+} DrawTile;
+
+typedef struct
+{
+	Uint32 Key;
+	const TTileItem *Item;
+} DisplayListEntry;
+// Things to draw for a whole view, in draw order: by tile row, then by y,
+// keeping tile order for ties
+typedef struct
+{
+	CArray entries;	// of DisplayListEntry
+	CArray rowStarts;	// of int; index of first entry of each row, plus end
+	CArray scratch;	// of DisplayListEntry, for sorting
+} DisplayList;
+
 typedef struct
 {
 	GraphicsDevice *g;
@@ -59,8 +83,9 @@ typedef struct
 	int dx, dy;	// remainder pixel offset from starting tile
 	Vec2i OrigSize;
 	Vec2i Size;	// size in tiles
-	Tile **tiles;
-	CArray displaylist;	// of const TTileItem *, to determine draw order
+	DrawTile **tiles;
+	DisplayList debris;
+	DisplayList things;
 } DrawBuffer;
 
 void DrawBufferInit(DrawBuffer *b, Vec2i size, GraphicsDevice *g);
@@ -69,6 +94,10 @@ void DrawBufferTerminate(DrawBuffer *b);
 void DrawBufferSetFromMap(
 	DrawBuffer *buffer, Map *map, Vec2i origin, int width);
 void DrawBufferFix(DrawBuffer *buffer);
-void DrawBufferSortDisplayList(DrawBuffer *buffer);
+// Collect and sort the things in sight, once per frame
+void DrawBufferBuildDisplayLists(DrawBuffer *buffer);
+// Get the range of display list entries for a tile row
+const DisplayListEntry *DisplayListGetRow(
+	const DisplayList *dl, const int row, int *count);
 
 #endif
@@ -56,18 +56,25 @@
 #include "grafx.h"
 
 
+static void DrawPoint(
+	GraphicsDevice *device, const int x, const int y, color_t c);
 void Draw_Point(const int x, const int y, color_t c)
 {
-	Uint32 *screen = gGraphicsDevice.buf;
+	DrawPoint(&gGraphicsDevice, x, y, c);
+}
+static void DrawPoint(
+	GraphicsDevice *device, const int x, const int y, color_t c)
+{
+	Uint32 *screen = device->buf;
 	int idx = PixelIndex(
 		x,
 		y,
-		gGraphicsDevice.cachedConfig.Res.x,
-		gGraphicsDevice.cachedConfig.Res.y);
-	if (x < gGraphicsDevice.clipping.left ||
-		x > gGraphicsDevice.clipping.right ||
-		y < gGraphicsDevice.clipping.top ||
-		y > gGraphicsDevice.clipping.bottom)
+		device->cachedConfig.Res.x,
+		device->cachedConfig.Res.y);
+	if (x < device->clipping.left ||
+		x > device->clipping.right ||
+		y < device->clipping.top ||
+		y > device->clipping.bottom)
 	{
 		return;
 	}
@@ -140,18 +147,27 @@ static void Draw_DiagonalLine(const int x1, const int x2, color_t c)
 	return;
 }
 
+typedef struct
+{
+	GraphicsDevice *g;
+	color_t c;
+} DrawPointData;
 static void DrawPointFunc(void *data, const Vec2i pos);
-void DrawLine(const Vec2i from, const Vec2i to, color_t c)
+void DrawLine(
+	GraphicsDevice *g, const Vec2i from, const Vec2i to, color_t c)
 {
+	DrawPointData dpData;
+	dpData.g = g;
+	dpData.c = c;
 	AlgoLineDrawData data;
 	data.Draw = DrawPointFunc;
-	data.data = &c;
+	data.data = &dpData;
 	BresenhamLineDraw(from, to, &data);
 }
 static void DrawPointFunc(void *data, const Vec2i pos)
 {
-	const color_t *c = data;
-	Draw_Point(pos.x, pos.y, *c);
+	const DrawPointData *dpData = data;
+	DrawPoint(dpData->g, pos.x, pos.y, dpData->c);
 }
 
 void Draw_Line(
@@ -177,10 +193,10 @@ void DrawPointMask(GraphicsDevice *device, Vec2i pos, color_t mask)
 		device->cachedConfig.Res.x,
 		device->cachedConfig.Res.y);
 	color_t c;
-	if (pos.x < gGraphicsDevice.clipping.left ||
-		pos.x > gGraphicsDevice.clipping.right ||
-		pos.y < gGraphicsDevice.clipping.top ||
-		pos.y > gGraphicsDevice.clipping.bottom)
+	if (pos.x < device->clipping.left ||
+		pos.x > device->clipping.right ||
+		pos.y < device->clipping.top ||
+		pos.y > device->clipping.bottom)
 	{
 		return;
 	}
@@ -270,7 +286,7 @@ void DrawShadow(GraphicsDevice *device, Vec2i pos, Vec2i size)
 	Vec2i drawPos;
 	for (drawPos.y = pos.y - size.y; drawPos.y < pos.y + size.y; drawPos.y++)
 	{
-		if (drawPos.y >= device->clipping.bottom)
+		if (drawPos.y > device->clipping.bottom)
 		{
 			break;
 		}
@@ -283,7 +299,7 @@ void DrawShadow(GraphicsDevice *device, Vec2i pos, Vec2i size)
 			// Calculate value tint based on distance from center
 			Vec2i scaledPos;
 			int distance2;
-			if (drawPos.x >= device->clipping.right)
+			if (drawPos.x > device->clipping.right)
 			{
 				break;
 			}
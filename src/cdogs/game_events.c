@@ -28,6 +28,7 @@
 */
 #include "game_events.h"
 
+#include <stdint.h>
 #include <string.h>
 
 #include "actors.h"
@@ -36,126 +37,146 @@
 #include "utils.h"
 
 
-CArray gGameEvents;
+GameEventQueue gGameEvents;
 
-void GameEventsInit(CArray *store)
+#define CHUNK_SIZE (16 * 1024)
+// Events are packed at this alignment, enough for any of their data
+#define EVENT_ALIGN 8
+typedef struct
 {
-	CArrayInit(store, sizeof(GameEvent));
+	uint8_t *data;
+	size_t used;
+} GameEventChunk;
+
+void GameEventsInit(GameEventQueue *store)
+{
+	CArrayInit(&store->chunks, sizeof(GameEventChunk));
+	store->chunk = 0;
 }
-void GameEventsTerminate(CArray *store)
+void GameEventsTerminate(GameEventQueue *store)
 {
-	CArrayTerminate(store);
+	CA_FOREACH(GameEventChunk, c, store->chunks)
+		CFREE(c->data);
+	CA_FOREACH_END()
+	CArrayTerminate(&store->chunks);
 }
 
 
+#define EVENT_SIZE(_member) sizeof(((GameEvent *)NULL)->u._member)
 // Array indexed by GameEvent
 static GameEventEntry sGameEventEntries[] =
 {
-	{ GAME_EVENT_NONE, false, false, false, false, NULL },
-
-	{ GAME_EVENT_CLIENT_CONNECT, false, false, false, false, NULL },
-	{ GAME_EVENT_CLIENT_ID, false, false, false, false, NClientId_fields },
-	{ GAME_EVENT_CAMPAIGN_DEF, false, false, false, false, NCampaignDef_fields },
-	{ GAME_EVENT_PLAYER_DATA, true, false, true, false, NPlayerData_fields },
-	{ GAME_EVENT_PLAYER_REMOVE, true, false, true, false, NPlayerRemove_fields },
-	{ GAME_EVENT_TILE_SET, true, false, true, true, NTileSet_fields },
-	{ GAME_EVENT_MAP_OBJECT_ADD, true, false, true, true, NMapObjectAdd_fields },
-	{ GAME_EVENT_MAP_OBJECT_DAMAGE, true, false, true, true, NMapObjectDamage_fields },
-	{ GAME_EVENT_MAP_OBJECT_REMOVE, true, false, true, true, NMapObjectRemove_fields },
-	{ GAME_EVENT_CLIENT_READY, false, false, false, false, NULL },
-	{ GAME_EVENT_NET_GAME_START, false, false, false, false, NULL },
-
-	{ GAME_EVENT_CONFIG, true, false, true, false, NConfig_fields },
-	{ GAME_EVENT_SCORE, true, true, true, true, NScore_fields },
-	{ GAME_EVENT_SOUND_AT, true, false, true, true, NSound_fields },
-	{ GAME_EVENT_SCREEN_SHAKE, false, false, true, true, NULL },
-	{ GAME_EVENT_SET_MESSAGE, false, false, true, true, NULL },
-
-	{ GAME_EVENT_GAME_START, true, false, true, true, NULL },
-	{ GAME_EVENT_GAME_BEGIN, true, false, true, true, NULL },
-
-	{ GAME_EVENT_ACTOR_ADD, true, false, true, true, NActorAdd_fields },
-	{ GAME_EVENT_ACTOR_MOVE, true, true, true, true, NActorMove_fields },
-	{ GAME_EVENT_ACTOR_STATE, true, true, true, true, NActorState_fields },
-	{ GAME_EVENT_ACTOR_DIR, true, true, true, true, NActorDir_fields },
-	{ GAME_EVENT_ACTOR_SLIDE, true, true, true, true, NActorSlide_fields },
-	{ GAME_EVENT_ACTOR_IMPULSE, true, false, true, true, NActorImpulse_fields },
-	{ GAME_EVENT_ACTOR_SWITCH_GUN, true, true, true, true, NActorSwitchGun_fields },
-	{ GAME_EVENT_ACTOR_PICKUP_ALL, false, true, true, true, NActorPickupAll_fields },
-	{ GAME_EVENT_ACTOR_REPLACE_GUN, true, false, true, true, NActorReplaceGun_fields },
-	{ GAME_EVENT_ACTOR_HEAL, true, false, true, true, NActorHeal_fields },
-	{ GAME_EVENT_ACTOR_HIT, true, false, true, true, NActorHit_fields },
-	{ GAME_EVENT_ACTOR_ADD_AMMO, true, false, true, true, NActorAddAmmo_fields },
-	{ GAME_EVENT_ACTOR_USE_AMMO, true, true, true, true, NActorUseAmmo_fields },
-	{ GAME_EVENT_ACTOR_DIE, true, false, true, true, NActorDie_fields },
-	{ GAME_EVENT_ACTOR_MELEE, true, true, true, true, NActorMelee_fields },
-
-	{ GAME_EVENT_ADD_PICKUP, true, false, true, true, NAddPickup_fields },
-	{ GAME_EVENT_REMOVE_PICKUP, true, false, true, true, NRemovePickup_fields },
-
-	{ GAME_EVENT_BULLET_BOUNCE, true, false, true, true, NBulletBounce_fields },
-	{ GAME_EVENT_REMOVE_BULLET, true, false, true, true, NRemoveBullet_fields },
-	{ GAME_EVENT_PARTICLE_REMOVE, false, false, true, true, NULL },
-	{ GAME_EVENT_GUN_FIRE, true, true, true, true, NGunFire_fields },
-	{ GAME_EVENT_GUN_RELOAD, true, true, true, true, NGunReload_fields },
-	{ GAME_EVENT_GUN_STATE, true, true, true, true, NGunState_fields },
-	{ GAME_EVENT_ADD_BULLET, true, false, true, true, NAddBullet_fields },
-	{ GAME_EVENT_ADD_PARTICLE, false, false, true, true, NULL },
-	{ GAME_EVENT_TRIGGER, true, false, true, true, NTrigger_fields },
-	{ GAME_EVENT_EXPLORE_TILES, true, false, true, true, NExploreTiles_fields },
-	{ GAME_EVENT_RESCUE_CHARACTER, true, false, true, true, NRescueCharacter_fields },
-	{ GAME_EVENT_OBJECTIVE_UPDATE, true, false, true, true, NObjectiveUpdate_fields },
-	{ GAME_EVENT_ADD_KEYS, true, false, true, true, NAddKeys_fields },
-
-	{ GAME_EVENT_MISSION_COMPLETE, true, false, true, true, NMissionComplete_fields },
-
-	{ GAME_EVENT_MISSION_INCOMPLETE, true, false, true, true, NULL },
-	{ GAME_EVENT_MISSION_PICKUP, true, false, true, true, NULL },
-	{ GAME_EVENT_MISSION_END, true, false, true, true, NMissionEnd_fields }
+	{ GAME_EVENT_NONE, false, false, false, false, NULL, 0 },
+
+	{ GAME_EVENT_CLIENT_CONNECT, false, false, false, false, NULL, 0 },
+	{ GAME_EVENT_CLIENT_ID, false, false, false, false, NClientId_fields, 0 },
+	{ GAME_EVENT_CAMPAIGN_DEF, false, false, false, false, NCampaignDef_fields, 0 },
+	{ GAME_EVENT_PLAYER_DATA, true, false, true, false, NPlayerData_fields, EVENT_SIZE(PlayerData) },
+	{ GAME_EVENT_PLAYER_REMOVE, true, false, true, false, NPlayerRemove_fields, EVENT_SIZE(PlayerRemove) },
+	{ GAME_EVENT_TILE_SET, true, false, true, true, NTileSet_fields, EVENT_SIZE(TileSet) },
+	{ GAME_EVENT_MAP_OBJECT_ADD, true, false, true, true, NMapObjectAdd_fields, EVENT_SIZE(MapObjectAdd) },
+	{ GAME_EVENT_MAP_OBJECT_DAMAGE, true, false, true, true, NMapObjectDamage_fields, EVENT_SIZE(MapObjectDamage) },
+	{ GAME_EVENT_MAP_OBJECT_REMOVE, true, false, true, true, NMapObjectRemove_fields, EVENT_SIZE(MapObjectRemove) },
+	{ GAME_EVENT_CLIENT_READY, false, false, false, false, NULL, 0 },
+	{ GAME_EVENT_NET_GAME_START, false, false, false, false, NULL, 0 },
+
+	{ GAME_EVENT_CONFIG, true, false, true, false, NConfig_fields, EVENT_SIZE(Config) },
+	{ GAME_EVENT_SCORE, true, true, true, true, NScore_fields, EVENT_SIZE(Score) },
+	{ GAME_EVENT_SOUND_AT, true, false, true, true, NSound_fields, EVENT_SIZE(SoundAt) },
+	{ GAME_EVENT_SCREEN_SHAKE, false, false, true, true, NULL, EVENT_SIZE(ShakeAmount) },
+	{ GAME_EVENT_SET_MESSAGE, false, false, true, true, NULL, EVENT_SIZE(SetMessage) },
+
+	{ GAME_EVENT_GAME_START, true, false, true, true, NULL, 0 },
+	{ GAME_EVENT_GAME_BEGIN, true, false, true, true, NULL, 0 },
+
+	{ GAME_EVENT_ACTOR_ADD, true, false, true, true, NActorAdd_fields, EVENT_SIZE(ActorAdd) },
+	{ GAME_EVENT_ACTOR_MOVE, true, true, true, true, NActorMove_fields, EVENT_SIZE(ActorMove) },
+	{ GAME_EVENT_ACTOR_STATE, true, true, true, true, NActorState_fields, EVENT_SIZE(ActorState) },
+	{ GAME_EVENT_ACTOR_DIR, true, true, true, true, NActorDir_fields, EVENT_SIZE(ActorDir) },
+	{ GAME_EVENT_ACTOR_SLIDE, true, true, true, true, NActorSlide_fields, EVENT_SIZE(ActorSlide) },
+	{ GAME_EVENT_ACTOR_IMPULSE, true, false, true, true, NActorImpulse_fields, EVENT_SIZE(ActorImpulse) },
+	{ GAME_EVENT_ACTOR_SWITCH_GUN, true, true, true, true, NActorSwitchGun_fields, EVENT_SIZE(ActorSwitchGun) },
+	{ GAME_EVENT_ACTOR_PICKUP_ALL, false, true, true, true, NActorPickupAll_fields, EVENT_SIZE(ActorPickupAll) },
+	{ GAME_EVENT_ACTOR_REPLACE_GUN, true, false, true, true, NActorReplaceGun_fields, EVENT_SIZE(ActorReplaceGun) },
+	{ GAME_EVENT_ACTOR_HEAL, true, false, true, true, NActorHeal_fields, EVENT_SIZE(Heal) },
+	{ GAME_EVENT_ACTOR_HIT, true, false, true, true, NActorHit_fields, EVENT_SIZE(ActorHit) },
+	{ GAME_EVENT_ACTOR_ADD_AMMO, true, false, true, true, NActorAddAmmo_fields, EVENT_SIZE(AddAmmo) },
+	{ GAME_EVENT_ACTOR_USE_AMMO, true, true, true, true, NActorUseAmmo_fields, EVENT_SIZE(UseAmmo) },
+	{ GAME_EVENT_ACTOR_DIE, true, false, true, true, NActorDie_fields, EVENT_SIZE(ActorDie) },
+	{ GAME_EVENT_ACTOR_MELEE, true, true, true, true, NActorMelee_fields, EVENT_SIZE(Melee) },
+
+	{ GAME_EVENT_ADD_PICKUP, true, false, true, true, NAddPickup_fields, EVENT_SIZE(AddPickup) },
+	{ GAME_EVENT_REMOVE_PICKUP, true, false, true, true, NRemovePickup_fields, EVENT_SIZE(RemovePickup) },
+
+	{ GAME_EVENT_BULLET_BOUNCE, true, false, true, true, NBulletBounce_fields, EVENT_SIZE(BulletBounce) },
+	{ GAME_EVENT_REMOVE_BULLET, true, false, true, true, NRemoveBullet_fields, EVENT_SIZE(RemoveBullet) },
+	{ GAME_EVENT_GUN_FIRE, true, true, true, true, NGunFire_fields, EVENT_SIZE(GunFire) },
+	{ GAME_EVENT_GUN_RELOAD, true, true, true, true, NGunReload_fields, EVENT_SIZE(GunReload) },
+	{ GAME_EVENT_GUN_STATE, true, true, true, true, NGunState_fields, EVENT_SIZE(GunState) },
+	{ GAME_EVENT_ADD_BULLET, true, false, true, true, NAddBullet_fields, EVENT_SIZE(AddBullet) },
+	{ GAME_EVENT_ADD_PARTICLE, false, false, true, true, NULL, EVENT_SIZE(AddParticle) },
+	{ GAME_EVENT_TRIGGER, true, false, true, true, NTrigger_fields, EVENT_SIZE(TriggerEvent) },
+	{ GAME_EVENT_EXPLORE_TILES, true, false, true, true, NExploreTiles_fields, EVENT_SIZE(ExploreTiles) },
+	{ GAME_EVENT_RESCUE_CHARACTER, true, false, true, true, NRescueCharacter_fields, EVENT_SIZE(Rescue) },
+	{ GAME_EVENT_OBJECTIVE_UPDATE, true, false, true, true, NObjectiveUpdate_fields, EVENT_SIZE(ObjectiveUpdate) },
+	{ GAME_EVENT_ADD_KEYS, true, false, true, true, NAddKeys_fields, EVENT_SIZE(AddKeys) },
+
+	{ GAME_EVENT_MISSION_COMPLETE, true, false, true, true, NMissionComplete_fields, EVENT_SIZE(MissionComplete) },
+
+	{ GAME_EVENT_MISSION_INCOMPLETE, true, false, true, true, NULL, 0 },
+	{ GAME_EVENT_MISSION_PICKUP, true, false, true, true, NULL, 0 },
+	{ GAME_EVENT_MISSION_END, true, false, true, true, NMissionEnd_fields, EVENT_SIZE(MissionEnd) }
 };
 GameEventEntry GameEventGetEntry(const GameEventType e)
 {
 	return sGameEventEntries[(int)e];
 }
 
-void GameEventsEnqueue(CArray *store, GameEvent e)
+static size_t EventSize(const GameEventType type)
+{
+	const size_t size = offsetof(GameEvent, u) + sGameEventEntries[type].Size;
+	return (size + EVENT_ALIGN - 1) & ~(size_t)(EVENT_ALIGN - 1);
+}
+
+static GameEvent *EventAlloc(GameEventQueue *store, const size_t size);
+void GameEventsEnqueue(GameEventQueue *store, const GameEvent *e)
 {
-	if (store->elemSize == 0)
+	if (store->chunks.elemSize == 0)
 	{
 		return;
 	}
 	// If we're the server, broadcast any events that clients need
 	// If we're the client, pass along to server, but only if it's for a local player
 	// Otherwise we'd ping-pong the same updates from the server
-	const GameEventEntry gee = sGameEventEntries[e.Type];
+	const GameEventEntry gee = sGameEventEntries[e->Type];
 	if (gee.Broadcast)
 	{
-		NetServerSendMsg(&gNetServer, NET_SERVER_BCAST, gee.Type, &e.u);
+		NetServerSendMsg(&gNetServer, NET_SERVER_BCAST, gee.Type, &e->u);
 	}
 	if (gee.Submit)
 	{
 		int actorUID = -1;
 		bool actorIsLocal = false;
-		switch (e.Type)
+		switch (e->Type)
 		{
-		case GAME_EVENT_ACTOR_MOVE: actorUID = e.u.ActorMove.UID; break;
-		case GAME_EVENT_ACTOR_STATE: actorUID = e.u.ActorState.UID; break;
-		case GAME_EVENT_ACTOR_DIR: actorUID = e.u.ActorDir.UID; break;
-		case GAME_EVENT_ACTOR_SLIDE: actorUID = e.u.ActorSlide.UID; break;
-		case GAME_EVENT_ACTOR_SWITCH_GUN: actorUID = e.u.ActorSwitchGun.UID; break;
-		case GAME_EVENT_ACTOR_PICKUP_ALL: actorUID = e.u.ActorPickupAll.UID; break;
-		case GAME_EVENT_ACTOR_USE_AMMO: actorUID = e.u.UseAmmo.UID; break;
-		case GAME_EVENT_ACTOR_MELEE: actorUID = e.u.Melee.UID; break;
+		case GAME_EVENT_ACTOR_MOVE: actorUID = e->u.ActorMove.UID; break;
+		case GAME_EVENT_ACTOR_STATE: actorUID = e->u.ActorState.UID; break;
+		case GAME_EVENT_ACTOR_DIR: actorUID = e->u.ActorDir.UID; break;
+		case GAME_EVENT_ACTOR_SLIDE: actorUID = e->u.ActorSlide.UID; break;
+		case GAME_EVENT_ACTOR_SWITCH_GUN: actorUID = e->u.ActorSwitchGun.UID; break;
+		case GAME_EVENT_ACTOR_PICKUP_ALL: actorUID = e->u.ActorPickupAll.UID; break;
+		case GAME_EVENT_ACTOR_USE_AMMO: actorUID = e->u.UseAmmo.UID; break;
+		case GAME_EVENT_ACTOR_MELEE: actorUID = e->u.Melee.UID; break;
 		case GAME_EVENT_GUN_FIRE:
-			if (e.u.GunFire.IsGun)
+			if (e->u.GunFire.IsGun)
 			{
-				actorIsLocal = PlayerIsLocal(e.u.GunFire.PlayerUID);
+				actorIsLocal = PlayerIsLocal(e->u.GunFire.PlayerUID);
 			}
 			break;
 		case GAME_EVENT_GUN_RELOAD:
-			actorIsLocal = PlayerIsLocal(e.u.GunReload.PlayerUID);
+			actorIsLocal = PlayerIsLocal(e->u.GunReload.PlayerUID);
 			break;
-		case GAME_EVENT_GUN_STATE: actorUID = e.u.GunState.ActorUID; break;
+		case GAME_EVENT_GUN_STATE: actorUID = e->u.GunState.ActorUID; break;
 		default: break;
 		}
 		if (actorUID >= 0)
@@ -164,26 +185,97 @@ void GameEventsEnqueue(CArray *store, GameEvent e)
 		}
 		if (actorIsLocal)
 		{
-			NetClientSendMsg(&gNetClient, gee.Type, &e.u);
+			NetClientSendMsg(&gNetClient, gee.Type, &e->u);
 		}
 	}
 
-	CArrayPushBack(store, &e);
+	const size_t size = EventSize(e->Type);
+	memcpy(EventAlloc(store, size), e, size);
+}
+static GameEvent *EventAlloc(GameEventQueue *store, const size_t size)
+{
+	GameEventChunk *c = NULL;
+	if (store->chunk < (int)store->chunks.size)
+	{
+		c = CArrayGet(&store->chunks, store->chunk);
+		if (c->used + size > CHUNK_SIZE)
+		{
+			// Start the next chunk; old chunks don't move so events in
+			// them stay valid
+			store->chunk++;
+			c = NULL;
+		}
+	}
+	if (c == NULL && store->chunk == (int)store->chunks.size)
+	{
+		GameEventChunk newChunk;
+		CMALLOC(newChunk.data, CHUNK_SIZE);
+		newChunk.used = 0;
+		CArrayPushBack(&store->chunks, &newChunk);
+	}
+	c = CArrayGet(&store->chunks, store->chunk);
+	GameEvent *e = (GameEvent *)(c->data + c->used);
+	c->used += size;
+	return e;
 }
-static bool EventComplete(const void *elem);
-void GameEventsClear(CArray *store)
+
+GameEvent *GameEventsNext(GameEventQueue *store, GameEventCursor *c)
 {
-	CArrayRemoveIf(store, EventComplete);
+	while (c->chunk <= store->chunk && c->chunk < (int)store->chunks.size)
+	{
+		const GameEventChunk *chunk = CArrayGet(&store->chunks, c->chunk);
+		if (c->offset < chunk->used)
+		{
+			GameEvent *e = (GameEvent *)(chunk->data + c->offset);
+			c->offset += EventSize(e->Type);
+			return e;
+		}
+		c->chunk++;
+		c->offset = 0;
+	}
+	return NULL;
 }
-static bool EventComplete(const void *elem)
+
+void GameEventsClear(GameEventQueue *store)
 {
-	return ((const GameEvent *)elem)->Delay < 0;
+	// Move events that are still waiting on their delay to the front;
+	// they only move backwards so they can be moved in place
+	GameEventCursor dst = { 0, 0 };
+	GameEventChunk *dstChunk = NULL;
+	for (int i = 0; i <= store->chunk && i < (int)store->chunks.size; i++)
+	{
+		GameEventChunk *chunk = CArrayGet(&store->chunks, i);
+		const size_t used = chunk->used;
+		chunk->used = 0;
+		for (size_t offset = 0; offset < used;)
+		{
+			const GameEvent *e = (const GameEvent *)(chunk->data + offset);
+			const size_t size = EventSize(e->Type);
+			if (e->Delay >= 0)
+			{
+				dstChunk = CArrayGet(&store->chunks, dst.chunk);
+				if (dst.offset + size > CHUNK_SIZE)
+				{
+					dstChunk->used = dst.offset;
+					dst.chunk++;
+					dst.offset = 0;
+					dstChunk = CArrayGet(&store->chunks, dst.chunk);
+				}
+				memmove(dstChunk->data + dst.offset, e, size);
+				dst.offset += size;
+				dstChunk->used = dst.offset;
+			}
+			offset += size;
+		}
+	}
+	store->chunk = dst.chunk;
 }
 
 GameEvent GameEventNew(GameEventType type)
 {
 	GameEvent e;
-	memset(&e, 0, sizeof e);
+	// Only the type's own data is used; see GameEventsEnqueue
+	memset(&e, 0, offsetof(GameEvent, u) + sGameEventEntries[type].Size);
 	e.Type = type;
 	return e;
 }
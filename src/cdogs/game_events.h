@@ -88,7 +88,6 @@ typedef enum
 
 	GAME_EVENT_BULLET_BOUNCE,
 	GAME_EVENT_REMOVE_BULLET,
-	GAME_EVENT_PARTICLE_REMOVE,
 	GAME_EVENT_GUN_FIRE,
 	GAME_EVENT_GUN_RELOAD,
 	GAME_EVENT_GUN_STATE,
@@ -121,6 +120,8 @@ typedef struct
 	// Whether to broadcast these events only after game start
 	bool GameStart;
 	const pb_field_t *Fields;
+	// Size of the event's data in GameEvent.u
+	size_t Size;
 } GameEventEntry;
 GameEventEntry GameEventGetEntry(const GameEventType e);
 
@@ -169,7 +170,6 @@ typedef struct
 		} ObjectSetCounter;
 		NBulletBounce BulletBounce;
 		NRemoveBullet RemoveBullet;
-		int ParticleRemoveId;
 		NGunFire GunFire;
 		NGunReload GunReload;
 		NGunState GunState;
@@ -185,13 +185,33 @@ typedef struct
 	} u;
 } GameEvent;
 
-extern CArray gGameEvents;	// of GameEvent
+// Queue of game events, each packed into only as much space as its type
+// needs; handle them by pointer and only access their type's union member.
+// The memory is split into chunks that don't move, so events stay valid
+// while more are enqueued, until the queue is cleared.
+typedef struct
+{
+	CArray chunks;	// of GameEventChunk
+	int chunk;	// chunk being written to
+} GameEventQueue;
+typedef struct
+{
+	int chunk;
+	size_t offset;
+} GameEventCursor;
+
+extern GameEventQueue gGameEvents;
 
 #define GAME_OVER_DELAY (FPS_FRAMELIMIT * 2)
 
-void GameEventsInit(CArray *store);
-void GameEventsTerminate(CArray *store);
-void GameEventsEnqueue(CArray *store, GameEvent e);
-void GameEventsClear(CArray *store);
+void GameEventsInit(GameEventQueue *store);
+void GameEventsTerminate(GameEventQueue *store);
+void GameEventsEnqueue(GameEventQueue *store, const GameEvent *e);
+// Get the event at the cursor and move past it, or NULL at the end of the
+// queue; start with a zeroed cursor.
+// Events enqueued while iterating are returned too.
+GameEvent *GameEventsNext(GameEventQueue *store, GameEventCursor *c);
+// Remove events that are done, i.e. with negative Delay
+void GameEventsClear(GameEventQueue *store);
 
 GameEvent GameEventNew(GameEventType type);
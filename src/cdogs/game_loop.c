@@ -67,7 +67,7 @@ void GameLoop(GameLoopData *data)
 		const Uint32 ticksThen = ticksNow;
 		ticksNow = SDL_GetTicks();
 		ticksElapsed += ticksNow - ticksThen;
-		if ((int)ticksElapsed < 1000 / data->FPS)
+		if ((int)ticksElapsed < 1000 / data->FPS && !data->Unlimited)
 		{
 			SDL_Delay(1);
 			continue;
@@ -109,7 +109,11 @@ void GameLoop(GameLoopData *data)
 		ticksElapsed -= 1000 / data->FPS;
 		data->Frames++;
 		// frame skip
-		if ((int)ticksElapsed > 1000 / data->FPS)
+		if (data->Unlimited)
+		{
+			ticksElapsed = 0;
+		}
+		else if ((int)ticksElapsed > 1000 / data->FPS)
 		{
 			framesSkipped++;
 			if (framesSkipped == maxFrameskip)
@@ -125,7 +129,7 @@ void GameLoop(GameLoopData *data)
 		framesSkipped = 0;
 
 		// Draw
-		if (draw)
+		if (draw && !data->NoDraw)
 		{
 			if (data->DrawFunc)
 			{
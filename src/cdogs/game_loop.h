@@ -51,6 +51,9 @@ typedef struct
 	void (*DrawFunc)(void *);
 	int FPS;
 	bool InputEverySecondFrame;
+	// Run as fast as possible, without limiting the frame rate
+	bool Unlimited;
+	bool NoDraw;
 	int Frames;		// total frames looped
 	bool HasDrawnFirst;
 } GameLoopData;
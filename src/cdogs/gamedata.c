@@ -132,7 +132,6 @@ void MissionOptionsTerminate(struct MissionOptions *mo)
 	MobObjsTerminate();
 	PickupsTerminate();
 	ParticlesTerminate(&gParticles);
-	WatchesTerminate();
 	CA_FOREACH(PlayerData, p, gPlayerDatas)
 		p->ActorUID = -1;
 	CA_FOREACH_END()
@@ -102,7 +102,7 @@ void GrafxMakeBackground(
 {
 	CampaignAndMissionSetup(co, mo);
 	GameEventsInit(&gGameEvents);
-	MapLoad(map, mo, co);
+	MapLoad(map, mo, co, CampaignMissionSeed(co));
 	MapLoadDynamic(map, mo, &co->Setting.characters);
 	InitializeBadGuys();
 	CreateEnemies();
@@ -53,6 +53,7 @@
 #include <time.h>
 
 #include "actors.h"
+#include "ai.h"
 #include "ammo.h"
 #include "automap.h"
 #include "draw.h"
@@ -62,7 +63,9 @@
 #include "font.h"
 #include "game_events.h"
 #include "mission.h"
+#include "particle.h"
 #include "pic_manager.h"
+#include "visibility_cache.h"
 
 
 // Total number of milliseconds that the numeric update lasts for
@@ -101,6 +104,58 @@ void FPSCounterDraw(FPSCounter *counter)
 	FontStrOpt(s, Vec2iZero(), opts);
 }
 
+// Live particles, and spawned/culled in the last frame; shown above FPS
+static void DrawParticleStats(const Particles *ps)
+{
+	char s[64];
+	sprintf(
+		s, "Particles: %d +%d -%d",
+		ps->size, ps->Budget.LastSpawned, ps->Budget.LastCulled);
+
+	FontOpts opts = FontOptsNew();
+	opts.HAlign = ALIGN_END;
+	opts.VAlign = ALIGN_END;
+	opts.Area = gGraphicsDevice.cachedConfig.Res;
+	opts.Pad = Vec2iNew(10, 5 + 2 * FontH());
+	FontStrOpt(s, Vec2iZero(), opts);
+}
+
+// Bad guy decisions made, skipped and deferred in the last frame
+static void DrawAIStats(const AIScheduler *s)
+{
+	char buf[64];
+	sprintf(
+		buf, "AI: %d +%d ~%d -%d",
+		s->LastDecided + s->LastSkipped + s->LastDeferred,
+		s->LastDecided, s->LastSkipped, s->LastDeferred);
+
+	FontOpts opts = FontOptsNew();
+	opts.HAlign = ALIGN_END;
+	opts.VAlign = ALIGN_END;
+	opts.Area = gGraphicsDevice.cachedConfig.Res;
+	opts.Pad = Vec2iNew(10, 5 + 3 * FontH());
+	FontStrOpt(buf, Vec2iZero(), opts);
+}
+
+// AI line checks in the last frame: how many were looked up in the
+// visibility cache, and how many of those were found and known to be clear
+static void DrawVisibilityStats(const VisibilityCache *vc)
+{
+	char buf[64];
+	const int lookups = MAX(1, vc->LastLookups);
+	sprintf(
+		buf, "Lines: %d %d%% hit %d%% clear",
+		vc->LastLookups,
+		vc->LastHits * 100 / lookups, vc->LastClear * 100 / lookups);
+
+	FontOpts opts = FontOptsNew();
+	opts.HAlign = ALIGN_END;
+	opts.VAlign = ALIGN_END;
+	opts.Area = gGraphicsDevice.cachedConfig.Res;
+	opts.Pad = Vec2iNew(10, 5 + 4 * FontH());
+	FontStrOpt(buf, Vec2iZero(), opts);
+}
+
 void WallClockSetTime(WallClock *wc)
 {
 	time_t t = time(NULL);
@@ -1091,6 +1146,9 @@ void HUDDraw(
 	if (ConfigGetBool(&gConfig, "Interface.ShowFPS"))
 	{
 		FPSCounterDraw(&hud->fpsCounter);
+		DrawParticleStats(&gParticles);
+		DrawAIStats(&gAIScheduler);
+		DrawVisibilityStats(&gVisibilityCache);
 	}
 	if (ConfigGetBool(&gConfig, "Interface.ShowTime"))
 	{
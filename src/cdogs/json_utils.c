@@ -153,20 +153,6 @@ void LoadPic(const Pic **value, json_t *node, const char *name)
 		CFREE(tmp);
 	}
 }
-void LoadBulletGuns(CArray *guns, json_t *node, const char *name)
-{
-	node = json_find_first_label(node, name);
-	if (node == NULL || node->child == NULL)
-	{
-		return;
-	}
-	CArrayInit(guns, sizeof(const GunDescription *));
-	for (json_t *gun = node->child->child; gun; gun = gun->next)
-	{
-		const GunDescription *g = StrGunDescription(gun->text);
-		CArrayPushBack(guns, &g);
-	}
-}
 void LoadColor(color_t *c, json_t *node, const char *name)
 {
 	if (json_find_first_label(node, name) == NULL)
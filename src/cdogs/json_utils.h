@@ -52,8 +52,6 @@ char *GetString(json_t *node, const char *name);
 void LoadSoundFromNode(Mix_Chunk **value, json_t *node, const char *name);
 // Load a const Pic * based on a name
 void LoadPic(const Pic **value, json_t *node, const char *name);
-// Load an array of const GunDescription *
-void LoadBulletGuns(CArray *guns, json_t *node, const char *name);
 void LoadColor(color_t *c, json_t *node, const char *name);
 
 // Try to load a JSON node using a slash-delimited "path"
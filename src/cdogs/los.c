@@ -150,8 +150,7 @@ void LOSCalcFrom(Map *map, const Vec2i pos, const bool explore)
 	{
 		for (end.x = origin.x; end.x < origin.x + perimSize.x; end.x++)
 		{
-			const Tile *tile = MapGetTile(map, end);
-			if (!tile || !(tile->flags & MAPTILE_NO_SEE))
+			if (MapTileCanSee(map, end))
 			{
 				continue;
 			}
@@ -177,7 +176,7 @@ void LOSCalcFrom(Map *map, const Vec2i pos, const bool explore)
 				&e.u.ExploreTiles, &run, end,
 				*((bool *)CArrayGet(&map->LOS.Explored, end.y * map->Size.x + end.x))))
 			{
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 				e.u.ExploreTiles.Runs_count = 0;
 				e.u.ExploreTiles.Runs[0].Run = 0;
 				run = false;
@@ -186,7 +185,7 @@ void LOSCalcFrom(Map *map, const Vec2i pos, const bool explore)
 	}
 	if (e.u.ExploreTiles.Runs_count > 0)
 	{
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 	CArrayFillZero(&map->LOS.Explored);
 }
@@ -217,11 +216,10 @@ static bool IsNextTileBlockedAndSetVisibility(void *data, Vec2i pos)
 	// Check sight range
 	if (DistanceSquared(lData->Center, pos) >= lData->SightRange2) return true;
 	// Check map range
-	const Tile *t = MapGetTile(lData->Map, pos);
-	if (t == NULL) return true;
+	if (!MapIsTileIn(lData->Map, pos)) return true;
 	SetLOSVisible(lData->Map, pos, lData->Explore);
 	// Check if this tile is an obstruction
-	return t->flags & MAPTILE_NO_SEE;
+	return !MapTileCanSee(lData->Map, pos);
 }
 static bool IsTileVisibleNonObstruction(Map *map, const Vec2i pos);
 static void SetObstructionVisible(
@@ -242,9 +240,8 @@ static void SetObstructionVisible(
 }
 static bool IsTileVisibleNonObstruction(Map *map, const Vec2i pos)
 {
-	const Tile *t = MapGetTile(map, pos);
-	if (t == NULL) return false;
-	return !(t->flags & MAPTILE_NO_SEE) && LOSTileIsVisible(map, pos);
+	if (!MapIsTileIn(map, pos)) return false;
+	return MapTileCanSee(map, pos) && LOSTileIsVisible(map, pos);
 }
 
 bool LOSAddRun(
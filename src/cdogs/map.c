@@ -49,6 +49,7 @@
 #include "map.h"
 
 #include <assert.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 
@@ -59,6 +60,7 @@
 #include "door.h"
 #include "game_events.h"
 #include "gamedata.h"
+#include "log.h"
 #include "los.h"
 #include "map_build.h"
 #include "map_cave.h"
@@ -72,6 +74,7 @@
 #include "actors.h"
 #include "mission.h"
 #include "utils.h"
+#include "visibility_cache.h"
 
 #define KEY_W 9
 #define KEY_H 5
@@ -124,6 +127,80 @@ Tile *MapGetTile(Map *map, Vec2i pos)
 	}
 	return CArrayGet(&map->Tiles, pos.y * map->Size.x + pos.x);
 }
+int MapGetTileFlags(const Map *map, const Vec2i pos)
+{
+	if (pos.x < 0 || pos.x >= map->Size.x || pos.y < 0 || pos.y >= map->Size.y)
+	{
+		return TILE_NONE_FLAGS;
+	}
+	return ((const uint8_t *)map->TileFlags.data)[pos.y * map->Size.x + pos.x];
+}
+void MapSetTileFlags(Map *map, const Vec2i pos, const int flags)
+{
+	CASSERT((flags & ~0xFF) == 0, "tile flags must fit in a byte");
+	*(uint8_t *)CArrayGet(&map->TileFlags, pos.y * map->Size.x + pos.x) =
+		(uint8_t)flags;
+}
+int MapGetTileBlockers(const Map *map, const Vec2i pos)
+{
+	if (!MapIsTileIn(map, pos))
+	{
+		return 0;
+	}
+	return ((const uint8_t *)map->TileBlockers.data)[
+		pos.y * map->Size.x + pos.x];
+}
+static int ThingBlockers(const ThingId *tid);
+void MapUpdateTileBlockers(Map *map, const Vec2i pos)
+{
+	int blockers = 0;
+	const Tile *t = MapGetTile(map, pos);
+	CA_FOREACH(const ThingId, tid, t->things)
+		blockers |= ThingBlockers(tid);
+	CA_FOREACH_END()
+	*(uint8_t *)CArrayGet(&map->TileBlockers, pos.y * map->Size.x + pos.x) =
+		(uint8_t)blockers;
+}
+// Only objects and characters can get in the AI's way; particles, bullets
+// and pickups come and go without touching the blockers
+static bool ThingKindCanBlock(const TileItemKind kind)
+{
+	return kind == KIND_OBJECT || kind == KIND_CHARACTER;
+}
+static int ThingBlockers(const ThingId *tid)
+{
+	int blockers = 0;
+	if (tid->Kind == KIND_OBJECT)
+	{
+		const TObject *o = CArrayGet(&gObjs, tid->Id);
+		if (!TileItemIsDebris(&o->tileItem))
+		{
+			blockers |= TILE_BLOCKER_OBJECT;
+		}
+		if (ObjIsDangerous(o))
+		{
+			blockers |= TILE_BLOCKER_DANGEROUS;
+		}
+	}
+	else if (tid->Kind == KIND_CHARACTER)
+	{
+		blockers |= TILE_BLOCKER_CHARACTER;
+	}
+	return blockers;
+}
+bool MapTileCanSee(const Map *map, const Vec2i pos)
+{
+	return !(MapGetTileFlags(map, pos) & MAPTILE_NO_SEE);
+}
+bool MapTileCanWalk(const Map *map, const Vec2i pos)
+{
+	return !(MapGetTileFlags(map, pos) & MAPTILE_NO_WALK);
+}
+bool MapTileIsClear(Map *map, const Vec2i pos)
+{
+	const Tile *t = MapGetTile(map, pos);
+	return t != NULL && TileIsClear(t, MapGetTileFlags(map, pos));
+}
 
 bool MapIsTileIn(const Map *map, const Vec2i pos)
 {
@@ -150,13 +227,7 @@ bool MapIsTileInExit(const Map *map, const TTileItem *ti)
 		ti->y / TILE_HEIGHT <= map->ExitEnd.y;
 }
 
-static Tile *MapGetTileOfItem(Map *map, TTileItem *t)
-{
-	Vec2i pos = Vec2iToTile(Vec2iNew(t->x, t->y));
-	return MapGetTile(map, pos);
-}
-
-static void AddItemToTile(TTileItem *t, Tile *tile);
+static void AddItemToTile(Map *map, TTileItem *t, const Vec2i pos);
 bool MapTryMoveTileItem(Map *map, TTileItem *t, Vec2i pos)
 {
 	// Check if we can move to new position
@@ -183,17 +254,24 @@ bool MapTryMoveTileItem(Map *map, TTileItem *t, Vec2i pos)
 	// ...move and add to new tile
 	t->x = pos.x;
 	t->y = pos.y;
-	AddItemToTile(t, MapGetTile(map, t2));
+	AddItemToTile(map, t, t2);
 	return true;
 }
-static void AddItemToTile(TTileItem *t, Tile *tile)
+static void AddItemToTile(Map *map, TTileItem *t, const Vec2i pos)
 {
 	ThingId tid;
 	tid.Id = t->id;
 	tid.Kind = t->kind;
 	CASSERT(tid.Id >= 0, "invalid ThingId");
 	CASSERT(tid.Kind >= 0 && tid.Kind <= KIND_PICKUP, "unknown thing kind");
-	CArrayPushBack(&tile->things, &tid);
+	CArrayPushBack(&MapGetTile(map, pos)->things, &tid);
+	if (ThingKindCanBlock(tid.Kind))
+	{
+		// Adding a thing can only add blockers
+		*(uint8_t *)CArrayGet(
+			&map->TileBlockers, pos.y * map->Size.x + pos.x) |=
+			(uint8_t)ThingBlockers(&tid);
+	}
 }
 
 void MapRemoveTileItem(Map *map, TTileItem *t)
@@ -202,11 +280,18 @@ void MapRemoveTileItem(Map *map, TTileItem *t)
 	{
 		return;
 	}
-	Tile *tile = MapGetTileOfItem(map, t);
+	const Vec2i pos = Vec2iToTile(Vec2iNew(t->x, t->y));
+	Tile *tile = MapGetTile(map, pos);
 	CA_FOREACH(ThingId, tid, tile->things)
 		if (tid->Id == t->id && tid->Kind == t->kind)
 		{
 			CArrayDelete(&tile->things, _ca_index);
+			// Other things on the tile may block in the same way, so
+			// rescan them
+			if (ThingKindCanBlock(t->kind))
+			{
+				MapUpdateTileBlockers(map, pos);
+			}
 			return;
 		}
 	CA_FOREACH_END()
@@ -242,10 +327,10 @@ void IMapSet(Map *map, Vec2i pos, unsigned short v)
 void MapChangeFloor(
 	Map *map, const Vec2i pos, NamedPic *normal, NamedPic *shadow)
 {
-	Tile *tAbove = MapGetTile(map, Vec2iNew(pos.x, pos.y - 1));
-	int canSeeTileAbove = !(pos.y > 0 && !TileCanSee(tAbove));
+	int canSeeTileAbove =
+		!(pos.y > 0 && !MapTileCanSee(map, Vec2iNew(pos.x, pos.y - 1)));
 	Tile *t = MapGetTile(map, pos);
-	if (t->flags & MAPTILE_IS_DRAINAGE)
+	if (MapGetTileFlags(map, pos) & MAPTILE_IS_DRAINAGE)
 	{
 		return;
 	}
@@ -316,19 +401,19 @@ static int MapGetNumWallsAdjacentTile(Map *map, Vec2i v)
 	int count = 0;
 	if (v.x > 0 && v.y > 0 && v.x < map->Size.x - 1 && v.y < map->Size.y - 1)
 	{
-		if (!TileCanWalk(MapGetTile(map, Vec2iNew(v.x - 1, v.y))))
+		if (!MapTileCanWalk(map, Vec2iNew(v.x - 1, v.y)))
 		{
 			count++;
 		}
-		if (!TileCanWalk(MapGetTile(map, Vec2iNew(v.x + 1, v.y))))
+		if (!MapTileCanWalk(map, Vec2iNew(v.x + 1, v.y)))
 		{
 			count++;
 		}
-		if (!TileCanWalk(MapGetTile(map, Vec2iNew(v.x, v.y - 1))))
+		if (!MapTileCanWalk(map, Vec2iNew(v.x, v.y - 1)))
 		{
 			count++;
 		}
-		if (!TileCanWalk(MapGetTile(map, Vec2iNew(v.x, v.y + 1))))
+		if (!MapTileCanWalk(map, Vec2iNew(v.x, v.y + 1)))
 		{
 			count++;
 		}
@@ -343,19 +428,19 @@ static int MapGetNumWallsAroundTile(Map *map, Vec2i v)
 	if (v.x > 0 && v.y > 0 && v.x < map->Size.x - 1 && v.y < map->Size.y - 1)
 	{
 		// Having checked the adjacencies, check the diagonals
-		if (!TileCanWalk(MapGetTile(map, Vec2iNew(v.x - 1, v.y - 1))))
+		if (!MapTileCanWalk(map, Vec2iNew(v.x - 1, v.y - 1)))
 		{
 			count++;
 		}
-		if (!TileCanWalk(MapGetTile(map, Vec2iNew(v.x + 1, v.y + 1))))
+		if (!MapTileCanWalk(map, Vec2iNew(v.x + 1, v.y + 1)))
 		{
 			count++;
 		}
-		if (!TileCanWalk(MapGetTile(map, Vec2iNew(v.x + 1, v.y - 1))))
+		if (!MapTileCanWalk(map, Vec2iNew(v.x + 1, v.y - 1)))
 		{
 			count++;
 		}
-		if (!TileCanWalk(MapGetTile(map, Vec2iNew(v.x - 1, v.y + 1))))
+		if (!MapTileCanWalk(map, Vec2iNew(v.x - 1, v.y + 1)))
 		{
 			count++;
 		}
@@ -376,10 +461,9 @@ bool MapTryPlaceOneObject(
 	}
 	Vec2i realPos = Vec2iCenterOfTile(v);
 	int tileFlags = 0;
-	Tile *t = MapGetTile(map, v);
 	unsigned short iMap = IMapGet(map, v);
 
-	const bool isEmpty = TileIsClear(t);
+	const bool isEmpty = MapTileIsClear(map, v);
 	if (isStrictMode && !MapObjectIsTileOKStrict(
 			mo, iMap, isEmpty,
 			IMapGet(map, Vec2iNew(v.x, v.y - 1)),
@@ -419,7 +503,7 @@ bool MapTryPlaceOneObject(
 
 	NMapObjectAdd amo = NMapObjectAdd_init_default;
 	amo.UID = ObjsGetNextUID();
-	strcpy(amo.MapObjectClass, mo->Name);
+	amo.MapObjectId = MapObjectIndex(mo);
 	amo.Pos = Vec2i2Net(realPos);
 	amo.TileItemFlags = tileFlags | extraFlags;
 	amo.Health = mo->Health;
@@ -429,16 +513,16 @@ bool MapTryPlaceOneObject(
 
 void MapPlaceWreck(Map *map, const Vec2i v, const MapObject *mo)
 {
-	Tile *t = MapGetTile(map, v);
 	unsigned short iMap = IMapGet(map, v);
 	if (!MapObjectIsTileOK(
-		mo, iMap, TileIsClear(t), IMapGet(map, Vec2iNew(v.x, v.y - 1))))
+		mo, iMap, MapTileIsClear(map, v),
+		IMapGet(map, Vec2iNew(v.x, v.y - 1))))
 	{
 		return;
 	}
 	NMapObjectAdd amo = NMapObjectAdd_init_default;
 	amo.UID = ObjsGetNextUID();
-	strcpy(amo.MapObjectClass, mo->Name);
+	amo.MapObjectId = MapObjectIndex(mo);
 	amo.Pos = Vec2i2Net(Vec2iCenterOfTile(v));
 	amo.TileItemFlags = TILEITEM_IS_WRECK;
 	// Set health to 0 to force into a wreck
@@ -463,12 +547,12 @@ void MapPlaceCollectible(
 	const Objective *o = CArrayGet(&mo->missionData->Objectives, objective);
 	GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
 	e.u.AddPickup.UID = PickupsGetNextUID();
-	strcpy(e.u.AddPickup.PickupClass, o->u.Pickup->Name);
+	e.u.AddPickup.PickupClassId = PickupClassId(o->u.Pickup);
 	e.u.AddPickup.IsRandomSpawned = false;
 	e.u.AddPickup.SpawnerUID = -1;
 	e.u.AddPickup.TileItemFlags = ObjectiveToTileItem(objective);
 	e.u.AddPickup.Pos = Vec2i2Net(realPos);
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 }
 static int MapTryPlaceCollectible(
 	Map *map, const Mission *mission, const struct MissionOptions *mo,
@@ -547,14 +631,13 @@ void MapPlaceKey(
 	UNUSED(map);
 	GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
 	e.u.AddPickup.UID = PickupsGetNextUID();
-	strcpy(
-		e.u.AddPickup.PickupClass,
-		KeyPickupClass(mo->missionData->KeyStyle, keyIndex)->Name);
+	e.u.AddPickup.PickupClassId =
+		PickupClassId(KeyPickupClass(mo->missionData->KeyStyle, keyIndex));
 	e.u.AddPickup.IsRandomSpawned = false;
 	e.u.AddPickup.SpawnerUID = -1;
 	e.u.AddPickup.TileItemFlags = 0;
 	e.u.AddPickup.Pos = Vec2i2Net(Vec2iCenterOfTile(pos));
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 }
 
 static void MapPlaceCard(Map *map, int keyIndex, int map_access)
@@ -562,16 +645,12 @@ static void MapPlaceCard(Map *map, int keyIndex, int map_access)
 	for (;;)
 	{
 		Vec2i v = GuessCoords(map);
-		Tile *t;
-		Tile *tBelow;
 		unsigned short iMap;
-		t = MapGetTile(map, v);
 		iMap = IMapGet(map, v);
-		tBelow = MapGetTile(map, Vec2iNew(v.x, v.y + 1));
-		if (TileIsClear(t) &&
+		if (MapTileIsClear(map, v) &&
 			(iMap & 0xF00) == map_access &&
 			(iMap & MAP_MASKACCESS) == MAP_ROOM &&
-			TileIsClear(tBelow))
+			MapTileIsClear(map, Vec2iNew(v.x, v.y + 1)))
 		{
 			MapPlaceKey(map, &gMission, v, keyIndex);
 			return;
@@ -643,12 +722,16 @@ static void MapSetupDoors(Map *map, const Mission *m)
 	}
 }
 
-void MapTerminate(Map *map)
+static void MapFree(Map *map)
 {
 	CA_FOREACH(Trigger *, t, map->triggers)
 		TriggerTerminate(*t);
 	CA_FOREACH_END()
 	CArrayTerminate(&map->triggers);
+	CA_FOREACH(TWatch, w, map->watches)
+		WatchTerminate(w);
+	CA_FOREACH_END()
+	CArrayTerminate(&map->watches);
 	Vec2i v;
 	for (v.y = 0; v.y < map->Size.y; v.y++)
 	{
@@ -658,25 +741,50 @@ void MapTerminate(Map *map)
 			TileDestroy(t);
 		}
 	}
+	CArrayTerminate(&map->TileFlags);
+	CArrayTerminate(&map->TileBlockers);
 	CArrayTerminate(&map->Tiles);
 	CArrayTerminate(&map->iMap);
 	LOSTerminate(&map->LOS);
+	memset(map, 0, sizeof *map);
+}
+void MapTerminate(Map *map)
+{
+	MapFree(map);
 	PathCacheTerminate(&gPathCache);
+	VisibilityCacheTerminate(&gVisibilityCache);
 }
+static void MapBuild(
+	Map *map, const struct MissionOptions *mo, const CampaignOptions *co,
+	const unsigned int seed);
 void MapLoad(
-	Map *map, const struct MissionOptions *mo, const CampaignOptions *co)
+	Map *map, const struct MissionOptions *mo, const CampaignOptions *co,
+	const unsigned int seed)
 {
 	MapTerminate(map);
-
+	MapBuild(map, mo, co, seed);
+	PathCacheInit(&gPathCache, map);
+	VisibilityCacheInit(&gVisibilityCache, map);
+}
+// Build the map for a mission into an uninitialised map.
+// Only uses the map's own random sequence and reads the pic manager, so this
+// can run off the main thread once the map's pics have been generated.
+static void MapBuild(
+	Map *map, const struct MissionOptions *mo, const CampaignOptions *co,
+	const unsigned int seed)
+{
 	// Init map
 	memset(map, 0, sizeof *map);
+	map->buildSeed = seed;
+	CArrayInit(&map->TileFlags, sizeof(uint8_t));
+	CArrayInit(&map->TileBlockers, sizeof(uint8_t));
 	CArrayInit(&map->Tiles, sizeof(Tile));
 	CArrayInit(&map->iMap, sizeof(unsigned short));
 	const Mission *mission = mo->missionData;
 	map->Size = mission->Size;
 	LOSInit(map, map->Size);
 	CArrayInit(&map->triggers, sizeof(Trigger *));
-	PathCacheInit(&gPathCache, map);
+	CArrayInit(&map->watches, sizeof(TWatch));
 
 	Vec2i v;
 	for (v.y = 0; v.y < map->Size.y; v.y++)
@@ -685,7 +793,11 @@ void MapLoad(
 		{
 			Tile t;
 			unsigned short tI = MAP_FLOOR;
+			const uint8_t flags = 0;
+			const uint8_t blockers = 0;
 			TileInit(&t);
+			CArrayPushBack(&map->TileFlags, &flags);
+			CArrayPushBack(&map->TileBlockers, &blockers);
 			CArrayPushBack(&map->Tiles, &t);
 			CArrayPushBack(&map->iMap, &tI);
 		}
@@ -722,7 +834,7 @@ void MapLoad(
 	{
 		for (v.x = 0; v.x < map->Size.x; v.x++)
 		{
-			if (!(MapGetTile(map, v)->flags & MAPTILE_NO_WALK))
+			if (MapTileCanWalk(map, v))
 			{
 				map->NumExplorableTiles++;
 			}
@@ -730,6 +842,69 @@ void MapLoad(
 	}
 }
 
+MapPreload gMapPreload;
+
+static int MapPreloadRun(void *data);
+void MapPreloadStart(
+	MapPreload *p, const struct MissionOptions *mo, const CampaignOptions *co,
+	const unsigned int seed)
+{
+	MapPreloadCancel(p);
+	// Adding pics isn't thread safe, so do it before starting
+	MapGenerateTilePics(mo->missionData);
+	p->mo = mo;
+	p->co = co;
+	p->mission = mo->missionData;
+	p->seed = seed;
+	p->thread = SDL_CreateThread(MapPreloadRun, "mapPreload", p);
+	if (p->thread == NULL)
+	{
+		LOG(LM_MAP, LL_ERROR, "cannot start map preload: %s",
+			SDL_GetError());
+	}
+}
+static int MapPreloadRun(void *data)
+{
+	MapPreload *p = data;
+	const Uint32 ticksStart = SDL_GetTicks();
+	MapBuild(&p->map, p->mo, p->co, p->seed);
+	LOG(LM_MAP, LL_DEBUG, "preloaded map in %ums",
+		(unsigned)(SDL_GetTicks() - ticksStart));
+	return 0;
+}
+bool MapPreloadTake(
+	MapPreload *p, Map *map, const struct MissionOptions *mo,
+	const unsigned int seed)
+{
+	if (p->thread == NULL)
+	{
+		return false;
+	}
+	if (p->mission != mo->missionData || p->seed != seed)
+	{
+		MapPreloadCancel(p);
+		return false;
+	}
+	SDL_WaitThread(p->thread, NULL);
+	p->thread = NULL;
+	MapTerminate(map);
+	*map = p->map;
+	memset(&p->map, 0, sizeof p->map);
+	PathCacheInit(&gPathCache, map);
+	VisibilityCacheInit(&gVisibilityCache, map);
+	return true;
+}
+void MapPreloadCancel(MapPreload *p)
+{
+	if (p->thread == NULL)
+	{
+		return;
+	}
+	SDL_WaitThread(p->thread, NULL);
+	p->thread = NULL;
+	MapFree(&p->map);
+}
+
 static void AddObjectives(Map *map, const struct MissionOptions *mo);
 static void AddKeys(Map *map);
 void MapLoadDynamic(
@@ -892,7 +1067,7 @@ bool MapIsTileAreaClear(Map *map, const Vec2i fullPos, const Vec2i size)
 void MapMarkAsVisited(Map *map, Vec2i pos)
 {
 	Tile *t = MapGetTile(map, pos);
-	if (!t->isVisited && !(t->flags & MAPTILE_NO_WALK))
+	if (!t->isVisited && MapTileCanWalk(map, pos))
 	{
 		map->tilesSeen++;
 	}
@@ -960,7 +1135,7 @@ Vec2i MapSearchTileAround(Map *map, Vec2i start, TileSelectFunc func)
 bool MapTileIsUnexplored(Map *map, Vec2i tile)
 {
 	const Tile *t = MapGetTile(map, tile);
-	return !t->isVisited && !(t->flags & MAPTILE_NO_WALK);
+	return !t->isVisited && MapTileCanWalk(map, tile);
 }
 
 // Only creates the trigger, but does not place it
@@ -971,3 +1146,10 @@ Trigger *MapNewTrigger(Map *map)
 	t->id = map->triggerId++;
 	return t;
 }
+TWatch *MapNewWatch(Map *map)
+{
+	TWatch w;
+	WatchInit(&w, ++map->watchIndex);
+	CArrayPushBack(&map->watches, &w);
+	return CArrayGet(&map->watches, map->watches.size - 1);
+}
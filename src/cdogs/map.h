@@ -50,6 +50,8 @@
 
 #include <stdbool.h>
 
+#include <SDL_thread.h>
+
 #include "campaigns.h"
 #include "map_object.h"
 #include "mission.h"
@@ -91,8 +93,27 @@ typedef struct
 	CArray Explored; // of bool
 } LineOfSight;
 
+// Things on a tile that can stop the AI walking over it
+typedef enum
+{
+	TILE_BLOCKER_OBJECT = 1,	// an object that isn't debris
+	TILE_BLOCKER_DANGEROUS = 2,	// an object that can explode, even debris
+	TILE_BLOCKER_CHARACTER = 4
+} TileBlocker;
+
 typedef struct
 {
+	// Walking, shooting and seeing only need the flags, so those are
+	// packed into a byte per tile, indexed by y * Size.x + x.
+	// For the largest (256x256) maps that is 64 KB, against 5.5 MB of Tiles.
+	// Only the flags (and blockers below) are split out; pics, things and
+	// triggers are still in Tiles, so drawing and moving things touch a
+	// whole Tile each.
+	CArray TileFlags;	// of uint8_t; MapTileFlags
+	// Summary of each tile's things, kept up to date as things are added,
+	// moved, removed or wrecked, so that the AI's path finding doesn't
+	// need to look through them
+	CArray TileBlockers;	// of uint8_t; TileBlocker
 	CArray Tiles;	// of Tile
 	Vec2i Size;
 
@@ -103,6 +124,10 @@ typedef struct
 
 	CArray triggers;	// of Trigger *; owner
 	int triggerId;
+	// Watches belong to the map so that a map built in the background
+	// doesn't touch the current one's
+	CArray watches;	// of TWatch
+	int watchIndex;
 
 	int tilesSeen;
 	int keyAccessCount;
@@ -111,6 +136,10 @@ typedef struct
 	Vec2i ExitEnd;
 
 	int NumExplorableTiles;
+
+	// Random sequence for building the map, separate from rand() so that
+	// maps can be built in the background; see RandNext
+	unsigned int buildSeed;
 } Map;
 
 extern Map gMap;
@@ -118,6 +147,17 @@ extern Map gMap;
 unsigned short GetAccessMask(int k);
 
 Tile *MapGetTile(Map *map, Vec2i pos);
+// Get the tile's MapTileFlags, or TILE_NONE_FLAGS if outside the map
+int MapGetTileFlags(const Map *map, const Vec2i pos);
+void MapSetTileFlags(Map *map, const Vec2i pos, const int flags);
+// Get the tile's TileBlockers, or 0 if outside the map
+int MapGetTileBlockers(const Map *map, const Vec2i pos);
+// Recalculate a tile's TileBlockers from its things; needed when a thing
+// that is already on the tile changes
+void MapUpdateTileBlockers(Map *map, const Vec2i pos);
+bool MapTileCanSee(const Map *map, const Vec2i pos);
+bool MapTileCanWalk(const Map *map, const Vec2i pos);
+bool MapTileIsClear(Map *map, const Vec2i pos);
 bool MapIsTileIn(const Map *map, const Vec2i pos);
 bool MapIsRealPosIn(const Map *map, const Vec2i realPos);
 bool MapIsTileInExit(const Map *map, const TTileItem *ti);
@@ -131,8 +171,39 @@ bool MapTryMoveTileItem(Map *map, TTileItem *t, Vec2i pos);
 void MapRemoveTileItem(Map *map, TTileItem *t);
 
 void MapTerminate(Map *map);
+// Build the map for a mission; seed starts the map's own random sequence,
+// so the same seed always builds the same map
 void MapLoad(
-	Map *map, const struct MissionOptions *mo, const CampaignOptions* co);
+	Map *map, const struct MissionOptions *mo, const CampaignOptions* co,
+	const unsigned int seed);
+
+// Build the next mission's map on a background thread while the menus
+// before the mission are shown, so the mission can start straight away.
+// The mission and campaign must not change until the map is taken or
+// cancelled.
+typedef struct
+{
+	Map map;
+	const struct MissionOptions *mo;
+	const CampaignOptions *co;
+	const Mission *mission;
+	unsigned int seed;
+	SDL_Thread *thread;
+} MapPreload;
+extern MapPreload gMapPreload;
+
+void MapPreloadStart(
+	MapPreload *p, const struct MissionOptions *mo, const CampaignOptions *co,
+	const unsigned int seed);
+// Wait for the preloaded map and swap it into map.
+// Returns false if nothing was preloaded for this mission and seed,
+// in which case the map should be loaded as usual.
+bool MapPreloadTake(
+	MapPreload *p, Map *map, const struct MissionOptions *mo,
+	const unsigned int seed);
+// Wait for and discard any preloaded map
+void MapPreloadCancel(MapPreload *p);
+
 void MapLoadDynamic(
 	Map *map, const struct MissionOptions *mo, const CharacterStore *store);
 bool MapIsFullPosOKforPlayer(
@@ -170,3 +241,4 @@ void MapPlaceKey(
 	const int keyIndex);
 
 Trigger *MapNewTrigger(Map *map);
+TWatch *MapNewWatch(Map *map);
@@ -42,6 +42,8 @@
 static char *ReadFileIntoBuf(const char *path, const char *mode, long *len);
 
 static json_t *ReadArchiveJSON(const char *archive, const char *filename);
+static bool LoadCompiledMissions(
+	CArray *missions, const char *archive, const int version);
 int MapNewScanArchive(
 	const char *filename, char **title, int *numMissions)
 {
@@ -92,11 +94,9 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 
 	LoadArchivePics(&gPicManager, filename, "graphics");
 
-	root = ReadArchiveJSON(filename, "particles.json");
-	if (root != NULL)
-	{
-		ParticleClassesLoadJSON(&gParticleClasses.CustomClasses, root);
-	}
+	char path[CDOGS_PATH_MAX];
+	sprintf(path, "%s/particles.json", filename);
+	ParticleClassesLoadFile(&gParticleClasses.CustomClasses, path);
 
 	root = ReadArchiveJSON(filename, "character_classes.json");
 	if (root != NULL)
@@ -105,12 +105,8 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 			&gCharacterClasses.CustomClasses, root);
 	}
 
-	root = ReadArchiveJSON(filename, "bullets.json");
-	if (root != NULL)
-	{
-		BulletLoadJSON(
-			&gBulletClasses, &gBulletClasses.CustomClasses, root);
-	}
+	sprintf(path, "%s/bullets.json", filename);
+	BulletLoadFile(&gBulletClasses, &gBulletClasses.CustomClasses, path);
 
 	root = ReadArchiveJSON(filename, "ammo.json");
 	if (root != NULL)
@@ -119,13 +115,8 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 		json_free_value(&root);
 	}
 
-	root = ReadArchiveJSON(filename, "guns.json");
-	if (root != NULL)
-	{
-		WeaponLoadJSON(
-			&gGunDescriptions, &gGunDescriptions.CustomGuns, root);
-		json_free_value(&root);
-	}
+	sprintf(path, "%s/guns.json", filename);
+	WeaponLoadFile(&gGunDescriptions, &gGunDescriptions.CustomGuns, path);
 
 	BulletLoadWeapons(&gBulletClasses);
 
@@ -141,24 +132,27 @@ int MapNewLoadArchive(const char *filename, CampaignSetting *c)
 
 	// Reset custom map objects
 	MapObjectsClear(&gMapObjects.CustomClasses);
-	root = ReadArchiveJSON(filename, "map_objects.json");
-	if (root != NULL)
-	{
-		MapObjectsLoadJSON(&gMapObjects.CustomClasses, root);
-	}
+	sprintf(path, "%s/map_objects.json", filename);
+	MapObjectsLoadFile(&gMapObjects.CustomClasses, path);
 	MapObjectsLoadAmmoAndGunSpawners(
 		&gMapObjects, &gAmmo, &gGunDescriptions, true);
 
 
-	root = ReadArchiveJSON(filename, "missions.json");
-	if (root == NULL)
+	// Use precompiled missions if they're up to date, so that missions.json
+	// and its tiles don't need parsing
+	if (!LoadCompiledMissions(&c->Missions, filename, version))
 	{
-		err = -1;
-		goto bail;
+		root = ReadArchiveJSON(filename, "missions.json");
+		if (root == NULL)
+		{
+			err = -1;
+			goto bail;
+		}
+		LoadMissions(
+			&c->Missions, json_find_first_label(root, "Missions")->child,
+			version, NULL);
+		json_free_value(&root);
 	}
-	LoadMissions(
-		&c->Missions, json_find_first_label(root, "Missions")->child, version);
-	json_free_value(&root);
 
 	// Note: some campaigns don't have characters (e.g. dogfights)
 	root = ReadArchiveJSON(filename, "characters.json");
@@ -172,6 +166,41 @@ bail:
 	return err;
 }
 
+static bool LoadCompiledMissions(
+	CArray *missions, const char *archive, const int version)
+{
+	MapCompiled compiled;
+	if (!MapCompiledOpen(&compiled, archive))
+	{
+		return false;
+	}
+	bool ok = false;
+	json_t *root = NULL;
+	if (json_parse_document(&root, compiled.missionsJSON) != JSON_OK)
+	{
+		LOG(LM_MAP, LL_WARN, "invalid compiled missions in %s", archive);
+		root = NULL;
+		goto bail;
+	}
+	ok = LoadMissions(
+		missions, json_find_first_label(root, "Missions")->child, version,
+		&compiled);
+	if (!ok)
+	{
+		LOG(LM_MAP, LL_WARN,
+			"compiled missions in %s don't match their tiles", archive);
+		CA_FOREACH(Mission, m, *missions)
+			MissionTerminate(m);
+		CA_FOREACH_END()
+		CArrayClear(missions);
+	}
+
+bail:
+	json_free_value(&root);
+	MapCompiledClose(&compiled);
+	return ok;
+}
+
 static json_t *ReadArchiveJSON(const char *archive, const char *filename)
 {
 	json_t *root = NULL;
@@ -216,19 +245,21 @@ static void LoadArchiveSounds(
 		long len;
 		buf = ReadFileIntoBuf(file.path, "rb", &len);
 		if (buf == NULL) goto nextFile;
+		char nameBuf[CDOGS_FILENAME_MAX];
+		strcpy(nameBuf, file.name);
+		// Remove extension
+		char *dot = strrchr(nameBuf, '.');
+		if (dot != NULL)
+		{
+			*dot = '\0';
+		}
+		// Named even if it can't be played, so sound IDs stay the same
+		SoundAddName(&device->customSoundNames, nameBuf);
 		SDL_RWops *rwops = SDL_RWFromMem(buf, len);
 		Mix_Chunk *data = Mix_LoadWAV_RW(rwops, 0);
 		if (data != NULL)
 		{
-			char nameBuf[CDOGS_FILENAME_MAX];
-			strcpy(nameBuf, file.name);
-			// Remove extension
-			char *dot = strrchr(nameBuf, '.');
-			if (dot != NULL)
-			{
-				*dot = '\0';
-			}
-			SoundAdd(&device->customSounds, nameBuf, data);
+			SoundAdd(device->customSounds, nameBuf, data);
 		}
 		rwops->close(rwops);
 	nextFile:
@@ -304,7 +335,7 @@ end:
 }
 
 
-static json_t *SaveMissions(CArray *a);
+static json_t *SaveMissions(CArray *a, const bool withTiles);
 int MapArchiveSave(const char *filename, CampaignSetting *c)
 {
 	int res = 1;
@@ -342,13 +373,23 @@ int MapArchiveSave(const char *filename, CampaignSetting *c)
 
 	json_free_value(&root);
 	root = json_new_object();
-	json_insert_pair_into_object(root, "Missions", SaveMissions(&c->Missions));
+	json_insert_pair_into_object(
+		root, "Missions", SaveMissions(&c->Missions, true));
 	sprintf(buf2, "%s/missions.json", buf);
 	if (!TrySaveJSONFile(root, buf2))
 	{
 		res = 0;
 		goto bail;
 	}
+	// Not fatal; the JSON will be loaded instead
+	json_free_value(&root);
+	root = json_new_object();
+	json_insert_pair_into_object(
+		root, "Missions", SaveMissions(&c->Missions, false));
+	char *missionsJSON;
+	json_tree_to_string(root, &missionsJSON);
+	MapCompiledSave(buf, &c->Missions, missionsJSON);
+	CFREE(missionsJSON);
 
 	if (!CharacterSave(&c->characters, buf))
 	{
@@ -374,7 +415,7 @@ static json_t *SaveStaticWrecks(Mission *m);
 static json_t *SaveStaticCharacters(Mission *m);
 static json_t *SaveStaticObjectives(Mission *m);
 static json_t *SaveStaticKeys(Mission *m);
-static json_t *SaveMissions(CArray *a)
+static json_t *SaveMissions(CArray *a, const bool withTiles)
 {
 	json_t *missionsNode = json_new_array();
 	for (int i = 0; i < (int)a->size; i++)
@@ -441,8 +482,11 @@ static json_t *SaveMissions(CArray *a)
 			break;
 		case MAPTYPE_STATIC:
 			{
-				json_insert_pair_into_object(
-					node, "Tiles", SaveStaticTiles(mission));
+				if (withTiles)
+				{
+					json_insert_pair_into_object(
+						node, "Tiles", SaveStaticTiles(mission));
+				}
 				json_insert_pair_into_object(
 					node, "StaticItems", SaveStaticItems(mission));
 				json_insert_pair_into_object(
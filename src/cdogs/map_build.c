@@ -71,9 +71,8 @@ void MapSetTile(Map *map, Vec2i pos, unsigned short tileType, Mission *m)
 	MapSetupTile(map, Vec2iNew(pos.x, pos.y + 1), m);
 }
 
-void MapSetupTilesAndWalls(Map *map, const Mission *m)
+void MapGenerateTilePics(const Mission *m)
 {
-	// Pre-load the tile pics that this map will use
 	// TODO: multiple styles and colours
 	// Walls
 	for (int i = 0; i < WALL_TYPE_COUNT; i++)
@@ -96,6 +95,18 @@ void MapSetupTilesAndWalls(Map *map, const Mission *m)
 			&gPicManager, "tile", m->RoomStyle, IntTileType(i),
 			m->RoomMask, m->AltMask);
 	}
+}
+
+static void SetAlternateFloor(Map *map, const Vec2i pos, NamedPic *p)
+{
+	MapGetTile(map, pos)->pic = p;
+	MapSetTileFlags(
+		map, pos, MapGetTileFlags(map, pos) & ~MAPTILE_IS_NORMAL_FLOOR);
+}
+void MapSetupTilesAndWalls(Map *map, const Mission *m)
+{
+	// Pre-load the tile pics that this map will use
+	MapGenerateTilePics(m);
 
 	Vec2i v;
 	for (v.x = 0; v.x < map->Size.x; v.x++)
@@ -110,35 +121,39 @@ void MapSetupTilesAndWalls(Map *map, const Mission *m)
 	for (int i = 0; i < map->Size.x*map->Size.y / 45; i++)
 	{
 		// Make sure drain tiles aren't next to each other
-		Tile *t = MapGetTile(map, Vec2iNew(
-			(rand() % map->Size.x) & 0xFFFFFE,
-			(rand() % map->Size.y) & 0xFFFFFE));
-		if (TileIsNormalFloor(t))
+		const Vec2i pos = Vec2iNew(
+			(RandNext(&map->buildSeed) % map->Size.x) & 0xFFFFFE,
+			(RandNext(&map->buildSeed) % map->Size.y) & 0xFFFFFE);
+		if (MapGetTileFlags(map, pos) & MAPTILE_IS_NORMAL_FLOOR)
 		{
-			TileSetAlternateFloor(t, PicManagerGetRandomDrain(&gPicManager));
-			t->flags |= MAPTILE_IS_DRAINAGE;
+			SetAlternateFloor(map, pos, PicManagerGetRandomDrain(
+				&gPicManager, &map->buildSeed));
+			MapSetTileFlags(
+				map, pos, MapGetTileFlags(map, pos) | MAPTILE_IS_DRAINAGE);
 		}
 	}
 
 	// Randomly change normal floor tiles to alternative floor tiles
 	for (int i = 0; i < map->Size.x*map->Size.y / 22; i++)
 	{
-		Tile *t = MapGetTile(
-			map, Vec2iNew(rand() % map->Size.x, rand() % map->Size.y));
-		if (TileIsNormalFloor(t))
+		const Vec2i pos = Vec2iNew(
+			RandNext(&map->buildSeed) % map->Size.x,
+			RandNext(&map->buildSeed) % map->Size.y);
+		if (MapGetTileFlags(map, pos) & MAPTILE_IS_NORMAL_FLOOR)
 		{
-			TileSetAlternateFloor(t, PicManagerGetMaskedStylePic(
+			SetAlternateFloor(map, pos, PicManagerGetMaskedStylePic(
 				&gPicManager, "tile", m->FloorStyle, "alt1",
 				m->FloorMask, m->AltMask));
 		}
 	}
 	for (int i = 0; i < map->Size.x*map->Size.y / 16; i++)
 	{
-		Tile *t = MapGetTile(
-			map, Vec2iNew(rand() % map->Size.x, rand() % map->Size.y));
-		if (TileIsNormalFloor(t))
+		const Vec2i pos = Vec2iNew(
+			RandNext(&map->buildSeed) % map->Size.x,
+			RandNext(&map->buildSeed) % map->Size.y);
+		if (MapGetTileFlags(map, pos) & MAPTILE_IS_NORMAL_FLOOR)
 		{
-			TileSetAlternateFloor(t, PicManagerGetMaskedStylePic(
+			SetAlternateFloor(map, pos, PicManagerGetMaskedStylePic(
 				&gPicManager, "tile", m->FloorStyle, "alt2",
 				m->FloorMask, m->AltMask));
 		}
@@ -148,8 +163,7 @@ static const char *MapGetWallPic(const Map *m, const Vec2i pos);
 // Set tile properties for a map tile, such as picture to use
 static void MapSetupTile(Map *map, const Vec2i pos, const Mission *m)
 {
-	Tile *tAbove = MapGetTile(map, Vec2iNew(pos.x, pos.y - 1));
-	bool canSeeTileAbove = !(tAbove != NULL && !TileCanSee(tAbove));
+	bool canSeeTileAbove = MapTileCanSee(map, Vec2iNew(pos.x, pos.y - 1));
 	Tile *t = MapGetTile(map, pos);
 	if (!t)
 	{
@@ -167,7 +181,9 @@ static void MapSetupTile(Map *map, const Vec2i pos, const Mission *m)
 		{
 			// Normal floor tiles can be replaced randomly with
 			// special floor tiles such as drainage
-			t->flags |= MAPTILE_IS_NORMAL_FLOOR;
+			MapSetTileFlags(
+				map, pos,
+				MapGetTileFlags(map, pos) | MAPTILE_IS_NORMAL_FLOOR);
 		}
 		break;
 
@@ -183,15 +199,15 @@ static void MapSetupTile(Map *map, const Vec2i pos, const Mission *m)
 		t->pic = PicManagerGetMaskedStylePic(
 			&gPicManager, "wall", m->WallStyle, MapGetWallPic(map, pos),
 			m->WallMask, m->AltMask);
-		t->flags =
+		MapSetTileFlags(
+			map, pos,
 			MAPTILE_NO_WALK | MAPTILE_NO_SHOOT |
-			MAPTILE_NO_SEE | MAPTILE_IS_WALL;
+			MAPTILE_NO_SEE | MAPTILE_IS_WALL);
 		break;
 
 	case MAP_NOTHING:
 		t->pic = NULL;
-		t->flags =
-			MAPTILE_NO_WALK | MAPTILE_IS_NOTHING;
+		MapSetTileFlags(map, pos, MAPTILE_NO_WALK | MAPTILE_IS_NOTHING);
 		break;
 	}
 }
@@ -360,7 +376,9 @@ void MapPlaceDoors(
 	if (doors[0])
 	{
 		int doorSize = MIN(
-			(doorMax > doorMin ? (rand() % (doorMax - doorMin + 1)) : 0) + doorMin,
+			(doorMax > doorMin ?
+				(RandNext(&map->buildSeed) % (doorMax - doorMin + 1)) : 0) +
+				doorMin,
 			size.y - 4);
 		for (i = -doorSize / 2; i < (doorSize + 1) / 2; i++)
 		{
@@ -374,7 +392,9 @@ void MapPlaceDoors(
 	if (doors[1])
 	{
 		int doorSize = MIN(
-			(doorMax > doorMin ? (rand() % (doorMax - doorMin + 1)) : 0) + doorMin,
+			(doorMax > doorMin ?
+				(RandNext(&map->buildSeed) % (doorMax - doorMin + 1)) : 0) +
+				doorMin,
 			size.y - 4);
 		for (i = -doorSize / 2; i < (doorSize + 1) / 2; i++)
 		{
@@ -388,7 +408,9 @@ void MapPlaceDoors(
 	if (doors[2])
 	{
 		int doorSize = MIN(
-			(doorMax > doorMin ? (rand() % (doorMax - doorMin + 1)) : 0) + doorMin,
+			(doorMax > doorMin ?
+				(RandNext(&map->buildSeed) % (doorMax - doorMin + 1)) : 0) +
+				doorMin,
 			size.x - 4);
 		for (i = -doorSize / 2; i < (doorSize + 1) / 2; i++)
 		{
@@ -402,7 +424,9 @@ void MapPlaceDoors(
 	if (doors[3])
 	{
 		int doorSize = MIN(
-			(doorMax > doorMin ? (rand() % (doorMax - doorMin + 1)) : 0) + doorMin,
+			(doorMax > doorMin ?
+				(RandNext(&map->buildSeed) % (doorMax - doorMin + 1)) : 0) +
+				doorMin,
 			size.x - 4);
 		for (i = -doorSize / 2; i < (doorSize + 1) / 2; i++)
 		{
@@ -756,10 +780,10 @@ void MapMakePillar(Map *map, Vec2i pos, Vec2i size)
 	}
 }
 
-unsigned short GenerateAccessMask(int *accessLevel)
+unsigned short GenerateAccessMask(int *accessLevel, unsigned int *seed)
 {
 	unsigned short accessMask = 0;
-	switch (rand() % 20)
+	switch (RandNext(seed) % 20)
 	{
 	case 0:
 		if (*accessLevel >= 4)
@@ -810,17 +834,19 @@ unsigned short GenerateAccessMask(int *accessLevel)
 
 void MapGenerateRandomExitArea(Map *map)
 {
-	const Tile *t = NULL;
-	for (int i = 0; i < 10000 && (t == NULL ||!TileCanWalk(t)); i++)
+	bool canWalk = false;
+	for (int i = 0; i < 10000 && !canWalk; i++)
 	{
-		map->ExitStart.x = (rand() % (abs(map->Size.x) - EXIT_WIDTH - 1));
+		map->ExitStart.x = (RandNext(&map->buildSeed) %
+			(abs(map->Size.x) - EXIT_WIDTH - 1));
 		map->ExitEnd.x = map->ExitStart.x + EXIT_WIDTH + 1;
-		map->ExitStart.y = (rand() % (abs(map->Size.y) - EXIT_HEIGHT - 1));
+		map->ExitStart.y = (RandNext(&map->buildSeed) %
+			(abs(map->Size.y) - EXIT_HEIGHT - 1));
 		map->ExitEnd.y = map->ExitStart.y + EXIT_HEIGHT + 1;
 		// Check that the exit area is walkable
 		const Vec2i center = Vec2iNew(
 			(map->ExitStart.x + map->ExitEnd.x) / 2,
 			(map->ExitStart.y + map->ExitEnd.y) / 2);
-		t = MapGetTile(map, center);
+		canWalk = MapTileCanWalk(map, center);
 	}
 }
@@ -68,7 +68,11 @@ void MapMakePillar(Map *map, Vec2i pos, Vec2i size);
 void MapMakeWall(Map *map, Vec2i pos);
 void MapSetTile(Map *map, Vec2i pos, unsigned short tileType, Mission *m);
 
+// Generate the coloured wall and floor pics that a mission's map uses.
+// This adds to the pic manager so must not run alongside other threads
+// that use pics.
+void MapGenerateTilePics(const Mission *m);
 void MapSetupTilesAndWalls(Map *map, const Mission *m);
 
-unsigned short GenerateAccessMask(int *accessLevel);
+unsigned short GenerateAccessMask(int *accessLevel, unsigned int *seed);
 void MapGenerateRandomExitArea(Map *map);
@@ -30,7 +30,7 @@
 #include "algorithms.h"
 
 
-static void CaveRep(Map *map, const int r1, const int r2);
+static void CaveRep(Map *map, const int r1, const int r2, const int reps);
 static void LinkDisconnectedAreas(Map *map);
 static void FixCorridors(Map *map, const int corridorWidth);
 void MapCaveLoad(Map *map, const struct MissionOptions *mo)
@@ -46,70 +46,37 @@ void MapCaveLoad(Map *map, const struct MissionOptions *mo)
 		IMapSet(map, pos, MAP_WALL);
 	}
 	// Shuffle
-	CArrayShuffle(&map->iMap);
+	CArrayShuffle(&map->iMap, &map->buildSeed);
 	// Repetitions
-	for (int i = 0; i < m->u.Cave.Repeat; i++)
-	{
-		CaveRep(map, m->u.Cave.R1, m->u.Cave.R2);
-	}
+	CaveRep(map, m->u.Cave.R1, m->u.Cave.R2, m->u.Cave.Repeat);
 
 	LinkDisconnectedAreas(map);
 
 	FixCorridors(map, m->u.Cave.CorridorWidth);
 }
 
-// Perform one generation of cellular automata
-// If the number of walls within 1 distance is at least R1, OR
-// if the number of walls within 2 distance is at most R2, then the tile
-// becomes a wall; otherwise it is a floor
-static int CountTilesAround(
-	const Map *map, const Vec2i pos, const int radius,
-	const unsigned short tile);
-static void CaveRep(Map *map, const int r1, const int r2)
+// Perform generations of cellular automata on the walls of the map
+static void CaveRep(Map *map, const int r1, const int r2, const int reps)
 {
-	CArray buf;
-	CArrayInit(&buf, map->iMap.elemSize);
-	const unsigned short floor = MAP_FLOOR;
-	CArrayResize(&buf, map->iMap.size, &floor);
-	Vec2i v;
-	for (v.y = 0; v.y < map->Size.y; v.y++)
+	if (reps <= 0)
 	{
-		for (v.x = 0; v.x < map->Size.x; v.x++)
-		{
-			const int idx = v.x + v.y * map->Size.x;
-			unsigned short *tile = CArrayGet(&buf, idx);
-			if (CountTilesAround(map, v, 1, MAP_WALL) >= r1 ||
-				CountTilesAround(map, v, 2, MAP_WALL) <= r2)
-			{
-				*tile = MAP_WALL;
-			}
-			else
-			{
-				*tile = MAP_FLOOR;
-			}
-		}
+		return;
 	}
-	CArrayCopy(&map->iMap, &buf);
-	CArrayTerminate(&buf);
-}
-static int CountTilesAround(
-	const Map *map, const Vec2i pos, const int radius,
-	const unsigned short tile)
-{
-	int c = 0;
-	for (int x = pos.x - radius; x <= pos.x + radius; x++)
+	const int size = map->Size.x * map->Size.y;
+	uint8_t *walls;
+	CMALLOC(walls, size);
+	for (int i = 0; i < size; i++)
 	{
-		for (int y = pos.y - radius; y <= pos.y + radius; y++)
-		{
-			// Also count edge of maps
-			if (x < 0 || x >= map->Size.x || y < 0 || y >= map->Size.y ||
-				IMapGet(map, Vec2iNew(x, y)) == tile)
-			{
-				c++;
-			}
-		}
+		const unsigned short *tile = CArrayGet(&map->iMap, i);
+		walls[i] = *tile == MAP_WALL;
+	}
+	CaveCellularAutomaton(walls, map->Size, r1, r2, reps);
+	for (int i = 0; i < size; i++)
+	{
+		unsigned short *tile = CArrayGet(&map->iMap, i);
+		*tile = walls[i] ? MAP_WALL : MAP_FLOOR;
 	}
-	return c;
+	CFREE(walls);
 }
 
 static void MapFloodFill(
@@ -150,7 +117,7 @@ static void LinkDisconnectedAreas(Map *map)
 		UNUSED(i);
 		CArrayPushBack(&areaTiles, &_ca_index);
 	CA_FOREACH_END()
-	CArrayShuffle(&areaTiles);
+	CArrayShuffle(&areaTiles, &map->buildSeed);
 	CArray areaStarts;
 	CArrayInit(&areaStarts, sizeof(int));
 	CArrayResize(&areaStarts, numAreas, &zero);
@@ -162,7 +162,8 @@ static Vec2i GuessCoords(Map *map);
 static int MapTryBuildSquare(Map *map)
 {
 	Vec2i v = GuessCoords(map);
-	Vec2i size = Vec2iNew(rand() % 9 + 8, rand() % 9 + 8);
+	Vec2i size = Vec2iNew(
+		RandNext(&map->buildSeed) % 9 + 8, RandNext(&map->buildSeed) % 9 + 8);
 	if (MapIsAreaClear(map, v, size))
 	{
 		MapMakeSquare(map, v, size);
@@ -180,8 +181,8 @@ static bool MapTryBuildRoom(
 	// make sure room is large enough to accommodate doors
 	int roomMin = MAX(m->u.Classic.Rooms.Min, doorMin + 4);
 	int roomMax = MAX(m->u.Classic.Rooms.Max, doorMin + 4);
-	int w = rand() % (roomMax - roomMin + 1) + roomMin;
-	int h = rand() % (roomMax - roomMin + 1) + roomMin;
+	int w = RandNext(&map->buildSeed) % (roomMax - roomMin + 1) + roomMin;
+	int h = RandNext(&map->buildSeed) % (roomMax - roomMin + 1) + roomMin;
 	Vec2i pos = GuessCoords(map);
 	Vec2i clearPos = Vec2iNew(pos.x - pad, pos.y - pad);
 	Vec2i clearSize = Vec2iNew(w + 2 * pad, h + 2 * pad);
@@ -235,7 +236,7 @@ static bool MapTryBuildRoom(
 	}
 	if (isClear)
 	{
-		int doormask = rand() % 15 + 1;
+		int doormask = RandNext(&map->buildSeed) % 15 + 1;
 		int doors[4];
 		int doorsUnplaced = 0;
 		int i;
@@ -289,7 +290,8 @@ static bool MapTryBuildRoom(
 			else
 			{
 				// Otherwise, generate an access level for this room
-				accessMask = GenerateAccessMask(&map->keyAccessCount);
+				accessMask = GenerateAccessMask(
+					&map->keyAccessCount, &map->buildSeed);
 				if (map->keyAccessCount < 1)
 				{
 					map->keyAccessCount = 1;
@@ -322,8 +324,8 @@ static bool MapTryBuildPillar(Map *map, const Mission *m, const int pad)
 	int pillarMin = m->u.Classic.Pillars.Min;
 	int pillarMax = m->u.Classic.Pillars.Max;
 	Vec2i size = Vec2iNew(
-		rand() % (pillarMax - pillarMin + 1) + pillarMin,
-		rand() % (pillarMax - pillarMin + 1) + pillarMin);
+		RandNext(&map->buildSeed) % (pillarMax - pillarMin + 1) + pillarMin,
+		RandNext(&map->buildSeed) % (pillarMax - pillarMin + 1) + pillarMin);
 	Vec2i pos = GuessCoords(map);
 	Vec2i clearPos = Vec2iNew(pos.x - pad, pos.y - pad);
 	Vec2i clearSize = Vec2iNew(size.x + 2 * pad, size.y + 2 * pad);
@@ -385,7 +387,9 @@ static int MapTryBuildWall(
 	if (MapIsValidStartForWall(map, v.x, v.y, tileType, pad))
 	{
 		MapMakeWall(map, v);
-		MapGrowWall(map, v.x, v.y, tileType, pad, rand() & 3, wallLength);
+		MapGrowWall(
+			map, v.x, v.y, tileType, pad, RandNext(&map->buildSeed) & 3,
+			wallLength);
 		return 1;
 	}
 	return 0;
@@ -488,11 +492,12 @@ static void MapGrowWall(
 	}
 	MapMakeWall(map, Vec2iNew(x, y));
 	length--;
-	if (length > 0 && (rand() & 3) == 0)
+	if (length > 0 && (RandNext(&map->buildSeed) & 3) == 0)
 	{
 		// Randomly try to grow the wall in a different direction
-		l = rand() % length;
-		MapGrowWall(map, x, y, tileType, pad, rand() & 3, l);
+		l = RandNext(&map->buildSeed) % length;
+		MapGrowWall(
+			map, x, y, tileType, pad, RandNext(&map->buildSeed) & 3, l);
 		length -= l;
 	}
 	// Keep growing wall in same direction
@@ -501,7 +506,9 @@ static void MapGrowWall(
 
 static Vec2i GuessCoords(Map *map)
 {
-	return Vec2iNew(rand() % map->Size.x, rand() % map->Size.y);
+	return Vec2iNew(
+		RandNext(&map->buildSeed) % map->Size.x,
+		RandNext(&map->buildSeed) % map->Size.y);
 }
 
 // Find the maximum door size for a wall
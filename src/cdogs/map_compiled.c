@@ -0,0 +1,319 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "map_compiled.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <SDL_endian.h>
+
+#include "log.h"
+#include "mission.h"
+#include "sys_config.h"
+#include "utils.h"
+
+#define MAGIC "CDMC"
+#define HEADER_SIZE 36
+#define SECTION_SIZE 8
+
+
+// Modification times are compared to the nanosecond where the platform
+// has them, so that edits within the same second are still noticed
+static bool StatJSON(const char *archive, uint32_t *size, uint64_t *mtime)
+{
+	char path[CDOGS_PATH_MAX];
+	sprintf(path, "%s/missions.json", archive);
+	struct stat st;
+	if (stat(path, &st) != 0)
+	{
+		return false;
+	}
+	*size = (uint32_t)st.st_size;
+#if defined(__APPLE__)
+	const long nsec = st.st_mtimespec.tv_nsec;
+#elif !defined(_WIN32)
+	const long nsec = st.st_mtim.tv_nsec;
+#else
+	const long nsec = 0;
+#endif
+	*mtime = (uint64_t)st.st_mtime * 1000000000u + (uint64_t)nsec;
+	return true;
+}
+
+static void Write32(FILE *f, const uint32_t value)
+{
+	const uint32_t v = SDL_SwapLE32(value);
+	fwrite(&v, sizeof v, 1, f);
+}
+static uint32_t Read32(const uint8_t *data)
+{
+	uint32_t v;
+	memcpy(&v, data, sizeof v);
+	return SDL_SwapLE32(v);
+}
+
+bool MapCompiledSave(
+	const char *archive, const CArray *missions, const char *missionsJSON)
+{
+	uint32_t jsonSize;
+	uint64_t jsonMtime;
+	if (!StatJSON(archive, &jsonSize, &jsonMtime))
+	{
+		LOG(LM_MAP, LL_ERROR, "cannot compile missions; no missions.json");
+		return false;
+	}
+	char path[CDOGS_PATH_MAX];
+	sprintf(path, "%s/%s", archive, MAP_COMPILED_FILE);
+	FILE *f = fopen(path, "wb");
+	if (f == NULL)
+	{
+		LOG(LM_MAP, LL_ERROR, "cannot open %s: %s", path, strerror(errno));
+		return false;
+	}
+
+	fwrite(MAGIC, 1, strlen(MAGIC), f);
+	Write32(f, MAP_COMPILED_VERSION);
+	Write32(f, jsonSize);
+	Write32(f, (uint32_t)(jsonMtime & 0xffffffff));
+	Write32(f, (uint32_t)(jsonMtime >> 32));
+	Write32(f, 0);	// reserved
+	Write32(f, (uint32_t)missions->size);
+	// Missions JSON, with its terminating nul, then padding
+	const uint32_t missionsJSONOffset =
+		HEADER_SIZE + SECTION_SIZE * (uint32_t)missions->size;
+	const uint32_t missionsJSONLen = (uint32_t)strlen(missionsJSON) + 1;
+	Write32(f, missionsJSONOffset);
+	Write32(f, missionsJSONLen);
+
+	// Section table
+	uint32_t offset = missionsJSONOffset + ((missionsJSONLen + 3) & ~3u);
+	CA_FOREACH(const Mission, m, *missions)
+		const uint32_t count =
+			m->Type == MAPTYPE_STATIC ? (uint32_t)m->u.Static.Tiles.size : 0;
+		Write32(f, offset);
+		Write32(f, count);
+		// Keep sections 4-byte aligned
+		offset += (count * sizeof(uint16_t) + 3) & ~3u;
+	CA_FOREACH_END()
+
+	fwrite(missionsJSON, 1, missionsJSONLen, f);
+	const uint8_t jsonPad[3] = { 0, 0, 0 };
+	fwrite(jsonPad, 1, ((missionsJSONLen + 3) & ~3u) - missionsJSONLen, f);
+
+	// Tiles
+	CA_FOREACH(const Mission, m, *missions)
+		if (m->Type != MAPTYPE_STATIC) continue;
+		const CArray *tiles = &m->u.Static.Tiles;
+		for (int i = 0; i < (int)tiles->size; i++)
+		{
+			const uint16_t t =
+				SDL_SwapLE16(*(const unsigned short *)CArrayGet(tiles, i));
+			fwrite(&t, sizeof t, 1, f);
+		}
+		if (tiles->size & 1)
+		{
+			const uint16_t pad = 0;
+			fwrite(&pad, sizeof pad, 1, f);
+		}
+	CA_FOREACH_END()
+
+	const bool ok = ferror(f) == 0;
+	if (fclose(f) != 0 || !ok)
+	{
+		LOG(LM_MAP, LL_ERROR, "error writing %s", path);
+		remove(path);
+		return false;
+	}
+	return true;
+}
+
+static bool MapFile(MapCompiled *mc, const char *path);
+bool MapCompiledOpen(MapCompiled *mc, const char *archive)
+{
+	memset(mc, 0, sizeof *mc);
+	uint32_t jsonSize;
+	uint64_t jsonMtime;
+	if (!StatJSON(archive, &jsonSize, &jsonMtime))
+	{
+		return false;
+	}
+	char path[CDOGS_PATH_MAX];
+	sprintf(path, "%s/%s", archive, MAP_COMPILED_FILE);
+	if (!MapFile(mc, path))
+	{
+		return false;
+	}
+	if (mc->size < HEADER_SIZE ||
+		memcmp(mc->data, MAGIC, strlen(MAGIC)) != 0 ||
+		Read32(mc->data + 4) != MAP_COMPILED_VERSION)
+	{
+		LOG(LM_MAP, LL_WARN, "ignoring invalid compiled missions %s", path);
+		goto bail;
+	}
+	const uint64_t mtime =
+		Read32(mc->data + 12) | ((uint64_t)Read32(mc->data + 16) << 32);
+	if (Read32(mc->data + 8) != jsonSize || mtime != jsonMtime)
+	{
+		LOG(LM_MAP, LL_DEBUG, "ignoring out of date compiled missions %s",
+			path);
+		goto bail;
+	}
+	mc->numMissions = (int)Read32(mc->data + 24);
+	const uint32_t missionsJSONOffset = Read32(mc->data + 28);
+	const uint32_t missionsJSONLen = Read32(mc->data + 32);
+	if (HEADER_SIZE + SECTION_SIZE * (size_t)mc->numMissions > mc->size ||
+		missionsJSONLen == 0 ||
+		(size_t)missionsJSONOffset + missionsJSONLen > mc->size ||
+		mc->data[missionsJSONOffset + missionsJSONLen - 1] != '\0')
+	{
+		LOG(LM_MAP, LL_WARN, "ignoring truncated compiled missions %s", path);
+		goto bail;
+	}
+	mc->missionsJSON = (const char *)mc->data + missionsJSONOffset;
+	return true;
+
+bail:
+	MapCompiledClose(mc);
+	return false;
+}
+
+static bool MapFile(MapCompiled *mc, const char *path)
+{
+#ifdef _WIN32
+	// No mmap; read the whole file instead
+	FILE *f = fopen(path, "rb");
+	if (f == NULL)
+	{
+		return false;
+	}
+	fseek(f, 0, SEEK_END);
+	const long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (size <= 0)
+	{
+		fclose(f);
+		return false;
+	}
+	uint8_t *buf;
+	CMALLOC(buf, size);
+	if (fread(buf, 1, size, f) != (size_t)size)
+	{
+		CFREE(buf);
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+	mc->data = buf;
+	mc->size = (size_t)size;
+	mc->isMapped = false;
+	return true;
+#else
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+	void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// The mapping stays valid after closing the file
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		LOG(LM_MAP, LL_WARN, "cannot map %s: %s", path, strerror(errno));
+		return false;
+	}
+	mc->data = data;
+	mc->size = (size_t)st.st_size;
+	mc->isMapped = true;
+	return true;
+#endif
+}
+
+void MapCompiledClose(MapCompiled *mc)
+{
+	if (mc->data == NULL)
+	{
+		return;
+	}
+#ifndef _WIN32
+	if (mc->isMapped)
+	{
+		munmap(mc->data, mc->size);
+	}
+	else
+#endif
+	{
+		CFREE(mc->data);
+	}
+	memset(mc, 0, sizeof *mc);
+}
+
+bool MapCompiledLoadTiles(
+	const MapCompiled *mc, const int missionIndex, const int count,
+	CArray *tiles)
+{
+	if (mc == NULL || mc->data == NULL ||
+		missionIndex < 0 || missionIndex >= mc->numMissions || count <= 0)
+	{
+		return false;
+	}
+	const uint8_t *section = mc->data + HEADER_SIZE + SECTION_SIZE * missionIndex;
+	const uint32_t offset = Read32(section);
+	if (Read32(section + 4) != (uint32_t)count ||
+		(size_t)offset + count * sizeof(uint16_t) > mc->size)
+	{
+		return false;
+	}
+	CArrayResize(tiles, count, NULL);
+	unsigned short *dst = tiles->data;
+	const uint8_t *src = mc->data + offset;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+	memcpy(dst, src, count * sizeof(uint16_t));
+#else
+	for (int i = 0; i < count; i++)
+	{
+		uint16_t t;
+		memcpy(&t, src + i * sizeof t, sizeof t);
+		dst[i] = SDL_SwapLE16(t);
+	}
+#endif
+	return true;
+}
@@ -0,0 +1,72 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "c_array.h"
+
+// Precompiled mission data, saved alongside missions.json in campaign
+// archives. The JSON file is still the source of truth; the compiled file
+// holds the bulky parts (static map tiles) as raw little-endian arrays in
+// flat sections, so they can be memory-mapped and copied without parsing,
+// plus the rest of the missions as JSON without their tiles.
+// The compiled file records the size and modification time of the JSON it
+// was compiled from, and is ignored if the JSON has since changed; the JSON
+// itself isn't read to check this.
+#define MAP_COMPILED_FILE "missions.bin"
+#define MAP_COMPILED_VERSION 3
+
+typedef struct
+{
+	uint8_t *data;
+	size_t size;
+	int numMissions;
+	// Missions without their tiles, as JSON text
+	const char *missionsJSON;
+	bool isMapped;
+} MapCompiled;
+
+// Compile the missions in an archive dir; call after saving missions.json
+// missionsJSON: the missions as saved, but without their static map tiles
+bool MapCompiledSave(
+	const char *archive, const CArray *missions, const char *missionsJSON);
+
+// Open the compiled missions in an archive dir
+// Returns false if missing, invalid or out of date
+bool MapCompiledOpen(MapCompiled *mc, const char *archive);
+void MapCompiledClose(MapCompiled *mc);
+
+// Load the static map tiles for a mission, by its index in missions.json
+// Returns false if the compiled data doesn't have exactly count tiles for
+// this mission, in which case the compiled file should not be used
+bool MapCompiledLoadTiles(
+	const MapCompiled *mc, const int missionIndex, const int count,
+	CArray *tiles);
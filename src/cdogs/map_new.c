@@ -159,7 +159,9 @@ int MapNewLoad(const char *filename, CampaignSetting *c)
 		goto bail;
 	}
 	MapNewLoadCampaignJSON(root, c);
-	LoadMissions(&c->Missions, json_find_first_label(root, "Missions")->child, version);
+	LoadMissions(
+		&c->Missions, json_find_first_label(root, "Missions")->child, version,
+		NULL);
 	CharacterLoadJSON(&c->characters, root, version);
 
 bail:
@@ -188,11 +190,16 @@ static void LoadWeapons(CArray *weapons, json_t *weaponsNode);
 static void LoadClassicRooms(Mission *m, json_t *roomsNode);
 static void LoadClassicDoors(Mission *m, json_t *node, char *name);
 static void LoadClassicPillars(Mission *m, json_t *node, char *name);
-static bool TryLoadStaticMap(Mission *m, json_t *node, int version);
-void LoadMissions(CArray *missions, json_t *missionsNode, int version)
+static bool TryLoadStaticMap(
+	Mission *m, json_t *node, int version,
+	const MapCompiled *compiled, const int index);
+bool LoadMissions(
+	CArray *missions, json_t *missionsNode, int version,
+	const MapCompiled *compiled)
 {
 	json_t *child;
-	for (child = missionsNode->child; child; child = child->next)
+	int index = 0;
+	for (child = missionsNode->child; child; child = child->next, index++)
 	{
 		Mission m;
 		MissionInit(&m);
@@ -337,8 +344,13 @@ void LoadMissions(CArray *missions, json_t *missionsNode, int version)
 			LoadClassicPillars(&m, child, "Pillars");
 			break;
 		case MAPTYPE_STATIC:
-			if (!TryLoadStaticMap(&m, child, version))
+			if (!TryLoadStaticMap(&m, child, version, compiled, index))
 			{
+				if (compiled != NULL)
+				{
+					MissionTerminate(&m);
+					return false;
+				}
 				continue;
 			}
 			break;
@@ -354,6 +366,7 @@ void LoadMissions(CArray *missions, json_t *missionsNode, int version)
 		}
 		CArrayPushBack(missions, &m);
 	}
+	return true;
 }
 static void LoadStaticItems(
 	Mission *m, json_t *node, const char *name, const int version);
@@ -363,10 +376,22 @@ static void LoadStaticCharacters(Mission *m, json_t *node, char *name);
 static void LoadStaticObjectives(Mission *m, json_t *node, char *name);
 static void LoadStaticKeys(Mission *m, json_t *node, char *name);
 static void LoadStaticExit(Mission *m, json_t *node, char *name);
-static bool TryLoadStaticMap(Mission *m, json_t *node, int version)
+static void LoadStaticTilesCSV(CArray *tiles, const char *csv);
+static bool TryLoadStaticMap(
+	Mission *m, json_t *node, int version,
+	const MapCompiled *compiled, const int index)
 {
 	CArrayInit(&m->u.Static.Tiles, sizeof(unsigned short));
-	if (version == 1)
+	if (compiled != NULL)
+	{
+		// The compiled missions' JSON has no tiles
+		if (!MapCompiledLoadTiles(
+			compiled, index, m->Size.x * m->Size.y, &m->u.Static.Tiles))
+		{
+			return false;
+		}
+	}
+	else if (version == 1)
 	{
 		// JSON array
 		json_t *tiles = json_find_first_label(node, "Tiles");
@@ -384,15 +409,11 @@ static bool TryLoadStaticMap(Mission *m, json_t *node, int version)
 	else
 	{
 		// CSV string
-		char *tileCSV = GetString(node, "Tiles");
-		char *pch = strtok(tileCSV, ",");
-		while (pch != NULL)
+		const json_t *tiles = json_find_first_label(node, "Tiles");
+		if (tiles != NULL && tiles->child != NULL)
 		{
-			unsigned short n = (unsigned short)atoi(pch);
-			CArrayPushBack(&m->u.Static.Tiles, &n);
-			pch = strtok(NULL, ",");
+			LoadStaticTilesCSV(&m->u.Static.Tiles, tiles->child->text);
 		}
-		CFREE(tileCSV);
 	}
 
 	LoadStaticItems(m, node, "StaticItems", version);
@@ -407,6 +428,29 @@ static bool TryLoadStaticMap(Mission *m, json_t *node, int version)
 	return true;
 }
 
+static void LoadStaticTilesCSV(CArray *tiles, const char *csv)
+{
+	if (*csv == '\0')
+	{
+		return;
+	}
+	// Count the tiles first so that the array is only allocated once
+	int count = 1;
+	for (const char *c = csv; *c != '\0'; c++)
+	{
+		if (*c == ',') count++;
+	}
+	CArrayResize(tiles, count, NULL);
+	unsigned short *t = tiles->data;
+	const char *c = csv;
+	for (int i = 0; i < count && c != NULL; i++)
+	{
+		t[i] = (unsigned short)strtol(c, NULL, 10);
+		c = strchr(c, ',');
+		if (c != NULL) c++;
+	}
+}
+
 static void LoadMissionObjectives(
 	CArray *objectives, json_t *objectivesNode, const int version)
 {
@@ -31,6 +31,7 @@
 
 #include "c_array.h"
 #include "map_archive.h"
+#include "map_compiled.h"
 
 // allocates title
 int MapNewScan(const char *filename, char **title, int *numMissions);
@@ -39,4 +40,9 @@ int MapNewLoad(const char *filename, CampaignSetting *c);
 // Helper methods for loading JSON maps
 int MapNewScanJSON(json_t *root, char **title, int *numMissions);
 void MapNewLoadCampaignJSON(json_t *root, CampaignSetting *c);
-void LoadMissions(CArray *missions, json_t *missionsNode, int version);
+// compiled: precompiled data to load the static map tiles from, if not NULL
+// Returns false if the compiled data doesn't match the missions; the
+// missions loaded so far are left in the array
+bool LoadMissions(
+	CArray *missions, json_t *missionsNode, int version,
+	const MapCompiled *compiled);
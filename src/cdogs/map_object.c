@@ -48,10 +48,10 @@
 */
 #include "map_object.h"
 
-#include "json_utils.h"
 #include "log.h"
 #include "map.h"
 #include "pics.h"
+#include "yajl_utils.h"
 
 
 MapObjects gMapObjects;
@@ -98,19 +98,9 @@ MapObject *StrMapObject(const char *s)
 	{
 		return NULL;
 	}
-	CA_FOREACH(MapObject, c, gMapObjects.CustomClasses)
-		if (strcmp(s, c->Name) == 0)
-		{
-			return c;
-		}
-	CA_FOREACH_END()
-	CA_FOREACH(MapObject, c, gMapObjects.Classes)
-		if (strcmp(s, c->Name) == 0)
-		{
-			return c;
-		}
-	CA_FOREACH_END()
-	return NULL;
+	MapObject *c;
+	hashmap_get(gMapObjects.names, s, (any_t *)&c);
+	return c;
 }
 MapObject *IntMapObject(const int m)
 {
@@ -177,6 +167,17 @@ MapObject *IndexMapObject(const int i)
 	}
 	return CArrayGet(&gMapObjects.CustomClasses, i - gMapObjects.Classes.size);
 }
+int MapObjectIndex(const MapObject *mo)
+{
+	const int idx = CArrayIndexOf(&gMapObjects.Classes, mo);
+	if (idx >= 0)
+	{
+		return idx;
+	}
+	const int customIdx = CArrayIndexOf(&gMapObjects.CustomClasses, mo);
+	CASSERT(customIdx >= 0, "cannot find map object");
+	return (int)gMapObjects.Classes.size + customIdx;
+}
 int DestructibleMapObjectIndex(const MapObject *mo)
 {
 	if (mo == NULL)
@@ -208,54 +209,59 @@ void MapObjectsInit(
 {
 	CArrayInit(&classes->Classes, sizeof(MapObject));
 	CArrayInit(&classes->CustomClasses, sizeof(MapObject));
+	classes->names = hashmap_new();
 	CArrayInit(&classes->Destructibles, sizeof(char *));
 	CArrayInit(&classes->Bloods, sizeof(char *));
 
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, filename);
-	FILE *f = fopen(buf, "r");
-	json_t *root = NULL;
-	if (f == NULL)
+	if (!MapObjectsLoadFile(&classes->Classes, buf))
 	{
 		LOG(LM_MAIN, LL_ERROR, "Error: cannot load map objects file %s", buf);
-		goto bail;
-	}
-	enum json_error e = json_stream_parse(f, &root);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAIN, LL_ERROR, "Error parsing map objects file %s", buf);
-		goto bail;
+		return;
 	}
-	MapObjectsLoadJSON(&classes->Classes, root);
 
 	// Load initial ammo/weapon spawners
 	MapObjectsLoadAmmoAndGunSpawners(classes, ammo, guns, false);
-
-bail:
-	if (f != NULL)
-	{
-		fclose(f);
-	}
-	json_free_value(&root);
 }
-static void LoadMapObject(MapObject *m, json_t *node);
+
+// Map objects are streamed from file one field at a time
+typedef struct
+{
+	CArray *Classes;
+	MapObject m;
+	char *pickup;
+	bool hasOffset;
+	bool hasWreckOffset;
+} MapObjectLoader;
+static bool LoadMapObjectHeader(
+	void *data, const char *key, const char *value);
+static void LoadMapObjectBegin(void *data, const char *section);
+static void LoadMapObjectField(
+	void *data, const char *key, const int index, const char *value);
+static void LoadMapObjectEnd(void *data);
+static void ReloadNames(MapObjects *mo);
 static void ReloadDestructibles(MapObjects *mo);
-void MapObjectsLoadJSON(CArray *classes, json_t *root)
+bool MapObjectsLoadFile(CArray *classes, const char *path)
 {
-	int version;
-	LoadInt(&version, root, "Version");
-	if (version > VERSION || version <= 0)
-	{
-		CASSERT(false, "cannot read map objects file version");
-		return;
-	}
-
-	json_t *pickupsNode = json_find_first_label(root, "MapObjects")->child;
-	for (json_t *child = pickupsNode->child; child; child = child->next)
+	MapObjectLoader l;
+	memset(&l, 0, sizeof l);
+	l.Classes = classes;
+	const YAJLStreamHandler h =
+	{
+		&l,
+		LoadMapObjectHeader,
+		LoadMapObjectBegin,
+		LoadMapObjectField,
+		LoadMapObjectEnd
+	};
+	const bool ok = YAJLStreamFile(path, "MapObjects", &h);
+	CFREE(l.pickup);
+	// Classes may have moved even if loading failed part way
+	ReloadNames(&gMapObjects);
+	if (!ok)
 	{
-		MapObject m;
-		LoadMapObject(&m, child);
-		CArrayPushBack(classes, &m);
+		return false;
 	}
 
 	ReloadDestructibles(&gMapObjects);
@@ -273,61 +279,151 @@ void MapObjectsLoadJSON(CArray *classes, json_t *root)
 		CSTRDUP(tmp, buf);
 		CArrayPushBack(&gMapObjects.Bloods, &tmp);
 	}
+	return true;
 }
-static void LoadMapObject(MapObject *m, json_t *node)
+static bool LoadMapObjectHeader(
+	void *data, const char *key, const char *value)
 {
-	memset(m, 0, sizeof *m);
-
-	m->Name = GetString(node, "Name");
-	LoadPic(&m->Normal.Pic, node, "Pic");
-	LoadPic(&m->Wreck.Pic, node, "WreckPic");
-	if (m->Normal.Pic)
+	UNUSED(data);
+	if (strcmp(key, "Version") == 0)
+	{
+		const int version = value != NULL ? atoi(value) : 0;
+		if (version > VERSION || version <= 0)
+		{
+			CASSERT(false, "cannot read map objects file version");
+			return false;
+		}
+	}
+	return true;
+}
+static void LoadMapObjectBegin(void *data, const char *section)
+{
+	UNUSED(section);
+	MapObjectLoader *l = data;
+	memset(&l->m, 0, sizeof l->m);
+	// Default tile size
+	l->m.Size = Vec2iNew(TILE_WIDTH, TILE_HEIGHT);
+	CFREE(l->pickup);
+	l->pickup = NULL;
+	l->hasOffset = l->hasWreckOffset = false;
+}
+static void LoadVec2iElement(Vec2i *v, const int index, const char *value)
+{
+	if (index == 0) v->x = atoi(value);
+	else if (index == 1) v->y = atoi(value);
+}
+static void LoadMapObjectField(
+	void *data, const char *key, const int index, const char *value)
+{
+	MapObjectLoader *l = data;
+	MapObject *m = &l->m;
+	if (value == NULL)
+	{
+		return;
+	}
+	if (strcmp(key, "Name") == 0)
+	{
+		CFREE(m->Name);
+		CSTRDUP(m->Name, value);
+	}
+	else if (strcmp(key, "Pic") == 0)
+	{
+		m->Normal.Pic = PicManagerGetPic(&gPicManager, value);
+	}
+	else if (strcmp(key, "WreckPic") == 0)
+	{
+		m->Wreck.Pic = PicManagerGetPic(&gPicManager, value);
+	}
+	else if (strcmp(key, "Offset") == 0)
+	{
+		LoadVec2iElement(&m->Normal.Offset, index, value);
+		l->hasOffset = true;
+	}
+	else if (strcmp(key, "WreckOffset") == 0)
+	{
+		LoadVec2iElement(&m->Wreck.Offset, index, value);
+		l->hasWreckOffset = true;
+	}
+	else if (strcmp(key, "Size") == 0)
+	{
+		LoadVec2iElement(&m->Size, index, value);
+	}
+	else if (strcmp(key, "Health") == 0)
+	{
+		m->Health = atoi(value);
+	}
+	else if (strcmp(key, "DestroyGuns") == 0)
+	{
+		if (index == 0)
+		{
+			CArrayInit(&m->DestroyGuns, sizeof(const GunDescription *));
+		}
+		const GunDescription *g = StrGunDescription(value);
+		CArrayPushBack(&m->DestroyGuns, &g);
+	}
+	else if (strcmp(key, "Flags") == 0)
+	{
+		m->Flags |= 1 << StrPlacementFlag(value);
+	}
+	else if (strcmp(key, "Type") == 0)
+	{
+		m->Type = StrMapObjectType(value);
+	}
+	else if (strcmp(key, "Pickup") == 0)
+	{
+		// Resolved at the end as "Type" may come after
+		CFREE(l->pickup);
+		CSTRDUP(l->pickup, value);
+	}
+}
+static void LoadMapObjectEnd(void *data)
+{
+	MapObjectLoader *l = data;
+	MapObject *m = &l->m;
+	if (m->Normal.Pic && !l->hasOffset)
 	{
 		// Default offset: centered X, align bottom of tile and sprite
 		m->Normal.Offset = Vec2iNew(
 			-m->Normal.Pic->size.x / 2,
 			TILE_HEIGHT / 2 - m->Normal.Pic->size.y);
-		LoadVec2i(&m->Normal.Offset, node, "Offset");
 	}
-	if (m->Wreck.Pic)
+	if (m->Wreck.Pic && !l->hasWreckOffset)
 	{
 		m->Wreck.Offset = Vec2iScaleDiv(m->Wreck.Pic->size, -2);
-		LoadVec2i(&m->Wreck.Offset, node, "WreckOffset");
-	}
-	// Default tile size
-	m->Size = Vec2iNew(TILE_WIDTH, TILE_HEIGHT);
-	LoadVec2i(&m->Size, node, "Size");
-	LoadInt(&m->Health, node, "Health");
-	LoadBulletGuns(&m->DestroyGuns, node, "DestroyGuns");
-	json_t *flagsNode = json_find_first_label(node, "Flags");
-	if (flagsNode != NULL && flagsNode->child != NULL)
-	{
-		for (json_t *flagNode = flagsNode->child->child;
-			flagNode;
-			flagNode = flagNode->next)
-		{
-			m->Flags |= 1 << StrPlacementFlag(flagNode->text);
-		}
 	}
 
 	// Special types
-	JSON_UTILS_LOAD_ENUM(m->Type, node, "Type", StrMapObjectType);
 	switch (m->Type)
 	{
 	case MAP_OBJECT_TYPE_NORMAL:
 		// Do nothing
 		break;
 	case MAP_OBJECT_TYPE_PICKUP_SPAWNER:
-		{
-			char *tmp = GetString(node, "Pickup");
-			m->u.PickupClass = StrPickupClass(tmp);
-			CFREE(tmp);
-		}
+		m->u.PickupClass = StrPickupClass(l->pickup);
 		break;
 	default:
 		CASSERT(false, "unknown error");
 		break;
 	}
+	CArrayPushBack(l->Classes, m);
+}
+static void AddNames(MapObjects *mo, CArray *classes);
+static void ReloadNames(MapObjects *mo)
+{
+	if (mo->names == NULL)
+	{
+		return;
+	}
+	hashmap_clear(mo->names, NULL);
+	// Custom classes are added first so they override built-in ones
+	AddNames(mo, &mo->CustomClasses);
+	AddNames(mo, &mo->Classes);
+}
+static void AddNames(MapObjects *mo, CArray *classes)
+{
+	CA_FOREACH(MapObject, c, *classes)
+		hashmap_put(mo->names, c->Name, c);
+	CA_FOREACH_END()
 }
 static void AddDestructibles(MapObjects *mo, const CArray *classes);
 static void ReloadDestructibles(MapObjects *mo)
@@ -370,6 +466,7 @@ void MapObjectsLoadAmmoAndGunSpawners(
 		LoadAmmoSpawners(&classes->Classes, &ammo->Ammo);
 		LoadGunSpawners(&classes->Classes, &guns->Guns);
 	}
+	ReloadNames(classes);
 }
 static void LoadAmmoSpawners(CArray *classes, const CArray *ammo)
 {
@@ -429,6 +526,7 @@ void MapObjectsClear(CArray *classes)
 		CArrayTerminate(&c->DestroyGuns);
 	}
 	CArrayClear(classes);
+	ReloadNames(&gMapObjects);
 }
 void MapObjectsTerminate(MapObjects *classes)
 {
@@ -436,6 +534,8 @@ void MapObjectsTerminate(MapObjects *classes)
 	CArrayTerminate(&classes->Classes);
 	MapObjectsClear(&classes->CustomClasses);
 	CArrayTerminate(&classes->CustomClasses);
+	hashmap_free(classes->names);
+	classes->names = NULL;
 	CA_FOREACH(char *, s, classes->Destructibles)
 		CFREE(*s);
 	CA_FOREACH_END()
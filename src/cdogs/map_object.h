@@ -50,6 +50,7 @@
 
 #include <json/json.h>
 #include "ammo.h"
+#include "c_hashmap/hashmap.h"
 #include "pic_manager.h"
 #include "pickup_class.h"
 
@@ -103,6 +104,8 @@ typedef struct
 {
 	CArray Classes;	// of MapObject
 	CArray CustomClasses;	// of MapObject
+	// Name lookup over both arrays, custom first; rebuilt when they change
+	map_t names;	// of MapObject *
 	// Names of special types of map objects; for editor support
 	// Reset on load
 	CArray Destructibles;	// of char *
@@ -114,8 +117,10 @@ extern MapObjects gMapObjects;
 MapObject *StrMapObject(const char *s);
 // Legacy map objects, integer based
 MapObject *IntMapObject(const int m);
-// Get map object by index; used by editor
+// Get map object by index; used by editor, and to send map objects over the
+// network without names
 MapObject *IndexMapObject(const int i);
+int MapObjectIndex(const MapObject *mo);
 // Get index of destructible map object; used by editor
 int DestructibleMapObjectIndex(const MapObject *mo);
 MapObject *RandomBloodMapObject(const MapObjects *mo);
@@ -123,7 +128,8 @@ MapObject *RandomBloodMapObject(const MapObjects *mo);
 void MapObjectsInit(
 	MapObjects *classes, const char *filename,
 	const AmmoClasses *ammo, const GunClasses *guns);
-void MapObjectsLoadJSON(CArray *classes, json_t *root);
+// Load map objects from a map_objects.json file, streamed
+bool MapObjectsLoadFile(CArray *classes, const char *path);
 void MapObjectsLoadAmmoAndGunSpawners(
 	MapObjects *classes, const AmmoClasses *ammo, const GunClasses *guns,
 	const bool isCustom);
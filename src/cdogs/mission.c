@@ -273,7 +273,6 @@ void SetupMission(Mission *m, struct MissionOptions *mo, int missionIndex)
 	MobObjsInit();
 	PickupsInit();
 	ParticlesInit(&gParticles);
-	WatchesInit();
 	SetupObjectives(m);
 	SetupBadguysForMission(m);
 	SetupWeapons(&mo->Weapons, &m->Weapons);
@@ -288,7 +287,7 @@ void MissionSetMessageIfComplete(struct MissionOptions *options)
 		{
 			GameEvent msg = GameEventNew(GAME_EVENT_MISSION_COMPLETE);
 			msg.u.MissionComplete = NMakeMissionComplete(options, &gMap);
-			GameEventsEnqueue(&gGameEvents, msg);
+			GameEventsEnqueue(&gGameEvents, &msg);
 		}
 		else if (options->HasBegun && gCampaign.Entry.Mode == GAME_MODE_NORMAL)
 		{
@@ -302,7 +301,7 @@ void MissionSetMessageIfComplete(struct MissionOptions *options)
 						GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
 						e.u.MissionEnd.Delay = GAME_OVER_DELAY;
 						strcpy(e.u.MissionEnd.Msg, "Mission failed");
-						GameEventsEnqueue(&gGameEvents, e);
+						GameEventsEnqueue(&gGameEvents, &e);
 					}
 				}
 			CA_FOREACH_END()
@@ -350,7 +349,7 @@ void UpdateMissionObjective(
 		GameEvent e = GameEventNew(GAME_EVENT_OBJECTIVE_UPDATE);
 		e.u.ObjectiveUpdate.ObjectiveId = idx;
 		e.u.ObjectiveUpdate.Count = count;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 }
 
@@ -378,7 +377,7 @@ void MissionBegin(struct MissionOptions *m)
 			e.u.SetMessage.Message, MusicGetErrorMessage(&gSoundDevice),
 			sizeof e.u.SetMessage.Message - 1);
 		e.u.SetMessage.Ticks = FPS_FRAMELIMIT * 2;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 	m->time = 0;
 	m->pickupTime = 0;
@@ -63,6 +63,7 @@ void NetClientInit(NetClient *n)
 	}
 	CArrayInit(&n->ScannedAddrs, sizeof(ScanInfo));
 	CArrayInit(&n->scannedAddrBuf, sizeof(ScanInfo));
+	CArrayInit(&n->TilePics, sizeof(NamedPic *));
 }
 void NetClientTerminate(NetClient *n)
 {
@@ -81,6 +82,7 @@ void NetClientTerminate(NetClient *n)
 	}
 	CArrayTerminate(&n->ScannedAddrs);
 	CArrayTerminate(&n->scannedAddrBuf);
+	CArrayTerminate(&n->TilePics);
 }
 
 static bool TryScanHost(NetClient *n, const enet_uint32 host);
@@ -430,7 +432,7 @@ static void OnReceive(NetClient *n, ENetEvent event)
 			}
 			else
 			{
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 			}
 		}
 	}
@@ -466,18 +468,27 @@ static void OnReceive(NetClient *n, ENetEvent event)
 				char buf[CDOGS_PATH_MAX];
 				GetDataFilePath(buf, def.Path);
 				CampaignEntry entry;
-				if (CampaignEntryTryLoad(&entry, buf, GAME_MODE_NORMAL) &&
-					CampaignLoad(&gCampaign, &entry))
-				{
-					gCampaign.IsClient = true;
-					gCampaign.MissionIndex = def.Mission;
-				}
-				else
+				if (!CampaignEntryTryLoad(&entry, buf, GAME_MODE_NORMAL) ||
+					!CampaignLoad(&gCampaign, &entry))
 				{
 					LOG(LM_NET, LL_ERROR, "failed to load campaign def %s",
 						def.Path);
 					gCampaign.IsError = true;
 				}
+				else if (def.IdsHash != NetIdsHash())
+				{
+					// Guns, pickups etc. are sent by ID, so they must match
+					LOG(LM_NET, LL_ERROR,
+						"game data differs from the server's (%08x vs %08x)",
+						(unsigned)NetIdsHash(), (unsigned)def.IdsHash);
+					CampaignUnload(&gCampaign);
+					gCampaign.IsError = true;
+				}
+				else
+				{
+					gCampaign.IsClient = true;
+					gCampaign.MissionIndex = def.Mission;
+				}
 			}
 			break;
 		case GAME_EVENT_NET_GAME_START:
@@ -55,6 +55,8 @@ typedef struct
 	CArray ScannedAddrs;		// of ScanInfo
 	// Buffer of scanned addresses - new ones will be scanned here
 	CArray scannedAddrBuf;	// of ScanInfo
+	// Tile pics named by the server, indexed by ID - 1
+	CArray TilePics;	// of NamedPic *
 } NetClient;
 
 extern NetClient gNetClient;
@@ -281,7 +281,7 @@ static void OnReceive(NetServer *n, ENetEvent event)
 		LOG(LM_NET, LL_TRACE, "recv gameEvent(%d)", (int)gee.Type);
 		GameEvent e = GameEventNew(gee.Type);
 		NetDecode(event.packet, &e.u, gee.Fields);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 	else
 	{
@@ -302,7 +302,7 @@ static void OnReceive(NetServer *n, ENetEvent event)
 				if (pData == NULL) continue;
 				GameEvent e = GameEventNew(GAME_EVENT_PLAYER_DATA);
 				e.u.PlayerData = PlayerDataMissionReset(pData);
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 			}
 			// Flush game events to make sure we reset player data
 			HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -391,7 +391,7 @@ static void OnDisconnect(const ENetEvent event)
 	{
 		GameEvent e = GameEventNew(GAME_EVENT_PLAYER_REMOVE);
 		e.u.PlayerRemove.UID = (peerId + 1) * MAX_LOCAL_PLAYERS + i;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 }
 
@@ -403,6 +403,8 @@ void NetServerFlush(NetServer *n)
 
 static void SendConfig(
 	Config *config, const char *name, NetServer *n, const int peerId);
+static void SetTilePic(
+	CArray *sent, const NamedPic *pic, bool *hasName, char *name, int32_t *id);
 void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 {
 	// Send details of all current players
@@ -457,8 +459,11 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 		NetServerSendMsg(n, peerId, GAME_EVENT_OBJECTIVE_UPDATE, &ou);
 	CA_FOREACH_END()
 
-	// Send all tiles, RLE
+	// Send all tiles, RLE; name each pic once, then send its ID
+	CArray sentPics;
+	CArrayInit(&sentPics, sizeof(const NamedPic *));
 	const Tile *tLast = NULL;
+	int flagsLast = 0;
 	NTileSet ts = NTileSet_init_default;
 	Vec2i pos;
 	for (pos.y = 0; pos.y < gMap.Size.y; pos.y++)
@@ -466,10 +471,11 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 		for (pos.x = 0; pos.x < gMap.Size.x; pos.x++)
 		{
 			const Tile *t = MapGetTile(&gMap, pos);
+			const int flags = MapGetTileFlags(&gMap, pos);
 			// Use RLE, so check if the current tile is the same as the last
 			if (tLast != NULL &&
 				t->pic == tLast->pic && t->picAlt == tLast->picAlt &&
-				t->flags == tLast->flags)
+				flags == flagsLast)
 			{
 				ts.RunLength++;
 			}
@@ -483,15 +489,20 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 				// Begin the next run
 				memset(&ts, 0, sizeof ts);
 				ts.Pos = Vec2i2Net(pos);
-				if (t->pic != NULL) strcpy(ts.PicName, t->pic->name);
-				if (t->picAlt != NULL) strcpy(ts.PicAltName, t->picAlt->name);
-				ts.Flags = t->flags;
+				SetTilePic(
+					&sentPics, t->pic, &ts.has_PicName, ts.PicName, &ts.PicId);
+				SetTilePic(
+					&sentPics, t->picAlt,
+					&ts.has_PicAltName, ts.PicAltName, &ts.PicAltId);
+				ts.Flags = flags;
 				ts.RunLength = 0;
 			}
 			tLast = t;
+			flagsLast = flags;
 		}
 	}
 	NetServerSendMsg(n, peerId, GAME_EVENT_TILE_SET, &ts);
+	CArrayTerminate(&sentPics);
 
 	// Send all the tiles visited so far
 	NExploreTiles et = NExploreTiles_init_default;
@@ -522,7 +533,7 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 		if (!p->isInUse) continue;
 		NAddPickup api = NAddPickup_init_default;
 		api.UID = p->UID;
-		strcpy(api.PickupClass, p->class->Name);
+		api.PickupClassId = PickupClassId(p->class);
 		api.IsRandomSpawned = p->IsRandomSpawned;
 		api.SpawnerUID = p->SpawnerUID;
 		api.TileItemFlags = p->tileItem.flags;
@@ -535,7 +546,7 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 		if (!o->isInUse) continue;
 		NMapObjectAdd amo = NMapObjectAdd_init_default;
 		amo.UID = o->uid;
-		strcpy(amo.MapObjectClass, o->Class->Name);
+		amo.MapObjectId = MapObjectIndex(o->Class);
 		amo.Pos = Vec2i2Net(Vec2iNew(o->tileItem.x, o->tileItem.y));
 		amo.TileItemFlags = o->tileItem.flags;
 		amo.Health = o->Health;
@@ -552,36 +563,33 @@ void NetServerSendGameStartMessages(NetServer *n, const int peerId)
 		NetServerSendMsg(n, peerId, GAME_EVENT_MISSION_COMPLETE, &mc);
 	}
 }
-static void SendConfig(
-	Config *config, const char *name, NetServer *n, const int peerId)
+static void SetTilePic(
+	CArray *sent, const NamedPic *pic, bool *hasName, char *name, int32_t *id)
 {
-	NConfig msg = NConfig_init_default;
-	const Config *c = ConfigGet(config, name);
-	strcpy(msg.Name, name);
-	switch (c->Type)
+	*hasName = false;
+	*id = 0;
+	if (pic == NULL)
+	{
+		return;
+	}
+	// Maps only use a few distinct tile pics
+	for (int i = 0; i < (int)sent->size; i++)
 	{
-	case CONFIG_TYPE_STRING:
-		CASSERT(false, "unimplemented");
-		break;
-	case CONFIG_TYPE_INT:
-		sprintf(msg.Value, "%d", c->u.Int.Value);
-		break;
-	case CONFIG_TYPE_FLOAT:
-		sprintf(msg.Value, "%f", c->u.Float.Value);
-		break;
-	case CONFIG_TYPE_BOOL:
-		strcpy(msg.Value, c->u.Bool.Value ? "true" : "false");
-		break;
-	case CONFIG_TYPE_ENUM:
-		sprintf(msg.Value, "%d", (int)c->u.Enum.Value);
-		break;
-	case CONFIG_TYPE_GROUP:
-		CASSERT(false, "Cannot send groups over net");
-		break;
-	default:
-		CASSERT(false, "Unknown config type");
-		break;
+		if (*(const NamedPic **)CArrayGet(sent, i) == pic)
+		{
+			*id = i + 1;
+			return;
+		}
 	}
+	CArrayPushBack(sent, &pic);
+	*id = (int32_t)sent->size;
+	*hasName = true;
+	strcpy(name, pic->name);
+}
+static void SendConfig(
+	Config *config, const char *name, NetServer *n, const int peerId)
+{
+	const NConfig msg = NMakeConfig(config, name);
 	NetServerSendMsg(n, peerId, GAME_EVENT_CONFIG, &msg);
 }
 
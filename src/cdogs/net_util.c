@@ -30,6 +30,11 @@
 
 #include "proto/nanopb/pb_decode.h"
 #include "proto/nanopb/pb_encode.h"
+#include "bullet_class.h"
+#include "map_object.h"
+#include "pickup_class.h"
+#include "sounds.h"
+#include "weapon.h"
 
 
 ENetPacket *NetEncode(const GameEventType e, const void *data)
@@ -89,8 +94,90 @@ NCampaignDef NMakeCampaignDef(const CampaignOptions *co)
 	}
 	def.GameMode = co->Entry.Mode;
 	def.Mission = co->MissionIndex;
+	def.IdsHash = NetIdsHash();
 	return def;
 }
+// FNV-1a, with the terminating nul so names can't run together
+static uint32_t HashName(uint32_t hash, const char *name)
+{
+	do
+	{
+		hash ^= (uint8_t)*name;
+		hash *= 16777619u;
+	} while (*name++ != '\0');
+	return hash;
+}
+uint32_t NetIdsHash(void)
+{
+	uint32_t hash = 2166136261u;
+	const int numGuns =
+		(int)gGunDescriptions.Guns.size + (int)gGunDescriptions.CustomGuns.size;
+	for (int i = 0; i < numGuns; i++)
+	{
+		hash = HashName(hash, IdGunDescription(i)->name);
+	}
+	hash = HashName(hash, "");
+	const int numBullets =
+		(int)gBulletClasses.Classes.size +
+		(int)gBulletClasses.CustomClasses.size;
+	for (int i = 0; i < numBullets; i++)
+	{
+		hash = HashName(hash, IdBulletClass(i)->Name);
+	}
+	hash = HashName(hash, "");
+	const int numPickups =
+		(int)gPickupClasses.Classes.size +
+		(int)gPickupClasses.CustomClasses.size +
+		(int)gPickupClasses.KeyClasses.size;
+	for (int i = 0; i < numPickups; i++)
+	{
+		hash = HashName(hash, PickupClassGetById(&gPickupClasses, i)->Name);
+	}
+	hash = HashName(hash, "");
+	for (int i = 0; i < MapObjectsCount(&gMapObjects); i++)
+	{
+		hash = HashName(hash, IndexMapObject(i)->Name);
+	}
+	hash = HashName(hash, "");
+	CA_FOREACH(const char *, name, gSoundDevice.soundNames)
+		hash = HashName(hash, *name);
+	CA_FOREACH_END()
+	CA_FOREACH(const char *, name, gSoundDevice.customSoundNames)
+		hash = HashName(hash, *name);
+	CA_FOREACH_END()
+	return hash;
+}
+NConfig NMakeConfig(Config *config, const char *name)
+{
+	NConfig msg = NConfig_init_default;
+	const Config *c = ConfigGet(config, name);
+	strcpy(msg.Name, name);
+	switch (c->Type)
+	{
+	case CONFIG_TYPE_STRING:
+		CASSERT(false, "unimplemented");
+		break;
+	case CONFIG_TYPE_INT:
+		sprintf(msg.Value, "%d", c->u.Int.Value);
+		break;
+	case CONFIG_TYPE_FLOAT:
+		sprintf(msg.Value, "%f", c->u.Float.Value);
+		break;
+	case CONFIG_TYPE_BOOL:
+		strcpy(msg.Value, c->u.Bool.Value ? "true" : "false");
+		break;
+	case CONFIG_TYPE_ENUM:
+		sprintf(msg.Value, "%d", (int)c->u.Enum.Value);
+		break;
+	case CONFIG_TYPE_GROUP:
+		CASSERT(false, "Cannot send groups over net");
+		break;
+	default:
+		CASSERT(false, "Unknown config type");
+		break;
+	}
+	return msg;
+}
 NMissionComplete NMakeMissionComplete(
 	const struct MissionOptions *mo, const Map *map)
 {
@@ -40,7 +40,7 @@
 
 #define NET_LISTEN_PORT 34219
 
-#define NET_PROTOCOL_VERSION 2
+#define NET_PROTOCOL_VERSION 5
 
 // Messages
 
@@ -53,6 +53,10 @@ bool NetDecode(ENetPacket *packet, void *dest, const pb_field_t *fields);
 
 NPlayerData NMakePlayerData(const PlayerData *p);
 NCampaignDef NMakeCampaignDef(const CampaignOptions *co);
+// Hash of the names of guns, bullets, pickups, map objects and sounds in ID
+// order; peers whose hashes differ would send each other the wrong IDs
+uint32_t NetIdsHash(void);
+NConfig NMakeConfig(Config *config, const char *name);
 NMissionComplete NMakeMissionComplete(
 	const struct MissionOptions *mo, const Map *map);
 
@@ -70,6 +70,7 @@
 #include "mission.h"
 #include "game.h"
 #include "utils.h"
+#include "visibility_cache.h"
 
 CArray gObjs;
 CArray gMobObjs;
@@ -105,7 +106,7 @@ void DamageObject(const NMapObjectDamage mod)
 		e.u.MapObjectRemove.ActorUID = mod.UID;
 		e.u.MapObjectRemove.PlayerUID = mod.PlayerUID;
 		e.u.MapObjectRemove.Flags = mod.Flags;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 }
 
@@ -127,7 +128,7 @@ void ObjRemove(const NMapObjectRemove mor)
 			GameEvent e = GameEventNew(GAME_EVENT_SCORE);
 			e.u.Score.PlayerUID = mor.PlayerUID;
 			e.u.Score.Score = OBJECT_SCORE;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 
 		// Weapons that go off when this object is destroyed
@@ -142,7 +143,8 @@ void ObjRemove(const NMapObjectRemove mor)
 		// TODO: doesn't need to be network event
 		GameEvent e = GameEventNew(GAME_EVENT_ADD_BULLET);
 		e.u.AddBullet.UID = MobObjsObjsGetNextUID();
-		strcpy(e.u.AddBullet.BulletClass, "fireball_wreck");
+		e.u.AddBullet.BulletClassId =
+			BulletClassId(StrBulletClass("fireball_wreck"));
 		e.u.AddBullet.MuzzlePos = Vec2i2Net(fullPos);
 		e.u.AddBullet.MuzzleHeight = 0;
 		e.u.AddBullet.Angle = 0;
@@ -150,7 +152,7 @@ void ObjRemove(const NMapObjectRemove mor)
 		e.u.AddBullet.Flags = 0;
 		e.u.AddBullet.PlayerUID = -1;
 		e.u.AddBullet.ActorUID = -1;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 
 	SoundPlayAt(&gSoundDevice, gSoundDevice.wreckSound, realPos);
@@ -159,6 +161,7 @@ void ObjRemove(const NMapObjectRemove mor)
 	if (o->Class->Wreck.Pic)
 	{
 		o->tileItem.flags = TILEITEM_IS_WRECK;
+		MapUpdateTileBlockers(&gMap, Vec2iToTile(realPos));
 	}
 	else
 	{
@@ -241,7 +244,7 @@ void Damage(
 			e.u.MapObjectDamage.ActorUID = uid;
 			e.u.MapObjectDamage.PlayerUID = playerUID;
 			e.u.MapObjectDamage.Flags = flags;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 		break;
 	default:
@@ -269,7 +272,7 @@ static void DoDamageCharacter(
 		ei.u.ActorImpulse.Vel = Vec2i2Net(Vec2iScaleDiv(
 			Vec2iScale(hitVector, power), SHOT_IMPULSE_DIVISOR));
 		ei.u.ActorImpulse.Pos = Vec2i2Net(actor->Pos);
-		GameEventsEnqueue(&gGameEvents, ei);
+		GameEventsEnqueue(&gGameEvents, &ei);
 	}
 
 	const bool canDamage =
@@ -282,7 +285,7 @@ static void DoDamageCharacter(
 	e.u.ActorHit.Special = special;
 	e.u.ActorHit.Power = canDamage ? power : 0;
 	e.u.ActorHit.Vel = Vec2i2Net(hitVector);
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 
 	if (canDamage)
 	{
@@ -304,7 +307,7 @@ static void DoDamageCharacter(
 			{
 				e.u.Score.Score = power;
 			}
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 	}
 }
@@ -321,7 +324,7 @@ void UpdateMobileObjects(int ticks)
 		{
 			GameEvent e = GameEventNew(GAME_EVENT_REMOVE_BULLET);
 			e.u.RemoveBullet.UID = obj->UID;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 			continue;
 		}
 		CPicUpdate(&obj->tileItem.CPic, ticks);
@@ -381,7 +384,7 @@ void ObjAdd(const NMapObjectAdd amo)
 	}
 	memset(o, 0, sizeof *o);
 	o->uid = amo.UID;
-	o->Class = StrMapObject(amo.MapObjectClass);
+	o->Class = IndexMapObject(amo.MapObjectId);
 	o->Health = amo.Health;
 	o->tileItem.x = o->tileItem.y = -1;
 	o->tileItem.flags = amo.TileItemFlags;
@@ -391,15 +394,24 @@ void ObjAdd(const NMapObjectAdd amo)
 	o->tileItem.id = i;
 	MapTryMoveTileItem(&gMap, &o->tileItem, Net2Vec2i(amo.Pos));
 	o->isInUse = true;
+	// AI paths go around dangerous objects
+	if (ObjIsDangerous(o))
+	{
+		VisibilityCacheInvalidate(&gVisibilityCache, VISIBILITY_WALK);
+	}
 	LOG(LM_MAIN, LL_DEBUG,
 		"added object uid(%d) class(%s) health(%d) pos(%d, %d)",
-		(int)amo.UID, amo.MapObjectClass, amo.Health, amo.Pos.x, amo.Pos.y);
+		(int)amo.UID, o->Class->Name, amo.Health, amo.Pos.x, amo.Pos.y);
 }
 void ObjDestroy(TObject *o)
 {
 	CASSERT(o->isInUse, "Destroying in-use object");
 	MapRemoveTileItem(&gMap, &o->tileItem);
 	o->isInUse = false;
+	if (ObjIsDangerous(o))
+	{
+		VisibilityCacheInvalidate(&gVisibilityCache, VISIBILITY_WALK);
+	}
 }
 
 bool ObjIsDangerous(const TObject *o)
@@ -433,15 +445,14 @@ void UpdateObjects(const int ticks)
 				obj->counter = -1;
 				GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
 				e.u.AddPickup.UID = PickupsGetNextUID();
-				strcpy(
-					e.u.AddPickup.PickupClass,
-					obj->Class->u.PickupClass->Name);
+				e.u.AddPickup.PickupClassId =
+					PickupClassId(obj->Class->u.PickupClass);
 				e.u.AddPickup.IsRandomSpawned = false;
 				e.u.AddPickup.SpawnerUID = obj->uid;
 				e.u.AddPickup.TileItemFlags = 0;
 				e.u.AddPickup.Pos =
 					Vec2i2Net(Vec2iNew(obj->tileItem.x, obj->tileItem.y));
-				GameEventsEnqueue(&gGameEvents, e);
+				GameEventsEnqueue(&gGameEvents, &e);
 			}
 			break;
 		default:
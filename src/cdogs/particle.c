@@ -28,18 +28,18 @@
 #include "particle.h"
 
 #include "collision.h"
+#include "config.h"
 #include "game_events.h"
-#include "json_utils.h"
 #include "log.h"
 #include "objs.h"
+#include "yajl_utils.h"
 
 
 ParticleClasses gParticleClasses;
-CArray gParticles;
+Particles gParticles;
 
 #define VERSION 1
 
-static void LoadParticleClass(ParticleClass *c, json_t *node);
 void ParticleClassesInit(ParticleClasses *classes, const char *filename)
 {
 	CArrayInit(&classes->Classes, sizeof(ParticleClass));
@@ -47,46 +47,151 @@ void ParticleClassesInit(ParticleClasses *classes, const char *filename)
 
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, filename);
-	FILE *f = fopen(buf, "r");
-	json_t *root = NULL;
-	if (f == NULL)
+	if (!ParticleClassesLoadFile(&classes->Classes, buf))
 	{
 		LOG(LM_MAIN, LL_ERROR, "Error: cannot load particles file %s", buf);
-		goto bail;
 	}
-	enum json_error e = json_stream_parse(f, &root);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAIN, LL_ERROR, "Error parsing particles file %s", buf);
-		goto bail;
-	}
-	ParticleClassesLoadJSON(&classes->Classes, root);
+}
 
-bail:
-	if (f != NULL)
+// Particle classes are streamed from file one field at a time
+typedef struct
+{
+	CArray *Classes;
+	ParticleClass c;
+	int range;
+	bool hasRange;
+	bool hasRangeLow;
+	bool hasRangeHigh;
+} ParticleClassLoader;
+static bool LoadParticleHeader(
+	void *data, const char *key, const char *value);
+static void LoadParticleBegin(void *data, const char *section);
+static void LoadParticleField(
+	void *data, const char *key, const int index, const char *value);
+static void LoadParticleEnd(void *data);
+bool ParticleClassesLoadFile(CArray *classes, const char *path)
+{
+	ParticleClassLoader l;
+	memset(&l, 0, sizeof l);
+	l.Classes = classes;
+	const YAJLStreamHandler h =
 	{
-		fclose(f);
+		&l,
+		LoadParticleHeader,
+		LoadParticleBegin,
+		LoadParticleField,
+		LoadParticleEnd
+	};
+	return YAJLStreamFile(path, "Particles", &h);
+}
+static bool LoadParticleHeader(
+	void *data, const char *key, const char *value)
+{
+	UNUSED(data);
+	if (strcmp(key, "Version") == 0)
+	{
+		const int version = value != NULL ? atoi(value) : 0;
+		if (version > VERSION || version <= 0)
+		{
+			CASSERT(false, "cannot read particles file version");
+			return false;
+		}
 	}
-	json_free_value(&root);
+	return true;
+}
+static void LoadParticleBegin(void *data, const char *section)
+{
+	UNUSED(section);
+	ParticleClassLoader *l = data;
+	memset(&l->c, 0, sizeof l->c);
+	l->c.Mask = colorWhite;
+	l->c.Bounces = true;
+	l->c.WallBounces = true;
+	l->c.Priority = PARTICLE_PRIORITY_NORMAL;
+	l->hasRange = l->hasRangeLow = l->hasRangeHigh = false;
 }
-void ParticleClassesLoadJSON(CArray *classes, json_t *root)
+static void LoadParticleField(
+	void *data, const char *key, const int index, const char *value)
 {
-	int version;
-	LoadInt(&version, root, "Version");
-	if (version > VERSION || version <= 0)
+	UNUSED(index);
+	ParticleClassLoader *l = data;
+	ParticleClass *c = &l->c;
+	if (value == NULL)
 	{
-		CASSERT(false, "cannot read particles file version");
 		return;
 	}
-
-	json_t *particlesNode = json_find_first_label(root, "Particles")->child;
-	for (json_t *child = particlesNode->child; child; child = child->next)
+	if (strcmp(key, "Name") == 0)
+	{
+		CFREE(c->Name);
+		CSTRDUP(c->Name, value);
+	}
+	else if (strcmp(key, "Sprites") == 0)
+	{
+		c->Sprites = PicManagerGetSprites(&gPicManager, value);
+	}
+	else if (strcmp(key, "Pic") == 0)
+	{
+		c->Pic = PicManagerGetPic(&gPicManager, value);
+	}
+	else if (strcmp(key, "Mask") == 0)
+	{
+		c->Mask = StrColor(value);
+	}
+	else if (strcmp(key, "Range") == 0)
+	{
+		l->range = atoi(value);
+		l->hasRange = true;
+	}
+	else if (strcmp(key, "RangeLow") == 0)
+	{
+		c->RangeLow = atoi(value);
+		l->hasRangeLow = true;
+	}
+	else if (strcmp(key, "RangeHigh") == 0)
+	{
+		c->RangeHigh = atoi(value);
+		l->hasRangeHigh = true;
+	}
+	else if (strcmp(key, "TicksPerFrame") == 0)
+	{
+		c->TicksPerFrame = atoi(value);
+	}
+	else if (strcmp(key, "GravityFactor") == 0)
+	{
+		c->GravityFactor = atoi(value);
+	}
+	else if (strcmp(key, "HitsWalls") == 0)
+	{
+		c->HitsWalls = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "Bounces") == 0)
+	{
+		c->Bounces = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "WallBounces") == 0)
+	{
+		c->WallBounces = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "Priority") == 0)
 	{
-		ParticleClass c;
-		LoadParticleClass(&c, child);
-		CArrayPushBack(classes, &c);
+		c->Priority = StrParticlePriority(value);
 	}
 }
+static void LoadParticleEnd(void *data)
+{
+	ParticleClassLoader *l = data;
+	ParticleClass *c = &l->c;
+	// "Range" sets both ends; "RangeLow"/"RangeHigh" override it
+	if (l->hasRange)
+	{
+		if (!l->hasRangeLow) c->RangeLow = l->range;
+		if (!l->hasRangeHigh) c->RangeHigh = l->range;
+	}
+	const int low = MIN(c->RangeLow, c->RangeHigh);
+	c->RangeHigh = MAX(c->RangeLow, c->RangeHigh);
+	c->RangeLow = low;
+	CArrayPushBack(l->Classes, c);
+}
 void ParticleClassesTerminate(ParticleClasses *classes)
 {
 	ParticleClassesClear(&classes->Classes);
@@ -103,50 +208,6 @@ void ParticleClassesClear(CArray *classes)
 	}
 	CArrayClear(classes);
 }
-static void LoadParticleClass(ParticleClass *c, json_t *node)
-{
-	memset(c, 0, sizeof *c);
-	c->Mask = colorWhite;
-	char *tmp;
-
-	c->Name = GetString(node, "Name");
-	if (json_find_first_label(node, "Sprites"))
-	{
-		tmp = GetString(node, "Sprites");
-		c->Sprites = PicManagerGetSprites(&gPicManager, tmp);
-		CFREE(tmp);
-	}
-	LoadPic(&c->Pic, node, "Pic");
-	if (json_find_first_label(node, "Mask"))
-	{
-		tmp = GetString(node, "Mask");
-		c->Mask = StrColor(tmp);
-		CFREE(tmp);
-	}
-	if (json_find_first_label(node, "Range"))
-	{
-		LoadInt(&c->RangeLow, node, "Range");
-		c->RangeHigh = c->RangeLow;
-	}
-	if (json_find_first_label(node, "RangeLow"))
-	{
-		LoadInt(&c->RangeLow, node, "RangeLow");
-	}
-	if (json_find_first_label(node, "RangeHigh"))
-	{
-		LoadInt(&c->RangeHigh, node, "RangeHigh");
-	}
-	c->RangeLow = MIN(c->RangeLow, c->RangeHigh);
-	c->RangeHigh = MAX(c->RangeLow, c->RangeHigh);
-	LoadInt(&c->TicksPerFrame, node, "TicksPerFrame");
-	LoadInt(&c->GravityFactor, node, "GravityFactor");
-	LoadBool(&c->HitsWalls, node, "HitsWalls");
-	c->Bounces = true;
-	LoadBool(&c->Bounces, node, "Bounces");
-	c->WallBounces = true;
-	LoadBool(&c->WallBounces, node, "WallBounces");
-}
-
 const ParticleClass *StrParticleClass(
 	const ParticleClasses *classes, const char *name)
 {
@@ -170,189 +231,339 @@ const ParticleClass *StrParticleClass(
 	return NULL;
 }
 
-void ParticlesInit(CArray *particles)
+static void ParticlesGrow(Particles *ps, const int capacity);
+void ParticlesInit(Particles *particles)
 {
-	CArrayInit(particles, sizeof(Particle));
-	CArrayReserve(particles, 256);
+	memset(particles, 0, sizeof *particles);
+	ParticlesGrow(particles, 256);
+	CArrayInit(&particles->TileItems, sizeof(TTileItem));
+	CArrayReserve(&particles->TileItems, 256);
+	CArrayInit(&particles->Indices, sizeof(int));
+	CArrayReserve(&particles->Indices, 256);
+	CArrayInit(&particles->FreeIds, sizeof(int));
+	ParticleBudgetInit(
+		&particles->Budget, ConfigGetInt(&gConfig, "Graphics.MaxParticles"));
 }
-void ParticlesTerminate(CArray *particles)
+static void ParticlesGrow(Particles *ps, const int capacity)
 {
-	for (int i = 0; i < (int)particles->size; i++)
+#define GROW(_arr) CREALLOC(ps->_arr, capacity * sizeof *ps->_arr)
+	GROW(Ids);
+	GROW(Classes);
+	GROW(X);
+	GROW(Y);
+	GROW(Z);
+	GROW(VelX);
+	GROW(VelY);
+	GROW(DZ);
+	GROW(GravityFactors);
+	GROW(Angles);
+	GROW(Spins);
+	GROW(Counts);
+	GROW(Ranges);
+	GROW(StartX);
+	GROW(StartY);
+#undef GROW
+	ps->capacity = capacity;
+}
+static void ParticleRemove(Particles *ps, const int i);
+void ParticlesTerminate(Particles *particles)
+{
+	for (int i = 0; i < particles->size; i++)
 	{
-		Particle *p = CArrayGet(particles, i);
-		if (p->isInUse)
-		{
-			ParticleDestroy(particles, i);
-		}
+		ParticleRemove(particles, i);
 	}
-	CArrayTerminate(particles);
+	CFREE(particles->Ids);
+	CFREE(particles->Classes);
+	CFREE(particles->X);
+	CFREE(particles->Y);
+	CFREE(particles->Z);
+	CFREE(particles->VelX);
+	CFREE(particles->VelY);
+	CFREE(particles->DZ);
+	CFREE(particles->GravityFactors);
+	CFREE(particles->Angles);
+	CFREE(particles->Spins);
+	CFREE(particles->Counts);
+	CFREE(particles->Ranges);
+	CFREE(particles->StartX);
+	CFREE(particles->StartY);
+	CArrayTerminate(&particles->TileItems);
+	CArrayTerminate(&particles->Indices);
+	CArrayTerminate(&particles->FreeIds);
+	memset(particles, 0, sizeof *particles);
 }
 
-static bool ParticleUpdate(Particle *p, const int ticks);
-void ParticlesUpdate(CArray *particles, const int ticks)
+static void ParticlesMove(Particles *ps);
+static void ParticlesFall(Particles *ps);
+static void ParticlesHitWalls(Particles *ps);
+static void ParticlesSpin(Particles *ps);
+static void ParticlesPlaceAndCompact(Particles *ps);
+void ParticlesUpdate(Particles *particles, const int ticks)
 {
-	for (int i = 0; i < (int)particles->size; i++)
+	ParticleBudgetNextFrame(&particles->Budget);
+	const int n = particles->size;
+	memcpy(particles->StartX, particles->X, n * sizeof *particles->X);
+	memcpy(particles->StartY, particles->Y, n * sizeof *particles->Y);
+	for (int i = 0; i < ticks; i++)
 	{
-		Particle *p = CArrayGet(particles, i);
-		if (!p->isInUse)
-		{
-			continue;
-		}
-		if (!ParticleUpdate(p, ticks))
-		{
-			GameEvent e = GameEventNew(GAME_EVENT_PARTICLE_REMOVE);
-			e.u.ParticleRemoveId = i;
-			GameEventsEnqueue(&gGameEvents, e);
-		}
+		ParticlesMove(particles);
+		ParticlesFall(particles);
 	}
+	int *counts = particles->Counts;
+	for (int i = 0; i < n; i++)
+	{
+		counts[i] += ticks;
+	}
+	ParticlesHitWalls(particles);
+	ParticlesSpin(particles);
+	ParticlesPlaceAndCompact(particles);
 }
-
-
-static bool ParticleUpdate(Particle *p, const int ticks)
+// Integrate one tick; simple loops over the packed arrays so that the
+// compiler can vectorise them
+static void ParticlesMove(Particles *ps)
 {
-	p->Count += ticks;
-	const Vec2i startPos = p->Pos;
-	for (int i = 0; i < ticks; i++)
+	const int n = ps->size;
+	int *x = ps->X;
+	int *y = ps->Y;
+	int *z = ps->Z;
+	const int *velX = ps->VelX;
+	const int *velY = ps->VelY;
+	const int *dz = ps->DZ;
+	for (int i = 0; i < n; i++)
+	{
+		x[i] += velX[i];
+	}
+	for (int i = 0; i < n; i++)
 	{
-		p->Pos = Vec2iAdd(p->Pos, p->Vel);
-		p->Z += p->DZ;
-		if (p->Class->GravityFactor != 0)
+		y[i] += velY[i];
+	}
+	for (int i = 0; i < n; i++)
+	{
+		z[i] += dz[i];
+	}
+}
+static void ParticlesFall(Particles *ps)
+{
+	for (int i = 0; i < ps->size; i++)
+	{
+		const int gravity = ps->GravityFactors[i];
+		if (gravity == 0)
 		{
-			if (p->Z <= 0)
+			continue;
+		}
+		if (ps->Z[i] <= 0)
+		{
+			ps->Z[i] = 0;
+			if (ps->Classes[i]->Bounces)
 			{
-				p->Z = 0;
-				if (p->Class->Bounces)
-				{
-					p->DZ = -p->DZ / 2;
-				}
-				else
-				{
-					p->DZ = 0;
-				}
+				ps->DZ[i] = -ps->DZ[i] / 2;
 			}
 			else
 			{
-				p->DZ -= p->Class->GravityFactor;
-			}
-			if (p->DZ == 0 && p->Z == 0)
-			{
-				p->Vel = Vec2iZero();
-				p->Spin = 0;
-				// Set as wreck so that it gets drawn last
-				p->tileItem.flags |= TILEITEM_IS_WRECK;
+				ps->DZ[i] = 0;
 			}
 		}
+		else
+		{
+			ps->DZ[i] -= gravity;
+		}
+		if (ps->DZ[i] == 0 && ps->Z[i] == 0)
+		{
+			ps->VelX[i] = ps->VelY[i] = 0;
+			ps->Spins[i] = 0;
+			// Set as wreck so that it gets drawn last
+			TTileItem *ti = CArrayGet(&ps->TileItems, ps->Ids[i]);
+			ti->flags |= TILEITEM_IS_WRECK;
+		}
 	}
-	if (p->Class->HitsWalls)
+}
+static void ParticlesHitWalls(Particles *ps)
+{
+	for (int i = 0; i < ps->size; i++)
 	{
-		const Vec2i realPos = Vec2iFull2Real(p->Pos);
+		if (!ps->Classes[i]->HitsWalls)
+		{
+			continue;
+		}
+		const Vec2i pos = Vec2iNew(ps->X[i], ps->Y[i]);
+		const Vec2i realPos = Vec2iFull2Real(pos);
 		const bool hitWall =
 			MapIsRealPosIn(&gMap, realPos) && ShootWall(realPos.x, realPos.y);
-		if (hitWall)
+		if (!hitWall)
 		{
-			if (p->Class->WallBounces)
-			{
-				p->Pos = GetWallBounceFullPos(startPos, p->Pos, &p->Vel);
-			}
-			else
-			{
-				p->Vel = Vec2iZero();
-			}
+			continue;
 		}
+		Vec2i vel = Vec2iZero();
+		if (ps->Classes[i]->WallBounces)
+		{
+			vel = Vec2iNew(ps->VelX[i], ps->VelY[i]);
+			const Vec2i bouncePos = GetWallBounceFullPos(
+				Vec2iNew(ps->StartX[i], ps->StartY[i]), pos, &vel);
+			ps->X[i] = bouncePos.x;
+			ps->Y[i] = bouncePos.y;
+		}
+		ps->VelX[i] = vel.x;
+		ps->VelY[i] = vel.y;
 	}
-	const Vec2i realPos = Vec2iFull2Real(p->Pos);
-	if (!MapTryMoveTileItem(&gMap, &p->tileItem, realPos))
-	{
-		// Out of map; destroy
-		return false;
-	}
-
-	// Spin
-	p->Angle += p->Spin;
-	if (p->Angle > 2 * PI)
+}
+static void ParticlesSpin(Particles *ps)
+{
+	const int n = ps->size;
+	double *angles = ps->Angles;
+	const double *spins = ps->Spins;
+	for (int i = 0; i < n; i++)
 	{
-		p->Angle -= PI * 2;
+		double angle = angles[i] + spins[i];
+		if (angle > 2 * PI)
+		{
+			angle -= PI * 2;
+		}
+		if (angle < 0)
+		{
+			angle += PI * 2;
+		}
+		angles[i] = angle;
 	}
-	if (p->Angle < 0)
+}
+// Move tile items, which only touches the map tiles if the particle has
+// crossed into another tile, and remove expired or out-of-map particles,
+// moving the rest down over them
+static void ParticlesPlaceAndCompact(Particles *ps)
+{
+	int w = 0;
+	for (int r = 0; r < ps->size; r++)
 	{
-		p->Angle += PI * 2;
+		TTileItem *ti = CArrayGet(&ps->TileItems, ps->Ids[r]);
+		const Vec2i realPos = Vec2iFull2Real(Vec2iNew(ps->X[r], ps->Y[r]));
+		if (ps->Counts[r] > ps->Ranges[r] ||
+			!MapTryMoveTileItem(&gMap, ti, realPos))
+		{
+			ParticleRemove(ps, r);
+			continue;
+		}
+		if (r != w)
+		{
+#define MOVE(_arr) ps->_arr[w] = ps->_arr[r]
+			MOVE(Ids);
+			MOVE(Classes);
+			MOVE(X);
+			MOVE(Y);
+			MOVE(Z);
+			MOVE(VelX);
+			MOVE(VelY);
+			MOVE(DZ);
+			MOVE(GravityFactors);
+			MOVE(Angles);
+			MOVE(Spins);
+			MOVE(Counts);
+			MOVE(Ranges);
+#undef MOVE
+			*(int *)CArrayGet(&ps->Indices, ps->Ids[w]) = w;
+		}
+		w++;
 	}
-
-	return p->Count <= p->Range;
+	ps->size = w;
 }
 
-static void DrawParticle(const Vec2i pos, const TileItemDrawFuncData *data);
-int ParticleAdd(CArray *particles, const AddParticle add)
+static void DrawParticle(
+	GraphicsDevice *g, const Vec2i pos, const TileItemDrawFuncData *data);
+int ParticleAdd(Particles *particles, const AddParticle add)
 {
-	// Find an empty slot in list
-	Particle *p = NULL;
-	int i;
-	for (i = 0; i < (int)particles->size; i++)
+	// Roll the range first so that the random sequence doesn't depend on
+	// what the budget allows
+	const int range = RAND_INT(add.Class->RangeLow, add.Class->RangeHigh);
+	if (!ParticleBudgetTrySpawn(
+		&particles->Budget, add.Class->Priority,
+		Vec2iFull2Real(add.FullPos), particles->size))
 	{
-		Particle *pSlot = CArrayGet(particles, i);
-		if (!pSlot->isInUse)
-		{
-			p = pSlot;
-			break;
-		}
+		return -1;
+	}
+
+	// Reuse a free ID, otherwise add a new one
+	int id;
+	if (particles->FreeIds.size > 0)
+	{
+		const int last = (int)particles->FreeIds.size - 1;
+		id = *(int *)CArrayGet(&particles->FreeIds, last);
+		CArrayDelete(&particles->FreeIds, last);
+	}
+	else
+	{
+		id = (int)particles->TileItems.size;
+		TTileItem ti;
+		memset(&ti, 0, sizeof ti);
+		CArrayPushBack(&particles->TileItems, &ti);
+		const int index = -1;
+		CArrayPushBack(&particles->Indices, &index);
+	}
+	if (particles->size == particles->capacity)
+	{
+		ParticlesGrow(particles, particles->capacity * 2);
 	}
-	// If no empty slots, add a new one
-	if (p == NULL)
-	{
-		Particle pNew;
-		memset(&pNew, 0, sizeof pNew);
-		CArrayPushBack(particles, &pNew);
-		i = (int)particles->size - 1;
-		p = CArrayGet(particles, i);
-	}
-	memset(p, 0, sizeof *p);
-	p->Class = add.Class;
-	p->Pos = add.FullPos;
-	p->Z = add.Z;
-	p->Angle = add.Angle;
-	p->Vel = add.Vel;
-	p->DZ = add.DZ;
-	p->Spin = add.Spin;
-	p->Range = RAND_INT(add.Class->RangeLow, add.Class->RangeHigh);
-	p->isInUse = true;
-	p->tileItem.x = p->tileItem.y = -1;
-	p->tileItem.kind = KIND_PARTICLE;
-	p->tileItem.id = i;
-	p->tileItem.drawFunc = DrawParticle;
-	p->tileItem.drawData.MobObjId = i;
-	MapTryMoveTileItem(&gMap, &p->tileItem, Vec2iFull2Real(add.FullPos));
-	return i;
+	const int i = particles->size;
+	particles->size++;
+	particles->Ids[i] = id;
+	particles->Classes[i] = add.Class;
+	particles->X[i] = add.FullPos.x;
+	particles->Y[i] = add.FullPos.y;
+	particles->Z[i] = add.Z;
+	particles->VelX[i] = add.Vel.x;
+	particles->VelY[i] = add.Vel.y;
+	particles->DZ[i] = add.DZ;
+	particles->GravityFactors[i] = add.Class->GravityFactor;
+	particles->Angles[i] = add.Angle;
+	particles->Spins[i] = add.Spin;
+	particles->Counts[i] = 0;
+	particles->Ranges[i] = range;
+	*(int *)CArrayGet(&particles->Indices, id) = i;
+
+	TTileItem *ti = CArrayGet(&particles->TileItems, id);
+	memset(ti, 0, sizeof *ti);
+	ti->x = ti->y = -1;
+	ti->kind = KIND_PARTICLE;
+	ti->id = id;
+	ti->drawFunc = DrawParticle;
+	ti->drawData.MobObjId = id;
+	MapTryMoveTileItem(&gMap, ti, Vec2iFull2Real(add.FullPos));
+	return id;
 }
-void ParticleDestroy(CArray *particles, const int id)
+// Remove a particle's tile item and free its ID; its slot in the packed
+// arrays is reused by the caller
+static void ParticleRemove(Particles *ps, const int i)
 {
-	Particle *p = CArrayGet(particles, id);
-	CASSERT(p->isInUse, "Destroying not-in-use particle");
-	MapRemoveTileItem(&gMap, &p->tileItem);
-	p->isInUse = false;
+	const int id = ps->Ids[i];
+	int *index = CArrayGet(&ps->Indices, id);
+	CASSERT(*index == i, "Removing not-in-use particle");
+	MapRemoveTileItem(&gMap, CArrayGet(&ps->TileItems, id));
+	*index = -1;
+	CArrayPushBack(&ps->FreeIds, &id);
 }
 
-static void DrawParticle(const Vec2i pos, const TileItemDrawFuncData *data)
+static void DrawParticle(
+	GraphicsDevice *g, const Vec2i pos, const TileItemDrawFuncData *data)
 {
-	const Particle *p = CArrayGet(&gParticles, data->MobObjId);
-	CASSERT(p->isInUse, "Cannot draw non-existent particle");
+	const Particles *ps = &gParticles;
+	const int i = *(const int *)CArrayGet(&ps->Indices, data->MobObjId);
+	CASSERT(i >= 0, "Cannot draw non-existent particle");
+	const ParticleClass *c = ps->Classes[i];
 	const Pic *pic;
-	if (p->Class->Sprites)
+	if (c->Sprites)
 	{
-		int frame = (int)RadiansToDirection(p->Angle);
-		if (p->Class->TicksPerFrame > 0)
+		int frame = (int)RadiansToDirection(ps->Angles[i]);
+		if (c->TicksPerFrame > 0)
 		{
 			frame = MIN(
-				p->Count / p->Class->TicksPerFrame,
-				(int)p->Class->Sprites->pics.size - 1);
+				ps->Counts[i] / c->TicksPerFrame,
+				(int)c->Sprites->pics.size - 1);
 		}
-		pic = CArrayGet(&p->Class->Sprites->pics, frame);
+		pic = CArrayGet(&c->Sprites->pics, frame);
 	}
 	else
 	{
-		pic = p->Class->Pic;
+		pic = c->Pic;
 	}
 	CASSERT(pic != NULL, "particle picture not found");
 	Vec2i picPos = Vec2iMinus(pos, Vec2iScaleDiv(pic->size, 2));
-	picPos.y -= p->Z / Z_FACTOR;
-	BlitMasked(&gGraphicsDevice, pic, picPos, p->Class->Mask, true);
+	picPos.y -= ps->Z[i] / Z_FACTOR;
+	BlitMasked(g, pic, picPos, c->Mask, true);
 }
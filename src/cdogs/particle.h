@@ -29,6 +29,7 @@
 
 #include <json/json.h>
 
+#include "particle_budget.h"
 #include "pic.h"
 #include "tile.h"
 
@@ -46,6 +47,7 @@ typedef struct
 	bool HitsWalls;
 	bool Bounces;
 	bool WallBounces;
+	ParticlePriority Priority;
 } ParticleClass;
 typedef struct
 {
@@ -54,22 +56,42 @@ typedef struct
 } ParticleClasses;
 extern ParticleClasses gParticleClasses;
 
+// Particles are stored as separate arrays per field, packed into
+// [0, size) so that they can be updated in simple loops.
+// Particles that expire are compacted away at the end of each update, so
+// their index changes; refer to them by ID, which stays the same for the
+// life of the particle and is used by the map tiles.
 typedef struct
 {
-	const ParticleClass *Class;
+	int size;
+	int capacity;
+	int *Ids;
+	const ParticleClass **Classes;
 	// Coordinates are in full
-	Vec2i Pos;
-	int Z;
-	double Angle;
-	Vec2i Vel;
-	int DZ;
-	double Spin;
-	int Count;
-	int Range;
-	TTileItem tileItem;
-	bool isInUse;
-} Particle;
-extern CArray gParticles;	// of Particle
+	int *X;
+	int *Y;
+	int *Z;
+	int *VelX;
+	int *VelY;
+	int *DZ;
+	// Copied from the class so that integration doesn't need to look it up
+	int *GravityFactors;
+	double *Angles;
+	double *Spins;
+	int *Counts;
+	int *Ranges;
+	// Positions at the start of the update, for wall bounces
+	int *StartX;
+	int *StartY;
+
+	// Indexed by ID
+	CArray TileItems;	// of TTileItem
+	CArray Indices;	// of int; index into the arrays above, or -1 if free
+	CArray FreeIds;	// of int
+
+	ParticleBudget Budget;
+} Particles;
+extern Particles gParticles;
 
 typedef struct
 {
@@ -83,15 +105,16 @@ typedef struct
 } AddParticle;
 
 void ParticleClassesInit(ParticleClasses *classes, const char *filename);
-void ParticleClassesLoadJSON(CArray *classes, json_t *root);
+// Load particle classes from a particles.json file, streamed
+bool ParticleClassesLoadFile(CArray *classes, const char *path);
 void ParticleClassesTerminate(ParticleClasses *classes);
 void ParticleClassesClear(CArray *classes);
 const ParticleClass *StrParticleClass(
 	const ParticleClasses *classes, const char *name);
 
-void ParticlesInit(CArray *particles);
-void ParticlesTerminate(CArray *particles);
-void ParticlesUpdate(CArray *particles, const int ticks);
+void ParticlesInit(Particles *particles);
+void ParticlesTerminate(Particles *particles);
+void ParticlesUpdate(Particles *particles, const int ticks);
 
-int ParticleAdd(CArray *particles, const AddParticle add);
-void ParticleDestroy(CArray *particles, const int id);
+// Returns the new particle's ID, or -1 if it didn't fit in the budget
+int ParticleAdd(Particles *particles, const AddParticle add);
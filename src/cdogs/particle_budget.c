@@ -0,0 +1,124 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "particle_budget.h"
+
+#include <string.h>
+
+#include "utils.h"
+
+
+ParticlePriority StrParticlePriority(const char *s)
+{
+	S2T(PARTICLE_PRIORITY_LOW, "Low");
+	S2T(PARTICLE_PRIORITY_NORMAL, "Normal");
+	S2T(PARTICLE_PRIORITY_HIGH, "High");
+	return PARTICLE_PRIORITY_NORMAL;
+}
+
+void ParticleBudgetInit(ParticleBudget *b, const int cap)
+{
+	memset(b, 0, sizeof *b);
+	b->Cap = cap;
+}
+
+void ParticleBudgetClearViews(ParticleBudget *b)
+{
+	b->NumViews = 0;
+}
+void ParticleBudgetAddView(ParticleBudget *b, const Rect2i view)
+{
+	CASSERT(b->NumViews < PARTICLE_BUDGET_MAX_VIEWS, "too many views");
+	b->Views[b->NumViews] = view;
+	b->NumViews++;
+}
+
+void ParticleBudgetNextFrame(ParticleBudget *b)
+{
+	b->LastSpawned = b->Spawned;
+	b->LastCulled = b->Culled;
+	b->Spawned = 0;
+	b->Culled = 0;
+}
+
+static bool IsNearViews(const ParticleBudget *b, const Vec2i realPos);
+bool ParticleBudgetTrySpawn(
+	ParticleBudget *b, const ParticlePriority priority, const Vec2i realPos,
+	const int numParticles)
+{
+	bool spawn = true;
+	if (priority == PARTICLE_PRIORITY_LOW && !IsNearViews(b, realPos))
+	{
+		spawn = false;
+	}
+	else if (b->Cap > 0)
+	{
+		// Each priority can fill the budget up to its own limit; in the last
+		// quarter before that, only every other spawn is kept
+		static const int limitQuarters[] = { 2, 3, 4 };
+		const int limit = b->Cap * limitQuarters[priority] / 4;
+		if (numParticles >= limit)
+		{
+			spawn = false;
+		}
+		else if (numParticles >= limit * 3 / 4)
+		{
+			b->thinCounter++;
+			spawn = (b->thinCounter & 1) == 0;
+		}
+	}
+	if (spawn)
+	{
+		b->Spawned++;
+	}
+	else
+	{
+		b->Culled++;
+	}
+	return spawn;
+}
+// If there are no views, e.g. before the first frame is drawn, nothing is
+// culled by position
+static bool IsNearViews(const ParticleBudget *b, const Vec2i realPos)
+{
+	if (b->NumViews == 0)
+	{
+		return true;
+	}
+	for (int i = 0; i < b->NumViews; i++)
+	{
+		const Rect2i *v = &b->Views[i];
+		if (realPos.x >= v->Pos.x - PARTICLE_BUDGET_VIEW_MARGIN &&
+			realPos.x < v->Pos.x + v->Size.x + PARTICLE_BUDGET_VIEW_MARGIN &&
+			realPos.y >= v->Pos.y - PARTICLE_BUDGET_VIEW_MARGIN &&
+			realPos.y < v->Pos.y + v->Size.y + PARTICLE_BUDGET_VIEW_MARGIN)
+		{
+			return true;
+		}
+	}
+	return false;
+}
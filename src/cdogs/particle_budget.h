@@ -0,0 +1,72 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include "vector.h"
+
+// Split screen views to cull against
+#define PARTICLE_BUDGET_MAX_VIEWS 4
+// How far outside the views low priority particles are still spawned
+#define PARTICLE_BUDGET_VIEW_MARGIN 32
+
+// How important a particle class is to see; as the budget fills up, lower
+// priority spawns are thinned out and then skipped before higher ones
+typedef enum
+{
+	PARTICLE_PRIORITY_LOW,	// cosmetic, e.g. blood, brass
+	PARTICLE_PRIORITY_NORMAL,
+	PARTICLE_PRIORITY_HIGH
+} ParticlePriority;
+ParticlePriority StrParticlePriority(const char *s);
+
+typedef struct
+{
+	// Maximum number of live particles; 0 for no limit
+	int Cap;
+	// Areas seen by the camera last frame, in real coordinates
+	Rect2i Views[PARTICLE_BUDGET_MAX_VIEWS];
+	int NumViews;
+	// Spawns for the frame being simulated, and for the last whole frame
+	int Spawned;
+	int Culled;
+	int LastSpawned;
+	int LastCulled;
+	int thinCounter;
+} ParticleBudget;
+
+void ParticleBudgetInit(ParticleBudget *b, const int cap);
+void ParticleBudgetClearViews(ParticleBudget *b);
+void ParticleBudgetAddView(ParticleBudget *b, const Rect2i view);
+// Start counting spawns for a new frame
+void ParticleBudgetNextFrame(ParticleBudget *b);
+// Whether to spawn a particle, given the current number of live particles
+bool ParticleBudgetTrySpawn(
+	ParticleBudget *b, const ParticlePriority priority, const Vec2i realPos,
+	const int numParticles);
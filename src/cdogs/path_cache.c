@@ -40,7 +40,7 @@ static CachedPath CachedPathCopy(CachedPath *c)
 {
 	CachedPath copy;
 	memcpy(&copy, c, sizeof *c);
-	(*copy.refs)++;
+	SDL_AtomicIncRef(copy.refs);
 	return copy;
 }
 void CachedPathDestroy(CachedPath *c)
@@ -49,9 +49,8 @@ void CachedPathDestroy(CachedPath *c)
 	{
 		return;
 	}
-	(*c->refs)--;
-	CASSERT(*c->refs >= 0, "out of sync ref count");
-	if (*c->refs == 0)
+	CASSERT(SDL_AtomicGet(c->refs) > 0, "out of sync ref count");
+	if (SDL_AtomicDecRef(c->refs))
 	{
 		ASPathDestroy(c->Path);
 		CFREE(c->refs);
@@ -70,11 +69,20 @@ void PathCacheInit(PathCache *pc, Map *m)
 	CArrayInit(&pc->paths, sizeof(CachedPath));
 	pc->head = 0;
 	pc->map = m;
+	pc->frozen = false;
+	CArrayInit(&pc->pending, sizeof(CachedPath));
+	pc->pendingMutex = SDL_CreateMutex();
 }
 void PathCacheTerminate(PathCache *pc)
 {
 	PathCacheClear(pc);
 	CArrayTerminate(&pc->paths);
+	CArrayTerminate(&pc->pending);
+	if (pc->pendingMutex != NULL)
+	{
+		SDL_DestroyMutex(pc->pendingMutex);
+		pc->pendingMutex = NULL;
+	}
 }
 
 void PathCacheClear(PathCache *pc)
@@ -86,6 +94,45 @@ void PathCacheClear(PathCache *pc)
 	pc->head = 0;
 }
 
+void PathCacheFreeze(PathCache *pc)
+{
+	CASSERT(!pc->frozen, "path cache already frozen");
+	pc->frozen = true;
+}
+static void PathCacheAdd(PathCache *pc, CachedPath *cp);
+static int ComparePendingPaths(const void *v1, const void *v2);
+void PathCacheThaw(PathCache *pc)
+{
+	CASSERT(pc->frozen, "path cache not frozen");
+	pc->frozen = false;
+	qsort(
+		pc->pending.data, pc->pending.size, pc->pending.elemSize,
+		ComparePendingPaths);
+	CA_FOREACH(CachedPath, cp, pc->pending)
+		PathCacheAdd(pc, cp);
+	CA_FOREACH_END()
+	CArrayClear(&pc->pending);
+}
+static int ComparePendingPaths(const void *v1, const void *v2)
+{
+	const CachedPath *c1 = v1;
+	const CachedPath *c2 = v2;
+	const int keys1[] = {
+		c1->from.y, c1->from.x, c1->to.y, c1->to.x, c1->ignoreObjects
+	};
+	const int keys2[] = {
+		c2->from.y, c2->from.x, c2->to.y, c2->to.x, c2->ignoreObjects
+	};
+	for (int i = 0; i < (int)(sizeof keys1 / sizeof keys1[0]); i++)
+	{
+		if (keys1[i] != keys2[i])
+		{
+			return keys1[i] < keys2[i] ? -1 : 1;
+		}
+	}
+	return 0;
+}
+
 typedef struct
 {
 	Map *Map;
@@ -106,6 +153,7 @@ CachedPath PathCacheCreate(
 		from.x, from.y, to.x, to.y);
 
 	// Search through existing cache for path
+	// Note: while frozen, paths is not modified so this is safe to read
 	CA_FOREACH(CachedPath, c, pc->paths)
 		if (CachedPathMatches(c, from, to))
 		{
@@ -123,35 +171,57 @@ CachedPath PathCacheCreate(
 	ac.IsTileOk = ignoreObjects ? IsTileWalkable : IsTileWalkableAroundObjects;
 	cp.Path = ASPathCreate(&cPathNodeSource, &ac, &from, &to);
 	CMALLOC(cp.refs, sizeof *cp.refs);
-	(*cp.refs) = 1;
+	SDL_AtomicSet(cp.refs, 1);
 	cp.from = from;
 	cp.to = to;
+	cp.ignoreObjects = ignoreObjects;
 	// Cache the path, optionally
 	if (cache)
 	{
-		(*cp.refs)++;
-		// Add to the cache if we are under the max size
-		if ((int)pc->paths.size < PATH_CACHE_MAX)
+		SDL_AtomicIncRef(cp.refs);
+		if (pc->frozen)
 		{
-			CArrayPushBack(&pc->paths, &cp);
+			SDL_LockMutex(pc->pendingMutex);
+			CArrayPushBack(&pc->pending, &cp);
+			SDL_UnlockMutex(pc->pendingMutex);
 		}
 		else
 		{
-			// Replace the oldest cached path with this one
-			CachedPath *oldest = CArrayGet(&pc->paths, pc->head);
-			CachedPathDestroy(oldest);
-			memcpy(oldest, &cp, sizeof cp);
-			// Move the head
-			pc->head++;
-			if (pc->head == pc->paths.size)
-			{
-				pc->head = 0;
-			}
+			PathCacheAdd(pc, &cp);
 		}
-		debug(D_NORMAL, "Cached pathfind (%d paths)\n", (int)pc->paths.size);
 	}
 	return cp;
 }
+static void PathCacheAdd(PathCache *pc, CachedPath *cp)
+{
+	// Paths found by different threads while frozen may be the same
+	CA_FOREACH(const CachedPath, c, pc->paths)
+		if (CachedPathMatches(c, cp->from, cp->to))
+		{
+			CachedPathDestroy(cp);
+			return;
+		}
+	CA_FOREACH_END()
+	// Add to the cache if we are under the max size
+	if ((int)pc->paths.size < PATH_CACHE_MAX)
+	{
+		CArrayPushBack(&pc->paths, cp);
+	}
+	else
+	{
+		// Replace the oldest cached path with this one
+		CachedPath *oldest = CArrayGet(&pc->paths, pc->head);
+		CachedPathDestroy(oldest);
+		memcpy(oldest, cp, sizeof *cp);
+		// Move the head
+		pc->head++;
+		if (pc->head == pc->paths.size)
+		{
+			pc->head = 0;
+		}
+	}
+	debug(D_NORMAL, "Cached pathfind (%d paths)\n", (int)pc->paths.size);
+}
 
 static void AddTileNeighbors(
 	ASNeighborList neighbors, void *node, void *context)
@@ -27,6 +27,8 @@
 */
 #pragma once
 
+#include <SDL_thread.h>
+
 #include "AStar.h"
 #include "c_array.h"
 #include "map.h"
@@ -34,12 +36,15 @@
 
 // Ref-counted path reference
 // Once refs reaches zero, can then free the path
+// Refs are atomic so that references can be taken and released from
+// different threads
 typedef struct
 {
 	ASPath Path;
-	int *refs;
+	SDL_atomic_t *refs;
 	Vec2i from;
 	Vec2i to;
+	bool ignoreObjects;
 } CachedPath;
 
 typedef struct
@@ -47,6 +52,10 @@ typedef struct
 	CArray paths;	// of CachedPath
 	size_t head;
 	Map *map;
+	// See PathCacheFreeze
+	bool frozen;
+	CArray pending;	// of CachedPath
+	SDL_mutex *pendingMutex;
 } PathCache;
 
 // Cache of A* paths so similar paths don't need to be recalculated
@@ -64,6 +73,13 @@ void PathCacheTerminate(PathCache *pc);
 // e.g. keys
 void PathCacheClear(PathCache *pc);
 
+// Freeze the cache so that paths can be created from multiple threads.
+// While frozen, lookups only see paths cached before freezing, and new
+// paths are held back; thawing adds them in a fixed order, so that what is
+// cached doesn't depend on which thread finished first.
+void PathCacheFreeze(PathCache *pc);
+void PathCacheThaw(PathCache *pc);
+
 CachedPath PathCacheCreate(
 	PathCache *pc, Vec2i from, Vec2i to,
 	const bool ignoreObjects, const bool cache);
\ No newline at end of file
@@ -59,27 +59,37 @@ void PicLoad(
 	p->size = size;
 	p->offset = Vec2iZero();
 	CMALLOC(p->Data, size.x * size.y * sizeof *((Pic *)0)->Data);
-	// Manually copy the pixels and replace the alpha component,
-	// since our gfx device format has no alpha
-	int srcI = offset.y*image->w + offset.x;
-	for (int i = 0; i < size.x * size.y; i++, srcI++)
+	// Frames at the edge of a spritesheet may be partly outside the image
+	const int w = CLAMP(image->w - offset.x, 0, size.x);
+	const int h = CLAMP(image->h - offset.y, 0, size.y);
+	memset(p->Data, 0, size.x * size.y * sizeof *p->Data);
+	const SDL_PixelFormat *f = gGraphicsDevice.Format;
+	const bool isDeviceFormat = image->format->format == f->format;
+	for (int y = 0; y < h; y++)
 	{
-		const Uint32 pixel = ((Uint32 *)image->pixels)[srcI];
-		color_t c;
-		SDL_GetRGBA(pixel, image->format, &c.r, &c.g, &c.b, &c.a);
-		// If completely transparent, replace rgb with black (0) too
-		// This is because transparency blitting checks entire pixel
-		if (c.a == 0)
+		const Uint32 *src = (const Uint32 *)(
+			(const Uint8 *)image->pixels + (offset.y + y) * image->pitch) +
+			offset.x;
+		Uint32 *dst = p->Data + y * size.x;
+		if (isDeviceFormat)
 		{
-			p->Data[i] = 0;
-		}
-		else
-		{
-			p->Data[i] = COLOR2PIXEL(c);
+			// Fast path: pixels are already in the device format, so only
+			// transparent pixels need replacing
+			for (int x = 0; x < w; x++)
+			{
+				// If completely transparent, replace rgb with black (0) too
+				// This is because transparency blitting checks entire pixel
+				dst[x] = (src[x] & f->Amask) ? src[x] : 0;
+			}
+			continue;
 		}
-		if ((i + 1) % size.x == 0)
+		// Manually copy the pixels and replace the alpha component,
+		// since our gfx device format has no alpha
+		for (int x = 0; x < w; x++)
 		{
-			srcI += image->w - size.x;
+			color_t c;
+			SDL_GetRGBA(src[x], image->format, &c.r, &c.g, &c.b, &c.a);
+			dst[x] = c.a == 0 ? 0 : COLOR2PIXEL(c);
 		}
 	}
 }
@@ -31,8 +31,10 @@
 
 #include <tinydir/tinydir.h>
 
+#include "char_pic_cache.h"
 #include "files.h"
 #include "log.h"
+#include "thread_pool.h"
 
 PicManager gPicManager;
 
@@ -50,144 +52,255 @@ void PicManagerInit(PicManager *pm)
 	CArrayInit(&pm->exitStyleNames, sizeof(char *));
 	CArrayInit(&pm->doorStyleNames, sizeof(char *));
 	CArrayInit(&pm->keyStyleNames, sizeof(char *));
+	pm->decodeLock = SDL_CreateMutex();
 }
 
 static NamedPic *AddNamedPic(map_t pics, const char *name, const Pic *p);
 static NamedSprites *AddNamedSprites(map_t sprites, const char *name);
 static void AfterAdd(PicManager *pm);
-static void PicManagerAdd(
-	map_t pics, map_t sprites, const char *name, SDL_Surface *imageIn)
-{
-	char buf[CDOGS_FILENAME_MAX];
-	const char *dot = strrchr(name, '.');
+
+// Get the name of a pic from its file name, i.e. without extension.
+// Special case: if the file name is in the form foobar_WxH.ext,
+// this is a spritesheet where each sprite is W wide by H high;
+// the name is then foobar and the sprite size is returned.
+// Otherwise returns a zero size.
+static Vec2i GetPicName(char *name)
+{
+	char *dot = strrchr(name, '.');
 	if (dot)
 	{
-		strncpy(buf, name, dot - name);
-		buf[dot - name] = '\0';
-	}
-	else
-	{
-		strcpy(buf, name);
+		*dot = '\0';
 	}
 	// TODO: check if name already exists
 	// TODO: use efficient data structure like trie
-	// Special case: if the file name is in the form foobar_WxH.ext,
-	// this is a spritesheet where each sprite is W wide by H high
-	// Load multiple images from this single sheet
-	Vec2i size = Vec2iNew(imageIn->w, imageIn->h);
-	bool isSpritesheet = false;
-	char *underscore = strrchr(buf, '_');
-	const char *x = strrchr(buf, 'x');
+	Vec2i size = Vec2iZero();
+	char *underscore = strrchr(name, '_');
+	const char *x = strrchr(name, 'x');
 	if (underscore != NULL && x != NULL &&
-		underscore + 1 < x && x + 1 < buf + strlen(buf))
+		underscore + 1 < x && x + 1 < name + strlen(name) &&
+		sscanf(underscore, "_%dx%d", &size.x, &size.y) == 2)
 	{
-		if (sscanf(underscore, "_%dx%d", &size.x, &size.y) != 2)
-		{
-			size = Vec2iNew(imageIn->w, imageIn->h);
-		}
-		else
-		{
-			*underscore = '\0';
-			isSpritesheet = true;
-		}
+		*underscore = '\0';
 	}
-	NamedSprites *nsp = NULL;
-	NamedPic *np = NULL;
-	if (isSpritesheet)
+	else
 	{
-		nsp = AddNamedSprites(sprites, buf);
+		size = Vec2iZero();
 	}
-	else
+	return size;
+}
+static void ConvertCharPic(Pic *pic);
+// Decode an image file into pics of a certain size, or one pic of the
+// whole image if size is zero
+static void DecodePics(
+	CArray *pics, const char *path, const Vec2i sizeIn, const bool isChar)
+{
+	SDL_RWops *rwops = SDL_RWFromFile(path, "rb");
+	if (rwops == NULL)
 	{
-		np = AddNamedPic(pics, buf, NULL);
+		return;
+	}
+	SDL_Surface *imageIn = NULL;
+	if (IMG_isPNG(rwops))
+	{
+		imageIn = IMG_Load_RW(rwops, 0);
 	}
-	// Use 32-bit image
+	rwops->close(rwops);
+	if (imageIn == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "Cannot load image %s: %s",
+			path, IMG_GetError());
+		return;
+	}
+	const Vec2i size = Vec2iIsZero(sizeIn) ?
+		Vec2iNew(imageIn->w, imageIn->h) : sizeIn;
+	// Convert the whole image to the device format, so that pics can be
+	// copied straight out of it
 	SDL_Surface *image = SDL_ConvertSurfaceFormat(
-		imageIn, SDL_PIXELFORMAT_RGBA8888, 0);
+		imageIn, gGraphicsDevice.Format->format, 0);
 	SDL_FreeSurface(imageIn);
+	if (image == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "Cannot convert image %s: %s",
+			path, SDL_GetError());
+		return;
+	}
 	SDL_LockSurface(image);
 	Vec2i offset;
 	for (offset.y = 0; offset.y < image->h; offset.y += size.y)
 	{
 		for (offset.x = 0; offset.x < image->w; offset.x += size.x)
 		{
-			Pic *pic;
-			if (isSpritesheet)
-			{
-				Pic p;
-				CArrayPushBack(&nsp->pics, &p);
-				pic = CArrayGet(&nsp->pics, nsp->pics.size - 1);
-			}
-			else
-			{
-				pic = &np->pic;
-			}
-			PicLoad(pic, size, offset, image);
-
-			if (strncmp("chars/", buf, strlen("chars/")) == 0)
+			Pic pic;
+			PicLoad(&pic, size, offset, image);
+			if (isChar)
 			{
 				// Convert char pics to multichannel version
-				for (int i = 0; i < pic->size.x * pic->size.y; i++)
-				{
-					color_t c = PIXEL2COLOR(pic->Data[i]);
-					// Don't bother if the alpha has already been modified; it
-					// means we have already processed this pixel
-					if (c.a != 255)
-					{
-						continue;
-					}
-					const uint8_t value = MAX(MAX(c.r, c.g), c.b);
-					if (abs((int)c.r - c.g) < 5 && abs((int)c.g - c.b) < 5)
-					{
-						// don't convert greyscale colours
-					}
-					else if ((c.g < 5 && c.b < 5) ||
-						(abs((int)c.g - c.b) < 5 && c.r > 250))
-					{
-						// Skin
-						c.r = c.g = c.b = value;
-						c.a = 254;
-					}
-					else if ((c.r < 5 && c.b < 5) ||
-						(abs((int)c.r - c.b) < 5 && c.g > 250))
-					{
-						// Hair
-						c.r = c.g = c.b = value;
-						c.a = 250;
-					}
-					else if ((c.r < 5 && c.g < 5) ||
-						(abs((int)c.r - c.g) < 5 && c.b > 250))
-					{
-						// Arms
-						c.r = c.g = c.b = value;
-						c.a = 253;
-					}
-					else if (c.b < 5 || (c.r > 250 && c.g > 250))
-					{
-						// Body
-						c.r = c.g = c.b = value;
-						c.a = 252;
-					}
-					else if (c.r < 5 || (c.g > 250 && c.b > 250))
-					{
-						// Legs
-						c.r = c.g = c.b = value;
-						c.a = 251;
-					}
-					pic->Data[i] = COLOR2PIXEL(c);
-				}
+				ConvertCharPic(&pic);
 			}
+			CArrayPushBack(pics, &pic);
 		}
 	}
 	SDL_UnlockSurface(image);
 	SDL_FreeSurface(image);
+}
+static void ConvertCharPic(Pic *pic)
+{
+	for (int i = 0; i < pic->size.x * pic->size.y; i++)
+	{
+		color_t c = PIXEL2COLOR(pic->Data[i]);
+		// Don't bother if the alpha has already been modified; it
+		// means we have already processed this pixel
+		if (c.a != 255)
+		{
+			continue;
+		}
+		const uint8_t value = MAX(MAX(c.r, c.g), c.b);
+		if (abs((int)c.r - c.g) < 5 && abs((int)c.g - c.b) < 5)
+		{
+			// don't convert greyscale colours
+		}
+		else if ((c.g < 5 && c.b < 5) ||
+			(abs((int)c.g - c.b) < 5 && c.r > 250))
+		{
+			// Skin
+			c.r = c.g = c.b = value;
+			c.a = 254;
+		}
+		else if ((c.r < 5 && c.b < 5) ||
+			(abs((int)c.r - c.b) < 5 && c.g > 250))
+		{
+			// Hair
+			c.r = c.g = c.b = value;
+			c.a = 250;
+		}
+		else if ((c.r < 5 && c.g < 5) ||
+			(abs((int)c.r - c.g) < 5 && c.b > 250))
+		{
+			// Arms
+			c.r = c.g = c.b = value;
+			c.a = 253;
+		}
+		else if (c.b < 5 || (c.r > 250 && c.g > 250))
+		{
+			// Body
+			c.r = c.g = c.b = value;
+			c.a = 252;
+		}
+		else if (c.r < 5 || (c.g > 250 && c.b > 250))
+		{
+			// Legs
+			c.r = c.g = c.b = value;
+			c.a = 251;
+		}
+		pic->Data[i] = COLOR2PIXEL(c);
+	}
+}
+static bool IsCharPicName(const char *name)
+{
+	return strncmp("chars/", name, strlen("chars/")) == 0;
+}
 
-	AfterAdd(&gPicManager);
+static void DecodeNamedPicPath(NamedPic *n)
+{
+	CArray pics;
+	CArrayInit(&pics, sizeof(Pic));
+	DecodePics(&pics, n->path, Vec2iZero(), IsCharPicName(n->name));
+	if (pics.size > 0)
+	{
+		n->pic = *(Pic *)CArrayGet(&pics, 0);
+	}
+	CArrayTerminate(&pics);
+	char *path = n->path;
+	SDL_AtomicSetPtr((void **)&n->path, NULL);
+	CFREE(path);
+}
+static void DecodeNamedSpritesPath(NamedSprites *ns)
+{
+	DecodePics(&ns->pics, ns->path, ns->spriteSize, IsCharPicName(ns->name));
+	char *path = ns->path;
+	SDL_AtomicSetPtr((void **)&ns->path, NULL);
+	CFREE(path);
 }
 
+// In DecodeOnUse mode, pics are only decoded on first use.
+// Use may come from drawing threads, so decoding is serialised.
+// Otherwise all pics are decoded at load, and this returns without locking.
+static void DecodeNamedPic(const PicManager *pm, NamedPic *n)
+{
+	if (SDL_AtomicGetPtr((void **)&n->path) == NULL)
+	{
+		return;
+	}
+	SDL_LockMutex(pm->decodeLock);
+	if (n->path != NULL)
+	{
+		DecodeNamedPicPath(n);
+	}
+	SDL_UnlockMutex(pm->decodeLock);
+}
+static void DecodeNamedSprites(const PicManager *pm, NamedSprites *ns)
+{
+	if (SDL_AtomicGetPtr((void **)&ns->path) == NULL)
+	{
+		return;
+	}
+	SDL_LockMutex(pm->decodeLock);
+	if (ns->path != NULL)
+	{
+		DecodeNamedSpritesPath(ns);
+	}
+	SDL_UnlockMutex(pm->decodeLock);
+}
+
+// A pic registered by a directory scan, still to be decoded;
+// exactly one of the two is set
+typedef struct
+{
+	NamedPic *Pic;
+	NamedSprites *Sprites;
+} PicDecodeTask;
+static void PicDecodeTaskRun(void *data, const int index)
+{
+	// Each task owns a different pic, so these can run in parallel
+	PicDecodeTask *t = CArrayGet(data, index);
+	if (t->Pic != NULL)
+	{
+		DecodeNamedPicPath(t->Pic);
+	}
+	else
+	{
+		DecodeNamedSpritesPath(t->Sprites);
+	}
+}
+
+static bool IsPNGFile(const char *path)
+{
+	const char *ext = StrGetFileExt(path);
+	return strcmp(ext, "png") == 0 || strcmp(ext, "PNG") == 0;
+}
+static void LoadDir(
+	CArray *tasks, const char *path, const char *prefix,
+	map_t pics, map_t sprites);
 void PicManagerLoadDir(
 	PicManager *pm, const char *path, const char *prefix,
 	map_t pics, map_t sprites)
+{
+	CArray tasks;
+	CArrayInit(&tasks, sizeof(PicDecodeTask));
+	LoadDir(&tasks, path, prefix, pics, sprites);
+	if (!pm->DecodeOnUse)
+	{
+		ThreadPoolRun(
+			&gThreadPool, PicDecodeTaskRun, &tasks, (int)tasks.size);
+	}
+	LOG(LM_MAIN, LL_DEBUG, "%s %d pics from %s",
+		pm->DecodeOnUse ? "registered" : "loaded", (int)tasks.size, path);
+	CArrayTerminate(&tasks);
+	AfterAdd(pm);
+}
+static void LoadDir(
+	CArray *tasks, const char *path, const char *prefix,
+	map_t pics, map_t sprites)
 {
 	tinydir_dir dir;
 	if (tinydir_open(&dir, path) == -1)
@@ -204,35 +317,39 @@ void PicManagerLoadDir(
 			perror("Cannot read image file");
 			goto bail;
 		}
-		if (file.is_reg)
+		if (file.is_reg && IsPNGFile(file.path))
 		{
-			SDL_RWops *rwops = SDL_RWFromFile(file.path, "rb");
-			const bool isPng = IMG_isPNG(rwops);
-			if (isPng)
+			char buf[CDOGS_PATH_MAX];
+			if (prefix)
+			{
+				sprintf(buf, "%s/%s", prefix, file.name);
+			}
+			else
+			{
+				strcpy(buf, file.name);
+			}
+			PicDecodeTask t;
+			memset(&t, 0, sizeof t);
+			const Vec2i size = GetPicName(buf);
+			if (!Vec2iIsZero(size))
 			{
-				SDL_Surface *data = IMG_Load_RW(rwops, 0);
-				if (!data)
+				t.Sprites = AddNamedSprites(sprites, buf);
+				if (t.Sprites != NULL)
 				{
-					LOG(LM_MAIN, LL_ERROR, "Cannot load image");
-					LOG(LM_MAIN, LL_ERROR, "IMG_Load: %s", IMG_GetError());
+					CSTRDUP(t.Sprites->path, file.path);
+					t.Sprites->spriteSize = size;
+					CArrayPushBack(tasks, &t);
 				}
-				else
+			}
+			else
+			{
+				t.Pic = AddNamedPic(pics, buf, NULL);
+				if (t.Pic != NULL)
 				{
-					char buf[CDOGS_PATH_MAX];
-					if (prefix)
-					{
-						char buf1[CDOGS_PATH_MAX];
-						sprintf(buf1, "%s/%s", prefix, file.name);
-						PathGetWithoutExtension(buf, buf1);
-					}
-					else
-					{
-						PathGetBasenameWithoutExtension(buf, file.name);
-					}
-					PicManagerAdd(pics, sprites, buf, data);
+					CSTRDUP(t.Pic->path, file.path);
+					CArrayPushBack(tasks, &t);
 				}
 			}
-			rwops->close(rwops);
 		}
 		else if (file.is_dir && file.name[0] != '.')
 		{
@@ -240,12 +357,11 @@ void PicManagerLoadDir(
 			{
 				char buf[CDOGS_PATH_MAX];
 				sprintf(buf, "%s/%s", prefix, file.name);
-				PicManagerLoadDir(pm, file.path, buf, pics, sprites);
+				LoadDir(tasks, file.path, buf, pics, sprites);
 			}
 			else
 			{
-				PicManagerLoadDir(
-					pm, file.path, file.name, pics, sprites);
+				LoadDir(tasks, file.path, file.name, pics, sprites);
 			}
 		}
 	}
@@ -404,6 +520,8 @@ static void NamedPicDestroy(any_t data);
 static void NamedSpritesDestroy(any_t data);
 void PicManagerClearCustom(PicManager *pm)
 {
+	// Recoloured pics may have been made from the custom pics
+	CharPicCacheClear(&gCharPicCache);
 	hashmap_destroy(pm->customPics, NamedPicDestroy);
 	hashmap_destroy(pm->customSprites, NamedSpritesDestroy);
 	pm->customPics = hashmap_new();
@@ -423,6 +541,7 @@ void PicManagerTerminate(PicManager *pm)
 	StylesTerminate(&pm->exitStyleNames);
 	StylesTerminate(&pm->doorStyleNames);
 	StylesTerminate(&pm->keyStyleNames);
+	SDL_DestroyMutex(pm->decodeLock);
 	IMG_Quit();
 }
 static void StylesTerminate(CArray *styles)
@@ -449,16 +568,16 @@ NamedPic *PicManagerGetNamedPic(const PicManager *pm, const char *name)
 {
 	NamedPic *n;
 	int error = hashmap_get(pm->customPics, name, (any_t *)&n);
-	if (error == MAP_OK)
+	if (error != MAP_OK)
 	{
-		return n;
+		error = hashmap_get(pm->pics, name, (any_t *)&n);
 	}
-	error = hashmap_get(pm->pics, name, (any_t *)&n);
-	if (error == MAP_OK)
+	if (error != MAP_OK)
 	{
-		return n;
+		return NULL;
 	}
-	return NULL;
+	DecodeNamedPic(pm, n);
+	return n;
 }
 Pic *PicManagerGetPic(const PicManager *pm, const char *name)
 {
@@ -471,16 +590,16 @@ const NamedSprites *PicManagerGetSprites(
 {
 	NamedSprites *n;
 	int error = hashmap_get(pm->customSprites, name, (any_t *)&n);
-	if (error == MAP_OK)
+	if (error != MAP_OK)
 	{
-		return n;
+		error = hashmap_get(pm->sprites, name, (any_t *)&n);
 	}
-	error = hashmap_get(pm->sprites, name, (any_t *)&n);
-	if (error == MAP_OK)
+	if (error != MAP_OK)
 	{
-		return n;
+		return NULL;
 	}
-	return NULL;
+	DecodeNamedSprites(pm, n);
+	return n;
 }
 
 static void GetMaskedName(
@@ -570,13 +689,15 @@ static NamedPic *AddNamedPic(map_t pics, const char *name, const Pic *p)
 {
 	NamedPic *n;
 	CMALLOC(n, sizeof *n);
+	memset(n, 0, sizeof *n);
 	if (p != NULL) n->pic = *p;
 	CSTRDUP(n->name, name);
 	const int error = hashmap_put(pics, name, n);
 	if (error != MAP_OK)
 	{
-		LOG(LM_MAIN, LL_ERROR, "failed to add named pic %s: %d", name, error);
-		CFREE(n);
+		const LogLevel ll = error == MAP_EXISTS ? LL_WARN : LL_ERROR;
+		LOG(LM_MAIN, ll, "failed to add named pic %s: %d", name, error);
+		NamedPicDestroy(n);
 		return NULL;
 	}
 	return n;
@@ -589,17 +710,18 @@ static NamedSprites *AddNamedSprites(map_t sprites, const char *name)
 	const int error = hashmap_put(sprites, name, ns);
 	if (error != MAP_OK)
 	{
-		LOG(LM_MAIN, LL_ERROR, "failed to add named sprites %s: %d",
-			name, error);
-		CFREE(ns);
+		const LogLevel ll = error == MAP_EXISTS ? LL_WARN : LL_ERROR;
+		LOG(LM_MAIN, ll, "failed to add named sprites %s: %d", name, error);
+		NamedSpritesDestroy(ns);
 		return NULL;
 	}
 	return ns;
 }
 
-NamedPic *PicManagerGetRandomDrain(PicManager *pm)
+NamedPic *PicManagerGetRandomDrain(PicManager *pm, unsigned int *seed)
 {
-	NamedPic **p = CArrayGet(&pm->drainPics, rand() % pm->drainPics.size);
+	NamedPic **p = CArrayGet(
+		&pm->drainPics, RandNext(seed) % (int)pm->drainPics.size);
 	return *p;
 }
 
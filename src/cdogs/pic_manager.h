@@ -45,6 +45,12 @@ typedef struct
 	CArray exitStyleNames;	// of char *
 	CArray doorStyleNames;	// of char *
 	CArray keyStyleNames;	// of char *
+
+	// Decode pics on first use instead of all at load; always on for the
+	// editor, and set by Graphics.DecodePicsOnUse for the game. Saves
+	// startup time and memory but decoding is serialised
+	bool DecodeOnUse;
+	SDL_mutex *decodeLock;
 } PicManager;
 
 extern PicManager gPicManager;
@@ -78,7 +84,7 @@ void PicManagerGenerateMaskedStylePic(
 	PicManager *pm, const char *name, const char *style, const char *type,
 	const color_t mask, const color_t maskAlt);
 
-NamedPic *PicManagerGetRandomDrain(PicManager *pm);
+NamedPic *PicManagerGetRandomDrain(PicManager *pm, unsigned int *seed);
 NamedPic *PicManagerGetExitPic(
 	PicManager *pm, const char *style, const bool isShadow);
 int PicManagerGetWallStyleIndex(PicManager *pm, const char *style);
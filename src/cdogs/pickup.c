@@ -90,7 +90,7 @@ void PickupAdd(const NAddPickup ap)
 	}
 	memset(p, 0, sizeof *p);
 	p->UID = ap.UID;
-	p->class = StrPickupClass(ap.PickupClass);
+	p->class = PickupClassGetById(&gPickupClasses, ap.PickupClassId);
 	p->tileItem.x = p->tileItem.y = -1;
 	p->tileItem.flags = ap.TileItemFlags;
 	p->tileItem.kind = KIND_PICKUP;
@@ -125,7 +125,7 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 			GameEvent e = GameEventNew(GAME_EVENT_SCORE);
 			e.u.Score.PlayerUID = a->PlayerUID;
 			e.u.Score.Score = p->class->u.Score;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 			sound = "pickup";
 			UpdateMissionObjective(
 				&gMission, p->tileItem.flags, OBJECTIVE_COLLECT, 1);
@@ -143,7 +143,7 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 			e.u.Heal.PlayerUID = a->PlayerUID;
 			e.u.Heal.Amount = p->class->u.Health;
 			e.u.Heal.IsRandomSpawned = p->IsRandomSpawned;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 		break;
 
@@ -181,7 +181,7 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 			e.u.AddAmmo.Amount = p->class->u.Ammo.Amount;
 			e.u.AddAmmo.IsRandomSpawned = p->IsRandomSpawned;
 			// Note: receiving end will prevent ammo from exceeding max
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 
 			sound = ammo->Sound;
 		}
@@ -192,7 +192,7 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 			GameEvent e = GameEventNew(GAME_EVENT_ADD_KEYS);
 			e.u.AddKeys.KeyFlags = p->class->u.Keys;
 			e.u.AddKeys.Pos = Vec2i2Net(actorPos);
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 		break;
 
@@ -205,8 +205,8 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 			e.u.ActorReplaceGun.GunIdx =
 				(int)a->guns.size == MAX_WEAPONS ?
 				a->gunIndex : (int)a->guns.size;
-			strcpy(e.u.ActorReplaceGun.Gun, gun->name);
-			GameEventsEnqueue(&gGameEvents, e);
+			e.u.ActorReplaceGun.GunId = GunDescriptionId(gun);
+			GameEventsEnqueue(&gGameEvents, &e);
 
 			// If the player has less ammo than the default amount,
 			// replenish up to this amount
@@ -224,7 +224,7 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 					e.u.AddAmmo.AmmoId = ammoId;
 					e.u.AddAmmo.Amount = ammoDeficit;
 					e.u.AddAmmo.IsRandomSpawned = false;
-					GameEventsEnqueue(&gGameEvents, e);
+					GameEventsEnqueue(&gGameEvents, &e);
 				}
 			}
 		}
@@ -243,15 +243,15 @@ void PickupPickup(TActor *a, Pickup *p, const bool pickupAll)
 		if (sound != NULL)
 		{
 			GameEvent es = GameEventNew(GAME_EVENT_SOUND_AT);
-			strcpy(es.u.SoundAt.Sound, sound);
+			es.u.SoundAt.SoundId = StrSoundId(sound);
 			es.u.SoundAt.Pos = Vec2i2Net(actorPos);
 			es.u.SoundAt.IsHit = false;
-			GameEventsEnqueue(&gGameEvents, es);
+			GameEventsEnqueue(&gGameEvents, &es);
 		}
 		GameEvent e = GameEventNew(GAME_EVENT_REMOVE_PICKUP);
 		e.u.RemovePickup.UID = p->UID;
 		e.u.RemovePickup.SpawnerUID = p->SpawnerUID;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 		// Prevent multiple pickups by marking
 		p->PickedUp = true;
 	}
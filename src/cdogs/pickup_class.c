@@ -131,36 +131,45 @@ PickupClass *KeyPickupClass(const char *style, const int i)
 }
 PickupClass *PickupClassGetById(PickupClasses *classes, const int id)
 {
+	CASSERT(
+		id >= 0 &&
+		id < (int)classes->Classes.size + (int)classes->CustomClasses.size +
+		(int)classes->KeyClasses.size,
+		"Pickup class ID out of bounds");
 	if (id < (int)classes->Classes.size)
 	{
 		return CArrayGet(&classes->Classes, id);
 	}
-	else
+	const int customId = id - (int)classes->Classes.size;
+	if (customId < (int)classes->CustomClasses.size)
 	{
-		return CArrayGet(
-			&classes->CustomClasses, id - (int)classes->Classes.size);
+		return CArrayGet(&classes->CustomClasses, customId);
 	}
+	return CArrayGet(
+		&classes->KeyClasses, customId - (int)classes->CustomClasses.size);
 }
-int StrPickupClassId(const char *s)
+int PickupClassId(const PickupClass *c)
 {
-	if (s == NULL || strlen(s) == 0)
+	int idx = CArrayIndexOf(&gPickupClasses.Classes, c);
+	if (idx >= 0)
 	{
-		return 0;
+		return idx;
 	}
-	CA_FOREACH(const PickupClass, c, gPickupClasses.CustomClasses)
-		if (strcmp(s, c->Name) == 0)
-		{
-			return _ca_index + (int)gPickupClasses.Classes.size;
-		}
-	CA_FOREACH_END()
-	CA_FOREACH(const PickupClass, c, gPickupClasses.Classes)
-		if (strcmp(s, c->Name) == 0)
-		{
-			return _ca_index;
-		}
-	CA_FOREACH_END()
-	CASSERT(false, "cannot parse pickup class name");
-	return 0;
+	int base = (int)gPickupClasses.Classes.size;
+	idx = CArrayIndexOf(&gPickupClasses.CustomClasses, c);
+	if (idx >= 0)
+	{
+		return base + idx;
+	}
+	base += (int)gPickupClasses.CustomClasses.size;
+	idx = CArrayIndexOf(&gPickupClasses.KeyClasses, c);
+	CASSERT(idx >= 0, "cannot find pickup class");
+	return base + idx;
+}
+int StrPickupClassId(const char *s)
+{
+	const PickupClass *c = StrPickupClass(s);
+	return c != NULL ? PickupClassId(c) : 0;
 }
 
 #define VERSION 1
@@ -78,7 +78,10 @@ const char *IntKeyStyle(const int style);
 PickupClass *IntKeyPickupClass(const int style, const int i);
 // Semi-legacy key classes, style+integer colour
 PickupClass *KeyPickupClass(const char *style, const int i);
+// IDs index the built-in classes, then the custom ones, then the keys, for
+// sending pickup classes over the network without names
 PickupClass *PickupClassGetById(PickupClasses *classes, const int id);
+int PickupClassId(const PickupClass *c);
 int StrPickupClassId(const char *s);
 
 void PickupClassesInit(
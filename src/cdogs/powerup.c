@@ -173,11 +173,11 @@ static void HealthPlace(const Vec2i pos, void *data)
 	GameEvent e = GameEventNew(GAME_EVENT_ADD_PICKUP);
 	e.u.AddPickup.UID = PickupsGetNextUID();
 	e.u.AddPickup.Pos = Vec2i2Net(pos);
-	strcpy(e.u.AddPickup.PickupClass, "health");
+	e.u.AddPickup.PickupClassId = StrPickupClassId("health");
 	e.u.AddPickup.IsRandomSpawned = true;
 	e.u.AddPickup.SpawnerUID = -1;
 	e.u.AddPickup.TileItemFlags = 0;
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 }
 
 
@@ -234,9 +234,11 @@ static void AmmoPlace(const Vec2i pos, void *data)
 	e.u.AddPickup.UID = PickupsGetNextUID();
 	e.u.AddPickup.Pos = Vec2i2Net(pos);
 	const Ammo *a = AmmoGetById(&gAmmo, ammoId);
-	sprintf(e.u.AddPickup.PickupClass, "ammo_%s", a->Name);
+	char buf[256];
+	sprintf(buf, "ammo_%s", a->Name);
+	e.u.AddPickup.PickupClassId = StrPickupClassId(buf);
 	e.u.AddPickup.IsRandomSpawned = true;
 	e.u.AddPickup.SpawnerUID = -1;
 	e.u.AddPickup.TileItemFlags = 0;
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 }
@@ -41,10 +41,11 @@ const pb_field_t NClientId_fields[3] = {
     PB_LAST_FIELD
 };
 
-const pb_field_t NCampaignDef_fields[4] = {
+const pb_field_t NCampaignDef_fields[5] = {
     PB_FIELD(  1, STRING  , REQUIRED, STATIC  , FIRST, NCampaignDef, Path, Path, 0),
     PB_FIELD(  2, INT32   , REQUIRED, STATIC  , OTHER, NCampaignDef, GameMode, Path, 0),
     PB_FIELD(  3, UINT32  , REQUIRED, STATIC  , OTHER, NCampaignDef, Mission, GameMode, 0),
+    PB_FIELD(  4, UINT32  , REQUIRED, STATIC  , OTHER, NCampaignDef, IdsHash, Mission, 0),
     PB_LAST_FIELD
 };
 
@@ -95,19 +96,21 @@ const pb_field_t NConfig_fields[3] = {
     PB_LAST_FIELD
 };
 
-const pb_field_t NTileSet_fields[6] = {
+const pb_field_t NTileSet_fields[8] = {
     PB_FIELD(  1, MESSAGE , REQUIRED, STATIC  , FIRST, NTileSet, Pos, Pos, &NVec2i_fields),
     PB_FIELD(  2, UINT32  , REQUIRED, STATIC  , OTHER, NTileSet, Flags, Pos, 0),
-    PB_FIELD(  3, STRING  , REQUIRED, STATIC  , OTHER, NTileSet, PicName, Flags, 0),
-    PB_FIELD(  4, STRING  , REQUIRED, STATIC  , OTHER, NTileSet, PicAltName, PicName, 0),
+    PB_FIELD(  3, STRING  , OPTIONAL, STATIC  , OTHER, NTileSet, PicName, Flags, 0),
+    PB_FIELD(  4, STRING  , OPTIONAL, STATIC  , OTHER, NTileSet, PicAltName, PicName, 0),
     PB_FIELD(  5, INT32   , REQUIRED, STATIC  , OTHER, NTileSet, RunLength, PicAltName, 0),
+    PB_FIELD(  6, INT32   , REQUIRED, STATIC  , OTHER, NTileSet, PicId, RunLength, 0),
+    PB_FIELD(  7, INT32   , REQUIRED, STATIC  , OTHER, NTileSet, PicAltId, PicId, 0),
     PB_LAST_FIELD
 };
 
 const pb_field_t NMapObjectAdd_fields[6] = {
     PB_FIELD(  1, UINT32  , REQUIRED, STATIC  , FIRST, NMapObjectAdd, UID, UID, 0),
-    PB_FIELD(  2, STRING  , REQUIRED, STATIC  , OTHER, NMapObjectAdd, MapObjectClass, UID, 0),
-    PB_FIELD(  3, MESSAGE , REQUIRED, STATIC  , OTHER, NMapObjectAdd, Pos, MapObjectClass, &NVec2i_fields),
+    PB_FIELD(  2, INT32   , REQUIRED, STATIC  , OTHER, NMapObjectAdd, MapObjectId, UID, 0),
+    PB_FIELD(  3, MESSAGE , REQUIRED, STATIC  , OTHER, NMapObjectAdd, Pos, MapObjectId, &NVec2i_fields),
     PB_FIELD(  4, UINT32  , REQUIRED, STATIC  , OTHER, NMapObjectAdd, TileItemFlags, Pos, 0),
     PB_FIELD(  5, INT32   , REQUIRED, STATIC  , OTHER, NMapObjectAdd, Health, TileItemFlags, 0),
     PB_LAST_FIELD
@@ -137,8 +140,8 @@ const pb_field_t NScore_fields[3] = {
 };
 
 const pb_field_t NSound_fields[4] = {
-    PB_FIELD(  1, STRING  , REQUIRED, STATIC  , FIRST, NSound, Sound, Sound, 0),
-    PB_FIELD(  2, MESSAGE , REQUIRED, STATIC  , OTHER, NSound, Pos, Sound, &NVec2i_fields),
+    PB_FIELD(  1, INT32   , REQUIRED, STATIC  , FIRST, NSound, SoundId, SoundId, 0),
+    PB_FIELD(  2, MESSAGE , REQUIRED, STATIC  , OTHER, NSound, Pos, SoundId, &NVec2i_fields),
     PB_FIELD(  3, BOOL    , REQUIRED, STATIC  , OTHER, NSound, IsHit, Pos, 0),
     PB_LAST_FIELD
 };
@@ -207,7 +210,7 @@ const pb_field_t NActorPickupAll_fields[3] = {
 const pb_field_t NActorReplaceGun_fields[4] = {
     PB_FIELD(  1, UINT32  , REQUIRED, STATIC  , FIRST, NActorReplaceGun, UID, UID, 0),
     PB_FIELD(  2, UINT32  , REQUIRED, STATIC  , OTHER, NActorReplaceGun, GunIdx, UID, 0),
-    PB_FIELD(  3, STRING  , REQUIRED, STATIC  , OTHER, NActorReplaceGun, Gun, GunIdx, 0),
+    PB_FIELD(  3, INT32   , REQUIRED, STATIC  , OTHER, NActorReplaceGun, GunId, GunIdx, 0),
     PB_LAST_FIELD
 };
 
@@ -253,8 +256,8 @@ const pb_field_t NActorDie_fields[2] = {
 
 const pb_field_t NActorMelee_fields[6] = {
     PB_FIELD(  1, UINT32  , REQUIRED, STATIC  , FIRST, NActorMelee, UID, UID, 0),
-    PB_FIELD(  2, STRING  , REQUIRED, STATIC  , OTHER, NActorMelee, BulletClass, UID, 0),
-    PB_FIELD(  3, INT32   , REQUIRED, STATIC  , OTHER, NActorMelee, HitType, BulletClass, 0),
+    PB_FIELD(  2, INT32   , REQUIRED, STATIC  , OTHER, NActorMelee, BulletClassId, UID, 0),
+    PB_FIELD(  3, INT32   , REQUIRED, STATIC  , OTHER, NActorMelee, HitType, BulletClassId, 0),
     PB_FIELD(  4, INT32   , REQUIRED, STATIC  , OTHER, NActorMelee, TargetKind, HitType, 0),
     PB_FIELD(  5, UINT32  , REQUIRED, STATIC  , OTHER, NActorMelee, TargetUID, TargetKind, 0),
     PB_LAST_FIELD
@@ -262,8 +265,8 @@ const pb_field_t NActorMelee_fields[6] = {
 
 const pb_field_t NAddPickup_fields[7] = {
     PB_FIELD(  1, UINT32  , REQUIRED, STATIC  , FIRST, NAddPickup, UID, UID, 0),
-    PB_FIELD(  2, STRING  , REQUIRED, STATIC  , OTHER, NAddPickup, PickupClass, UID, 0),
-    PB_FIELD(  3, BOOL    , REQUIRED, STATIC  , OTHER, NAddPickup, IsRandomSpawned, PickupClass, 0),
+    PB_FIELD(  2, INT32   , REQUIRED, STATIC  , OTHER, NAddPickup, PickupClassId, UID, 0),
+    PB_FIELD(  3, BOOL    , REQUIRED, STATIC  , OTHER, NAddPickup, IsRandomSpawned, PickupClassId, 0),
     PB_FIELD(  4, INT32   , REQUIRED, STATIC  , OTHER, NAddPickup, SpawnerUID, IsRandomSpawned, &NAddPickup_SpawnerUID_default),
     PB_FIELD(  5, UINT32  , REQUIRED, STATIC  , OTHER, NAddPickup, TileItemFlags, SpawnerUID, 0),
     PB_FIELD(  6, MESSAGE , REQUIRED, STATIC  , OTHER, NAddPickup, Pos, TileItemFlags, &NVec2i_fields),
@@ -292,8 +295,8 @@ const pb_field_t NRemoveBullet_fields[2] = {
 
 const pb_field_t NGunReload_fields[5] = {
     PB_FIELD(  1, INT32   , REQUIRED, STATIC  , FIRST, NGunReload, PlayerUID, PlayerUID, &NGunReload_PlayerUID_default),
-    PB_FIELD(  2, STRING  , REQUIRED, STATIC  , OTHER, NGunReload, Gun, PlayerUID, 0),
-    PB_FIELD(  3, MESSAGE , REQUIRED, STATIC  , OTHER, NGunReload, FullPos, Gun, &NVec2i_fields),
+    PB_FIELD(  2, INT32   , REQUIRED, STATIC  , OTHER, NGunReload, GunId, PlayerUID, 0),
+    PB_FIELD(  3, MESSAGE , REQUIRED, STATIC  , OTHER, NGunReload, FullPos, GunId, &NVec2i_fields),
     PB_FIELD(  4, INT32   , REQUIRED, STATIC  , OTHER, NGunReload, Direction, FullPos, 0),
     PB_LAST_FIELD
 };
@@ -301,8 +304,8 @@ const pb_field_t NGunReload_fields[5] = {
 const pb_field_t NGunFire_fields[10] = {
     PB_FIELD(  1, INT32   , REQUIRED, STATIC  , FIRST, NGunFire, UID, UID, &NGunFire_UID_default),
     PB_FIELD(  2, INT32   , REQUIRED, STATIC  , OTHER, NGunFire, PlayerUID, UID, &NGunFire_PlayerUID_default),
-    PB_FIELD(  3, STRING  , REQUIRED, STATIC  , OTHER, NGunFire, Gun, PlayerUID, 0),
-    PB_FIELD(  4, MESSAGE , REQUIRED, STATIC  , OTHER, NGunFire, MuzzleFullPos, Gun, &NVec2i_fields),
+    PB_FIELD(  3, INT32   , REQUIRED, STATIC  , OTHER, NGunFire, GunId, PlayerUID, 0),
+    PB_FIELD(  4, MESSAGE , REQUIRED, STATIC  , OTHER, NGunFire, MuzzleFullPos, GunId, &NVec2i_fields),
     PB_FIELD(  5, INT32   , REQUIRED, STATIC  , OTHER, NGunFire, Z, MuzzleFullPos, 0),
     PB_FIELD(  6, FLOAT   , REQUIRED, STATIC  , OTHER, NGunFire, Angle, Z, 0),
     PB_FIELD(  7, BOOL    , REQUIRED, STATIC  , OTHER, NGunFire, Sound, Angle, 0),
@@ -319,8 +322,8 @@ const pb_field_t NGunState_fields[3] = {
 
 const pb_field_t NAddBullet_fields[10] = {
     PB_FIELD(  1, UINT32  , REQUIRED, STATIC  , FIRST, NAddBullet, UID, UID, 0),
-    PB_FIELD(  2, STRING  , REQUIRED, STATIC  , OTHER, NAddBullet, BulletClass, UID, 0),
-    PB_FIELD(  3, MESSAGE , REQUIRED, STATIC  , OTHER, NAddBullet, MuzzlePos, BulletClass, &NVec2i_fields),
+    PB_FIELD(  2, INT32   , REQUIRED, STATIC  , OTHER, NAddBullet, BulletClassId, UID, 0),
+    PB_FIELD(  3, MESSAGE , REQUIRED, STATIC  , OTHER, NAddBullet, MuzzlePos, BulletClassId, &NVec2i_fields),
     PB_FIELD(  4, INT32   , REQUIRED, STATIC  , OTHER, NAddBullet, MuzzleHeight, MuzzlePos, 0),
     PB_FIELD(  5, FLOAT   , REQUIRED, STATIC  , OTHER, NAddBullet, Angle, MuzzleHeight, 0),
     PB_FIELD(  6, INT32   , REQUIRED, STATIC  , OTHER, NAddBullet, Elevation, Angle, 0),
@@ -41,7 +41,7 @@ typedef struct _NActorHeal {
 
 typedef struct _NActorMelee {
     uint32_t UID;
-    char BulletClass[128];
+    int32_t BulletClassId;
     int32_t HitType;
     int32_t TargetKind;
     uint32_t TargetUID;
@@ -55,7 +55,7 @@ typedef struct _NActorPickupAll {
 typedef struct _NActorReplaceGun {
     uint32_t UID;
     uint32_t GunIdx;
-    char Gun[128];
+    int32_t GunId;
 } NActorReplaceGun;
 
 typedef struct _NActorState {
@@ -79,6 +79,7 @@ typedef struct _NCampaignDef {
     char Path[4096];
     int32_t GameMode;
     uint32_t Mission;
+    uint32_t IdsHash;
 } NCampaignDef;
 
 typedef struct _NClientId {
@@ -209,7 +210,7 @@ typedef struct _NActorSlide {
 
 typedef struct _NAddBullet {
     uint32_t UID;
-    char BulletClass[128];
+    int32_t BulletClassId;
     NVec2i MuzzlePos;
     int32_t MuzzleHeight;
     float Angle;
@@ -226,7 +227,7 @@ typedef struct _NAddKeys {
 
 typedef struct _NAddPickup {
     uint32_t UID;
-    char PickupClass[128];
+    int32_t PickupClassId;
     bool IsRandomSpawned;
     int32_t SpawnerUID;
     uint32_t TileItemFlags;
@@ -257,7 +258,7 @@ typedef struct _NExploreTiles_Run {
 typedef struct _NGunFire {
     int32_t UID;
     int32_t PlayerUID;
-    char Gun[128];
+    int32_t GunId;
     NVec2i MuzzleFullPos;
     int32_t Z;
     float Angle;
@@ -268,14 +269,14 @@ typedef struct _NGunFire {
 
 typedef struct _NGunReload {
     int32_t PlayerUID;
-    char Gun[128];
+    int32_t GunId;
     NVec2i FullPos;
     int32_t Direction;
 } NGunReload;
 
 typedef struct _NMapObjectAdd {
     uint32_t UID;
-    char MapObjectClass[128];
+    int32_t MapObjectId;
     NVec2i Pos;
     uint32_t TileItemFlags;
     int32_t Health;
@@ -288,7 +289,7 @@ typedef struct _NMissionComplete {
 } NMissionComplete;
 
 typedef struct _NSound {
-    char Sound[128];
+    int32_t SoundId;
     NVec2i Pos;
     bool IsHit;
 } NSound;
@@ -296,9 +297,13 @@ typedef struct _NSound {
 typedef struct _NTileSet {
     NVec2i Pos;
     uint32_t Flags;
+    bool has_PicName;
     char PicName[128];
+    bool has_PicAltName;
     char PicAltName[128];
     int32_t RunLength;
+    int32_t PicId;
+    int32_t PicAltId;
 } NTileSet;
 
 typedef struct _NTrigger {
@@ -344,19 +349,19 @@ extern const int32_t NAddBullet_ActorUID_default;
 /* Initializer values for message structs */
 #define NServerInfo_init_default                 {0, 0, "", 0, "", 0, 0, 0}
 #define NClientId_init_default                   {0, 0}
-#define NCampaignDef_init_default                {"", 0, 0}
+#define NCampaignDef_init_default                {"", 0, 0, 0}
 #define NColor_init_default                      {0}
 #define NCharColors_init_default                 {NColor_init_default, NColor_init_default, NColor_init_default, NColor_init_default, NColor_init_default}
 #define NPlayerStats_init_default                {0, 0, 0, 0}
 #define NPlayerData_init_default                 {"", "", NCharColors_init_default, 0, {"", "", ""}, 0, NPlayerStats_init_default, NPlayerStats_init_default, 0, 0, 0}
 #define NPlayerRemove_init_default               {0}
 #define NConfig_init_default                     {"", ""}
-#define NTileSet_init_default                    {NVec2i_init_default, 0, "", "", 0}
-#define NMapObjectAdd_init_default               {0, "", NVec2i_init_default, 0, 0}
+#define NTileSet_init_default                    {NVec2i_init_default, 0, false, "", false, "", 0, 0, 0}
+#define NMapObjectAdd_init_default               {0, 0, NVec2i_init_default, 0, 0}
 #define NMapObjectDamage_init_default            {0, 0, 0, 0, 0}
 #define NMapObjectRemove_init_default            {0, 0, 0, 0}
 #define NScore_init_default                      {0, 0}
-#define NSound_init_default                      {"", NVec2i_init_default, 0}
+#define NSound_init_default                      {0, NVec2i_init_default, 0}
 #define NVec2i_init_default                      {0, 0}
 #define NActorAdd_init_default                   {0, 0, 4, 0, -1, 0, NVec2i_init_default}
 #define NActorMove_init_default                  {0, NVec2i_init_default, NVec2i_init_default}
@@ -366,21 +371,21 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NActorImpulse_init_default               {0, NVec2i_init_default, NVec2i_init_default}
 #define NActorSwitchGun_init_default             {0, 0}
 #define NActorPickupAll_init_default             {0, 0}
-#define NActorReplaceGun_init_default            {0, 0, ""}
+#define NActorReplaceGun_init_default            {0, 0, 0}
 #define NActorHeal_init_default                  {0, -1, 0, 0}
 #define NActorHit_init_default                   {0, -1, -1, 0, 0, NVec2i_init_default}
 #define NActorAddAmmo_init_default               {0, -1, 0, 0, 0}
 #define NActorUseAmmo_init_default               {0, -1, 0, 0}
 #define NActorDie_init_default                   {0}
-#define NActorMelee_init_default                 {0, "", 0, 0, 0}
-#define NAddPickup_init_default                  {0, "", 0, -1, 0, NVec2i_init_default}
+#define NActorMelee_init_default                 {0, 0, 0, 0, 0}
+#define NAddPickup_init_default                  {0, 0, 0, -1, 0, NVec2i_init_default}
 #define NRemovePickup_init_default               {0, -1}
 #define NBulletBounce_init_default               {0, 0, 0, NVec2i_init_default, NVec2i_init_default}
 #define NRemoveBullet_init_default               {0}
-#define NGunReload_init_default                  {-1, "", NVec2i_init_default, 0}
-#define NGunFire_init_default                    {-1, -1, "", NVec2i_init_default, 0, 0, 0, 0, 0}
+#define NGunReload_init_default                  {-1, 0, NVec2i_init_default, 0}
+#define NGunFire_init_default                    {-1, -1, 0, NVec2i_init_default, 0, 0, 0, 0, 0}
 #define NGunState_init_default                   {0, 0}
-#define NAddBullet_init_default                  {0, "", NVec2i_init_default, 0, 0, 0, 0, -1, -1}
+#define NAddBullet_init_default                  {0, 0, NVec2i_init_default, 0, 0, 0, 0, -1, -1}
 #define NTrigger_init_default                    {0, NVec2i_init_default}
 #define NExploreTiles_init_default               {0, {NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default, NExploreTiles_Run_init_default}}
 #define NExploreTiles_Run_init_default           {NVec2i_init_default, 0}
@@ -391,19 +396,19 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NMissionEnd_init_default                 {0, 0, ""}
 #define NServerInfo_init_zero                    {0, 0, "", 0, "", 0, 0, 0}
 #define NClientId_init_zero                      {0, 0}
-#define NCampaignDef_init_zero                   {"", 0, 0}
+#define NCampaignDef_init_zero                   {"", 0, 0, 0}
 #define NColor_init_zero                         {0}
 #define NCharColors_init_zero                    {NColor_init_zero, NColor_init_zero, NColor_init_zero, NColor_init_zero, NColor_init_zero}
 #define NPlayerStats_init_zero                   {0, 0, 0, 0}
 #define NPlayerData_init_zero                    {"", "", NCharColors_init_zero, 0, {"", "", ""}, 0, NPlayerStats_init_zero, NPlayerStats_init_zero, 0, 0, 0}
 #define NPlayerRemove_init_zero                  {0}
 #define NConfig_init_zero                        {"", ""}
-#define NTileSet_init_zero                       {NVec2i_init_zero, 0, "", "", 0}
-#define NMapObjectAdd_init_zero                  {0, "", NVec2i_init_zero, 0, 0}
+#define NTileSet_init_zero                       {NVec2i_init_zero, 0, false, "", false, "", 0, 0, 0}
+#define NMapObjectAdd_init_zero                  {0, 0, NVec2i_init_zero, 0, 0}
 #define NMapObjectDamage_init_zero               {0, 0, 0, 0, 0}
 #define NMapObjectRemove_init_zero               {0, 0, 0, 0}
 #define NScore_init_zero                         {0, 0}
-#define NSound_init_zero                         {"", NVec2i_init_zero, 0}
+#define NSound_init_zero                         {0, NVec2i_init_zero, 0}
 #define NVec2i_init_zero                         {0, 0}
 #define NActorAdd_init_zero                      {0, 0, 0, 0, 0, 0, NVec2i_init_zero}
 #define NActorMove_init_zero                     {0, NVec2i_init_zero, NVec2i_init_zero}
@@ -413,21 +418,21 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NActorImpulse_init_zero                  {0, NVec2i_init_zero, NVec2i_init_zero}
 #define NActorSwitchGun_init_zero                {0, 0}
 #define NActorPickupAll_init_zero                {0, 0}
-#define NActorReplaceGun_init_zero               {0, 0, ""}
+#define NActorReplaceGun_init_zero               {0, 0, 0}
 #define NActorHeal_init_zero                     {0, 0, 0, 0}
 #define NActorHit_init_zero                      {0, 0, 0, 0, 0, NVec2i_init_zero}
 #define NActorAddAmmo_init_zero                  {0, 0, 0, 0, 0}
 #define NActorUseAmmo_init_zero                  {0, 0, 0, 0}
 #define NActorDie_init_zero                      {0}
-#define NActorMelee_init_zero                    {0, "", 0, 0, 0}
-#define NAddPickup_init_zero                     {0, "", 0, 0, 0, NVec2i_init_zero}
+#define NActorMelee_init_zero                    {0, 0, 0, 0, 0}
+#define NAddPickup_init_zero                     {0, 0, 0, 0, 0, NVec2i_init_zero}
 #define NRemovePickup_init_zero                  {0, 0}
 #define NBulletBounce_init_zero                  {0, 0, 0, NVec2i_init_zero, NVec2i_init_zero}
 #define NRemoveBullet_init_zero                  {0}
-#define NGunReload_init_zero                     {0, "", NVec2i_init_zero, 0}
-#define NGunFire_init_zero                       {0, 0, "", NVec2i_init_zero, 0, 0, 0, 0, 0}
+#define NGunReload_init_zero                     {0, 0, NVec2i_init_zero, 0}
+#define NGunFire_init_zero                       {0, 0, 0, NVec2i_init_zero, 0, 0, 0, 0, 0}
 #define NGunState_init_zero                      {0, 0}
-#define NAddBullet_init_zero                     {0, "", NVec2i_init_zero, 0, 0, 0, 0, 0, 0}
+#define NAddBullet_init_zero                     {0, 0, NVec2i_init_zero, 0, 0, 0, 0, 0, 0}
 #define NTrigger_init_zero                       {0, NVec2i_init_zero}
 #define NExploreTiles_init_zero                  {0, {NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero, NExploreTiles_Run_init_zero}}
 #define NExploreTiles_Run_init_zero              {NVec2i_init_zero, 0}
@@ -451,7 +456,7 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NActorHeal_Amount_tag                    3
 #define NActorHeal_IsRandomSpawned_tag           4
 #define NActorMelee_UID_tag                      1
-#define NActorMelee_BulletClass_tag              2
+#define NActorMelee_BulletClassId_tag            2
 #define NActorMelee_HitType_tag                  3
 #define NActorMelee_TargetKind_tag               4
 #define NActorMelee_TargetUID_tag                5
@@ -459,7 +464,7 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NActorPickupAll_PickupAll_tag            2
 #define NActorReplaceGun_UID_tag                 1
 #define NActorReplaceGun_GunIdx_tag              2
-#define NActorReplaceGun_Gun_tag                 3
+#define NActorReplaceGun_GunId_tag               3
 #define NActorState_UID_tag                      1
 #define NActorState_State_tag                    2
 #define NActorSwitchGun_UID_tag                  1
@@ -471,6 +476,7 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NCampaignDef_Path_tag                    1
 #define NCampaignDef_GameMode_tag                2
 #define NCampaignDef_Mission_tag                 3
+#define NCampaignDef_IdsHash_tag                 4
 #define NClientId_Id_tag                         1
 #define NClientId_FirstPlayerUID_tag             2
 #define NColor_RGBA_tag                          1
@@ -535,7 +541,7 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NActorSlide_UID_tag                      1
 #define NActorSlide_Vel_tag                      2
 #define NAddBullet_UID_tag                       1
-#define NAddBullet_BulletClass_tag               2
+#define NAddBullet_BulletClassId_tag             2
 #define NAddBullet_MuzzlePos_tag                 3
 #define NAddBullet_MuzzleHeight_tag              4
 #define NAddBullet_Angle_tag                     5
@@ -546,7 +552,7 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NAddKeys_KeyFlags_tag                    1
 #define NAddKeys_Pos_tag                         2
 #define NAddPickup_UID_tag                       1
-#define NAddPickup_PickupClass_tag               2
+#define NAddPickup_PickupClassId_tag             2
 #define NAddPickup_IsRandomSpawned_tag           3
 #define NAddPickup_SpawnerUID_tag                4
 #define NAddPickup_TileItemFlags_tag             5
@@ -565,7 +571,7 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NExploreTiles_Run_Run_tag                2
 #define NGunFire_UID_tag                         1
 #define NGunFire_PlayerUID_tag                   2
-#define NGunFire_Gun_tag                         3
+#define NGunFire_GunId_tag                       3
 #define NGunFire_MuzzleFullPos_tag               4
 #define NGunFire_Z_tag                           5
 #define NGunFire_Angle_tag                       6
@@ -573,18 +579,18 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NGunFire_Flags_tag                       8
 #define NGunFire_IsGun_tag                       9
 #define NGunReload_PlayerUID_tag                 1
-#define NGunReload_Gun_tag                       2
+#define NGunReload_GunId_tag                     2
 #define NGunReload_FullPos_tag                   3
 #define NGunReload_Direction_tag                 4
 #define NMapObjectAdd_UID_tag                    1
-#define NMapObjectAdd_MapObjectClass_tag         2
+#define NMapObjectAdd_MapObjectId_tag            2
 #define NMapObjectAdd_Pos_tag                    3
 #define NMapObjectAdd_TileItemFlags_tag          4
 #define NMapObjectAdd_Health_tag                 5
 #define NMissionComplete_ShowMsg_tag             1
 #define NMissionComplete_ExitStart_tag           2
 #define NMissionComplete_ExitEnd_tag             3
-#define NSound_Sound_tag                         1
+#define NSound_SoundId_tag                       1
 #define NSound_Pos_tag                           2
 #define NSound_IsHit_tag                         3
 #define NTileSet_Pos_tag                         1
@@ -592,6 +598,8 @@ extern const int32_t NAddBullet_ActorUID_default;
 #define NTileSet_PicName_tag                     3
 #define NTileSet_PicAltName_tag                  4
 #define NTileSet_RunLength_tag                   5
+#define NTileSet_PicId_tag                       6
+#define NTileSet_PicAltId_tag                    7
 #define NTrigger_ID_tag                          1
 #define NTrigger_Tile_tag                        2
 #define NExploreTiles_Runs_tag                   1
@@ -609,14 +617,14 @@ extern const int32_t NAddBullet_ActorUID_default;
 /* Struct field encoding specification for nanopb */
 extern const pb_field_t NServerInfo_fields[9];
 extern const pb_field_t NClientId_fields[3];
-extern const pb_field_t NCampaignDef_fields[4];
+extern const pb_field_t NCampaignDef_fields[5];
 extern const pb_field_t NColor_fields[2];
 extern const pb_field_t NCharColors_fields[6];
 extern const pb_field_t NPlayerStats_fields[5];
 extern const pb_field_t NPlayerData_fields[11];
 extern const pb_field_t NPlayerRemove_fields[2];
 extern const pb_field_t NConfig_fields[3];
-extern const pb_field_t NTileSet_fields[6];
+extern const pb_field_t NTileSet_fields[8];
 extern const pb_field_t NMapObjectAdd_fields[6];
 extern const pb_field_t NMapObjectDamage_fields[6];
 extern const pb_field_t NMapObjectRemove_fields[5];
@@ -658,19 +666,19 @@ extern const pb_field_t NMissionEnd_fields[4];
 /* Maximum encoded size of messages (where known) */
 #define NServerInfo_size                         97
 #define NClientId_size                           12
-#define NCampaignDef_size                        4116
+#define NCampaignDef_size                        4122
 #define NColor_size                              11
 #define NCharColors_size                         65
 #define NPlayerStats_size                        44
 #define NPlayerData_size                         729
 #define NPlayerRemove_size                       6
 #define NConfig_size                             262
-#define NTileSet_size                            303
-#define NMapObjectAdd_size                       178
+#define NTileSet_size                            325
+#define NMapObjectAdd_size                       58
 #define NMapObjectDamage_size                    45
 #define NMapObjectRemove_size                    34
 #define NScore_size                              17
-#define NSound_size                              157
+#define NSound_size                              37
 #define NVec2i_size                              22
 #define NActorAdd_size                           75
 #define NActorMove_size                          54
@@ -680,21 +688,21 @@ extern const pb_field_t NMissionEnd_fields[4];
 #define NActorImpulse_size                       54
 #define NActorSwitchGun_size                     12
 #define NActorPickupAll_size                     8
-#define NActorReplaceGun_size                    143
+#define NActorReplaceGun_size                    23
 #define NActorHeal_size                          30
 #define NActorHit_size                           74
 #define NActorAddAmmo_size                       31
 #define NActorUseAmmo_size                       29
 #define NActorDie_size                           6
-#define NActorMelee_size                         165
-#define NAddPickup_size                          180
+#define NActorMelee_size                         45
+#define NAddPickup_size                          60
 #define NRemovePickup_size                       17
 #define NBulletBounce_size                       67
 #define NRemoveBullet_size                       6
-#define NGunReload_size                          177
-#define NGunFire_size                            203
+#define NGunReload_size                          57
+#define NGunFire_size                            83
 #define NGunState_size                           17
-#define NAddBullet_size                          216
+#define NAddBullet_size                          96
 #define NTrigger_size                            30
 #define NExploreTiles_size                       592
 #define NExploreTiles_Run_size                   35
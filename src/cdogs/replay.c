@@ -0,0 +1,443 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "replay.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <SDL_timer.h>
+
+#include "actors.h"
+#include "config.h"
+#include "game_events.h"
+#include "handle_game_events.h"
+#include "log.h"
+#include "net_util.h"
+#include "objs.h"
+#include "proto/nanopb/pb_decode.h"
+#include "proto/nanopb/pb_encode.h"
+
+#define REPLAY_MAGIC "CDRP"
+#define REPLAY_VERSION 2
+
+Replay gReplay;
+
+// Config groups whose values affect the game simulation
+static const char *configGroups[] = { "Game", "Deathmatch", "Dogfight" };
+
+
+void ReplayInit(Replay *r)
+{
+	memset(r, 0, sizeof *r);
+	CArrayInit(&r->Configs, sizeof(NConfig));
+	CArrayInit(&r->Players, sizeof(ReplayPlayer));
+}
+void ReplayTerminate(Replay *r)
+{
+	if (r->f != NULL)
+	{
+		fclose(r->f);
+	}
+	CArrayTerminate(&r->Configs);
+	CArrayTerminate(&r->Players);
+}
+
+static bool SetFilename(Replay *r, const char *filename)
+{
+	const size_t len = strlen(filename);
+	if (len >= sizeof r->Filename)
+	{
+		LOG(LM_MAIN, LL_ERROR, "replay path too long (%d chars, max %d)",
+			(int)len, (int)sizeof r->Filename - 1);
+		return false;
+	}
+	memcpy(r->Filename, filename, len + 1);
+	return true;
+}
+
+bool ReplayRecord(Replay *r, const char *filename)
+{
+	if (!SetFilename(r, filename))
+	{
+		return false;
+	}
+	r->Mode = REPLAY_MODE_RECORD;
+	LOG(LM_MAIN, LL_INFO, "recording next mission to %s", filename);
+	return true;
+}
+
+static bool ReadCallback(pb_istream_t *stream, uint8_t *buf, size_t count)
+{
+	return fread(buf, 1, count, stream->state) == count;
+}
+static pb_istream_t IStream(FILE *f)
+{
+	pb_istream_t s = { ReadCallback, f, SIZE_MAX, NULL };
+	return s;
+}
+static bool WriteCallback(pb_ostream_t *stream, const uint8_t *buf, size_t count)
+{
+	return fwrite(buf, 1, count, stream->state) == count;
+}
+static pb_ostream_t OStream(FILE *f)
+{
+	pb_ostream_t s = { WriteCallback, f, SIZE_MAX, 0, NULL };
+	return s;
+}
+static bool ReadInt(FILE *f, int *value)
+{
+	pb_istream_t s = IStream(f);
+	uint64_t v;
+	if (!pb_decode_varint(&s, &v)) return false;
+	*value = (int)v;
+	return true;
+}
+static void WriteInt(FILE *f, const int value)
+{
+	pb_ostream_t s = OStream(f);
+	pb_encode_varint(&s, (uint64_t)(unsigned int)value);
+}
+
+bool ReplayLoad(Replay *r, const char *filename)
+{
+	if (!SetFilename(r, filename))
+	{
+		return false;
+	}
+	r->f = fopen(filename, "rb");
+	if (r->f == NULL)
+	{
+		LOG(LM_MAIN, LL_ERROR, "cannot open replay %s", filename);
+		return false;
+	}
+	char magic[4];
+	int version;
+	if (fread(magic, 1, sizeof magic, r->f) != sizeof magic ||
+		memcmp(magic, REPLAY_MAGIC, sizeof magic) != 0 ||
+		!ReadInt(r->f, &version) || version != REPLAY_VERSION)
+	{
+		LOG(LM_MAIN, LL_ERROR, "%s is not a valid replay", filename);
+		goto bail;
+	}
+	pb_istream_t s = IStream(r->f);
+	int seed;
+	if (!pb_decode_delimited(&s, NCampaignDef_fields, &r->Campaign) ||
+		!ReadInt(r->f, &seed))
+	{
+		goto corrupt;
+	}
+	r->Seed = (unsigned int)seed;
+	int count;
+	if (!ReadInt(r->f, &count)) goto corrupt;
+	for (int i = 0; i < count; i++)
+	{
+		NConfig c = NConfig_init_default;
+		if (!pb_decode_delimited(&s, NConfig_fields, &c)) goto corrupt;
+		CArrayPushBack(&r->Configs, &c);
+	}
+	if (!ReadInt(r->f, &count) || count > MAX_LOCAL_PLAYERS) goto corrupt;
+	for (int i = 0; i < count; i++)
+	{
+		ReplayPlayer p;
+		p.Data = (NPlayerData)NPlayerData_init_default;
+		int inputDevice;
+		if (!pb_decode_delimited(&s, NPlayerData_fields, &p.Data) ||
+			!ReadInt(r->f, &inputDevice))
+		{
+			goto corrupt;
+		}
+		p.InputDevice = (input_device_e)inputDevice;
+		CArrayPushBack(&r->Players, &p);
+	}
+	r->Mode = REPLAY_MODE_PLAY;
+	LOG(LM_MAIN, LL_INFO, "loaded replay %s: campaign(%s) mission(%d) seed(%u)",
+		filename, r->Campaign.Path, (int)r->Campaign.Mission, r->Seed);
+	return true;
+
+corrupt:
+	LOG(LM_MAIN, LL_ERROR, "replay %s is corrupt", filename);
+bail:
+	fclose(r->f);
+	r->f = NULL;
+	return false;
+}
+
+bool ReplayIsRecording(const Replay *r)
+{
+	return r->Mode == REPLAY_MODE_RECORD;
+}
+bool ReplayIsPlaying(const Replay *r)
+{
+	return r->Mode == REPLAY_MODE_PLAY;
+}
+
+void ReplaySetupPlayers(const Replay *r)
+{
+	// Apply the recorded config the same way a net client would
+	CA_FOREACH(const NConfig, c, r->Configs)
+		GameEvent e = GameEventNew(GAME_EVENT_CONFIG);
+		e.u.Config = *c;
+		GameEventsEnqueue(&gGameEvents, &e);
+	CA_FOREACH_END()
+	CA_FOREACH(const ReplayPlayer, rp, r->Players)
+		GameEvent e = GameEventNew(GAME_EVENT_PLAYER_DATA);
+		e.u.PlayerData = rp->Data;
+		GameEventsEnqueue(&gGameEvents, &e);
+	CA_FOREACH_END()
+	HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
+	CA_FOREACH(const ReplayPlayer, rp, r->Players)
+		PlayerData *p = PlayerDataGetByUID(rp->Data.UID);
+		p->inputDevice = rp->InputDevice;
+	CA_FOREACH_END()
+}
+
+static void WriteHeader(Replay *r, const CampaignOptions *co)
+{
+	fwrite(REPLAY_MAGIC, 1, strlen(REPLAY_MAGIC), r->f);
+	WriteInt(r->f, REPLAY_VERSION);
+	pb_ostream_t s = OStream(r->f);
+	const NCampaignDef def = NMakeCampaignDef(co);
+	pb_encode_delimited(&s, NCampaignDef_fields, &def);
+	WriteInt(r->f, (int)r->Seed);
+
+	CArrayClear(&r->Configs);
+	for (int i = 0; i < (int)(sizeof configGroups / sizeof *configGroups); i++)
+	{
+		CA_FOREACH(const Config, c, *ConfigGetGroup(&gConfig, configGroups[i]))
+			if (c->Type == CONFIG_TYPE_STRING || c->Type == CONFIG_TYPE_GROUP)
+			{
+				continue;
+			}
+			char name[256];
+			sprintf(name, "%s.%s", configGroups[i], c->Name);
+			const NConfig nc = NMakeConfig(&gConfig, name);
+			CArrayPushBack(&r->Configs, &nc);
+		CA_FOREACH_END()
+	}
+	WriteInt(r->f, (int)r->Configs.size);
+	CA_FOREACH(const NConfig, c, r->Configs)
+		pb_encode_delimited(&s, NConfig_fields, c);
+	CA_FOREACH_END()
+
+	int numPlayers = 0;
+	CA_FOREACH(const PlayerData, p, gPlayerDatas)
+		if (p->IsLocal) numPlayers++;
+	CA_FOREACH_END()
+	WriteInt(r->f, numPlayers);
+	CA_FOREACH(const PlayerData, p, gPlayerDatas)
+		if (!p->IsLocal) continue;
+		const NPlayerData pd = NMakePlayerData(p);
+		pb_encode_delimited(&s, NPlayerData_fields, &pd);
+		WriteInt(r->f, (int)p->inputDevice);
+	CA_FOREACH_END()
+}
+
+void ReplayStart(Replay *r, const CampaignOptions *co)
+{
+	if (r->Mode == REPLAY_MODE_NONE)
+	{
+		return;
+	}
+	if (r->Mode == REPLAY_MODE_RECORD)
+	{
+		// Remote players' commands aren't available to record
+		if (co->IsClient || ConfigGetBool(&gConfig, "StartServer"))
+		{
+			LOG(LM_MAIN, LL_WARN, "cannot record replays of net games");
+			r->Mode = REPLAY_MODE_NONE;
+			return;
+		}
+		// Quick play campaigns are generated, and can't be loaded by path
+		if (co->Entry.Path == NULL || co->Entry.Path[0] == '\0')
+		{
+			LOG(LM_MAIN, LL_WARN, "cannot record replays without campaign file");
+			r->Mode = REPLAY_MODE_NONE;
+			return;
+		}
+		r->f = fopen(r->Filename, "wb");
+		if (r->f == NULL)
+		{
+			LOG(LM_MAIN, LL_ERROR, "cannot open %s for recording", r->Filename);
+			r->Mode = REPLAY_MODE_NONE;
+			return;
+		}
+		// Use a fresh seed for PVP modes, like normal games
+		r->Seed = IsPVP(co->Entry.Mode) ?
+			(unsigned int)time(NULL) : CampaignMissionSeed(co);
+		WriteHeader(r, co);
+	}
+	// Seed here rather than relying on the campaign seed, as the menus
+	// leading up to the mission also use random numbers
+	srand(r->Seed);
+	memset(r->cmds, 0, sizeof r->cmds);
+	r->run = 0;
+	r->Frames = 0;
+	r->startTicks = SDL_GetTicks();
+}
+
+static void WriteRun(Replay *r)
+{
+	if (r->run == 0) return;
+	WriteInt(r->f, r->run);
+	for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+	{
+		WriteInt(r->f, r->cmds[i]);
+	}
+}
+bool ReplayUpdate(Replay *r, int *cmds)
+{
+	switch (r->Mode)
+	{
+	case REPLAY_MODE_RECORD:
+		if (r->run > 0 && memcmp(r->cmds, cmds, sizeof r->cmds) != 0)
+		{
+			WriteRun(r);
+			r->run = 0;
+		}
+		memcpy(r->cmds, cmds, sizeof r->cmds);
+		r->run++;
+		break;
+	case REPLAY_MODE_PLAY:
+		if (r->run < 0)
+		{
+			return false;
+		}
+		if (r->run == 0)
+		{
+			// A run of zero marks the end of the replay
+			if (!ReadInt(r->f, &r->run) || r->run == 0)
+			{
+				r->run = -1;
+				return false;
+			}
+			for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+			{
+				if (!ReadInt(r->f, &r->cmds[i]))
+				{
+					LOG(LM_MAIN, LL_ERROR, "replay ended unexpectedly");
+					r->run = -1;
+					return false;
+				}
+			}
+		}
+		r->run--;
+		memcpy(cmds, r->cmds, sizeof r->cmds);
+		break;
+	default:
+		return true;
+	}
+	r->Frames++;
+	return true;
+}
+
+// Hash the game state that the replay should reproduce
+static uint32_t Checksum(void)
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+#define HASH(_x) \
+	do\
+	{\
+		const uint32_t _v = (uint32_t)(_x);\
+		for (int _i = 0; _i < 4; _i++)\
+		{\
+			hash = (hash ^ ((_v >> (_i * 8)) & 0xff)) * 16777619u;\
+		}\
+	} while (0)
+	CA_FOREACH(const TActor, a, gActors)
+		if (!a->isInUse) continue;
+		HASH(a->uid);
+		HASH(a->Pos.x);
+		HASH(a->Pos.y);
+		HASH(a->health);
+		HASH(a->dead);
+	CA_FOREACH_END()
+	CA_FOREACH(const TObject, o, gObjs)
+		if (!o->isInUse) continue;
+		HASH(o->uid);
+		HASH(o->Health);
+	CA_FOREACH_END()
+	HASH(gMission.time);
+#undef HASH
+	return hash;
+}
+
+void ReplayEnd(Replay *r)
+{
+	if (r->f == NULL)
+	{
+		return;
+	}
+	const uint32_t checksum = Checksum();
+	const Uint32 ticks = SDL_GetTicks() - r->startTicks;
+	if (r->Mode == REPLAY_MODE_RECORD)
+	{
+		WriteRun(r);
+		WriteInt(r->f, 0);
+		pb_ostream_t s = OStream(r->f);
+		pb_encode_fixed32(&s, &checksum);
+		LOG(LM_MAIN, LL_INFO, "recorded %d frames to %s",
+			r->Frames, r->Filename);
+		// Only record one mission
+		r->Mode = REPLAY_MODE_NONE;
+	}
+	else
+	{
+		// Skip any unplayed commands to get to the checksum
+		while (r->run >= 0)
+		{
+			if (!ReadInt(r->f, &r->run) || r->run == 0) break;
+			int cmd;
+			for (int i = 0; i < MAX_LOCAL_PLAYERS; i++)
+			{
+				ReadInt(r->f, &cmd);
+			}
+		}
+		uint32_t expected;
+		pb_istream_t s = IStream(r->f);
+		if (!pb_decode_fixed32(&s, &expected))
+		{
+			LOG(LM_MAIN, LL_WARN, "replay has no checksum");
+		}
+		else if (expected != checksum)
+		{
+			LOG(LM_MAIN, LL_ERROR,
+				"replay desync: checksum(%08x) expected(%08x)",
+				checksum, expected);
+		}
+		else
+		{
+			LOG(LM_MAIN, LL_INFO, "replay checksum ok (%08x)", checksum);
+		}
+		LOG(LM_MAIN, LL_INFO, "played %d frames in %ums (%.1f fps)",
+			r->Frames, ticks, ticks > 0 ? r->Frames * 1000.0 / ticks : 0.0);
+	}
+	fclose(r->f);
+	r->f = NULL;
+}
@@ -0,0 +1,101 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include <SDL_stdinc.h>
+
+#include "campaigns.h"
+#include "player.h"
+#include "sys_config.h"
+
+typedef enum
+{
+	REPLAY_MODE_NONE,
+	REPLAY_MODE_RECORD,
+	REPLAY_MODE_PLAY
+} ReplayMode;
+
+typedef struct
+{
+	NPlayerData Data;
+	input_device_e InputDevice;
+} ReplayPlayer;
+
+// Records the inputs of a single mission to a file, so that the mission
+// can be re-simulated exactly, as fast as possible.
+// The file stores the campaign, mission, random seed, game config and
+// players, followed by run-length encoded player commands, one per update,
+// and a checksum of the final game state.
+typedef struct
+{
+	ReplayMode Mode;
+	char Filename[CDOGS_PATH_MAX];
+	FILE *f;
+	// Skip drawing during playback
+	bool NoRender;
+
+	NCampaignDef Campaign;
+	unsigned int Seed;
+	CArray Configs;	// of NConfig
+	CArray Players;	// of ReplayPlayer
+
+	// Current run of identical commands
+	int cmds[MAX_LOCAL_PLAYERS];
+	int run;	// -1 once playback has finished
+	int Frames;
+	Uint32 startTicks;
+} Replay;
+
+extern Replay gReplay;
+
+void ReplayInit(Replay *r);
+void ReplayTerminate(Replay *r);
+
+// Record the next mission played to a file
+// Returns false if the path does not fit in Filename
+bool ReplayRecord(Replay *r, const char *filename);
+// Load a replay file for playback; ScreenReplay plays it back
+bool ReplayLoad(Replay *r, const char *filename);
+
+bool ReplayIsRecording(const Replay *r);
+bool ReplayIsPlaying(const Replay *r);
+
+// Set up the players and config for a loaded replay
+void ReplaySetupPlayers(const Replay *r);
+
+// Call at the start of a mission; seeds the random number generator
+// and writes the replay header if recording
+void ReplayStart(Replay *r, const CampaignOptions *co);
+// Record or play back the local player commands for one update
+// Returns false if the playback has finished
+bool ReplayUpdate(Replay *r, int *cmds);
+// Call at the end of a mission; closes the file and checks the final state
+void ReplayEnd(Replay *r);
@@ -57,6 +57,16 @@ ScreenShake ScreenShakeAdd(ScreenShake s, int force, int multiplier)
 // Convert ticks left to a shake delta
 #define TICKS_TO_DELTA_RATIO 28
 
+// Screen shake is only drawn, so use a separate random number generator;
+// this keeps the game's random numbers the same regardless of how many
+// frames are drawn, which replays rely on
+static unsigned int shakeSeed = 1;
+static int ShakeRand(void)
+{
+	shakeSeed = shakeSeed * 1103515245 + 12345;
+	return (int)((shakeSeed >> 16) & 0x7fff);
+}
+
 Vec2i ScreenShakeGetDelta(ScreenShake s)
 {
 	int maxDelta = s * TICKS_TO_DELTA_RATIO / SHAKE_STANDARD;
@@ -64,7 +74,7 @@ Vec2i ScreenShakeGetDelta(ScreenShake s)
 	{
 		return Vec2iZero();
 	}
-	return Vec2iNew(rand() % maxDelta, rand() % maxDelta);
+	return Vec2iNew(ShakeRand() % maxDelta, ShakeRand() % maxDelta);
 }
 
 ScreenShake ScreenShakeUpdate(ScreenShake s, int ticks)
@@ -63,6 +63,7 @@
 #include "log.h"
 #include "map.h"
 #include "music.h"
+#include "thread_pool.h"
 #include "vector.h"
 
 SoundDevice gSoundDevice;
@@ -92,43 +93,45 @@ int OpenAudio(int frequency, Uint16 format, int channels, int chunkSize)
 	return 0;
 }
 
-static void LoadSound(SoundDevice *device, const char *name, const char *path)
+void SoundAdd(map_t sounds, const char *name, Mix_Chunk *data)
 {
-	Mix_Chunk *data = Mix_LoadWAV(path);
-	if (data == NULL)
+	// Keep the first sound with the same name, e.g. same file with
+	// different ext; the existing one may be playing
+	const int error = hashmap_put(sounds, name, data);
+	if (error == MAP_EXISTS)
 	{
-		return;
+		LOG(LM_MAIN, LL_WARN, "duplicate sound %s, ignoring", name);
+		Mix_FreeChunk(data);
+	}
+	else if (error != MAP_OK)
+	{
+		LOG(LM_MAIN, LL_ERROR, "failed to add sound %s: %d", name, error);
+		Mix_FreeChunk(data);
 	}
-	char buf[CDOGS_FILENAME_MAX];
-	PathGetWithoutExtension(buf, name);
-	SoundAdd(&device->sounds, buf, data);
-}
-void SoundAdd(CArray *sounds, const char *name, Mix_Chunk *data)
-{
-	SoundData sound;
-	sound.data = data;
-	strcpy(sound.Name, name);
-	CArrayPushBack(sounds, &sound);
 }
 
 static void SoundLoadDirImpl(
-	SoundDevice *s, const char *path, const char *prefix);
+	SoundDevice *s, const char *path, const char *prefix, const bool decode);
 void SoundInitialize(SoundDevice *device, const char *path)
 {
 	memset(device, 0, sizeof *device);
+	CArrayInit(&device->soundNames, sizeof(char *));
+	CArrayInit(&device->customSoundNames, sizeof(char *));
+	char buf[CDOGS_PATH_MAX];
+	GetDataFilePath(buf, path);
 	if (OpenAudio(44100, AUDIO_S16, 2, 1024) != 0)
 	{
+		// Still need the names for sound IDs
+		SoundLoadDirImpl(device, buf, NULL, false);
 		return;
 	}
 
 	device->channels = 64;
 	SoundReconfigure(device);
 
-	CArrayInit(&device->sounds, sizeof(SoundData));
-	CArrayInit(&device->customSounds, sizeof(SoundData));
-	char buf[CDOGS_PATH_MAX];
-	GetDataFilePath(buf, path);
-	SoundLoadDirImpl(device, buf, NULL);
+	device->sounds = hashmap_new();
+	device->customSounds = hashmap_new();
+	SoundLoadDirImpl(device, buf, NULL, true);
 
 	// Look for commonly used sounds to set our pointers
 	CArrayInit(&device->footstepSounds, sizeof(Mix_Chunk *));
@@ -156,8 +159,69 @@ void SoundInitialize(SoundDevice *device, const char *path)
 		CArrayPushBack(&device->screamSounds, &scream);
 	}
 }
+// A sound file to load; files are decoded in parallel, then added in order
+typedef struct
+{
+	char Path[CDOGS_PATH_MAX];
+	char Name[CDOGS_FILENAME_MAX];
+	Mix_Chunk *Data;
+	bool IsDecoded;
+} SoundLoadTask;
+static void SoundLoadTaskDecode(void *data, const int index)
+{
+	SoundLoadTask *t = CArrayGet(data, index);
+	if (t->IsDecoded)
+	{
+		return;
+	}
+	t->Data = Mix_LoadWAV(t->Path);
+	t->IsDecoded = true;
+}
+static void CollectSoundFiles(
+	CArray *tasks, const char *path, const char *prefix);
 static void SoundLoadDirImpl(
-	SoundDevice *s, const char *path, const char *prefix)
+	SoundDevice *s, const char *path, const char *prefix, const bool decode)
+{
+	CArray tasks;
+	CArrayInit(&tasks, sizeof(SoundLoadTask));
+	CollectSoundFiles(&tasks, path, prefix);
+	CA_FOREACH(const SoundLoadTask, t, tasks)
+		SoundAddName(&s->soundNames, t->Name);
+	CA_FOREACH_END()
+	if (!decode)
+	{
+		goto bail;
+	}
+	// Decode the first file of each type on this thread; SDL_mixer loads
+	// its codec libraries lazily, which isn't safe from multiple threads
+	for (int i = 0; i < (int)tasks.size; i++)
+	{
+		const SoundLoadTask *t = CArrayGet(&tasks, i);
+		const char *ext = StrGetFileExt(t->Path);
+		bool isFirst = true;
+		for (int j = 0; j < i && isFirst; j++)
+		{
+			const SoundLoadTask *prev = CArrayGet(&tasks, j);
+			isFirst = strcmp(StrGetFileExt(prev->Path), ext) != 0;
+		}
+		if (isFirst)
+		{
+			SoundLoadTaskDecode(&tasks, i);
+		}
+	}
+	ThreadPoolRun(&gThreadPool, SoundLoadTaskDecode, &tasks, (int)tasks.size);
+	CA_FOREACH(const SoundLoadTask, t, tasks)
+		if (t->Data != NULL)
+		{
+			SoundAdd(s->sounds, t->Name, t->Data);
+		}
+	CA_FOREACH_END()
+
+bail:
+	CArrayTerminate(&tasks);
+}
+static void CollectSoundFiles(
+	CArray *tasks, const char *path, const char *prefix)
 {
 	tinydir_dir dir;
 	if (tinydir_open(&dir, path) == -1)
@@ -184,11 +248,15 @@ static void SoundLoadDirImpl(
 		}
 		if (file.is_reg)
 		{
-			LoadSound(s, buf, file.path);
+			SoundLoadTask t;
+			memset(&t, 0, sizeof t);
+			strcpy(t.Path, file.path);
+			PathGetWithoutExtension(t.Name, buf);
+			CArrayPushBack(tasks, &t);
 		}
 		else if (file.is_dir && file.name[0] != '.')
 		{
-			SoundLoadDirImpl(s, file.path, buf);
+			CollectSoundFiles(tasks, file.path, buf);
 		}
 	}
 
@@ -220,17 +288,66 @@ void SoundReconfigure(SoundDevice *s)
 	s->isInitialised = true;
 }
 
-void SoundClear(CArray *sounds)
+// Binary search; returns the index of the name, or -1 - the index to insert
+// it at
+static int FindSoundName(const CArray *names, const char *name)
 {
-	for (int i = 0; i < (int)sounds->size; i++)
+	int lo = 0;
+	int hi = (int)names->size;
+	while (lo < hi)
 	{
-		SoundData *sound = CArrayGet(sounds, i);
-		Mix_FreeChunk(sound->data);
+		const int mid = (lo + hi) / 2;
+		const int cmp = strcmp(*(char **)CArrayGet(names, mid), name);
+		if (cmp == 0)
+		{
+			return mid;
+		}
+		if (cmp < 0)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return -1 - lo;
+}
+void SoundAddName(CArray *names, const char *name)
+{
+	const int idx = FindSoundName(names, name);
+	if (idx >= 0)
+	{
+		// Same file with different ext
+		return;
 	}
-	CArrayClear(sounds);
+	char *s;
+	CSTRDUP(s, name);
+	CArrayInsert(names, -1 - idx, &s);
+}
+static void SoundNamesClear(CArray *names)
+{
+	CA_FOREACH(char *, name, *names)
+		CFREE(*name);
+	CA_FOREACH_END()
+	CArrayClear(names);
+}
+
+static void SoundDataDestroy(any_t data)
+{
+	Mix_FreeChunk(data);
+}
+void SoundClear(map_t sounds, CArray *names)
+{
+	hashmap_clear(sounds, SoundDataDestroy);
+	SoundNamesClear(names);
 }
 void SoundTerminate(SoundDevice *device, const bool waitForSoundsComplete)
 {
+	SoundNamesClear(&device->soundNames);
+	CArrayTerminate(&device->soundNames);
+	SoundNamesClear(&device->customSoundNames);
+	CArrayTerminate(&device->customSoundNames);
 	if (!device->isInitialised)
 	{
 		return;
@@ -250,10 +367,10 @@ void SoundTerminate(SoundDevice *device, const bool waitForSoundsComplete)
 	}
 	Mix_CloseAudio();
 
-	SoundClear(&device->sounds);
-	CArrayTerminate(&device->sounds);
-	SoundClear(&device->customSounds);
-	CArrayTerminate(&device->customSounds);
+	hashmap_destroy(device->sounds, SoundDataDestroy);
+	device->sounds = NULL;
+	hashmap_destroy(device->customSounds, SoundDataDestroy);
+	device->customSounds = NULL;
 }
 
 #define OUT_OF_SIGHT_DISTANCE_PLUS 200
@@ -384,8 +501,7 @@ void SoundPlayAt(SoundDevice *device, Mix_Chunk *data, const Vec2i pos)
 
 static bool IsPosNoSee(void *data, Vec2i pos)
 {
-	const Tile *t = MapGetTile(data, Vec2iToTile(pos));
-	return t != NULL && (t->flags & MAPTILE_NO_SEE);
+	return !MapTileCanSee(data, Vec2iToTile(pos));
 }
 void SoundPlayAtPlusDistance(
 	SoundDevice *device, Mix_Chunk *data,
@@ -440,19 +556,43 @@ Mix_Chunk *StrSound(const char *s)
 	{
 		return NULL;
 	}
-	CA_FOREACH(SoundData, sound, gSoundDevice.customSounds)
-		if (strcmp(sound->Name, s) == 0)
-		{
-			return sound->data;
-		}
-	CA_FOREACH_END()
-	CA_FOREACH(SoundData, sound, gSoundDevice.sounds)
-		if (strcmp(sound->Name, s) == 0)
-		{
-			return sound->data;
-		}
-	CA_FOREACH_END()
-	return NULL;
+	Mix_Chunk *sound;
+	if (hashmap_get(gSoundDevice.customSounds, s, (any_t *)&sound) == MAP_OK)
+	{
+		return sound;
+	}
+	hashmap_get(gSoundDevice.sounds, s, (any_t *)&sound);
+	return sound;
+}
+int StrSoundId(const char *s)
+{
+	if (s == NULL || strlen(s) == 0)
+	{
+		return -1;
+	}
+	// Custom sounds replace built-in ones with the same name
+	const int customIdx = FindSoundName(&gSoundDevice.customSoundNames, s);
+	if (customIdx >= 0)
+	{
+		return (int)gSoundDevice.soundNames.size + customIdx;
+	}
+	const int idx = FindSoundName(&gSoundDevice.soundNames, s);
+	return idx >= 0 ? idx : -1;
+}
+Mix_Chunk *IdSound(const int id)
+{
+	const CArray *names = &gSoundDevice.soundNames;
+	int idx = id;
+	if (idx >= (int)names->size)
+	{
+		names = &gSoundDevice.customSoundNames;
+		idx -= (int)gSoundDevice.soundNames.size;
+	}
+	if (idx < 0 || idx >= (int)names->size)
+	{
+		return NULL;
+	}
+	return StrSound(*(char **)CArrayGet(names, idx));
 }
 
 Mix_Chunk *SoundGetRandomFootstep(SoundDevice *device)
@@ -53,17 +53,12 @@
 #include <SDL_mixer.h>
 
 #include "c_array.h"
+#include "c_hashmap/hashmap.h"
 #include "defs.h"
 #include "sys_config.h"
 #include "utils.h"
 #include "vector.h"
 
-typedef struct
-{
-	char Name[CDOGS_FILENAME_MAX];
-	Mix_Chunk *data;
-} SoundData;
-
 typedef enum
 {
 	MUSIC_OK,
@@ -86,8 +81,12 @@ typedef struct
 	Vec2i earRight1;
 	Vec2i earRight2;
 
-	CArray sounds;	// of SoundData
-	CArray customSounds;	// of SoundData
+	map_t sounds;	// of Mix_Chunk
+	map_t customSounds;	// of Mix_Chunk
+	// Sorted names of all sound files found, even without audio; these give
+	// sounds the same IDs for every player with the same data
+	CArray soundNames;	// of char *
+	CArray customSoundNames;	// of char *
 
 	// Some commonly-used sounds, store them here for quick access
 	CArray footstepSounds;	// of Mix_Chunk *
@@ -121,9 +120,10 @@ typedef struct
 } HitSounds;
 
 void SoundInitialize(SoundDevice *device, const char *path);
-void SoundAdd(CArray *sounds, const char *name, Mix_Chunk *data);
+void SoundAdd(map_t sounds, const char *name, Mix_Chunk *data);
+void SoundAddName(CArray *names, const char *name);
 void SoundReconfigure(SoundDevice *s);
-void SoundClear(CArray *sounds);
+void SoundClear(map_t sounds, CArray *names);
 void SoundTerminate(SoundDevice *device, const bool waitForSoundsComplete);
 void SoundPlay(SoundDevice *device, Mix_Chunk *data);
 void SoundSetEarsSide(const bool isLeft, const Vec2i pos);
@@ -138,5 +138,9 @@ void SoundPlayAtPlusDistance(
 	const Vec2i pos, const int plusDistance);
 
 Mix_Chunk *StrSound(const char *s);
+// IDs index the built-in names, then the custom ones, for sending sounds over
+// the network without names; -1 is no sound
+int StrSoundId(const char *s);
+Mix_Chunk *IdSound(const int id);
 Mix_Chunk *SoundGetRandomFootstep(SoundDevice *device);
 Mix_Chunk *SoundGetRandomScream(SoundDevice *device);
@@ -0,0 +1,294 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "spatial_query.h"
+
+#include <stdlib.h>
+
+#include "actors.h"
+#include "objs.h"
+#include "pickup.h"
+
+// Scanning up to this many things is faster than searching tiles
+#define SCAN_THINGS_MAX 64
+// How many tiles can be searched for each thing that could be scanned
+// instead; checking a tile is much cheaper than checking a thing
+#define TILES_PER_THING 4
+
+
+SpatialQuery SpatialQueryNew(const Vec2i fullPos, const int kindMask)
+{
+	SpatialQuery q;
+	q.FullPos = fullPos;
+	q.KindMask = kindMask;
+	q.Filter = NULL;
+	q.FilterData = NULL;
+	q.MaxDistance = -1;
+	return q;
+}
+
+// Results so far; for nearest queries, a sorted array of up to K results,
+// otherwise an unsorted CArray
+typedef struct
+{
+	const SpatialQuery *Q;
+	SpatialQueryResult *Results;
+	int K;
+	int N;
+	CArray *All;
+} Search;
+
+static bool ResultLess(
+	const SpatialQueryResult *r1, const SpatialQueryResult *r2)
+{
+	if (r1->Distance != r2->Distance)
+	{
+		return r1->Distance < r2->Distance;
+	}
+	if (r1->Id.Kind != r2->Id.Kind)
+	{
+		return r1->Id.Kind < r2->Id.Kind;
+	}
+	return r1->Id.Id < r2->Id.Id;
+}
+static int CompareResults(const void *v1, const void *v2)
+{
+	const SpatialQueryResult *r1 = v1;
+	const SpatialQueryResult *r2 = v2;
+	if (ResultLess(r1, r2))
+	{
+		return -1;
+	}
+	return ResultLess(r2, r1) ? 1 : 0;
+}
+
+static Vec2i ThingFullPos(const ThingId *tid, const TTileItem *ti)
+{
+	if (tid->Kind == KIND_CHARACTER)
+	{
+		const TActor *a = CArrayGet(&gActors, tid->Id);
+		return a->Pos;
+	}
+	return Vec2iReal2Full(Vec2iNew(ti->x, ti->y));
+}
+
+static void Consider(
+	Search *s, const ThingId *tid, TTileItem *ti, const Vec2i pos)
+{
+	const SpatialQuery *q = s->Q;
+	SpatialQueryResult r;
+	r.Id = *tid;
+	r.Item = ti;
+	r.Distance = CHEBYSHEV_DISTANCE(q->FullPos.x, q->FullPos.y, pos.x, pos.y);
+	if (q->MaxDistance >= 0 && r.Distance > q->MaxDistance)
+	{
+		return;
+	}
+	// Check the distance before the filter, which may be more expensive
+	const bool isFull = s->All == NULL && s->N == s->K;
+	if (isFull && !ResultLess(&r, &s->Results[s->N - 1]))
+	{
+		return;
+	}
+	if (q->Filter != NULL && !q->Filter(tid, ti, q->FilterData))
+	{
+		return;
+	}
+	if (s->All != NULL)
+	{
+		CArrayPushBack(s->All, &r);
+		return;
+	}
+	// Insert into the sorted nearest results, dropping the furthest if full
+	int i = isFull ? s->K - 1 : s->N++;
+	for (; i > 0 && ResultLess(&r, &s->Results[i - 1]); i--)
+	{
+		s->Results[i] = s->Results[i - 1];
+	}
+	s->Results[i] = r;
+}
+
+static void ConsiderTile(Search *s, Map *map, const Vec2i v)
+{
+	const Tile *t = MapGetTile(map, v);
+	CA_FOREACH(const ThingId, tid, t->things)
+		if (s->Q->KindMask & SPATIAL_QUERY_KIND(tid->Kind))
+		{
+			ThingId id = *tid;
+			TTileItem *ti = ThingIdGetTileItem(&id);
+			Consider(s, &id, ti, ThingFullPos(&id, ti));
+		}
+	CA_FOREACH_END()
+}
+
+// Number of things that would be checked by scanning
+static int CountThings(const int kindMask)
+{
+	int count = 0;
+	if (kindMask & SPATIAL_QUERY_KIND(KIND_CHARACTER))
+	{
+		count += (int)gActors.size;
+	}
+	if (kindMask & SPATIAL_QUERY_KIND(KIND_MOBILEOBJECT))
+	{
+		count += (int)gMobObjs.size;
+	}
+	if (kindMask & SPATIAL_QUERY_KIND(KIND_OBJECT))
+	{
+		count += (int)gObjs.size;
+	}
+	if (kindMask & SPATIAL_QUERY_KIND(KIND_PICKUP))
+	{
+		count += (int)gPickups.size;
+	}
+	return count;
+}
+
+#define SCAN(_kind, _type, _array, _fullPos)\
+	if (s->Q->KindMask & SPATIAL_QUERY_KIND(_kind))\
+	{\
+		CA_FOREACH(_type, _t, _array)\
+			if (!_t->isInUse) continue;\
+			const ThingId tid = { _ca_index, _kind };\
+			Consider(s, &tid, &_t->tileItem, _fullPos);\
+		CA_FOREACH_END()\
+	}
+#define TILE_ITEM_FULL_POS(_t)\
+	Vec2iReal2Full(Vec2iNew(_t->tileItem.x, _t->tileItem.y))
+static void ScanThings(Search *s)
+{
+	SCAN(KIND_CHARACTER, TActor, gActors, _t->Pos);
+	SCAN(KIND_MOBILEOBJECT, TMobileObject, gMobObjs, TILE_ITEM_FULL_POS(_t));
+	SCAN(KIND_OBJECT, TObject, gObjs, TILE_ITEM_FULL_POS(_t));
+	SCAN(KIND_PICKUP, Pickup, gPickups, TILE_ITEM_FULL_POS(_t));
+}
+
+static void SearchRings(Search *s, Map *map)
+{
+	const SpatialQuery *q = s->Q;
+	CASSERT(
+		!(q->KindMask & SPATIAL_QUERY_KIND(KIND_PARTICLE)),
+		"cannot query particles");
+	const Vec2i c = Vec2iToTile(Vec2iFull2Real(q->FullPos));
+	// Beyond this ring, there are no more tiles
+	const int maxR = MAX(
+		MAX(abs(c.x), abs(map->Size.x - 1 - c.x)),
+		MAX(abs(c.y), abs(map->Size.y - 1 - c.y)));
+	const int numThings = CountThings(q->KindMask);
+	if (numThings <= SCAN_THINGS_MAX)
+	{
+		ScanThings(s);
+		return;
+	}
+	const int maxTiles = numThings * TILES_PER_THING;
+	int tilesSearched = 0;
+	for (int r = 0; r <= maxR; r++)
+	{
+		// Things in this ring are at least this far away, since the search
+		// position and the things can be anywhere within their tiles
+		const int minDistance =
+			MAX(0, (r - 1) * MIN(TILE_WIDTH, TILE_HEIGHT) - 1) << 8;
+		if (q->MaxDistance >= 0 && minDistance > q->MaxDistance)
+		{
+			break;
+		}
+		if (s->All == NULL && s->N == s->K &&
+			minDistance > s->Results[s->K - 1].Distance)
+		{
+			break;
+		}
+		tilesSearched += r == 0 ? 1 : 8 * r;
+		if (tilesSearched > maxTiles)
+		{
+			// Too sparse for the tiles to help; start again by scanning
+			s->N = 0;
+			if (s->All != NULL)
+			{
+				CArrayClear(s->All);
+			}
+			ScanThings(s);
+			return;
+		}
+		for (int y = c.y - r; y <= c.y + r; y++)
+		{
+			if (y < 0 || y >= map->Size.y)
+			{
+				continue;
+			}
+			// Whole rows at the top and bottom, otherwise just the sides
+			const int step = (y == c.y - r || y == c.y + r) ? 1 : 2 * r;
+			for (int x = c.x - r; x <= c.x + r; x += step)
+			{
+				if (x < 0 || x >= map->Size.x)
+				{
+					continue;
+				}
+				ConsiderTile(s, map, Vec2iNew(x, y));
+			}
+		}
+	}
+}
+
+int SpatialQueryNearest(
+	Map *map, const SpatialQuery *q, SpatialQueryResult *results,
+	const int k)
+{
+	if (k <= 0)
+	{
+		return 0;
+	}
+	Search s;
+	s.Q = q;
+	s.Results = results;
+	s.K = k;
+	s.N = 0;
+	s.All = NULL;
+	SearchRings(&s, map);
+	return s.N;
+}
+
+void SpatialQueryRadius(Map *map, const SpatialQuery *q, CArray *results)
+{
+	CASSERT(
+		results->elemSize == sizeof(SpatialQueryResult),
+		"wrong result array");
+	Search s;
+	s.Q = q;
+	s.Results = NULL;
+	s.K = 0;
+	s.N = 0;
+	CArray found;
+	CArrayInit(&found, sizeof(SpatialQueryResult));
+	s.All = &found;
+	SearchRings(&s, map);
+	qsort(
+		found.data, found.size, found.elemSize, CompareResults);
+	CA_FOREACH(const SpatialQueryResult, r, found)
+		CArrayPushBack(results, r);
+	CA_FOREACH_END()
+	CArrayTerminate(&found);
+}
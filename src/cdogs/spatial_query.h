@@ -0,0 +1,83 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include "c_array.h"
+#include "map.h"
+#include "tile.h"
+#include "vector.h"
+
+// Queries for the things nearest to a point.
+// Searches the map's tiles in rings outwards from the point, stopping once
+// no closer things can be found; if the rings would cover more tiles than
+// there are things to check, scans the things instead.
+// Only reads the map and things, so queries can run from multiple threads
+// as long as nothing moves.
+
+// Bit for each TileItemKind to search; particles are not supported
+#define SPATIAL_QUERY_KIND(_kind) (1 << (_kind))
+
+// Return whether a thing matches the query
+typedef bool (*SpatialQueryFilter)(
+	const ThingId *tid, const TTileItem *ti, void *data);
+
+typedef struct
+{
+	// Where to search from, in full coordinates
+	Vec2i FullPos;
+	// Of SPATIAL_QUERY_KIND
+	int KindMask;
+	// Optional
+	SpatialQueryFilter Filter;
+	void *FilterData;
+	// Furthest distance to search, in full coordinates; negative for no limit
+	int MaxDistance;
+} SpatialQuery;
+SpatialQuery SpatialQueryNew(const Vec2i fullPos, const int kindMask);
+
+typedef struct
+{
+	ThingId Id;
+	TTileItem *Item;
+	// Chebyshev distance in full coordinates; characters are measured from
+	// their full positions, other things from their tile item positions
+	int Distance;
+} SpatialQueryResult;
+
+// Find the k nearest matching things, closest first.
+// Ties go to the thing with the lowest kind then ID, i.e. the first in its
+// container, so results don't depend on how the search proceeds.
+// Returns the number found.
+int SpatialQueryNearest(
+	Map *map, const SpatialQuery *q, SpatialQueryResult *results,
+	const int k);
+// Find all matching things within MaxDistance, closest first
+// results: of SpatialQueryResult; appended to
+void SpatialQueryRadius(Map *map, const SpatialQuery *q, CArray *results);
@@ -0,0 +1,162 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "thread_pool.h"
+
+#include "log.h"
+#include "utils.h"
+
+ThreadPool gThreadPool;
+
+
+static int ThreadPoolWorker(void *data);
+void ThreadPoolInit(ThreadPool *tp, const int numThreads)
+{
+	memset(tp, 0, sizeof *tp);
+	CArrayInit(&tp->threads, sizeof(SDL_Thread *));
+	if (numThreads <= 0)
+	{
+		return;
+	}
+	tp->mutex = SDL_CreateMutex();
+	tp->workCond = SDL_CreateCond();
+	tp->doneCond = SDL_CreateCond();
+	for (int i = 0; i < numThreads; i++)
+	{
+		SDL_Thread *t = SDL_CreateThread(ThreadPoolWorker, "worker", tp);
+		if (t == NULL)
+		{
+			LOG(LM_MAIN, LL_ERROR, "cannot create worker thread: %s",
+				SDL_GetError());
+			break;
+		}
+		CArrayPushBack(&tp->threads, &t);
+	}
+	LOG(LM_MAIN, LL_INFO, "started %d worker threads", (int)tp->threads.size);
+}
+void ThreadPoolTerminate(ThreadPool *tp)
+{
+	if (tp->mutex != NULL)
+	{
+		SDL_LockMutex(tp->mutex);
+		tp->quit = true;
+		SDL_CondBroadcast(tp->workCond);
+		SDL_UnlockMutex(tp->mutex);
+	}
+	CA_FOREACH(SDL_Thread *, t, tp->threads)
+		SDL_WaitThread(*t, NULL);
+	CA_FOREACH_END()
+	CArrayTerminate(&tp->threads);
+	if (tp->mutex != NULL)
+	{
+		SDL_DestroyCond(tp->doneCond);
+		SDL_DestroyCond(tp->workCond);
+		SDL_DestroyMutex(tp->mutex);
+	}
+	memset(tp, 0, sizeof *tp);
+}
+
+int ThreadPoolConcurrency(const ThreadPool *tp)
+{
+	return (int)tp->threads.size + 1;
+}
+
+static void RunNext(ThreadPool *tp);
+void ThreadPoolRun(
+	ThreadPool *tp, ThreadPoolFunc func, void *data, const int count)
+{
+	bool runHere = tp->threads.size == 0 || count <= 1;
+	if (!runHere)
+	{
+		SDL_LockMutex(tp->mutex);
+		if (tp->remaining > 0)
+		{
+			// Pool is busy; don't wait for it
+			SDL_UnlockMutex(tp->mutex);
+			runHere = true;
+		}
+	}
+	if (runHere)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			func(data, i);
+		}
+		return;
+	}
+
+	tp->func = func;
+	tp->data = data;
+	tp->count = count;
+	tp->next = 0;
+	tp->remaining = count;
+	SDL_CondBroadcast(tp->workCond);
+	while (tp->next < tp->count)
+	{
+		RunNext(tp);
+	}
+	while (tp->remaining > 0)
+	{
+		SDL_CondWait(tp->doneCond, tp->mutex);
+	}
+	SDL_UnlockMutex(tp->mutex);
+}
+
+static int ThreadPoolWorker(void *data)
+{
+	ThreadPool *tp = data;
+	SDL_LockMutex(tp->mutex);
+	for (;;)
+	{
+		while (!tp->quit && tp->next >= tp->count)
+		{
+			SDL_CondWait(tp->workCond, tp->mutex);
+		}
+		if (tp->quit)
+		{
+			break;
+		}
+		RunNext(tp);
+	}
+	SDL_UnlockMutex(tp->mutex);
+	return 0;
+}
+// Run the next item of the batch; mutex must be held
+static void RunNext(ThreadPool *tp)
+{
+	const int index = tp->next++;
+	const ThreadPoolFunc func = tp->func;
+	void *data = tp->data;
+	SDL_UnlockMutex(tp->mutex);
+	func(data, index);
+	SDL_LockMutex(tp->mutex);
+	tp->remaining--;
+	if (tp->remaining == 0)
+	{
+		SDL_CondBroadcast(tp->doneCond);
+	}
+}
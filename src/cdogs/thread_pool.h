@@ -0,0 +1,69 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <stdbool.h>
+
+#include <SDL_thread.h>
+
+#include "c_array.h"
+
+typedef void (*ThreadPoolFunc)(void *data, const int index);
+
+typedef struct
+{
+	CArray threads;	// of SDL_Thread *
+	SDL_mutex *mutex;
+	SDL_cond *workCond;
+	SDL_cond *doneCond;
+	// Current batch of work
+	ThreadPoolFunc func;
+	void *data;
+	int count;
+	int next;
+	int remaining;
+	bool quit;
+} ThreadPool;
+
+// Pool of worker threads for splitting up work that can run in parallel
+extern ThreadPool gThreadPool;
+
+// Start a pool with a number of worker threads; 0 for no workers,
+// in which case all work runs on the calling thread
+void ThreadPoolInit(ThreadPool *tp, const int numThreads);
+void ThreadPoolTerminate(ThreadPool *tp);
+
+// Number of threads that can run work, including the calling thread
+int ThreadPoolConcurrency(const ThreadPool *tp);
+
+// Run func(data, i) for every i in [0, count) across the pool,
+// returning when all have finished.
+// The calling thread also runs work.
+// If the pool is already busy (e.g. nested calls), runs on the calling thread.
+void ThreadPoolRun(
+	ThreadPool *tp, ThreadPoolFunc func, void *data, const int count);
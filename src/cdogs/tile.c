@@ -54,13 +54,6 @@
 #include "triggers.h"
 
 
-Tile TileNone(void)
-{
-	Tile t;
-	TileInit(&t);
-	t.flags = MAPTILE_NO_WALK | MAPTILE_IS_NOTHING;
-	return t;
-}
 void TileInit(Tile *t)
 {
 	memset(t, 0, sizeof *t);
@@ -84,24 +77,12 @@ bool IsTileItemInsideTile(TTileItem *i, Vec2i tilePos)
 		i->y + i->size.y / 2 < (tilePos.y + 1) * TILE_HEIGHT;
 }
 
-bool TileCanSee(Tile *t)
-{
-	return !(t->flags & MAPTILE_NO_SEE);
-}
-bool TileCanWalk(const Tile *t)
-{
-	return !(t->flags & MAPTILE_NO_WALK);
-}
-bool TileIsNormalFloor(Tile *t)
-{
-	return t->flags & MAPTILE_IS_NORMAL_FLOOR;
-}
-bool TileIsClear(Tile *t)
+bool TileIsClear(const Tile *t, const int flags)
 {
 	// Check if tile is normal floor
 	const int normalFloorFlags =
 		MAPTILE_IS_NORMAL_FLOOR | MAPTILE_IS_DRAINAGE | MAPTILE_OFFSET_PIC;
-	if (t->flags & ~normalFloorFlags) return false;
+	if (flags & ~normalFloorFlags) return false;
 	// Check if tile has no things on it, excluding particles
 	CA_FOREACH(const ThingId, tid, t->things)
 		if (tid->Kind != KIND_PARTICLE) return false;
@@ -119,12 +100,6 @@ bool TileHasCharacter(Tile *t)
 	return false;
 }
 
-void TileSetAlternateFloor(Tile *t, NamedPic *p)
-{
-	t->pic = p;
-	t->flags &= ~MAPTILE_IS_NORMAL_FLOOR;
-}
-
 void TileItemUpdate(TTileItem *t, const int ticks)
 {
 	t->SoundLock = MAX(0, t->SoundLock - ticks);
@@ -140,7 +115,7 @@ TTileItem *ThingIdGetTileItem(ThingId *tid)
 		ti = &((TActor *)CArrayGet(&gActors, tid->Id))->tileItem;
 		break;
 	case KIND_PARTICLE:
-		ti = &((Particle *)CArrayGet(&gParticles, tid->Id))->tileItem;
+		ti = CArrayGet(&gParticles.TileItems, tid->Id);
 		break;
 	case KIND_MOBILEOBJECT:
 		ti = &((TMobileObject *)CArrayGet(
@@ -113,7 +113,8 @@ typedef struct
 		} MuzzleFlash;
 	} u;
 } TileItemDrawFuncData;
-typedef void (*TileItemDrawFunc)(const Vec2i, const TileItemDrawFuncData *);
+typedef void (*TileItemDrawFunc)(
+	GraphicsDevice *, const Vec2i, const TileItemDrawFuncData *);
 typedef struct TileItem
 {
 	int x, y;
@@ -137,28 +138,28 @@ typedef struct
 	int Id;
 	TileItemKind Kind;
 } ThingId;
+// Flags of tiles outside the map
+#define TILE_NONE_FLAGS (MAPTILE_NO_WALK | MAPTILE_IS_NOTHING)
+
+// The parts of a map tile that aren't needed for walking and seeing.
+// Tile flags (MapTileFlags) are stored separately in the map.
 typedef struct
 {
 	// Note: use NamedPic so we can serialise over net using name
 	NamedPic *pic;
 	NamedPic *picAlt;
-	int flags;
 	bool isVisited;
 	CArray triggers;	// of Trigger *
 	CArray things;		// of ThingId
 } Tile;
 
 
-Tile TileNone(void);
 void TileInit(Tile *t);
 void TileDestroy(Tile *t);
 bool IsTileItemInsideTile(TTileItem *i, Vec2i tilePos);
-bool TileCanSee(Tile *t);
-bool TileCanWalk(const Tile *t);
-bool TileIsNormalFloor(Tile *t);
-bool TileIsClear(Tile *t);
+// Whether a tile with these flags and things has nothing on it
+bool TileIsClear(const Tile *t, const int flags);
 bool TileHasCharacter(Tile *t);
-void TileSetAlternateFloor(Tile *t, NamedPic *p);
 
 void TileItemUpdate(TTileItem *t, const int ticks);
 
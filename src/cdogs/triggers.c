@@ -55,9 +55,6 @@
 #include "sounds.h"
 #include "utils.h"
 
-CArray gWatches;	// of TWatch
-static int watchIndex = 1;
-
 
 Trigger *TriggerNew(void)
 {
@@ -80,16 +77,18 @@ Action *TriggerAddAction(Trigger *t)
 	return CArrayGet(&t->actions, t->actions.size - 1);
 }
 
-TWatch *WatchNew(void)
+void WatchInit(TWatch *w, const int index)
+{
+	memset(w, 0, sizeof *w);
+	w->index = index;
+	CArrayInit(&w->actions, sizeof(Action));
+	CArrayInit(&w->conditions, sizeof(Condition));
+	w->active = false;
+}
+void WatchTerminate(TWatch *w)
 {
-	TWatch t;
-	memset(&t, 0, sizeof(TWatch));
-	t.index = watchIndex++;
-	CArrayInit(&t.actions, sizeof(Action));
-	CArrayInit(&t.conditions, sizeof(Condition));
-	t.active = false;
-	CArrayPushBack(&gWatches, &t);
-	return CArrayGet(&gWatches, gWatches.size - 1);
+	CArrayTerminate(&w->conditions);
+	CArrayTerminate(&w->actions);
 }
 Condition *WatchAddCondition(
 	TWatch *w, const ConditionType type, const int counterMax,
@@ -111,9 +110,9 @@ Action *WatchAddAction(TWatch *w)
 	return CArrayGet(&w->actions, w->actions.size - 1);
 }
 
-static void ActivateWatch(int idx)
+static void ActivateWatch(CArray *mapWatches, int idx)
 {
-	CA_FOREACH(TWatch, w, gWatches)
+	CA_FOREACH(TWatch, w, *mapWatches)
 		if (w->index == idx)
 		{
 			w->active = true;
@@ -130,9 +129,9 @@ static void ActivateWatch(int idx)
 	CASSERT(false, "Cannot find watch");
 }
 
-static void DeactivateWatch(int idx)
+static void DeactivateWatch(CArray *mapWatches, int idx)
 {
-	CA_FOREACH(TWatch, w, gWatches)
+	CA_FOREACH(TWatch, w, *mapWatches)
 		if (w->index == idx)
 		{
 			w->active = false;
@@ -142,20 +141,7 @@ static void DeactivateWatch(int idx)
 	CASSERT(false, "Cannot find watch");
 }
 
-void WatchesInit(void)
-{
-	CArrayInit(&gWatches, sizeof(TWatch));
-}
-void WatchesTerminate(void)
-{
-	CA_FOREACH(TWatch, w, gWatches)
-		CArrayTerminate(&w->conditions);
-		CArrayTerminate(&w->actions);
-	CA_FOREACH_END()
-	CArrayTerminate(&gWatches);
-}
-
-static void ActionRun(Action *a, CArray *mapTriggers)
+static void ActionRun(Action *a, CArray *mapTriggers, CArray *mapWatches)
 {
 	switch (a->Type)
 	{
@@ -187,15 +173,15 @@ static void ActionRun(Action *a, CArray *mapTriggers)
 		break;
 
 	case ACTION_EVENT:
-		GameEventsEnqueue(&gGameEvents, a->a.Event);
+		GameEventsEnqueue(&gGameEvents, &a->a.Event);
 		break;
 
 	case ACTION_ACTIVATEWATCH:
-		ActivateWatch(a->u.index);
+		ActivateWatch(mapWatches, a->u.index);
 		break;
 
 	case ACTION_DEACTIVATEWATCH:
-		DeactivateWatch(a->u.index);
+		DeactivateWatch(mapWatches, a->u.index);
 		break;
 
 	case ACTION_SOUND:
@@ -214,7 +200,7 @@ static bool ConditionsMet(CArray *conditions, const int ticks)
 		switch (c->Type)
 		{
 		case CONDITION_TILECLEAR:
-			conditionMet = TileIsClear(MapGetTile(&gMap, c->Pos));
+			conditionMet = MapTileIsClear(&gMap, c->Pos);
 			break;
 		}
 		if (conditionMet)
@@ -237,22 +223,23 @@ bool TriggerCanActivate(const Trigger *t, const int flags)
 	return t->isActive && (t->flags == 0 || (t->flags & flags));
 }
 
-void TriggerActivate(Trigger *t, CArray *mapTriggers)
+void TriggerActivate(Trigger *t, CArray *mapTriggers, CArray *mapWatches)
 {
 	CA_FOREACH(Action, a, t->actions)
-		ActionRun(a, mapTriggers);
+		ActionRun(a, mapTriggers, mapWatches);
 	CA_FOREACH_END()
 }
 
-void UpdateWatches(CArray *mapTriggers, const int ticks)
+void UpdateWatches(CArray *mapTriggers, CArray *mapWatches, const int ticks)
 {
-	CA_FOREACH(TWatch, w, gWatches)
+	CA_FOREACH(TWatch, w, *mapWatches)
 		if (!w->active) continue;
 		if (ConditionsMet(&w->conditions, ticks))
 		{
 			for (int j = 0; j < (int)w->actions.size; j++)
 			{
-				ActionRun(CArrayGet(&w->actions, j), mapTriggers);
+				ActionRun(
+					CArrayGet(&w->actions, j), mapTriggers, mapWatches);
 			}
 		}
 	CA_FOREACH_END()
@@ -118,16 +118,14 @@ typedef struct
 
 
 bool TriggerCanActivate(const Trigger *t, const int flags);
-void TriggerActivate(Trigger *t, CArray *mapTriggers);
-void UpdateWatches(CArray *mapTriggers, const int ticks);
+void TriggerActivate(Trigger *t, CArray *mapTriggers, CArray *mapWatches);
+void UpdateWatches(CArray *mapTriggers, CArray *mapWatches, const int ticks);
 Trigger *TriggerNew(void);
 void TriggerTerminate(Trigger *t);
 Action *TriggerAddAction(Trigger *t);
 
-void WatchesInit(void);
-void WatchesTerminate(void);
-
-TWatch *WatchNew(void);
+void WatchInit(TWatch *w, const int index);
+void WatchTerminate(TWatch *w);
 Condition *WatchAddCondition(
 	TWatch *w, const ConditionType type, const int counterMax,
 	const Vec2i pos);
@@ -389,6 +389,17 @@ double ToRadians(double degrees)
 	return degrees * PI / 180.0;
 }
 
+int RandNext(unsigned int *seed)
+{
+	// Hash successive steps of a Weyl sequence; any seed works, including 0
+	*seed += 0x9E3779B9u;
+	unsigned int z = *seed;
+	z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+	z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+	z ^= z >> 16;
+	return (int)(z >> 1);
+}
+
 const char *InputDeviceName(const int d, const int deviceIndex)
 {
 	switch (d)
@@ -443,6 +454,19 @@ char *Div8Str(int i)
 	sprintf(buf, "%d", i/8);
 	return buf;
 }
+char *ZeroUnlimitedStr(int i)
+{
+	static char buf[32];
+	if (i == 0)
+	{
+		strcpy(buf, "Unlimited");
+	}
+	else
+	{
+		sprintf(buf, "%d", i);
+	}
+	return buf;
+}
 void CamelToTitle(char *buf, const char *src)
 {
 	const char *first = src;
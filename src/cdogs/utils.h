@@ -195,6 +195,8 @@ int StrAllyCollision(const char *str);
 char *IntStr(int i);
 char *PercentStr(int p);
 char *Div8Str(int i);
+// Integer as string, or "Unlimited" for 0
+char *ZeroUnlimitedStr(int i);
 void CamelToTitle(char *buf, const char *src);
 
 // Helper macros for defining type/str conversion funcs
@@ -204,6 +206,10 @@ void CamelToTitle(char *buf, const char *src);
 #define RAND_INT(_low, _high) ((_low) == (_high) ? (_low) : (_low) + (rand() % ((_high) - (_low))))
 #define RAND_DOUBLE(_low, _high) ((_low) + ((double)rand() / RAND_MAX * ((_high) - (_low))))
 
+// Next number in [0, INT_MAX] from a private random sequence, for code that
+// must be repeatable from a seed without sharing rand() with other threads
+int RandNext(unsigned int *seed);
+
 typedef struct
 {
 	int Id;
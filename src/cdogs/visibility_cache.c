@@ -0,0 +1,245 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "visibility_cache.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "ai_utils.h"
+
+// Must be a power of two
+#define VISIBILITY_CACHE_SIZE 4096
+// How far, in pixels, the line algorithms may check either side of a line
+// between two points, with some to spare
+#define LINE_MARGIN 3
+
+VisibilityCache gVisibilityCache;
+
+
+void VisibilityCacheInit(VisibilityCache *vc, Map *m)
+{
+	memset(vc, 0, sizeof *vc);
+	vc->map = m;
+	// Zeroed entries are from epoch 0, and so are never valid
+	CCALLOC(vc->entries, VISIBILITY_CACHE_SIZE * sizeof *vc->entries);
+	for (int i = 0; i < VISIBILITY_COUNT; i++)
+	{
+		vc->epochs[i] = 1;
+	}
+	CArrayInit(&vc->pending, sizeof(VisibilityCacheEntry));
+	vc->pendingMutex = SDL_CreateMutex();
+}
+void VisibilityCacheTerminate(VisibilityCache *vc)
+{
+	CFREE(vc->entries);
+	vc->entries = NULL;
+	CArrayTerminate(&vc->pending);
+	if (vc->pendingMutex != NULL)
+	{
+		SDL_DestroyMutex(vc->pendingMutex);
+		vc->pendingMutex = NULL;
+	}
+}
+
+void VisibilityCacheInvalidate(VisibilityCache *vc, const VisibilityKind kind)
+{
+	vc->epochs[kind]++;
+}
+
+void VisibilityCacheFreeze(VisibilityCache *vc)
+{
+	CASSERT(!vc->frozen, "visibility cache already frozen");
+	vc->frozen = true;
+}
+static VisibilityCacheEntry *GetEntry(
+	VisibilityCache *vc, const Vec2i from, const Vec2i to, const int kind);
+void VisibilityCacheThaw(VisibilityCache *vc)
+{
+	CASSERT(vc->frozen, "visibility cache not frozen");
+	vc->frozen = false;
+	// What is cached never changes the answers, so the order doesn't matter
+	CA_FOREACH(const VisibilityCacheEntry, e, vc->pending)
+		*GetEntry(vc, e->From, e->To, e->Kind) = *e;
+	CA_FOREACH_END()
+	CArrayClear(&vc->pending);
+}
+
+void VisibilityCacheNextFrame(VisibilityCache *vc)
+{
+	vc->LastLookups = SDL_AtomicSet(&vc->lookups, 0);
+	vc->LastHits = SDL_AtomicSet(&vc->hits, 0);
+	vc->LastClear = SDL_AtomicSet(&vc->clear, 0);
+}
+
+// The slot for a pair of tiles; direct mapped, so a new pair replaces
+// whatever was there before
+static VisibilityCacheEntry *GetEntry(
+	VisibilityCache *vc, const Vec2i from, const Vec2i to, const int kind)
+{
+	const unsigned int hash =
+		((unsigned int)from.x * 73856093u) ^
+		((unsigned int)from.y * 19349663u) ^
+		((unsigned int)to.x * 83492791u) ^
+		((unsigned int)to.y * 2654435761u) ^
+		(unsigned int)kind;
+	return &vc->entries[(hash ^ (hash >> 15)) & (VISIBILITY_CACHE_SIZE - 1)];
+}
+
+// Same as the full checks, including for tiles outside the map
+static bool IsTileClear(Map *map, const Vec2i pos, const VisibilityKind kind)
+{
+	switch (kind)
+	{
+	case VISIBILITY_SEE:
+		return MapTileCanSee(map, pos);
+	case VISIBILITY_WALK:
+		return IsTileWalkable(map, pos);
+	default:
+		CASSERT(false, "unknown visibility kind");
+		return false;
+	}
+}
+// Whether all the tiles that lines between any points in the two tiles can
+// touch are clear.
+// A line between points in the two tiles stays within half a tile of the
+// line between the tiles' centres, so a tile can be touched if that centre
+// line passes within a whole tile, plus the margin, of the tile's centre.
+static bool AreTilesBetweenClear(
+	Map *map, const Vec2i t1, const Vec2i t2, const VisibilityKind kind)
+{
+	const double x1 = t1.x * TILE_WIDTH + TILE_WIDTH / 2.0;
+	const double y1 = t1.y * TILE_HEIGHT + TILE_HEIGHT / 2.0;
+	const double x2 = t2.x * TILE_WIDTH + TILE_WIDTH / 2.0;
+	const double y2 = t2.y * TILE_HEIGHT + TILE_HEIGHT / 2.0;
+	const double rx = TILE_WIDTH + LINE_MARGIN;
+	const double ry = TILE_HEIGHT + LINE_MARGIN;
+	for (int ty = MIN(t1.y, t2.y) - 2; ty <= MAX(t1.y, t2.y) + 2; ty++)
+	{
+		// Find the part of the centre line close enough to this row
+		const double cy = ty * TILE_HEIGHT + TILE_HEIGHT / 2.0;
+		double xa, xb;
+		if (t1.y == t2.y)
+		{
+			if (fabs(cy - y1) > ry)
+			{
+				continue;
+			}
+			xa = x1;
+			xb = x2;
+		}
+		else
+		{
+			double sa = (cy - ry - y1) / (y2 - y1);
+			double sb = (cy + ry - y1) / (y2 - y1);
+			if (sa > sb)
+			{
+				const double tmp = sa;
+				sa = sb;
+				sb = tmp;
+			}
+			sa = MAX(sa, 0.0);
+			sb = MIN(sb, 1.0);
+			if (sa > sb)
+			{
+				continue;
+			}
+			xa = x1 + sa * (x2 - x1);
+			xb = x1 + sb * (x2 - x1);
+		}
+		if (xa > xb)
+		{
+			const double tmp = xa;
+			xa = xb;
+			xb = tmp;
+		}
+		const int txMin = (int)ceil((xa - rx - TILE_WIDTH / 2.0) / TILE_WIDTH);
+		const int txMax =
+			(int)floor((xb + rx - TILE_WIDTH / 2.0) / TILE_WIDTH);
+		for (int tx = txMin; tx <= txMax; tx++)
+		{
+			if (!IsTileClear(map, Vec2iNew(tx, ty), kind))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool VisibilityCacheIsClear(
+	VisibilityCache *vc, const Vec2i from, const Vec2i to,
+	const VisibilityKind kind)
+{
+	// Negative positions round towards the wrong tile; leave them to the
+	// full check
+	if (from.x < 0 || from.y < 0 || to.x < 0 || to.y < 0)
+	{
+		return false;
+	}
+	Vec2i t1 = Vec2iToTile(from);
+	Vec2i t2 = Vec2iToTile(to);
+	// Lines in either direction touch the same tiles
+	if (t2.y < t1.y || (t2.y == t1.y && t2.x < t1.x))
+	{
+		const Vec2i tmp = t1;
+		t1 = t2;
+		t2 = tmp;
+	}
+	SDL_AtomicIncRef(&vc->lookups);
+	VisibilityCacheEntry *e = GetEntry(vc, t1, t2, kind);
+	if (e->Epoch == vc->epochs[kind] && e->Kind == (int)kind &&
+		Vec2iEqual(e->From, t1) && Vec2iEqual(e->To, t2))
+	{
+		SDL_AtomicIncRef(&vc->hits);
+	}
+	else
+	{
+		VisibilityCacheEntry added;
+		added.From = t1;
+		added.To = t2;
+		added.Kind = kind;
+		added.Epoch = vc->epochs[kind];
+		added.IsClear = AreTilesBetweenClear(vc->map, t1, t2, kind);
+		if (vc->frozen)
+		{
+			SDL_LockMutex(vc->pendingMutex);
+			CArrayPushBack(&vc->pending, &added);
+			SDL_UnlockMutex(vc->pendingMutex);
+			e = &added;
+		}
+		else
+		{
+			*e = added;
+		}
+	}
+	if (e->IsClear)
+	{
+		SDL_AtomicIncRef(&vc->clear);
+	}
+	return e->IsClear;
+}
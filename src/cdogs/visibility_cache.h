@@ -0,0 +1,100 @@
+/*
+    C-Dogs SDL
+    A port of the legendary (and fun) action/arcade cdogs.
+    Copyright (c) 2016, Cong Xu
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+    Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+    ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+    LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+    CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+    SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+    INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+    CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+    ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include <SDL_thread.h>
+
+#include "c_array.h"
+#include "map.h"
+#include "vector.h"
+
+// What a line needs to be clear of
+typedef enum
+{
+	VISIBILITY_SEE,		// tiles that can't be seen through
+	VISIBILITY_WALK,	// tiles that can't be walked over, ignoring actors
+	VISIBILITY_COUNT
+} VisibilityKind;
+
+typedef struct
+{
+	Vec2i From;
+	Vec2i To;
+	int Kind;
+	int Epoch;
+	bool IsClear;
+} VisibilityCacheEntry;
+
+typedef struct
+{
+	Map *map;
+	VisibilityCacheEntry *entries;
+	// Entries from an older epoch are stale; see VisibilityCacheInvalidate
+	int epochs[VISIBILITY_COUNT];
+	// See VisibilityCacheFreeze
+	bool frozen;
+	CArray pending;	// of VisibilityCacheEntry
+	SDL_mutex *pendingMutex;
+	// Counts for the frame being simulated, and for the last whole frame:
+	// lookups, lookups found in the cache, and lines known to be clear
+	SDL_atomic_t lookups;
+	SDL_atomic_t hits;
+	SDL_atomic_t clear;
+	int LastLookups;
+	int LastHits;
+	int LastClear;
+} VisibilityCache;
+
+// Cache of whether lines between pairs of tiles are clear, so that the AI's
+// repeated clear shot and clear path checks don't need to walk the line
+// Note: lifetime managed by Map
+extern VisibilityCache gVisibilityCache;
+
+void VisibilityCacheInit(VisibilityCache *vc, Map *m);
+void VisibilityCacheTerminate(VisibilityCache *vc);
+
+// Forget everything cached for one kind of line
+// This is done when the underlying map changes, e.g. doors, keys or
+// dangerous objects
+void VisibilityCacheInvalidate(VisibilityCache *vc, const VisibilityKind kind);
+
+// Freeze the cache so that it can be used from multiple threads.
+// While frozen, lookups only see what was cached before freezing, and new
+// entries are held back until thawing.
+void VisibilityCacheFreeze(VisibilityCache *vc);
+void VisibilityCacheThaw(VisibilityCache *vc);
+
+// Start counting a new frame
+void VisibilityCacheNextFrame(VisibilityCache *vc);
+
+// Whether a line between two real positions is certainly clear; this is the
+// case if every tile that any line between their two tiles could touch is
+// clear. If not, the line may still be clear and needs checking in full.
+bool VisibilityCacheIsClear(
+	VisibilityCache *vc, const Vec2i from, const Vec2i to,
+	const VisibilityKind kind);
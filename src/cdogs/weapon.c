@@ -51,16 +51,14 @@
 #include <assert.h>
 #include <math.h>
 
-#include <json/json.h>
-
 #include "ammo.h"
 #include "config.h"
 #include "game_events.h"
-#include "json_utils.h"
 #include "log.h"
 #include "net_util.h"
 #include "objs.h"
 #include "sounds.h"
+#include "yajl_utils.h"
 
 GunClasses gGunDescriptions;
 
@@ -72,205 +70,244 @@ void WeaponInitialize(GunClasses *g)
 	CArrayInit(&g->Guns, sizeof(GunDescription));
 	CArrayInit(&g->CustomGuns, sizeof(GunDescription));
 }
-static void LoadGunDescription(
-	GunDescription *g, json_t *node, const GunDescription *defaultGun);
+static void GunDescriptionCopy(GunDescription *dst, const GunDescription *src);
 static void GunDescriptionTerminate(GunDescription *g);
-void WeaponLoadJSON(GunClasses *g, CArray *classes, json_t *root)
+
+// Guns are streamed from file one field at a time
+typedef struct
+{
+	GunClasses *g;
+	CArray *classes;
+	// Loading main game data, which has the default gun and gun indices
+	bool isMain;
+	bool defaultsAdded;
+	bool isDefault;
+	bool isPseudo;
+	bool skip;
+	GunDescription gd;
+	int index;
+	int elevation;
+	bool hasElevation;
+	bool hasElevationLow;
+	bool hasElevationHigh;
+} GunLoader;
+static bool LoadGunHeader(void *data, const char *key, const char *value);
+static void LoadGunBegin(void *data, const char *section);
+static void LoadGunField(
+	void *data, const char *key, const int index, const char *value);
+static void LoadGunEnd(void *data);
+static void AddDefaultGuns(GunLoader *l);
+bool WeaponLoadFile(GunClasses *g, CArray *classes, const char *path)
 {
 	LOG(LM_MAP, LL_DEBUG, "loading weapons");
-	int version;
-	LoadInt(&version, root, "Version");
-	if (version > VERSION || version <= 0)
-	{
-		CASSERT(false, "cannot read guns file version");
-		return;
-	}
-
-	GunDescription *defaultDesc = &g->Default;
-	// Only load default gun from main game data
-	if (classes == &g->Guns)
+	GunLoader l;
+	memset(&l, 0, sizeof l);
+	l.g = g;
+	l.classes = classes;
+	l.isMain = classes == &g->Guns;
+	const YAJLStreamHandler h =
+	{
+		&l,
+		LoadGunHeader,
+		LoadGunBegin,
+		LoadGunField,
+		LoadGunEnd
+	};
+	const bool ok = YAJLStreamFile(path, NULL, &h);
+	// Left over if loading failed part way
+	GunDescriptionTerminate(&l.gd);
+	// Guns by index need to exist even if there were no other guns
+	AddDefaultGuns(&l);
+	return ok;
+}
+static bool LoadGunHeader(void *data, const char *key, const char *value)
+{
+	UNUSED(data);
+	if (strcmp(key, "Version") == 0)
 	{
-		json_t *defaultNode = json_find_first_label(root, "DefaultGun");
-		if (defaultNode != NULL)
+		const int version = value != NULL ? atoi(value) : 0;
+		if (version > VERSION || version <= 0)
 		{
-			LoadGunDescription(defaultDesc, defaultNode->child, NULL);
-		}
-		else
-		{
-			memset(defaultDesc, 0, sizeof *defaultDesc);
-		}
-		CASSERT(g->Guns.size == 0, "guns not empty");
-		for (int i = 0; i < GUN_COUNT; i++)
-		{
-			GunDescription gd;
-			if (defaultNode != NULL)
-			{
-				LoadGunDescription(&gd, defaultNode->child, NULL);
-			}
-			else
-			{
-				memset(&gd, 0, sizeof gd);
-			}
-			CArrayPushBack(&g->Guns, &gd);
+			CASSERT(false, "cannot read guns file version");
+			return false;
 		}
 	}
-	json_t *gunsNode = json_find_first_label(root, "Guns")->child;
-	for (json_t *child = gunsNode->child; child; child = child->next)
+	return true;
+}
+static void LoadGunBegin(void *data, const char *section)
+{
+	GunLoader *l = data;
+	l->isDefault = strcmp(section, "DefaultGun") == 0;
+	l->isPseudo = strcmp(section, "PseudoGuns") == 0;
+	// Only load default gun from main game data
+	l->skip =
+		(l->isDefault && !l->isMain) ||
+		(!l->isDefault && !l->isPseudo && strcmp(section, "Guns") != 0);
+	if (l->skip)
 	{
-		GunDescription gd;
-		LoadGunDescription(&gd, child, defaultDesc);
-		int idx = -1;
-		// Only allow index for non-custom guns
-		if (classes == &g->Guns)
-		{
-			LoadInt(&idx, child, "Index");
-		}
-		if (idx >= 0 && idx < GUN_COUNT)
-		{
-			GunDescription *gExisting = CArrayGet(&g->Guns, idx);
-			GunDescriptionTerminate(gExisting);
-			memcpy(gExisting, &gd, sizeof gd);
-		}
-		else
-		{
-			CArrayPushBack(classes, &gd);
-		}
+		return;
 	}
-	json_t *pseudoGunsNode = json_find_first_label(root, "PseudoGuns");
-	if (pseudoGunsNode != NULL)
+	memset(&l->gd, 0, sizeof l->gd);
+	l->gd.AmmoId = -1;
+	if (!l->isDefault)
 	{
-		for (json_t *child = pseudoGunsNode->child->child;
-			child;
-			child = child->next)
-		{
-			GunDescription gd;
-			LoadGunDescription(&gd, child, defaultDesc);
-			gd.IsRealGun = false;
-			CArrayPushBack(classes, &gd);
-		}
+		// The default gun must come before the guns that use it
+		AddDefaultGuns(l);
+		GunDescriptionCopy(&l->gd, &l->g->Default);
+		l->gd.MuzzleHeight /= Z_FACTOR;
 	}
+	l->index = -1;
+	l->hasElevation = l->hasElevationLow = l->hasElevationHigh = false;
 }
-static void LoadGunDescription(
-	GunDescription *g, json_t *node, const GunDescription *defaultGun)
+static void LoadGunField(
+	void *data, const char *key, const int index, const char *value)
 {
-	memset(g, 0, sizeof *g);
-	g->AmmoId = -1;
-	if (defaultGun)
+	UNUSED(index);
+	GunLoader *l = data;
+	GunDescription *g = &l->gd;
+	if (l->skip || value == NULL)
 	{
-		memcpy(g, defaultGun, sizeof *g);
-		if (defaultGun->name)
-		{
-			CSTRDUP(g->name, defaultGun->name);
-		}
-		if (defaultGun->Description)
-		{
-			CSTRDUP(g->Description, defaultGun->Description);
-		}
-		g->MuzzleHeight /= Z_FACTOR;
+		return;
 	}
-	char *tmp;
-
-	tmp = NULL;
-	LoadStr(&tmp, node, "Pic");
-	if (tmp != NULL)
+	if (strcmp(key, "Pic") == 0)
 	{
 		char buf[CDOGS_PATH_MAX];
-		sprintf(buf, "chars/guns/%s", tmp);
+		sprintf(buf, "chars/guns/%s", value);
 		g->Pic = PicManagerGetSprites(&gPicManager, buf);
-		CFREE(tmp);
 	}
-
-	const Pic *icon = NULL;
-	LoadPic(&icon, node, "Icon");
-	if (icon != NULL)
+	else if (strcmp(key, "Icon") == 0)
 	{
-		g->Icon = icon;
+		const Pic *icon = PicManagerGetPic(&gPicManager, value);
+		if (icon != NULL)
+		{
+			g->Icon = icon;
+		}
 	}
-
-	tmp = NULL;
-	LoadStr(&tmp, node, "Name");
-	if (tmp != NULL)
+	else if (strcmp(key, "Name") == 0)
 	{
 		CFREE(g->name);
-		g->name = tmp;
+		CSTRDUP(g->name, value);
 	}
-
-	tmp = NULL;
-	LoadStr(&tmp, node, "Description");
-	if (tmp != NULL)
+	else if (strcmp(key, "Description") == 0)
 	{
 		CFREE(g->Description);
-		g->Description = tmp;
+		CSTRDUP(g->Description, value);
 	}
-
-	tmp = NULL;
-	LoadStr(&tmp, node, "Bullet");
-	if (tmp != NULL)
+	else if (strcmp(key, "Bullet") == 0)
 	{
-		g->Bullet = StrBulletClass(tmp);
-		CFREE(tmp);
+		g->Bullet = StrBulletClass(value);
 	}
-
-	tmp = NULL;
-	LoadStr(&tmp, node, "Ammo");
-	if (tmp != NULL)
+	else if (strcmp(key, "Ammo") == 0)
 	{
-		g->AmmoId = StrAmmoId(tmp);
-		CFREE(tmp);
+		g->AmmoId = StrAmmoId(value);
 	}
-
-	LoadInt(&g->Cost, node, "Cost");
-
-	LoadInt(&g->Lock, node, "Lock");
-
-	LoadInt(&g->ReloadLead, node, "ReloadLead");
-
-	LoadSoundFromNode(&g->Sound, node, "Sound");
-	LoadSoundFromNode(&g->ReloadSound, node, "ReloadSound");
-	LoadSoundFromNode(&g->SwitchSound, node, "SwitchSound");
-
-	LoadInt(&g->SoundLockLength, node, "SoundLockLength");
-
-	LoadDouble(&g->Recoil, node, "Recoil");
-
-	LoadInt(&g->Spread.Count, node, "SpreadCount");
-	LoadDouble(&g->Spread.Width, node, "SpreadWidth");
-	LoadDouble(&g->AngleOffset, node, "AngleOffset");
-
-	LoadInt(&g->MuzzleHeight, node, "MuzzleHeight");
-	g->MuzzleHeight *= Z_FACTOR;
-	if (json_find_first_label(node, "Elevation"))
+	else if (strcmp(key, "Index") == 0)
 	{
-		LoadInt(&g->ElevationLow, node, "Elevation");
-		g->ElevationHigh = g->ElevationLow;
+		l->index = atoi(value);
 	}
-	LoadInt(&g->ElevationLow, node, "ElevationLow");
-	LoadInt(&g->ElevationHigh, node, "ElevationHigh");
-	g->ElevationLow = MIN(g->ElevationLow, g->ElevationHigh);
-	g->ElevationHigh = MAX(g->ElevationLow, g->ElevationHigh);
-	tmp = NULL;
-	LoadStr(&tmp, node, "MuzzleFlashParticle");
-	if (tmp != NULL)
+	else if (strcmp(key, "Cost") == 0)
 	{
-		g->MuzzleFlash = StrParticleClass(&gParticleClasses, tmp);
-		CFREE(tmp);
+		g->Cost = atoi(value);
 	}
-
-	tmp = NULL;
-	LoadStr(&tmp, node, "Brass");
-	if (tmp != NULL)
+	else if (strcmp(key, "Lock") == 0)
 	{
-		g->Brass = StrParticleClass(&gParticleClasses, tmp);
-		CFREE(tmp);
+		g->Lock = atoi(value);
 	}
-
-	LoadBool(&g->CanShoot, node, "CanShoot");
-
-	LoadBool(&g->CanDrop, node, "CanDrop");
-
-	LoadInt(&g->ShakeAmount, node, "ShakeAmount");
-
-	g->IsRealGun = true;
+	else if (strcmp(key, "ReloadLead") == 0)
+	{
+		g->ReloadLead = atoi(value);
+	}
+	else if (strcmp(key, "Sound") == 0)
+	{
+		g->Sound = StrSound(value);
+	}
+	else if (strcmp(key, "ReloadSound") == 0)
+	{
+		g->ReloadSound = StrSound(value);
+	}
+	else if (strcmp(key, "SwitchSound") == 0)
+	{
+		g->SwitchSound = StrSound(value);
+	}
+	else if (strcmp(key, "SoundLockLength") == 0)
+	{
+		g->SoundLockLength = atoi(value);
+	}
+	else if (strcmp(key, "Recoil") == 0)
+	{
+		g->Recoil = atof(value);
+	}
+	else if (strcmp(key, "SpreadCount") == 0)
+	{
+		g->Spread.Count = atoi(value);
+	}
+	else if (strcmp(key, "SpreadWidth") == 0)
+	{
+		g->Spread.Width = atof(value);
+	}
+	else if (strcmp(key, "AngleOffset") == 0)
+	{
+		g->AngleOffset = atof(value);
+	}
+	else if (strcmp(key, "MuzzleHeight") == 0)
+	{
+		g->MuzzleHeight = atoi(value);
+	}
+	else if (strcmp(key, "Elevation") == 0)
+	{
+		l->elevation = atoi(value);
+		l->hasElevation = true;
+	}
+	else if (strcmp(key, "ElevationLow") == 0)
+	{
+		g->ElevationLow = atoi(value);
+		l->hasElevationLow = true;
+	}
+	else if (strcmp(key, "ElevationHigh") == 0)
+	{
+		g->ElevationHigh = atoi(value);
+		l->hasElevationHigh = true;
+	}
+	else if (strcmp(key, "MuzzleFlashParticle") == 0)
+	{
+		g->MuzzleFlash = StrParticleClass(&gParticleClasses, value);
+	}
+	else if (strcmp(key, "Brass") == 0)
+	{
+		g->Brass = StrParticleClass(&gParticleClasses, value);
+	}
+	else if (strcmp(key, "CanShoot") == 0)
+	{
+		g->CanShoot = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "CanDrop") == 0)
+	{
+		g->CanDrop = strcmp(value, "true") == 0;
+	}
+	else if (strcmp(key, "ShakeAmount") == 0)
+	{
+		g->ShakeAmount = atoi(value);
+	}
+}
+static void LoadGunEnd(void *data)
+{
+	GunLoader *l = data;
+	GunDescription *g = &l->gd;
+	if (l->skip)
+	{
+		return;
+	}
+	g->MuzzleHeight *= Z_FACTOR;
+	// "Elevation" sets both ends; "ElevationLow"/"ElevationHigh" override it
+	if (l->hasElevation)
+	{
+		if (!l->hasElevationLow) g->ElevationLow = l->elevation;
+		if (!l->hasElevationHigh) g->ElevationHigh = l->elevation;
+	}
+	const int low = MIN(g->ElevationLow, g->ElevationHigh);
+	g->ElevationHigh = MAX(g->ElevationLow, g->ElevationHigh);
+	g->ElevationLow = low;
+	g->IsRealGun = !l->isPseudo;
 
 	LOG(LM_MAP, LL_DEBUG,
 		"loaded gun name(%s) bullet(%s) ammo(%d) cost(%d) lock(%d)...",
@@ -291,6 +328,54 @@ static void LoadGunDescription(
 	LOG(LM_MAP, LL_DEBUG,
 		"...canDrop(%s) shakeAmount(%d)",
 		g->CanDrop ? "true" : "false", g->ShakeAmount);
+
+	if (l->isDefault)
+	{
+		GunDescriptionTerminate(&l->g->Default);
+		memcpy(&l->g->Default, g, sizeof *g);
+	}
+	// Only allow index for non-custom guns
+	else if (l->isMain && !l->isPseudo && l->index >= 0 && l->index < GUN_COUNT)
+	{
+		GunDescription *gExisting = CArrayGet(&l->g->Guns, l->index);
+		GunDescriptionTerminate(gExisting);
+		memcpy(gExisting, g, sizeof *g);
+	}
+	else
+	{
+		CArrayPushBack(l->classes, g);
+	}
+	// Ownership of the strings has moved
+	memset(g, 0, sizeof *g);
+}
+// Main game data has a copy of the default gun for each gun index, which are
+// replaced by the guns with those indices
+static void AddDefaultGuns(GunLoader *l)
+{
+	if (!l->isMain || l->defaultsAdded)
+	{
+		return;
+	}
+	CASSERT(l->g->Guns.size == 0, "guns not empty");
+	for (int i = 0; i < GUN_COUNT; i++)
+	{
+		GunDescription gd;
+		GunDescriptionCopy(&gd, &l->g->Default);
+		CArrayPushBack(&l->g->Guns, &gd);
+	}
+	l->defaultsAdded = true;
+}
+static void GunDescriptionCopy(GunDescription *dst, const GunDescription *src)
+{
+	memcpy(dst, src, sizeof *dst);
+	if (src->name)
+	{
+		CSTRDUP(dst->name, src->name);
+	}
+	if (src->Description)
+	{
+		CSTRDUP(dst->Description, src->Description);
+	}
 }
 void WeaponTerminate(GunClasses *g)
 {
@@ -360,25 +445,14 @@ GunDescription *IdGunDescription(const int i)
 }
 int GunDescriptionId(const GunDescription *g)
 {
-	int idx = 0;
-	for (int i = 0; i < (int)gGunDescriptions.Guns.size; i++, idx++)
-	{
-		const GunDescription *c = CArrayGet(&gGunDescriptions.Guns, i);
-		if (c == g)
-		{
-			return idx;
-		}
-	}
-	for (int i = 0; i < (int)gGunDescriptions.CustomGuns.size; i++, idx++)
+	const int idx = CArrayIndexOf(&gGunDescriptions.Guns, g);
+	if (idx >= 0)
 	{
-		const GunDescription *c = CArrayGet(&gGunDescriptions.CustomGuns, i);
-		if (c == g)
-		{
-			return idx;
-		}
+		return idx;
 	}
-	CASSERT(false, "cannot find gun");
-	return -1;
+	const int customIdx = CArrayIndexOf(&gGunDescriptions.CustomGuns, g);
+	CASSERT(customIdx >= 0, "cannot find gun");
+	return (int)gGunDescriptions.Guns.size + customIdx;
 }
 
 void WeaponUpdate(
@@ -394,10 +468,10 @@ void WeaponUpdate(
 	{
 		GameEvent e = GameEventNew(GAME_EVENT_GUN_RELOAD);
 		e.u.GunReload.PlayerUID = playerUID;
-		strcpy(e.u.GunReload.Gun, w->Gun->name);
+		e.u.GunReload.GunId = GunDescriptionId(w->Gun);
 		e.u.GunReload.FullPos = Vec2i2Net(fullPos);
 		e.u.GunReload.Direction = (int)d;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 	w->lock -= ticks;
 	if (w->lock < 0)
@@ -449,7 +523,7 @@ void WeaponFire(
 		GameEvent e = GameEventNew(GAME_EVENT_GUN_STATE);
 		e.u.GunState.ActorUID = uid;
 		e.u.GunState.State = GUNSTATE_FIRING;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 	if (!w->Gun->CanShoot)
 	{
@@ -480,14 +554,14 @@ void GunFire(
 	GameEvent e = GameEventNew(GAME_EVENT_GUN_FIRE);
 	e.u.GunFire.UID = uid;
 	e.u.GunFire.PlayerUID = playerUID;
-	strcpy(e.u.GunFire.Gun, g->name);
+	e.u.GunFire.GunId = GunDescriptionId(g);
 	e.u.GunFire.MuzzleFullPos = Vec2i2Net(fullPos);
 	e.u.GunFire.Z = z;
 	e.u.GunFire.Angle = (float)radians;
 	e.u.GunFire.Sound = playSound;
 	e.u.GunFire.Flags = flags;
 	e.u.GunFire.IsGun = isGun;
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 }
 
 void GunAddBrass(
@@ -517,7 +591,7 @@ void GunAddBrass(
 	e.u.AddParticle.Angle = RAND_DOUBLE(0, PI * 2);
 	e.u.AddParticle.DZ = (rand() % 6) + 6;
 	e.u.AddParticle.Spin = RAND_DOUBLE(-0.1, 0.1);
-	GameEventsEnqueue(&gGameEvents, e);
+	GameEventsEnqueue(&gGameEvents, &e);
 }
 
 static Vec2i GetMuzzleOffset(const direction_e d);
@@ -607,63 +681,21 @@ void BulletAndWeaponInitialize(
 {
 	BulletInitialize(b);
 
-	FILE *bf = NULL;
-	FILE *gf = NULL;
-	json_t *broot = NULL;
-	json_t *groot = NULL;
-	enum json_error e;
-
-	// 2-pass bullet loading will free root for us
-	bool freeBRoot = true;
 	char buf[CDOGS_PATH_MAX];
 	GetDataFilePath(buf, bpath);
-	bf = fopen(buf, "r");
-	if (bf == NULL)
+	if (!BulletLoadFile(b, &b->Classes, buf))
 	{
 		LOG(LM_MAP, LL_ERROR, "Error: cannot load bullets file %s", buf);
-		goto bail;
-	}
-	e = json_stream_parse(bf, &broot);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAP, LL_ERROR, "Error parsing bullets file %s [error %d]",
-			buf, (int)e);
-		goto bail;
+		return;
 	}
-	BulletLoadJSON(b, &b->Classes, broot);
 
 	WeaponInitialize(g);
 	GetDataFilePath(buf, gpath);
-	gf = fopen(buf, "r");
-	if (gf == NULL)
+	if (!WeaponLoadFile(g, &g->Guns, buf))
 	{
 		LOG(LM_MAP, LL_ERROR, "Error: cannot load guns file %s", buf);
-		goto bail;
-	}
-	e = json_stream_parse(gf, &groot);
-	if (e != JSON_OK)
-	{
-		LOG(LM_MAP, LL_ERROR, "Error parsing guns file %s [error %d]",
-			buf, (int)e);
-		goto bail;
+		return;
 	}
-	WeaponLoadJSON(g, &g->Guns, groot);
 
 	BulletLoadWeapons(b);
-	freeBRoot = false;
-
-bail:
-	if (bf)
-	{
-		fclose(bf);
-	}
-	if (gf)
-	{
-		fclose(gf);
-	}
-	if (freeBRoot)
-	{
-		json_free_value(&broot);
-	}
-	json_free_value(&groot);
 }
@@ -140,7 +140,7 @@ typedef struct
 extern GunClasses gGunDescriptions;
 
 void WeaponInitialize(GunClasses *g);
-void WeaponLoadJSON(GunClasses *g, CArray *classes, json_t *root);
+bool WeaponLoadFile(GunClasses *g, CArray *classes, const char *path);
 void WeaponClassesClear(CArray *classes);
 void WeaponTerminate(GunClasses *g);
 Weapon WeaponCreate(const GunDescription *gun);
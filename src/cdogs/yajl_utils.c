@@ -27,6 +27,10 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include "log.h"
+#include "yajl/api/yajl_parse.h"
 
 
 static char *ReadFile(const char *filename);
@@ -241,3 +245,207 @@ bail:
 	CFREE(pathCopy);
 	return out;
 }
+
+#define STREAM_MAX_DEPTH 16
+typedef struct
+{
+	const YAJLStreamHandler *h;
+	// Top-level key to report, or NULL for all of them
+	const char *section;
+	// Depth of the objects being reported, 0 if outside a section
+	int elementDepth;
+	char sectionName[64];
+	int depth;
+	// Slash-delimited key of the current value, relative to the element
+	char key[256];
+	size_t keyLens[STREAM_MAX_DEPTH];
+	// Index of the next value, for each depth that is an array
+	int indices[STREAM_MAX_DEPTH];
+	// Null-terminated copy of the current value
+	char *value;
+	size_t valueSize;
+} StreamState;
+static int StreamScalar(StreamState *s, const char *value, const size_t len)
+{
+	const char *v = NULL;
+	if (value != NULL)
+	{
+		if (len + 1 > s->valueSize)
+		{
+			s->valueSize = len + 1;
+			s->value = realloc(s->value, s->valueSize);
+			if (s->value == NULL) return 0;
+		}
+		memcpy(s->value, value, len);
+		s->value[len] = '\0';
+		v = s->value;
+	}
+	const int index = s->indices[s->depth];
+	if (index >= 0)
+	{
+		s->indices[s->depth]++;
+	}
+	if (s->depth == 1)
+	{
+		return s->h->Header == NULL || s->h->Header(s->h->Data, s->key, v);
+	}
+	if (s->elementDepth > 0 && s->depth >= s->elementDepth)
+	{
+		s->h->Field(s->h->Data, s->key, index, v);
+	}
+	return 1;
+}
+static int StreamNull(void *ctx)
+{
+	return StreamScalar(ctx, NULL, 0);
+}
+static int StreamBoolean(void *ctx, int boolVal)
+{
+	const char *v = boolVal ? "true" : "false";
+	return StreamScalar(ctx, v, strlen(v));
+}
+static int StreamNumber(void *ctx, const char *numberVal, size_t numberLen)
+{
+	return StreamScalar(ctx, numberVal, numberLen);
+}
+static int StreamString(
+	void *ctx, const unsigned char *stringVal, size_t stringLen)
+{
+	return StreamScalar(ctx, (const char *)stringVal, stringLen);
+}
+static int StreamStart(StreamState *s, const bool isArray)
+{
+	if (s->depth > 0 && s->indices[s->depth] >= 0)
+	{
+		s->indices[s->depth]++;
+	}
+	s->depth++;
+	if (s->depth >= STREAM_MAX_DEPTH)
+	{
+		return 0;
+	}
+	s->indices[s->depth] = isArray ? 0 : -1;
+	if (s->depth == 2 &&
+		(s->section == NULL || strcmp(s->key, s->section) == 0))
+	{
+		// Sections are either arrays of objects or a single object
+		s->elementDepth = isArray ? 3 : 2;
+		strncpy(s->sectionName, s->key, sizeof s->sectionName - 1);
+	}
+	if (s->elementDepth > 0 && s->depth == s->elementDepth && !isArray)
+	{
+		s->key[0] = '\0';
+		s->h->Begin(s->h->Data, s->sectionName);
+	}
+	s->keyLens[s->depth] = strlen(s->key);
+	return 1;
+}
+static int StreamStartMap(void *ctx)
+{
+	return StreamStart(ctx, false);
+}
+static int StreamStartArray(void *ctx)
+{
+	return StreamStart(ctx, true);
+}
+static int StreamEnd(void *ctx)
+{
+	StreamState *s = ctx;
+	if (s->elementDepth > 0 && s->depth == s->elementDepth &&
+		s->indices[s->depth] < 0)
+	{
+		s->h->End(s->h->Data);
+	}
+	if (s->depth == 2)
+	{
+		s->elementDepth = 0;
+	}
+	// Restore the key that this value had
+	s->key[s->keyLens[s->depth]] = '\0';
+	s->depth--;
+	return 1;
+}
+static int StreamMapKey(void *ctx, const unsigned char *key, size_t len)
+{
+	StreamState *s = ctx;
+	size_t start = s->keyLens[s->depth];
+	if (start > 0)
+	{
+		s->key[start++] = '/';
+	}
+	if (start + len >= sizeof s->key)
+	{
+		return 0;
+	}
+	memcpy(s->key + start, key, len);
+	s->key[start + len] = '\0';
+	return 1;
+}
+static const yajl_callbacks streamCallbacks =
+{
+	StreamNull,
+	StreamBoolean,
+	NULL,
+	NULL,
+	StreamNumber,
+	StreamString,
+	StreamStartMap,
+	StreamMapKey,
+	StreamEnd,
+	StreamStartArray,
+	StreamEnd
+};
+bool YAJLStreamFile(
+	const char *filename, const char *section, const YAJLStreamHandler *h)
+{
+	bool ok = false;
+	StreamState s;
+	memset(&s, 0, sizeof s);
+	s.h = h;
+	s.section = section;
+	s.indices[0] = -1;
+	yajl_handle yh = NULL;
+	FILE *f = fopen(filename, "rb");
+	if (f == NULL)
+	{
+		LOG(LM_MAIN, LL_DEBUG, "cannot open %s", filename);
+		goto bail;
+	}
+	yh = yajl_alloc(&streamCallbacks, NULL, &s);
+	unsigned char buf[16 * 1024];
+	yajl_status status = yajl_status_ok;
+	for (;;)
+	{
+		const size_t len = fread(buf, 1, sizeof buf, f);
+		if (len == 0)
+		{
+			status = yajl_complete_parse(yh);
+			break;
+		}
+		status = yajl_parse(yh, buf, len);
+		if (status != yajl_status_ok)
+		{
+			break;
+		}
+	}
+	if (status == yajl_status_error)
+	{
+		unsigned char *err = yajl_get_error(yh, 0, NULL, 0);
+		LOG(LM_MAIN, LL_ERROR, "Error parsing %s: %s", filename, err);
+		yajl_free_error(yh, err);
+		goto bail;
+	}
+	ok = status == yajl_status_ok;
+
+bail:
+	if (yh != NULL)
+	{
+		yajl_free(yh);
+	}
+	if (f != NULL)
+	{
+		fclose(f);
+	}
+	free(s.value);
+	return ok;
+}
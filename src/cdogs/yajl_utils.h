@@ -73,3 +73,25 @@ bool YAJLTryLoadValue(yajl_val *node, const char *name);
 		}\
 	}
 */
+
+// Streaming (SAX-style) loading for data files shaped like
+// { "Version": 1, "Default": { ... }, "<section>": [ { ... }, { ... } ] }
+// Each top-level object, and each object in a top-level array, is reported
+// one field at a time, without building a document tree. Fields of nested
+// objects have slash-delimited keys (e.g. "Sound/Hit"), and elements of
+// arrays are reported with their index (-1 if not in an array).
+// Sections are reported in file order; pass a NULL section for all of them.
+typedef struct
+{
+	void *Data;
+	// Top-level scalars, e.g. "Version"; return false to stop loading
+	bool (*Header)(void *data, const char *key, const char *value);
+	// Start of an object in the named top-level section
+	void (*Begin)(void *data, const char *section);
+	// Values are strings, numbers as written, "true"/"false" or NULL
+	void (*Field)(
+		void *data, const char *key, const int index, const char *value);
+	void (*End)(void *data);
+} YAJLStreamHandler;
+bool YAJLStreamFile(
+	const char *filename, const char *section, const YAJLStreamHandler *h);
@@ -830,7 +830,7 @@ static void MissionChangeType(void *data, int d)
 	MissionOptionsTerminate(&gMission);
 	CampaignAndMissionSetup(mct->C, &gMission);
 	memset(&map, 0, sizeof map);
-	MapLoad(&map, &gMission, mct->C);
+	MapLoad(&map, &gMission, mct->C, CampaignMissionSeed(mct->C));
 	MapLoadDynamic(&map, &gMission, &mct->C->Setting.characters);
 	MissionConvertToType(gMission.missionData, &map, mct->Type);
 }
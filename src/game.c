@@ -82,6 +82,7 @@
 #include <cdogs/pic_manager.h>
 #include <cdogs/pics.h>
 #include <cdogs/powerup.h>
+#include <cdogs/replay.h>
 #include <cdogs/triggers.h>
 
 
@@ -105,7 +106,7 @@ static void PlayerSpecialCommands(TActor *actor, const int cmd)
 		GameEvent e = GameEventNew(GAME_EVENT_ACTOR_SWITCH_GUN);
 		e.u.ActorSwitchGun.UID = actor->uid;
 		e.u.ActorSwitchGun.GunIdx = (actor->gunIndex + 1) % actor->guns.size;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 }
 
@@ -185,11 +186,20 @@ bool RunGame(const CampaignOptions *co, struct MissionOptions *m, Map *map)
 		gGraphicsDevice.bkg, NULL, gGraphicsDevice.buf,
 		gGraphicsDevice.cachedConfig.Res.x * sizeof(Uint32));
 
-	MapLoad(map, m, co);
+	ReplayStart(&gReplay, co);
+
+	// Replays build the map from their own seed so they can be played back
+	const unsigned int seed = gReplay.Mode != REPLAY_MODE_NONE ?
+		gReplay.Seed : CampaignMissionSeed(co);
+	if (!MapPreloadTake(&gMapPreload, map, m, seed))
+	{
+		MapLoad(map, m, co, seed);
+	}
 
 	// Seed random if PVP mode (otherwise players will always spawn in same
 	// position)
-	if (IsPVP(co->Entry.Mode))
+	// Replays have already been seeded
+	if (IsPVP(co->Entry.Mode) && gReplay.Mode == REPLAY_MODE_NONE)
 	{
 		srand((unsigned int)time(NULL));
 	}
@@ -211,7 +221,7 @@ bool RunGame(const CampaignOptions *co, struct MissionOptions *m, Map *map)
 			if (!p->IsLocal) continue;
 			GameEvent e = GameEventNew(GAME_EVENT_PLAYER_DATA);
 			e.u.PlayerData = PlayerDataMissionReset(p);
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		CA_FOREACH_END()
 		// Process the events to force add the players
 		HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
@@ -265,7 +275,7 @@ bool RunGame(const CampaignOptions *co, struct MissionOptions *m, Map *map)
 
 	NetServerSendGameStartMessages(&gNetServer, NET_SERVER_BCAST);
 	GameEvent start = GameEventNew(GAME_EVENT_GAME_START);
-	GameEventsEnqueue(&gGameEvents, start);
+	GameEventsEnqueue(&gGameEvents, &start);
 
 	data.loop = GameLoopDataNew(
 		&data, RunGameUpdate, &data, RunGameDraw);
@@ -273,11 +283,15 @@ bool RunGame(const CampaignOptions *co, struct MissionOptions *m, Map *map)
 	data.loop.InputFunc = RunGameInput;
 	data.loop.FPS = ConfigGetInt(&gConfig, "Game.FPS");
 	data.loop.InputEverySecondFrame = true;
+	// Play replays back as fast as possible
+	data.loop.Unlimited = ReplayIsPlaying(&gReplay);
+	data.loop.NoDraw = data.loop.Unlimited && gReplay.NoRender;
 	GameLoop(&data.loop);
 	LOG(LM_MAIN, LL_INFO, "Game finished");
 
 	// Flush events
 	HandleGameEvents(&gGameEvents, NULL, NULL, NULL);
+	ReplayEnd(&gReplay);
 
 	PowerupSpawnerTerminate(&data.healthSpawner);
 	CA_FOREACH(PowerupSpawner, a, data.ammoSpawners)
@@ -299,7 +313,12 @@ static void RunGameInput(void *data)
 	{
 		GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
 		e.u.MissionEnd.IsQuit = true;
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
+		return;
+	}
+	if (ReplayIsPlaying(&gReplay))
+	{
+		// Commands come from the replay instead
 		return;
 	}
 
@@ -388,7 +407,7 @@ static void RunGameInput(void *data)
 			// Already paused; exit
 			GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
 			e.u.MissionEnd.IsQuit = true;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 			// Need to unpause to process the quit
 			rData->pausingDevice = INPUT_DEVICE_UNSET;
 			rData->controllerUnplugged = false;
@@ -441,7 +460,7 @@ static GameLoopResult RunGameUpdate(void *data)
 	if (!rData->m->HasBegun && MissionCanBegin())
 	{
 		GameEvent begin = GameEventNew(GAME_EVENT_GAME_BEGIN);
-		GameEventsEnqueue(&gGameEvents, begin);
+		GameEventsEnqueue(&gGameEvents, &begin);
 	}
 
 	// Set mission complete and display exit if it is complete
@@ -462,12 +481,28 @@ static GameLoopResult RunGameUpdate(void *data)
 		return UPDATE_RESULT_DRAW;
 	}
 
+	if (!ReplayUpdate(&gReplay, rData->cmds))
+	{
+		// End of replay
+		NMissionEnd me = NMissionEnd_init_zero;
+		me.IsQuit = true;
+		MissionDone(rData->m, me);
+		return UPDATE_RESULT_DRAW;
+	}
+
 	// Update all the things in the game
 	const int ticksPerFrame = 1;
 
 	if (gPlayerDatas.size > 0)
 	{
 		LOSReset(&gMap.LOS);
+		TActor *players[MAX_LOCAL_PLAYERS];
+		int idxs[MAX_LOCAL_PLAYERS];
+		int numPlayers = 0;
+		TActor *aiPlayers[MAX_LOCAL_PLAYERS];
+		int aiCmds[MAX_LOCAL_PLAYERS];
+		int aiIdxs[MAX_LOCAL_PLAYERS];
+		int numAIPlayers = 0;
 		for (int i = 0, idx = 0; i < (int)gPlayerDatas.size; i++, idx++)
 		{
 			const PlayerData *p = CArrayGet(&gPlayerDatas, i);
@@ -490,10 +525,24 @@ static GameLoopResult RunGameUpdate(void *data)
 			}
 			if (p->inputDevice == INPUT_DEVICE_AI)
 			{
-				rData->cmds[idx] = AICoopGetCmd(player, ticksPerFrame);
+				aiPlayers[numAIPlayers] = player;
+				aiIdxs[numAIPlayers] = idx;
+				numAIPlayers++;
 			}
-			PlayerSpecialCommands(player, rData->cmds[idx]);
-			CommandActor(player, rData->cmds[idx], ticksPerFrame);
+			players[numPlayers] = player;
+			idxs[numPlayers] = idx;
+			numPlayers++;
+		}
+		// AI players think in parallel, then all players act in order
+		AICoopGetCmds(aiPlayers, aiCmds, numAIPlayers, ticksPerFrame);
+		for (int i = 0; i < numAIPlayers; i++)
+		{
+			rData->cmds[aiIdxs[i]] = aiCmds[i];
+		}
+		for (int i = 0; i < numPlayers; i++)
+		{
+			PlayerSpecialCommands(players[i], rData->cmds[idxs[i]]);
+			CommandActor(players[i], rData->cmds[idxs[i]], ticksPerFrame);
 		}
 	}
 
@@ -542,7 +591,7 @@ static GameLoopResult RunGameUpdate(void *data)
 				ei.u.ActorImpulse.UID = p->uid;
 				ei.u.ActorImpulse.Vel = Vec2i2Net(Vec2iScale(vel, 64));
 				ei.u.ActorImpulse.Pos = Vec2i2Net(Vec2iZero());
-				GameEventsEnqueue(&gGameEvents, ei);
+				GameEventsEnqueue(&gGameEvents, &ei);
 				LOG(LM_MAIN, LL_TRACE,
 					"playerUID(%d) pos(%d, %d) screen(%d, %d) impulse(%d, %d)",
 					p->uid, p->tileItem.x, p->tileItem.y, screen.x, screen.y,
@@ -556,7 +605,8 @@ static GameLoopResult RunGameUpdate(void *data)
 	UpdateMobileObjects(ticksPerFrame);
 	ParticlesUpdate(&gParticles, ticksPerFrame);
 
-	UpdateWatches(&rData->map->triggers, ticksPerFrame);
+	UpdateWatches(
+		&rData->map->triggers, &rData->map->watches, ticksPerFrame);
 
 	PowerupSpawnerUpdate(&rData->healthSpawner, ticksPerFrame);
 	CA_FOREACH(PowerupSpawner, a, rData->ammoSpawners)
@@ -595,7 +645,7 @@ static void CheckMissionCompletion(const struct MissionOptions *mo)
 			GameEvent e = GameEventNew(GAME_EVENT_OBJECTIVE_UPDATE);
 			e.u.ObjectiveUpdate.ObjectiveId = _ca_index;
 			e.u.ObjectiveUpdate.Count = update;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 	CA_FOREACH_END()
 
@@ -604,18 +654,18 @@ static void CheckMissionCompletion(const struct MissionOptions *mo)
 	if (mo->state == MISSION_STATE_PLAY && isMissionComplete)
 	{
 		GameEvent e = GameEventNew(GAME_EVENT_MISSION_PICKUP);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 	if (mo->state == MISSION_STATE_PICKUP && !isMissionComplete)
 	{
 		GameEvent e = GameEventNew(GAME_EVENT_MISSION_INCOMPLETE);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 	if (mo->state == MISSION_STATE_PICKUP &&
 		mo->pickupTime + PICKUP_LIMIT <= mo->time)
 	{
 		GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
-		GameEventsEnqueue(&gGameEvents, e);
+		GameEventsEnqueue(&gGameEvents, &e);
 	}
 
 	// Check that all players have been destroyed
@@ -636,7 +686,7 @@ static void CheckMissionCompletion(const struct MissionOptions *mo)
 		{
 			GameEvent e = GameEventNew(GAME_EVENT_MISSION_END);
 			e.u.MissionEnd.Delay = GAME_OVER_DELAY;
-			GameEventsEnqueue(&gGameEvents, e);
+			GameEventsEnqueue(&gGameEvents, &e);
 		}
 	}
 }
@@ -455,6 +455,8 @@ menu_t *MenuCreateOptionsGraphics(const char *name, MenuSystem *ms)
 	MenuAddConfigOptionsItem(menu, ConfigGet(&gConfig, "Graphics.Shadows"));
 	MenuAddConfigOptionsItem(menu, ConfigGet(&gConfig, "Graphics.Gore"));
 	MenuAddConfigOptionsItem(menu, ConfigGet(&gConfig, "Graphics.Brass"));
+	MenuAddConfigOptionsItem(
+		menu, ConfigGet(&gConfig, "Graphics.MaxParticles"));
 	MenuAddSubmenu(menu, MenuCreateSeparator(""));
 	MenuAddSubmenu(menu, MenuCreateBack("Done"));
 	MenuSetPostInputFunc(menu, PostInputConfigApply, ms);
@@ -55,9 +55,11 @@
 #include <cdogs/game_events.h>
 #include <cdogs/handle_game_events.h>
 #include <cdogs/hiscores.h>
+#include <cdogs/map.h>
 #include <cdogs/music.h>
 #include <cdogs/net_client.h>
 #include <cdogs/net_server.h>
+#include <cdogs/replay.h>
 
 #include "autosave.h"
 #include "briefing_screens.h"
@@ -113,6 +115,22 @@ bail:
 	ConfigResetChanged(&gConfig);
 }
 
+void ScreenReplay(void)
+{
+	PlayerDataTerminate(&gPlayerDatas);
+	PlayerDataInit(&gPlayerDatas);
+	GameEventsInit(&gGameEvents);
+
+	ReplaySetupPlayers(&gReplay);
+	gCampaign.MissionIndex = gReplay.Campaign.Mission;
+	CampaignAndMissionSetup(&gCampaign, &gMission);
+	RunGame(&gCampaign, &gMission, &gMap);
+	MissionOptionsTerminate(&gMission);
+	CampaignUnload(&gCampaign);
+
+	GameEventsTerminate(&gGameEvents);
+	ConfigResetChanged(&gConfig);
+}
 
 static void Campaign(GraphicsDevice *graphics, CampaignOptions *co)
 {
@@ -155,6 +173,15 @@ static void Campaign(GraphicsDevice *graphics, CampaignOptions *co)
 			}
 		}
 
+		// Build the map while the briefing and equip screens are shown.
+		// Net clients may still be sent changes from the server, so they
+		// build it when the game starts.
+		if (!co->IsClient)
+		{
+			MapPreloadStart(
+				&gMapPreload, &gMission, co, CampaignMissionSeed(co));
+		}
+
 		// Mission briefing
 		if (GetNumPlayers(PLAYER_ANY, false, true) > 0 &&
 			IsMissionBriefingNeeded(co->Entry.Mode))
@@ -303,6 +330,8 @@ static void Campaign(GraphicsDevice *graphics, CampaignOptions *co)
 		gameOver = !playNext;
 
 	bail:
+		// The preloaded map is built from the mission, so finish with it first
+		MapPreloadCancel(&gMapPreload);
 		// Need to terminate the mission later as it is used in calculating scores
 		MissionOptionsTerminate(&gMission);
 	} while (run && !gameOver);
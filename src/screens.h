@@ -52,3 +52,5 @@
 #include <cdogs/grafx.h>
 
 void ScreenStart(void);
+// Play back the loaded replay, without any menus
+void ScreenReplay(void);
@@ -0,0 +1,80 @@
+#include <cbehave/cbehave.h>
+
+#include <ai_scheduler.h>
+
+
+FEATURE(AISchedulerShouldDecide, "AI scheduler")
+	SCENARIO("Actors decide on staggered frames by priority")
+		GIVEN("a scheduler with no limit")
+			AIScheduler s;
+			AISchedulerInit(&s, 0);
+		AND("a close, a near and a far actor")
+			int nextClose = 0, nextNear = 0, nextFar = 0;
+			const AIPriority close =
+				AISchedulerGetPriority(AI_SCHEDULER_CLOSE_TILES - 1);
+			const AIPriority near =
+				AISchedulerGetPriority(AI_SCHEDULER_CLOSE_TILES);
+			const AIPriority far = AISchedulerGetPriority(-1);
+
+		WHEN("I schedule them for many frames")
+			const int frames = AI_SCHEDULER_FAR_INTERVAL * 4;
+			int closeCount = 0, nearCount = 0, farCount = 0;
+			for (int i = 0; i < frames; i++)
+			{
+				AISchedulerNextFrame(&s);
+				closeCount += AISchedulerShouldDecide(&s, &nextClose, 1, close);
+				nearCount += AISchedulerShouldDecide(&s, &nextNear, 2, near);
+				farCount += AISchedulerShouldDecide(&s, &nextFar, 3, far);
+			}
+
+		THEN("each should decide straight away, then once per its interval")
+			SHOULD_INT_EQUAL(closeCount, frames);
+			SHOULD_INT_EQUAL(
+				nearCount, 1 + frames / AI_SCHEDULER_NEAR_INTERVAL);
+			SHOULD_INT_EQUAL(farCount, 1 + frames / AI_SCHEDULER_FAR_INTERVAL);
+	SCENARIO_END
+
+	SCENARIO("Decisions over the budget are deferred to later frames")
+		GIVEN("a scheduler with a budget of 2 per frame")
+			AIScheduler s;
+			AISchedulerInit(&s, 2);
+		AND("5 near actors, all due")
+			int next[5] = { 0, 0, 0, 0, 0 };
+			const AIPriority near =
+				AISchedulerGetPriority(AI_SCHEDULER_CLOSE_TILES);
+
+		WHEN("I schedule them for one frame")
+			bool decided[5] = { false, false, false, false, false };
+			AISchedulerNextFrame(&s);
+			for (int i = 0; i < 5; i++)
+			{
+				decided[i] = AISchedulerShouldDecide(&s, &next[i], i, near);
+			}
+			AISchedulerNextFrame(&s);
+
+		THEN("only 2 should decide and the rest should be deferred")
+			SHOULD_INT_EQUAL(s.LastDecided, 2);
+			SHOULD_INT_EQUAL(s.LastDeferred, 3);
+		AND("the deferred ones should all decide within two more frames")
+			for (int f = 0; f < 2; f++)
+			{
+				for (int i = 0; i < 5; i++)
+				{
+					if (AISchedulerShouldDecide(&s, &next[i], i, near))
+					{
+						decided[i] = true;
+					}
+				}
+				AISchedulerNextFrame(&s);
+			}
+			for (int i = 0; i < 5; i++)
+			{
+				SHOULD_BE_TRUE(decided[i]);
+			}
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"AI scheduler features are:",
+	TEST_FEATURE(AISchedulerShouldDecide)
+)
@@ -0,0 +1,387 @@
+#include <cbehave/cbehave.h>
+
+#include <ai.h>
+#include <ai_utils.h>
+#include <actor_placement.h>
+#include <collision.h>
+#include <config.h>
+#include <game_events.h>
+#include <gamedata.h>
+#include <handle_game_events.h>
+#include <path_cache.h>
+#include <thread_pool.h>
+#include <visibility_cache.h>
+
+#define NUM_ACTORS 40
+#define NUM_FRAMES 30
+static TActor *player;
+static Weapon guns[NUM_ACTORS + 1];
+static CharBot bot;
+static Character character;
+
+// Stubs
+CArray gActors;
+CArray gPlayerDatas;
+struct MissionOptions gMission;
+CampaignOptions gCampaign;
+Config gConfig;
+GameEventQueue gGameEvents;
+Map gMap;
+PathCache gPathCache;
+VisibilityCache gVisibilityCache;
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+int ConfigGetInt(Config *c, const char *name)
+{
+	UNUSED(c);
+	UNUSED(name);
+	return 0;
+}
+int ConfigGetEnum(Config *c, const char *name)
+{
+	UNUSED(c);
+	UNUSED(name);
+	return DIFFICULTY_NORMAL;
+}
+void PathCacheFreeze(PathCache *pc)
+{
+	UNUSED(pc);
+}
+void PathCacheThaw(PathCache *pc)
+{
+	UNUSED(pc);
+}
+void VisibilityCacheFreeze(VisibilityCache *vc)
+{
+	UNUSED(vc);
+}
+void VisibilityCacheThaw(VisibilityCache *vc)
+{
+	UNUSED(vc);
+}
+void VisibilityCacheNextFrame(VisibilityCache *vc)
+{
+	UNUSED(vc);
+}
+bool IsPlayerAlive(const PlayerData *p)
+{
+	return p->ActorUID >= 0;
+}
+TActor *ActorGetByUID(const int uid)
+{
+	CA_FOREACH(TActor, a, gActors)
+		if (a->uid == uid)
+		{
+			return a;
+		}
+	CA_FOREACH_END()
+	return NULL;
+}
+const Character *ActorGetCharacter(const TActor *a)
+{
+	UNUSED(a);
+	return &character;
+}
+Weapon *ActorGetGun(const TActor *a)
+{
+	return &guns[a->uid];
+}
+bool ActorCanFire(const TActor *a)
+{
+	UNUSED(a);
+	return true;
+}
+void ActorSetAIState(TActor *actor, const AIState s)
+{
+	actor->aiContext->State = s;
+}
+int ActorsGetNextUID(void)
+{
+	return 0;
+}
+TActor *AIGetClosestPlayer(Vec2i fullpos)
+{
+	UNUSED(fullpos);
+	return player;
+}
+Vec2i AIGetClosestPlayerPos(Vec2i pos)
+{
+	UNUSED(pos);
+	return player->Pos;
+}
+bool AIHasClearShot(const Vec2i from, const Vec2i to)
+{
+	return ((from.x + to.y) / TILE_WIDTH) % 3 != 0;
+}
+bool AIIsFacing(const TActor *a, const Vec2i targetFull, const direction_e d)
+{
+	UNUSED(a);
+	UNUSED(targetFull);
+	return ((int)d & 1) == 0;
+}
+int AIReverseDirection(int cmd)
+{
+	return cmd ^ (CMD_LEFT | CMD_RIGHT);
+}
+int AIGoto(TActor *actor, Vec2i target, bool ignoreObjects)
+{
+	UNUSED(actor);
+	UNUSED(target);
+	UNUSED(ignoreObjects);
+	return CMD_UP;
+}
+// Like AIGetClosestActor, reads the other actors' flags
+int AIHuntClosest(TActor *actor)
+{
+	int awake = 0;
+	CA_FOREACH(const TActor, a, gActors)
+		if (a != actor && !(a->flags & (FLAGS_SLEEPING | FLAGS_DETOURING)))
+		{
+			awake++;
+		}
+	CA_FOREACH_END()
+	return DirectionToCmd(awake);
+}
+bool IsCollisionDiamond(const Map *map, const Vec2i pos, const Vec2i fullSize)
+{
+	UNUSED(map);
+	UNUSED(fullSize);
+	return (pos.x / TILE_WIDTH + pos.y / TILE_HEIGHT) % 7 == 0;
+}
+TTileItem *CollideGetFirstItem(
+	const TTileItem *item, const Vec2i pos,
+	const int mask, const CollisionTeam team, const bool isPVP)
+{
+	UNUSED(item);
+	UNUSED(pos);
+	UNUSED(mask);
+	UNUSED(team);
+	UNUSED(isPVP);
+	return NULL;
+}
+CollisionTeam CalcCollisionTeam(const bool isActor, const TActor *actor)
+{
+	UNUSED(isActor);
+	UNUSED(actor);
+	return COLLISIONTEAM_NONE;
+}
+bool IsPVP(const GameMode mode)
+{
+	UNUSED(mode);
+	return false;
+}
+bool CanCompleteMission(const struct MissionOptions *options)
+{
+	UNUSED(options);
+	return false;
+}
+Vec2i MapGetExitPos(const Map *m)
+{
+	UNUSED(m);
+	return Vec2iZero();
+}
+bool MapIsTileInExit(const Map *map, const TTileItem *ti)
+{
+	UNUSED(map);
+	UNUSED(ti);
+	return false;
+}
+int MapHasLockedRooms(Map *map)
+{
+	UNUSED(map);
+	return 0;
+}
+bool CharacterIsPrisoner(const CharacterStore *store, const Character *c)
+{
+	UNUSED(store);
+	UNUSED(c);
+	return false;
+}
+int CharacterGetStartingHealth(const Character *c, const bool isNPC)
+{
+	UNUSED(c);
+	UNUSED(isNPC);
+	return 0;
+}
+int CharacterStoreGetPrisonerId(const CharacterStore *store, const int i)
+{
+	UNUSED(store);
+	UNUSED(i);
+	return 0;
+}
+int CharacterStoreGetRandomBaddieId(const CharacterStore *store)
+{
+	UNUSED(store);
+	return 0;
+}
+int CharacterStoreGetRandomSpecialId(const CharacterStore *store)
+{
+	UNUSED(store);
+	return 0;
+}
+NVec2i PlaceAwayFromPlayers(Map *map)
+{
+	UNUSED(map);
+	NVec2i v = { 0, 0 };
+	return v;
+}
+NVec2i PlacePrisoner(Map *map)
+{
+	UNUSED(map);
+	NVec2i v = { 0, 0 };
+	return v;
+}
+GameEvent GameEventNew(GameEventType type)
+{
+	GameEvent e;
+	memset(&e, 0, sizeof e);
+	e.Type = type;
+	return e;
+}
+void GameEventsEnqueue(GameEventQueue *store, const GameEvent *e)
+{
+	UNUSED(store);
+	UNUSED(e);
+}
+void HandleGameEvents(
+	GameEventQueue *store, Camera *camera, PowerupSpawner *healthSpawner,
+	CArray *ammoSpawners)
+{
+	UNUSED(store);
+	UNUSED(camera);
+	UNUSED(healthSpawner);
+	UNUSED(ammoSpawners);
+}
+
+// Event stream: what each actor does, in the order they act
+typedef struct
+{
+	int UID;
+	int Cmd;
+	int Flags;
+} ActEvent;
+static ActEvent *events;
+void CommandActor(TActor *actor, int cmd, int ticks)
+{
+	UNUSED(ticks);
+	events->UID = actor->uid;
+	events->Cmd = cmd;
+	events->Flags = actor->flags;
+	events++;
+	actor->lastCmd = cmd;
+	const Vec2i v = Vec2iNew(
+		(Right(cmd) - Left(cmd)) * 256 * 4, (Down(cmd) - Up(cmd)) * 256 * 4);
+	actor->Pos = Vec2iAdd(actor->Pos, v);
+}
+
+static Mission mission;
+static AIContext contexts[NUM_ACTORS];
+static void ActorsInitTest(void)
+{
+	memset(&bot, 0, sizeof bot);
+	bot.probabilityToMove = 50;
+	bot.probabilityToTrack = 25;
+	bot.probabilityToShoot = 10;
+	bot.actionDelay = 2;
+	memset(&character, 0, sizeof character);
+	character.bot = &bot;
+	memset(&mission, 0, sizeof mission);
+	CArrayInit(&mission.Enemies, sizeof(int));
+	memset(&gMission, 0, sizeof gMission);
+	gMission.missionData = &mission;
+	memset(guns, 0, sizeof guns);
+	memset(contexts, 0, sizeof contexts);
+
+	CArrayInit(&gActors, sizeof(TActor));
+	for (int i = 0; i < NUM_ACTORS; i++)
+	{
+		TActor a;
+		memset(&a, 0, sizeof a);
+		a.isInUse = true;
+		a.uid = i;
+		a.PlayerUID = -1;
+		// Spread out, so that some are too far away and fall asleep
+		a.Pos = Vec2iNew((i * 3 * TILE_WIDTH) << 8, (i % 5 * TILE_HEIGHT) << 8);
+		a.direction = (direction_e)(i % DIRECTION_COUNT);
+		a.flags = i % 4 == 0 ? FLAGS_AWAKEALWAYS : 0;
+		if (i % 3 == 0) a.flags |= FLAGS_TRYRIGHT;
+		contexts[i].ChatterCounter = 2;
+		contexts[i].EnemyId = -1;
+		a.aiContext = &contexts[i];
+		CArrayPushBack(&gActors, &a);
+	}
+	TActor p;
+	memset(&p, 0, sizeof p);
+	p.isInUse = true;
+	p.uid = NUM_ACTORS;
+	p.PlayerUID = 0;
+	CArrayPushBack(&gActors, &p);
+	player = CArrayGet(&gActors, NUM_ACTORS);
+
+	CArrayInit(&gPlayerDatas, sizeof(PlayerData));
+	PlayerData pd;
+	memset(&pd, 0, sizeof pd);
+	pd.ActorUID = NUM_ACTORS;
+	CArrayPushBack(&gPlayerDatas, &pd);
+}
+static void ActorsTerminateTest(void)
+{
+	CArrayTerminate(&gActors);
+	CArrayTerminate(&gPlayerDatas);
+	CArrayTerminate(&mission.Enemies);
+}
+
+static void RunFrames(ActEvent *e, const int numThreads)
+{
+	events = e;
+	ActorsInitTest();
+	AISchedulerInit(&gAIScheduler, 0);
+	ThreadPoolInit(&gThreadPool, numThreads);
+	srand(1);
+	for (int f = 0; f < NUM_FRAMES; f++)
+	{
+		// Walk the player along, so that actors wake and sleep
+		player->Pos.x += (4 * TILE_WIDTH) << 8;
+		CommandBadGuys(1);
+	}
+	ThreadPoolTerminate(&gThreadPool);
+	ActorsTerminateTest();
+}
+
+
+FEATURE(CommandBadGuys, "Bad guy commands")
+	SCENARIO("Thinking in parallel does the same as thinking serially")
+		GIVEN("bad guys whose thinking reads each other's flags")
+			ActEvent *serial;
+			CCALLOC(serial, sizeof *serial * NUM_ACTORS * NUM_FRAMES);
+			ActEvent *parallel;
+			CCALLOC(parallel, sizeof *parallel * NUM_ACTORS * NUM_FRAMES);
+		WHEN("I command them for a number of frames with one thread")
+			RunFrames(serial, 1);
+		AND("with several threads")
+			RunFrames(parallel, 4);
+		THEN("they should act and change their flags the same way")
+			SHOULD_MEM_EQUAL(
+				serial, parallel, sizeof *serial * NUM_ACTORS * NUM_FRAMES);
+		AND("some should have changed their flags")
+			bool flagsChanged = false;
+			for (int i = NUM_ACTORS; i < NUM_ACTORS * NUM_FRAMES; i++)
+			{
+				if (serial[i].Flags != serial[i - NUM_ACTORS].Flags)
+				{
+					flagsChanged = true;
+				}
+			}
+			SHOULD_BE_TRUE(flagsChanged);
+			CFREE(serial);
+			CFREE(parallel);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"AI features are:",
+	TEST_FEATURE(CommandBadGuys)
+)
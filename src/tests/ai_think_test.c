@@ -0,0 +1,111 @@
+#include <cbehave/cbehave.h>
+
+#include <ai_think.h>
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+#define NUM_ACTORS 50
+#define NUM_FRAMES 20
+static TActor actors[NUM_ACTORS];
+static AIContext contexts[NUM_ACTORS];
+
+static void ActorsInitTest(void)
+{
+	memset(actors, 0, sizeof actors);
+	memset(contexts, 0, sizeof contexts);
+	for (int i = 0; i < NUM_ACTORS; i++)
+	{
+		// UIDs out of array order, like after actors are removed and added
+		actors[i].uid = (i * 7) % NUM_ACTORS;
+		actors[i].Pos = Vec2iNew(i * 100, i * 50);
+		actors[i].aiContext = &contexts[i];
+	}
+}
+
+// Reads all the other actors, uses the actor's own random sequence and
+// writes to its own state
+static int ThinkTest(TActor *a, void *data)
+{
+	UNUSED(data);
+	int sum = 0;
+	for (int i = 0; i < NUM_ACTORS; i++)
+	{
+		sum += actors[i].Pos.x - a->Pos.y;
+	}
+	a->aiContext->Delay = RandNext(&a->aiContext->RandSeed) % 100;
+	return (sum + a->aiContext->Delay) & 0xff;
+}
+
+// Event stream: actor UID and command for each act, per frame
+typedef struct
+{
+	int UID;
+	int Cmd;
+} ActEvent;
+static void RunFrames(
+	ActEvent *events, const int numThreads, const bool reverse)
+{
+	ActorsInitTest();
+	ThreadPoolInit(&gThreadPool, numThreads);
+	for (int f = 0; f < NUM_FRAMES; f++)
+	{
+		AIThink think;
+		AIThinkInit(&think, ThinkTest, NULL);
+		for (int i = 0; i < NUM_ACTORS; i++)
+		{
+			const int idx = reverse ? NUM_ACTORS - 1 - i : i;
+			// Every third actor doesn't think and keeps its last command
+			AIThinkAdd(&think, &actors[idx], idx % 3 != 0, idx);
+		}
+		AIThinkRun(&think, &gThreadPool, (unsigned int)f * 12345u);
+		// Act: move actors so the next frame depends on this one
+		CA_FOREACH(const AIThinkItem, item, think.Items)
+			item->Actor->Pos.x += item->Cmd;
+			events->UID = item->Actor->uid;
+			events->Cmd = item->Cmd;
+			events++;
+		CA_FOREACH_END()
+		AIThinkTerminate(&think);
+	}
+	ThreadPoolTerminate(&gThreadPool);
+}
+
+
+FEATURE(AIThinkRun, "Two phase AI update")
+	SCENARIO("Act the same regardless of threads")
+		GIVEN("actors that think single threaded")
+			const size_t size = NUM_FRAMES * NUM_ACTORS * sizeof(ActEvent);
+			ActEvent *single;
+			CMALLOC(single, size);
+			RunFrames(single, 0, false);
+		AND("the same actors that think with multiple threads")
+			ActEvent *multi;
+			CMALLOC(multi, size);
+			RunFrames(multi, 4, false);
+		AND("in a different order")
+			ActEvent *reversed;
+			CMALLOC(reversed, size);
+			RunFrames(reversed, 4, true);
+
+		THEN("the event streams should be identical")
+			SHOULD_MEM_EQUAL(multi, single, size);
+			SHOULD_MEM_EQUAL(reversed, single, size);
+		AND("acts should be in UID order")
+			SHOULD_INT_EQUAL(single[0].UID, 0);
+			SHOULD_INT_EQUAL(single[NUM_ACTORS - 1].UID, NUM_ACTORS - 1);
+			CFREE(single);
+			CFREE(multi);
+			CFREE(reversed);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Two phase AI update features are:",
+	TEST_FEATURE(AIThinkRun)
+)
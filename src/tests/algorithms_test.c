@@ -0,0 +1,130 @@
+#define SDL_MAIN_HANDLED
+#include <cbehave/cbehave.h>
+
+#include <time.h>
+
+#include <algorithms.h>
+
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+// Straightforward version of the cave automaton, counting around each tile
+static int CountWallsAround(
+	const uint8_t *walls, const Vec2i size, const int px, const int py,
+	const int radius)
+{
+	int c = 0;
+	for (int x = px - radius; x <= px + radius; x++)
+	{
+		for (int y = py - radius; y <= py + radius; y++)
+		{
+			// Also count edge of maps
+			if (x < 0 || x >= size.x || y < 0 || y >= size.y ||
+				walls[x + y * size.x])
+			{
+				c++;
+			}
+		}
+	}
+	return c;
+}
+static void CaveReference(
+	uint8_t *walls, const Vec2i size, const int r1, const int r2,
+	const int generations)
+{
+	uint8_t *buf;
+	CMALLOC(buf, size.x * size.y);
+	for (int i = 0; i < generations; i++)
+	{
+		for (int y = 0; y < size.y; y++)
+		{
+			for (int x = 0; x < size.x; x++)
+			{
+				buf[x + y * size.x] = (uint8_t)(
+					CountWallsAround(walls, size, x, y, 1) >= r1 ||
+					CountWallsAround(walls, size, x, y, 2) <= r2);
+			}
+		}
+		memcpy(walls, buf, size.x * size.y);
+	}
+	CFREE(buf);
+}
+static uint8_t *RandomWalls(const Vec2i size, const int fillPercent)
+{
+	uint8_t *walls;
+	CMALLOC(walls, size.x * size.y);
+	for (int i = 0; i < size.x * size.y; i++)
+	{
+		walls[i] = (uint8_t)(rand() % 100 < fillPercent);
+	}
+	return walls;
+}
+static double Seconds(const clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+FEATURE(CaveCellularAutomaton, "Cave cellular automaton")
+	SCENARIO("Same result as counting around each tile")
+		GIVEN("random grids of various sizes")
+			srand(1);
+			const Vec2i sizes[] =
+			{
+				{ 1, 1 }, { 2, 7 }, { 5, 5 }, { 31, 17 }, { 64, 64 }
+			};
+			const int numSizes = sizeof sizes / sizeof sizes[0];
+		WHEN("I run the automaton and the reference version on each")
+			int mismatches = 0;
+			for (int i = 0; i < numSizes; i++)
+			{
+				const Vec2i size = sizes[i];
+				uint8_t *walls = RandomWalls(size, 45);
+				uint8_t *expected;
+				CMALLOC(expected, size.x * size.y);
+				memcpy(expected, walls, size.x * size.y);
+				CaveCellularAutomaton(walls, size, 5, 2, 4);
+				CaveReference(expected, size, 5, 2, 4);
+				if (memcmp(walls, expected, size.x * size.y) != 0)
+				{
+					mismatches++;
+				}
+				CFREE(walls);
+				CFREE(expected);
+			}
+		THEN("the results should be identical")
+			SHOULD_INT_EQUAL(mismatches, 0);
+	SCENARIO_END
+
+	SCENARIO("Generate a large cave")
+		GIVEN("a random 512x512 grid")
+			srand(2);
+			const Vec2i size = Vec2iNew(512, 512);
+			uint8_t *walls = RandomWalls(size, 45);
+			uint8_t *expected;
+			CMALLOC(expected, size.x * size.y);
+			memcpy(expected, walls, size.x * size.y);
+		WHEN("I run 4 generations with both versions")
+			clock_t start = clock();
+			CaveCellularAutomaton(walls, size, 5, 2, 4);
+			const double fast = Seconds(start);
+			start = clock();
+			CaveReference(expected, size, 5, 2, 4);
+			const double reference = Seconds(start);
+			printf("512x512 cave: %.1fms (reference %.1fms)\n",
+				fast * 1000, reference * 1000);
+		THEN("the results should be identical")
+			SHOULD_MEM_EQUAL(walls, expected, size.x * size.y);
+			CFREE(walls);
+			CFREE(expected);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Algorithms features are:",
+	TEST_FEATURE(CaveCellularAutomaton)
+)
@@ -113,9 +113,39 @@ FEATURE(CArrayRemoveIf, "Array remove if")
 	SCENARIO_END
 FEATURE_END
 
+FEATURE(CArrayIndexOf, "Array index of")
+	SCENARIO("Index of elements")
+		GIVEN("an array with numbers 0-4")
+			CArray a;
+			CArrayInit(&a, sizeof(int));
+			for (int i = 0; i < 5; i++)
+			{
+				CArrayPushBack(&a, &i);
+			}
+
+		WHEN("I get the index of each element's address")
+			int indices[5];
+			for (int i = 0; i < 5; i++)
+			{
+				indices[i] = CArrayIndexOf(&a, CArrayGet(&a, i));
+			}
+
+		THEN("the indices should match")
+			for (int i = 0; i < 5; i++)
+			{
+				SHOULD_INT_EQUAL(indices[i], i);
+			}
+		AND("addresses outside the array should not be found")
+			const int other = 0;
+			SHOULD_INT_EQUAL(CArrayIndexOf(&a, &other), -1);
+			CArrayTerminate(&a);
+	SCENARIO_END
+FEATURE_END
+
 CBEHAVE_RUN(
 	"CArray features are:",
 	TEST_FEATURE(CArrayInsert),
 	TEST_FEATURE(CArrayDelete),
-	TEST_FEATURE(CArrayRemoveIf)
+	TEST_FEATURE(CArrayRemoveIf),
+	TEST_FEATURE(CArrayIndexOf)
 )
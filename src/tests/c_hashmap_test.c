@@ -1,10 +1,135 @@
 #include <cbehave/cbehave.h>
 
+#include <stdio.h>
+#include <time.h>
+
 #include <c_hashmap/hashmap.h>
+#include <tinydir/tinydir.h>
 
 
 // All tests in this file adapted from example code in the original c_hashmap
-// package's main.c
+// package's main.c, except the benchmark
+
+
+// The keys the game puts in its maps: pic and sound names, which are paths
+// relative to their dirs without extensions, and class names
+#define MAX_KEYS 4096
+#define MAX_KEY 256
+static char keys[MAX_KEYS][MAX_KEY];
+static int numKeys = 0;
+static void AddKey(const char *key)
+{
+	if (numKeys == MAX_KEYS || strlen(key) == 0 || strlen(key) >= MAX_KEY)
+	{
+		return;
+	}
+	for (int i = 0; i < numKeys; i++)
+	{
+		if (strcmp(keys[i], key) == 0)
+		{
+			return;
+		}
+	}
+	strcpy(keys[numKeys++], key);
+}
+static void AddFileKeys(const char *path, const char *prefix, const char *ext)
+{
+	tinydir_dir dir;
+	if (tinydir_open(&dir, path) == -1)
+	{
+		return;
+	}
+	for (; dir.has_next; tinydir_next(&dir))
+	{
+		tinydir_file file;
+		tinydir_readfile(&dir, &file);
+		char buf[MAX_KEY * 2];
+		if (prefix != NULL)
+		{
+			sprintf(buf, "%s/%s", prefix, file.name);
+		}
+		else
+		{
+			strcpy(buf, file.name);
+		}
+		if (file.is_dir && file.name[0] != '.')
+		{
+			AddFileKeys(file.path, buf, ext);
+		}
+		else if (file.is_reg &&
+			(ext == NULL || strcmp(file.extension, ext) == 0))
+		{
+			char *dot = strrchr(buf, '.');
+			if (dot != NULL)
+			{
+				*dot = '\0';
+			}
+			AddKey(buf);
+		}
+	}
+	tinydir_close(&dir);
+}
+static void AddClassNameKeys(const char *path)
+{
+	FILE *f = fopen(path, "r");
+	if (f == NULL)
+	{
+		return;
+	}
+	char line[1024];
+	while (fgets(line, sizeof line, f))
+	{
+		const char *name = strstr(line, "\"Name\": \"");
+		if (name == NULL)
+		{
+			continue;
+		}
+		char buf[MAX_KEY];
+		if (sscanf(name + strlen("\"Name\": \""), "%255[^\"]", buf) == 1)
+		{
+			AddKey(buf);
+		}
+	}
+	fclose(f);
+}
+// Note: relative to this dir
+static void AddGameKeys(void)
+{
+	numKeys = 0;
+	AddFileKeys("../../graphics", NULL, "png");
+	AddFileKeys("../../sounds", NULL, NULL);
+	const char *classFiles[] =
+	{
+		"ammo", "bullets", "character_classes", "guns", "map_objects",
+		"particles", "pickups"
+	};
+	for (int i = 0; i < (int)(sizeof classFiles / sizeof classFiles[0]); i++)
+	{
+		char buf[MAX_KEY];
+		sprintf(buf, "../../data/%s.json", classFiles[i]);
+		AddClassNameKeys(buf);
+	}
+}
+// What sounds used before the hashmap: a linear scan of the names
+static int LinearFind(const char *key)
+{
+	for (int i = 0; i < numKeys; i++)
+	{
+		if (strcmp(keys[i], key) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+static double Seconds(const clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+static double NsPerOp(const double seconds, const int ops)
+{
+	return seconds * 1e9 / ops;
+}
 
 
 FEATURE(hashmap_put, "Hashmap put")
@@ -21,6 +146,28 @@ FEATURE(hashmap_put, "Hashmap put")
 
 		hashmap_free(map);
 	SCENARIO_END
+
+	SCENARIO("Put an existing key")
+		GIVEN("a hashmap with a value")
+			map_t map = hashmap_new();
+			int value = 42;
+			hashmap_put(map, "somekey", &value);
+
+		WHEN("I put another value with the same key")
+			int value2 = 43;
+			int error = hashmap_put(map, "somekey", &value2);
+
+		THEN("the operation should report the existing key")
+			SHOULD_INT_EQUAL(error, (int)MAP_EXISTS);
+		AND("the original value should be kept");
+			int *valueOut;
+			hashmap_get(map, "somekey", (void **)&valueOut);
+			SHOULD_INT_EQUAL(*valueOut, value);
+		AND("the map should still have one element");
+			SHOULD_INT_EQUAL(hashmap_length(map), 1);
+
+		hashmap_free(map);
+	SCENARIO_END
 FEATURE_END
 
 FEATURE(hashmap_get, "Hashmap get")
@@ -76,9 +223,99 @@ FEATURE(hashmap_remove, "Hashmap remove")
 	SCENARIO_END
 FEATURE_END
 
+FEATURE(hashmap_benchmark, "Hashmap benchmark")
+	SCENARIO("Look up the game's keys")
+		GIVEN("the pic, sound and class names")
+			AddGameKeys();
+			// Lookups of other keys miss, like every pic and sound lookup
+			// that checks the custom map first
+			static char missKeys[MAX_KEYS][MAX_KEY + 1];
+			for (int i = 0; i < numKeys; i++)
+			{
+				sprintf(missKeys[i], "%s_", keys[i]);
+			}
+			const int rounds = 100;
+
+		WHEN("I put and get all of them many times")
+			int putErrors = 0, hits = 0, misses = 0;
+			map_t map = NULL;
+			clock_t start = clock();
+			for (int r = 0; r < rounds; r++)
+			{
+				hashmap_free(map);
+				map = hashmap_new();
+				for (int i = 0; i < numKeys; i++)
+				{
+					putErrors += hashmap_put(map, keys[i], keys[i]) != MAP_OK;
+				}
+			}
+			const double putTime = Seconds(start);
+			start = clock();
+			for (int r = 0; r < rounds; r++)
+			{
+				for (int i = 0; i < numKeys; i++)
+				{
+					any_t value;
+					hits += hashmap_get(map, keys[i], &value) == MAP_OK &&
+						value == keys[i];
+				}
+			}
+			const double hitTime = Seconds(start);
+			start = clock();
+			for (int r = 0; r < rounds; r++)
+			{
+				for (int i = 0; i < numKeys; i++)
+				{
+					any_t value;
+					misses +=
+						hashmap_get(map, missKeys[i], &value) == MAP_MISSING;
+				}
+			}
+			const double missTime = Seconds(start);
+		AND("I find them with a linear scan for reference")
+			int linearHits = 0, linearMisses = 0;
+			start = clock();
+			for (int r = 0; r < rounds; r++)
+			{
+				for (int i = 0; i < numKeys; i++)
+				{
+					linearHits += LinearFind(keys[i]) == i;
+				}
+			}
+			const double linearHitTime = Seconds(start);
+			start = clock();
+			for (int r = 0; r < rounds; r++)
+			{
+				for (int i = 0; i < numKeys; i++)
+				{
+					linearMisses += LinearFind(missKeys[i]) == -1;
+				}
+			}
+			const double linearMissTime = Seconds(start);
+			const int ops = rounds * numKeys;
+			printf("%d keys: put %.0fns, get hit %.0fns (linear %.0fns),"
+				" get miss %.0fns (linear %.0fns)\n",
+				numKeys, NsPerOp(putTime, ops),
+				NsPerOp(hitTime, ops), NsPerOp(linearHitTime, ops),
+				NsPerOp(missTime, ops), NsPerOp(linearMissTime, ops));
+
+		THEN("every key should be found and no others")
+			SHOULD_INT_GT(numKeys, 0);
+			SHOULD_INT_EQUAL(putErrors, 0);
+			SHOULD_INT_EQUAL(hashmap_length(map), numKeys);
+			SHOULD_INT_EQUAL(hits, rounds * numKeys);
+			SHOULD_INT_EQUAL(misses, rounds * numKeys);
+			SHOULD_INT_EQUAL(linearHits, rounds * numKeys);
+			SHOULD_INT_EQUAL(linearMisses, rounds * numKeys);
+
+		hashmap_free(map);
+	SCENARIO_END
+FEATURE_END
+
 CBEHAVE_RUN(
 	"c_hashmap features are:",
 	TEST_FEATURE(hashmap_put),
 	TEST_FEATURE(hashmap_get),
-	TEST_FEATURE(hashmap_remove)
+	TEST_FEATURE(hashmap_remove),
+	TEST_FEATURE(hashmap_benchmark)
 )
@@ -0,0 +1,348 @@
+#define SDL_MAIN_HANDLED
+#include <cbehave/cbehave.h>
+
+#include <actors.h>
+#include <algorithms.h>
+#include <config.h>
+#include <draw.h>
+#include <draw_actor.h>
+#include <font.h>
+#include <los.h>
+#include <map.h>
+#include <objs.h>
+#include <thread_pool.h>
+
+
+// Stubs
+CArray gActors;
+GraphicsDevice gGraphicsDevice;
+Map gMap;
+struct MissionOptions gMission;
+CArray gObjs;
+PicManager gPicManager;
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+int ConfigGetJSONVersion(FILE *f)
+{
+	UNUSED(f);
+	return 0;
+}
+bool ConfigIsOld(FILE *f)
+{
+	UNUSED(f);
+	return false;
+}
+const char *ObjectiveTypeStr(const ObjectiveType t)
+{
+	UNUSED(t);
+	return NULL;
+}
+void BresenhamLineDraw(Vec2i from, Vec2i to, AlgoLineDrawData *data)
+{
+	UNUSED(from);
+	UNUSED(to);
+	UNUSED(data);
+}
+void CPicDraw(
+	GraphicsDevice *g, const CPic *p,
+	const Vec2i pos, const CPicDrawContext *context)
+{
+	UNUSED(g);
+	UNUSED(p);
+	UNUSED(pos);
+	UNUSED(context);
+}
+void DrawActorPics(
+	GraphicsDevice *g, const ActorPics *pics, const Vec2i picPos,
+	const direction_e d)
+{
+	UNUSED(g);
+	UNUSED(pics);
+	UNUSED(picPos);
+	UNUSED(d);
+}
+void DrawLaserSight(
+	GraphicsDevice *g, const ActorPics *pics, const TActor *a,
+	const Vec2i picPos)
+{
+	UNUSED(g);
+	UNUSED(pics);
+	UNUSED(a);
+	UNUSED(picPos);
+}
+void DrawActorHighlight(
+	GraphicsDevice *g, const ActorPics *pics, const Vec2i pos,
+	const color_t color, const direction_e d)
+{
+	UNUSED(g);
+	UNUSED(pics);
+	UNUSED(pos);
+	UNUSED(color);
+	UNUSED(d);
+}
+void DrawChatters(DrawBuffer *b, const Vec2i offset)
+{
+	UNUSED(b);
+	UNUSED(offset);
+}
+void GetCharacterPicsFromActor(ActorPics *pics, TActor *a)
+{
+	UNUSED(pics);
+	UNUSED(a);
+}
+int FontStrW(const char *s)
+{
+	UNUSED(s);
+	return 0;
+}
+Vec2i FontStr(const char *s, Vec2i pos)
+{
+	UNUSED(s);
+	return pos;
+}
+bool LOSTileIsVisible(Map *map, const Vec2i pos)
+{
+	UNUSED(map);
+	return (pos.x + pos.y) % 5 != 0;
+}
+Tile *MapGetTile(Map *map, Vec2i pos)
+{
+	UNUSED(map);
+	UNUSED(pos);
+	return NULL;
+}
+int MapGetTileFlags(const Map *map, const Vec2i pos)
+{
+	UNUSED(map);
+	UNUSED(pos);
+	return TILE_NONE_FLAGS;
+}
+Pic *PicManagerGetPic(const PicManager *pm, const char *name)
+{
+	UNUSED(pm);
+	UNUSED(name);
+	return NULL;
+}
+direction_e RadiansToDirection(const double r)
+{
+	UNUSED(r);
+	return DIRECTION_UP;
+}
+bool TileItemIsDebris(const TTileItem *t)
+{
+	return t->flags & TILEITEM_IS_WRECK;
+}
+
+#define NUM_THINGS 64
+static TTileItem things[NUM_THINGS];
+TTileItem *ThingIdGetTileItem(ThingId *tid)
+{
+	return &things[tid->Id];
+}
+
+static Pic thingPic;
+static const Pic *GetThingPic(int id, Vec2i *offset)
+{
+	UNUSED(id);
+	*offset = Vec2iScaleDiv(thingPic.size, -2);
+	return &thingPic;
+}
+
+static void PicInitColor(Pic *p, const Vec2i size, const color_t c)
+{
+	p->size = size;
+	p->offset = Vec2iZero();
+	CMALLOC(p->Data, size.x * size.y * sizeof *p->Data);
+	for (int i = 0; i < size.x * size.y; i++)
+	{
+		// Vary the colour so misplaced pixels show up
+		color_t pc = c;
+		pc.r = (Uint8)(c.r + i);
+		p->Data[i] = COLOR2PIXEL(pc);
+	}
+}
+
+static void SetClip(
+	GraphicsDevice *g, const int left, const int top,
+	const int right, const int bottom)
+{
+	g->clipping.left = left;
+	g->clipping.top = top;
+	g->clipping.right = right;
+	g->clipping.bottom = bottom;
+}
+
+static NamedPic floorPic, wallPic, doorPic;
+static void GraphicsInitTest(void)
+{
+	gConfig = ConfigDefault();
+	gGraphicsDevice.cachedConfig.Res = Vec2iNew(320, 240);
+	gGraphicsDevice.Format = SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
+	CMALLOC(gGraphicsDevice.buf, 320 * 240 * sizeof(Uint32));
+	SetClip(&gGraphicsDevice, 0, 0, 320 - 1, 240 - 1);
+	PicInitColor(
+		&floorPic.pic, Vec2iNew(TILE_WIDTH, TILE_HEIGHT), colorGray);
+	PicInitColor(&wallPic.pic, Vec2iNew(TILE_WIDTH, TILE_HEIGHT), colorRed);
+	PicInitColor(&doorPic.pic, Vec2iNew(TILE_WIDTH, 20), colorBlue);
+	PicInitColor(&thingPic, Vec2iNew(12, 30), colorGreen);
+}
+static void GraphicsTerminateTest(void)
+{
+	PicFree(&floorPic.pic);
+	PicFree(&wallPic.pic);
+	PicFree(&doorPic.pic);
+	PicFree(&thingPic);
+	CFREE(gGraphicsDevice.buf);
+	SDL_FreeFormat(gGraphicsDevice.Format);
+	ConfigDestroy(&gConfig);
+}
+
+// Fill a buffer with floors, walls, doors, fog and things
+static void DrawBufferInitTest(
+	DrawBuffer *b, GraphicsDevice *g, const Vec2i top, const int width)
+{
+	DrawBufferInit(b, Vec2iNew(X_TILES, Y_TILES), g);
+	memset(b->tiles[0], 0, X_TILES * Y_TILES * sizeof *b->tiles[0]);
+	b->Size = Vec2iNew(width, Y_TILES);
+	b->xTop = top.x;
+	b->yTop = top.y;
+	b->xStart = top.x / TILE_WIDTH;
+	b->yStart = top.y / TILE_HEIGHT;
+	b->dx = b->xStart * TILE_WIDTH - b->xTop;
+	b->dy = b->yStart * TILE_HEIGHT - b->yTop;
+	static int thingCount = 0;
+	DrawTile *tile = &b->tiles[0][0];
+	for (int y = b->yStart; y < b->yStart + Y_TILES; y++)
+	{
+		for (int x = b->xStart; x < b->xStart + width; x++, tile++)
+		{
+			CArrayInit(&tile->things, sizeof(ThingId));
+			tile->isVisited = (x + y) % 11 != 0;
+			tile->pic = &floorPic;
+			if ((x * 3 + y) % 7 == 0)
+			{
+				tile->pic = &wallPic;
+				tile->flags |= MAPTILE_IS_WALL;
+			}
+			else if ((x + y * 5) % 13 == 0)
+			{
+				tile->picAlt = &doorPic;
+				tile->flags |= MAPTILE_OFFSET_PIC;
+			}
+			if ((x * y) % 9 == 1 && thingCount < NUM_THINGS)
+			{
+				TTileItem *t = &things[thingCount];
+				memset(t, 0, sizeof *t);
+				t->x = x * TILE_WIDTH + (x * 7) % TILE_WIDTH;
+				t->y = y * TILE_HEIGHT + (x * 5 + y * 3) % TILE_HEIGHT;
+				t->getPicFunc = GetThingPic;
+				t->ShadowSize = Vec2iNew(8, 6);
+				t->kind = KIND_OBJECT;
+				if (thingCount % 4 == 0)
+				{
+					t->flags |= TILEITEM_IS_WRECK;
+				}
+				ThingId tid = { thingCount, KIND_OBJECT };
+				CArrayPushBack(&tile->things, &tid);
+				thingCount++;
+			}
+		}
+		tile += X_TILES - width;
+	}
+	DrawBufferFix(b);
+}
+static void DrawBufferTerminateTest(DrawBuffer *b)
+{
+	for (int i = 0; i < X_TILES * Y_TILES; i++)
+	{
+		CArrayTerminate(&b->tiles[0][i].things);
+	}
+	DrawBufferTerminate(b);
+}
+
+static void DrawViews(
+	DrawBuffer **buffers, const Vec2i *offsets, const int n,
+	Uint32 *out, const int numThreads)
+{
+	ThreadPoolInit(&gThreadPool, numThreads);
+	const size_t size =
+		gGraphicsDevice.cachedConfig.Res.x *
+		gGraphicsDevice.cachedConfig.Res.y * sizeof *gGraphicsDevice.buf;
+	memset(gGraphicsDevice.buf, 0, size);
+	DrawBuffersDraw(buffers, offsets, n);
+	memcpy(out, gGraphicsDevice.buf, size);
+	ThreadPoolTerminate(&gThreadPool);
+}
+
+
+FEATURE(DrawBufferDrawParallel, "Draw in parallel")
+	SCENARIO("Draw the same as single threaded")
+		GIVEN("a graphics device")
+			GraphicsInitTest();
+			const int bufSize = 320 * 240;
+		AND("a view with floors, walls, doors, fog and things")
+			DrawBuffer b;
+			DrawBufferInitTest(
+				&b, &gGraphicsDevice, Vec2iNew(5, 7), X_TILES);
+			DrawBuffer *buffers[] = { &b };
+			const Vec2i offsets[] = { { 0, 0 } };
+		WHEN("I draw it single threaded and with multiple threads")
+			Uint32 *single, *multi;
+			CMALLOC(single, bufSize * sizeof *single);
+			CMALLOC(multi, bufSize * sizeof *multi);
+			DrawViews(buffers, offsets, 1, single, 0);
+			DrawViews(buffers, offsets, 1, multi, 3);
+		THEN("the results should be identical")
+			SHOULD_MEM_EQUAL(multi, single, bufSize * sizeof *single);
+			CFREE(single);
+			CFREE(multi);
+			DrawBufferTerminateTest(&b);
+			GraphicsTerminateTest();
+	SCENARIO_END
+
+	SCENARIO("Draw split screen views the same as single threaded")
+		GIVEN("a graphics device")
+			GraphicsInitTest();
+			const int bufSize = 320 * 240;
+		AND("four views, each clipped to a quarter of the screen")
+			GraphicsDevice devices[4];
+			DrawBuffer views[4];
+			DrawBuffer *buffers[4];
+			Vec2i offsets[4];
+			for (int i = 0; i < 4; i++)
+			{
+				devices[i] = gGraphicsDevice;
+				const int left = (i & 1) ? 160 : 0;
+				const int top = (i < 2) ? 0 : 120;
+				SetClip(&devices[i], left, top, left + 159, top + 119);
+				DrawBufferInitTest(
+					&views[i], &devices[i], Vec2iNew(i * 37, i * 23),
+					X_TILES_HALF);
+				buffers[i] = &views[i];
+				offsets[i] = Vec2iNew(left - 80, top - 60);
+			}
+		WHEN("I draw them single threaded and with multiple threads")
+			Uint32 *single, *multi;
+			CMALLOC(single, bufSize * sizeof *single);
+			CMALLOC(multi, bufSize * sizeof *multi);
+			DrawViews(buffers, offsets, 4, single, 0);
+			DrawViews(buffers, offsets, 4, multi, 3);
+		THEN("the results should be identical")
+			SHOULD_MEM_EQUAL(multi, single, bufSize * sizeof *single);
+			CFREE(single);
+			CFREE(multi);
+			for (int i = 0; i < 4; i++)
+			{
+				DrawBufferTerminateTest(&views[i]);
+			}
+			GraphicsTerminateTest();
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Draw features are:",
+	TEST_FEATURE(DrawBufferDrawParallel)
+)
@@ -0,0 +1,317 @@
+#include <cbehave/cbehave.h>
+
+#include <time.h>
+
+#include <actors.h>
+#include <game_events.h>
+#include <net_client.h>
+#include <net_server.h>
+#include <player.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+NetClient gNetClient;
+NetServer gNetServer;
+void NetClientSendMsg(NetClient *n, const GameEventType e, const void *data)
+{
+	UNUSED(n);
+	UNUSED(e);
+	UNUSED(data);
+}
+void NetServerSendMsg(
+	NetServer *n, const int peerId, const GameEventType e, const void *data)
+{
+	UNUSED(n);
+	UNUSED(peerId);
+	UNUSED(e);
+	UNUSED(data);
+}
+bool PlayerIsLocal(const int uid)
+{
+	UNUSED(uid);
+	return false;
+}
+bool ActorIsLocalPlayer(const int uid)
+{
+	UNUSED(uid);
+	return false;
+}
+
+// A mix of small and large events, with something unique in each
+static GameEvent MakeEvent(const int i)
+{
+	GameEvent e;
+	switch (i % 4)
+	{
+	case 0:
+		e = GameEventNew(GAME_EVENT_SCREEN_SHAKE);
+		e.u.ShakeAmount = i;
+		break;
+	case 1:
+		e = GameEventNew(GAME_EVENT_ACTOR_MOVE);
+		e.u.ActorMove.UID = i;
+		break;
+	case 2:
+		e = GameEventNew(GAME_EVENT_PLAYER_DATA);
+		sprintf(e.u.PlayerData.Name, "player%d", i);
+		break;
+	default:
+		e = GameEventNew(GAME_EVENT_GAME_BEGIN);
+		break;
+	}
+	return e;
+}
+static bool EventMatches(const GameEvent *e, const int i)
+{
+	const GameEvent expected = MakeEvent(i);
+	if (e->Type != expected.Type)
+	{
+		return false;
+	}
+	switch (e->Type)
+	{
+	case GAME_EVENT_SCREEN_SHAKE:
+		return e->u.ShakeAmount == i;
+	case GAME_EVENT_ACTOR_MOVE:
+		return (int)e->u.ActorMove.UID == i;
+	case GAME_EVENT_PLAYER_DATA:
+		return strcmp(e->u.PlayerData.Name, expected.u.PlayerData.Name) == 0;
+	default:
+		return true;
+	}
+}
+static int CountEvents(GameEventQueue *store)
+{
+	int count = 0;
+	GameEventCursor c = { 0, 0 };
+	while (GameEventsNext(store, &c) != NULL)
+	{
+		count++;
+	}
+	return count;
+}
+
+// Events for a frame; mostly small ones
+static GameEvent MakeFrameEvent(const int i)
+{
+	if (i % 16 == 2)
+	{
+		return MakeEvent(i);
+	}
+	GameEvent e = GameEventNew(GAME_EVENT_SCREEN_SHAKE);
+	e.u.ShakeAmount = i;
+	return e;
+}
+static int sHandled;
+static void Handle(const GameEvent *e)
+{
+	sHandled += e->Type;
+}
+static void Run(GameEventQueue *store, const int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		const GameEvent e = MakeFrameEvent(i);
+		GameEventsEnqueue(store, &e);
+	}
+	GameEventCursor c = { 0, 0 };
+	for (GameEvent *e = GameEventsNext(store, &c);
+		e != NULL;
+		e = GameEventsNext(store, &c))
+	{
+		e->Delay--;
+		if (e->Delay >= 0)
+		{
+			continue;
+		}
+		Handle(e);
+	}
+	GameEventsClear(store);
+}
+
+// The old queue: whole, zeroed events passed by value into an array
+static GameEvent ReferenceEventNew(const int i)
+{
+	GameEvent e;
+	memset(&e, 0, sizeof e);
+	const GameEvent made = MakeFrameEvent(i);
+	e.Type = made.Type;
+	e.u = made.u;
+	return e;
+}
+static void ReferenceEnqueue(CArray *store, GameEvent e)
+{
+	CArrayPushBack(store, &e);
+}
+static void ReferenceHandle(const GameEvent e)
+{
+	sHandled += e.Type;
+}
+// Called through pointers, like the old functions in other modules
+static void (*const sReferenceEnqueue)(CArray *, GameEvent) = ReferenceEnqueue;
+static void (*const sReferenceHandle)(const GameEvent) = ReferenceHandle;
+static bool ReferenceComplete(const void *elem)
+{
+	return ((const GameEvent *)elem)->Delay < 0;
+}
+static void ReferenceRun(CArray *store, const int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		sReferenceEnqueue(store, ReferenceEventNew(i));
+	}
+	for (int i = 0; i < (int)store->size; i++)
+	{
+		GameEvent *e = CArrayGet(store, i);
+		e->Delay--;
+		if (e->Delay >= 0)
+		{
+			continue;
+		}
+		sReferenceHandle(*e);
+	}
+	CArrayRemoveIf(store, ReferenceComplete);
+}
+static double Seconds(const clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+FEATURE(GameEventQueue, "Game event queue")
+	SCENARIO("Enqueue events of different sizes")
+		GIVEN("a queue")
+			GameEventQueue store;
+			GameEventsInit(&store);
+		WHEN("I enqueue enough events to fill several chunks")
+			const int n = 2000;
+			for (int i = 0; i < n; i++)
+			{
+				const GameEvent e = MakeEvent(i);
+				GameEventsEnqueue(&store, &e);
+			}
+		THEN("they should come back in order with their data")
+			int i = 0;
+			int mismatches = 0;
+			GameEventCursor c = { 0, 0 };
+			for (GameEvent *e = GameEventsNext(&store, &c);
+				e != NULL;
+				e = GameEventsNext(&store, &c), i++)
+			{
+				if (!EventMatches(e, i))
+				{
+					mismatches++;
+				}
+			}
+			SHOULD_INT_EQUAL(i, n);
+			SHOULD_INT_EQUAL(mismatches, 0);
+			GameEventsTerminate(&store);
+	SCENARIO_END
+
+	SCENARIO("Enqueue while handling an event")
+		GIVEN("a queue with an event")
+			GameEventQueue store;
+			GameEventsInit(&store);
+			const GameEvent first = MakeEvent(2);
+			GameEventsEnqueue(&store, &first);
+			GameEventCursor c = { 0, 0 };
+			const GameEvent *e = GameEventsNext(&store, &c);
+		WHEN("I enqueue many more events while holding on to it")
+			for (int i = 0; i < 1000; i++)
+			{
+				const GameEvent more = MakeEvent(i);
+				GameEventsEnqueue(&store, &more);
+			}
+		THEN("the event should be unchanged")
+			SHOULD_BE_TRUE(EventMatches(e, 2));
+		AND("iterating should continue on to the new events")
+			int count = 0;
+			while (GameEventsNext(&store, &c) != NULL)
+			{
+				count++;
+			}
+			SHOULD_INT_EQUAL(count, 1000);
+			GameEventsTerminate(&store);
+	SCENARIO_END
+
+	SCENARIO("Clear keeps delayed events")
+		GIVEN("a queue with done and delayed events")
+			GameEventQueue store;
+			GameEventsInit(&store);
+			const int n = 2000;
+			for (int i = 0; i < n; i++)
+			{
+				GameEvent e = MakeEvent(i);
+				e.Delay = i % 3 == 0 ? 0 : -1;
+				GameEventsEnqueue(&store, &e);
+			}
+		WHEN("I clear the queue")
+			GameEventsClear(&store);
+		THEN("only the delayed events should remain, in order")
+			int i = 0;
+			int mismatches = 0;
+			GameEventCursor c = { 0, 0 };
+			for (GameEvent *e = GameEventsNext(&store, &c);
+				e != NULL;
+				e = GameEventsNext(&store, &c), i += 3)
+			{
+				if (!EventMatches(e, i) || e->Delay != 0)
+				{
+					mismatches++;
+				}
+			}
+			SHOULD_INT_EQUAL(i, n + 1);
+			SHOULD_INT_EQUAL(mismatches, 0);
+		AND("new events should go after them")
+			const GameEvent e = MakeEvent(1);
+			GameEventsEnqueue(&store, &e);
+			SHOULD_INT_EQUAL(CountEvents(&store), (n + 2) / 3 + 1);
+			GameEventsTerminate(&store);
+	SCENARIO_END
+
+	SCENARIO("Event throughput")
+		GIVEN("a frame's worth of mixed events")
+			const int n = 1000;
+			const int frames = 1000;
+			GameEventQueue store;
+			GameEventsInit(&store);
+			CArray reference;
+			CArrayInit(&reference, sizeof(GameEvent));
+		WHEN("I enqueue and handle them with the queue and the old array")
+			sHandled = 0;
+			clock_t start = clock();
+			for (int i = 0; i < frames; i++)
+			{
+				Run(&store, n);
+			}
+			const double fast = Seconds(start);
+			const int handled = sHandled;
+			sHandled = 0;
+			start = clock();
+			for (int i = 0; i < frames; i++)
+			{
+				ReferenceRun(&reference, n);
+			}
+			const double slow = Seconds(start);
+			printf("events/s: %.1fM (array %.1fM)\n",
+				n * frames / fast / 1e6, n * frames / slow / 1e6);
+		THEN("both should handle the same events")
+			SHOULD_INT_EQUAL(handled, sHandled);
+			SHOULD_INT_EQUAL(CountEvents(&store), 0);
+			CArrayTerminate(&reference);
+			GameEventsTerminate(&store);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Game event features are:",
+	TEST_FEATURE(GameEventQueue)
+)
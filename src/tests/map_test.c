@@ -0,0 +1,677 @@
+#include <cbehave/cbehave.h>
+
+#include <math.h>
+#include <time.h>
+
+#include <algorithms.h>
+#include <AStar.h>
+#include <gamedata.h>
+#include <los.h>
+#include <map.h>
+#include <map_build.h>
+#include <map_cave.h>
+#include <map_classic.h>
+#include <map_static.h>
+#include <objs.h>
+#include <path_cache.h>
+#include <visibility_cache.h>
+
+// Stubs
+struct MissionOptions gMission;
+CArray gObjs;
+PathCache gPathCache;
+VisibilityCache gVisibilityCache;
+CampaignOptions gCampaign;
+Config gConfig;
+GameEventQueue gGameEvents;
+PicManager gPicManager;
+SoundDevice gSoundDevice;
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+void PathCacheInit(PathCache *pc, Map *m)
+{
+	UNUSED(pc);
+	UNUSED(m);
+}
+void PathCacheTerminate(PathCache *pc)
+{
+	UNUSED(pc);
+}
+void VisibilityCacheInit(VisibilityCache *vc, Map *m)
+{
+	UNUSED(vc);
+	UNUSED(m);
+}
+void VisibilityCacheTerminate(VisibilityCache *vc)
+{
+	UNUSED(vc);
+}
+void LOSInit(Map *map, const Vec2i size)
+{
+	UNUSED(map);
+	UNUSED(size);
+}
+void LOSTerminate(LineOfSight *los)
+{
+	UNUSED(los);
+}
+void TileInit(Tile *t)
+{
+	memset(t, 0, sizeof *t);
+	CArrayInit(&t->things, sizeof(ThingId));
+}
+void TileDestroy(Tile *t)
+{
+	CArrayTerminate(&t->things);
+}
+bool TileIsClear(const Tile *t, const int flags)
+{
+	UNUSED(t);
+	UNUSED(flags);
+	return true;
+}
+bool TileItemIsDebris(const TTileItem *t)
+{
+	return t->flags & TILEITEM_IS_WRECK;
+}
+void MapGenerateTilePics(const Mission *m)
+{
+	UNUSED(m);
+}
+void MapSetupTilesAndWalls(Map *map, const Mission *m)
+{
+	UNUSED(map);
+	UNUSED(m);
+}
+void MapGenerateRandomExitArea(Map *map)
+{
+	UNUSED(map);
+}
+// A row of single doors, one for every 10 tiles of map width
+void MapClassicLoad(Map *map, const Mission *m, const CampaignOptions *co)
+{
+	UNUSED(co);
+	for (int i = 0; i < m->Size.x / 10; i++)
+	{
+		IMapSet(map, Vec2iNew(2 + i * 3, 2), MAP_DOOR);
+	}
+}
+void MapStaticLoad(Map *map, const struct MissionOptions *mo)
+{
+	UNUSED(map);
+	UNUSED(mo);
+}
+void MapCaveLoad(Map *map, const struct MissionOptions *mo)
+{
+	UNUSED(map);
+	UNUSED(mo);
+}
+// Doors come with a watch to close them
+void MapAddDoorGroup(
+	Map *map, const Mission *m, const Vec2i v, const int keyFlags)
+{
+	UNUSED(m);
+	UNUSED(v);
+	UNUSED(keyFlags);
+	MapNewWatch(map);
+}
+bool AreKeysAllowed(const GameMode mode)
+{
+	UNUSED(mode);
+	return false;
+}
+bool HasObjectives(const GameMode mode)
+{
+	UNUSED(mode);
+	return false;
+}
+bool AreasCollide(
+	const Vec2i pos1, const Vec2i pos2, const Vec2i size1, const Vec2i size2)
+{
+	UNUSED(pos1);
+	UNUSED(pos2);
+	UNUSED(size1);
+	UNUSED(size2);
+	return false;
+}
+bool IsCollisionWithWall(const Vec2i pos, const Vec2i fullSize)
+{
+	UNUSED(pos);
+	UNUSED(fullSize);
+	return false;
+}
+bool ConfigGetBool(Config *c, const char *name)
+{
+	UNUSED(c);
+	UNUSED(name);
+	return false;
+}
+GameEvent GameEventNew(GameEventType type)
+{
+	GameEvent e;
+	memset(&e, 0, sizeof e);
+	e.Type = type;
+	return e;
+}
+void GameEventsEnqueue(GameEventQueue *store, const GameEvent *e)
+{
+	UNUSED(store);
+	UNUSED(e);
+}
+void SoundPlayAt(SoundDevice *device, Mix_Chunk *data, const Vec2i pos)
+{
+	UNUSED(device);
+	UNUSED(data);
+	UNUSED(pos);
+}
+PickupClass *KeyPickupClass(const char *style, const int i)
+{
+	UNUSED(style);
+	UNUSED(i);
+	return NULL;
+}
+int PickupsGetNextUID(void)
+{
+	return 0;
+}
+int PickupClassId(const PickupClass *c)
+{
+	UNUSED(c);
+	return 0;
+}
+bool MapObjectIsWreck(const MapObject *mo)
+{
+	UNUSED(mo);
+	return false;
+}
+int MapObjectIndex(const MapObject *mo)
+{
+	UNUSED(mo);
+	return 0;
+}
+bool MapObjectIsTileOK(
+	const MapObject *obj, unsigned short tile, const bool isEmpty,
+	unsigned short tileAbove)
+{
+	UNUSED(obj);
+	UNUSED(tile);
+	UNUSED(isEmpty);
+	UNUSED(tileAbove);
+	return false;
+}
+bool MapObjectIsTileOKStrict(
+	const MapObject *obj, const unsigned short tile, const bool isEmpty,
+	const unsigned short tileAbove, const unsigned short tileBelow,
+	const int numWallsAdjacent, const int numWallsAround)
+{
+	UNUSED(obj);
+	UNUSED(tile);
+	UNUSED(isEmpty);
+	UNUSED(tileAbove);
+	UNUSED(tileBelow);
+	UNUSED(numWallsAdjacent);
+	UNUSED(numWallsAround);
+	return false;
+}
+void MapStaticLoadDynamic(
+	Map *map, const struct MissionOptions *mo, const CharacterStore *store)
+{
+	UNUSED(map);
+	UNUSED(mo);
+	UNUSED(store);
+}
+void ObjAdd(const NMapObjectAdd amo)
+{
+	UNUSED(amo);
+}
+bool ObjIsDangerous(const TObject *o)
+{
+	return o->Class->DestroyGuns.size > 0;
+}
+int ObjsGetNextUID(void)
+{
+	return 0;
+}
+NamedPic *PicManagerGetExitPic(
+	PicManager *pm, const char *style, const bool isShadow)
+{
+	UNUSED(pm);
+	UNUSED(style);
+	UNUSED(isShadow);
+	return NULL;
+}
+TTileItem *ThingIdGetTileItem(ThingId *tid)
+{
+	UNUSED(tid);
+	return NULL;
+}
+NVec2i Vec2i2Net(const Vec2i v)
+{
+	NVec2i nv;
+	nv.x = v.x;
+	nv.y = v.y;
+	return nv;
+}
+
+static void MissionInitTest(
+	Mission *m, struct MissionOptions *mo, const int width)
+{
+	memset(m, 0, sizeof *m);
+	m->Type = MAPTYPE_CLASSIC;
+	m->Size = Vec2iNew(width, 20);
+	memset(mo, 0, sizeof *mo);
+	mo->missionData = m;
+}
+
+// A thing that isn't on the map yet
+static void AddThing(TTileItem *ti, const int id, const TileItemKind kind)
+{
+	memset(ti, 0, sizeof *ti);
+	ti->x = ti->y = -1;
+	ti->id = id;
+	ti->kind = kind;
+}
+// Put a thing on the middle of a tile, like ObjAdd does
+static void MoveThing(TTileItem *ti, const Vec2i tile)
+{
+	MapTryMoveTileItem(&gMap, ti, Vec2iNew(
+		tile.x * TILE_WIDTH + TILE_WIDTH / 2,
+		tile.y * TILE_HEIGHT + TILE_HEIGHT / 2));
+}
+// Whether every tile's TileBlockers matches a full recompute from its things
+static bool TileBlockersMatchRecompute(Map *map)
+{
+	const size_t size = map->TileBlockers.size;
+	uint8_t *blockers;
+	CMALLOC(blockers, size);
+	memcpy(blockers, map->TileBlockers.data, size);
+	Vec2i pos;
+	for (pos.y = 0; pos.y < map->Size.y; pos.y++)
+	{
+		for (pos.x = 0; pos.x < map->Size.x; pos.x++)
+		{
+			MapUpdateTileBlockers(map, pos);
+		}
+	}
+	const bool match = memcmp(blockers, map->TileBlockers.data, size) == 0;
+	CFREE(blockers);
+	return match;
+}
+
+
+// A tile as it was before the flags were split out of it, to compare LOS
+// and path finding against
+typedef struct
+{
+	NamedPic *pic;
+	NamedPic *picAlt;
+	int flags;
+	bool isVisited;
+	CArray triggers;
+	CArray things;
+} FlaggedTile;
+static FlaggedTile *flaggedTiles = NULL;
+static int FlaggedTileFlags(const Vec2i pos)
+{
+	if (!MapIsTileIn(&gMap, pos))
+	{
+		return TILE_NONE_FLAGS;
+	}
+	return flaggedTiles[pos.y * gMap.Size.x + pos.x].flags;
+}
+static int PackedTileFlags(const Vec2i pos)
+{
+	return MapGetTileFlags(&gMap, pos);
+}
+static int (*GetFlags)(const Vec2i) = PackedTileFlags;
+// Same as the AI's line of sight check
+static bool IsPosNoSee(void *data, Vec2i pos)
+{
+	UNUSED(data);
+	return GetFlags(Vec2iToTile(pos)) & MAPTILE_NO_SEE;
+}
+// Same as the path cache's A* callbacks, for tiles without things
+static bool IsFlagWalkable(const Vec2i pos)
+{
+	return !(GetFlags(pos) & MAPTILE_NO_WALK);
+}
+static void AddTileNeighbors(
+	ASNeighborList neighbors, void *node, void *context)
+{
+	UNUSED(context);
+	const Vec2i *v = node;
+	for (int y = v->y - 1; y <= v->y + 1; y++)
+	{
+		for (int x = v->x - 1; x <= v->x + 1; x++)
+		{
+			if ((x == v->x && y == v->y) ||
+				!MapIsTileIn(&gMap, Vec2iNew(x, y)) ||
+				!IsFlagWalkable(Vec2iNew(x, y)) ||
+				!IsFlagWalkable(Vec2iNew(v->x, y)) ||
+				!IsFlagWalkable(Vec2iNew(x, v->y)))
+			{
+				continue;
+			}
+			Vec2i neighbor = Vec2iNew(x, y);
+			float cost;
+			if (x != v->x && y != v->y)
+			{
+				cost = TILE_WIDTH * 1.1f;
+			}
+			else if (x != v->x)
+			{
+				cost = TILE_WIDTH;
+			}
+			else
+			{
+				cost = TILE_HEIGHT;
+			}
+			ASNeighborListAdd(neighbors, &neighbor, cost);
+		}
+	}
+}
+static float AStarHeuristic(void *fromNode, void *toNode, void *context)
+{
+	UNUSED(context);
+	const Vec2i *v1 = fromNode;
+	const Vec2i *v2 = toNode;
+	return (float)sqrt(DistanceSquared(
+		Vec2iCenterOfTile(*v1), Vec2iCenterOfTile(*v2)));
+}
+static ASPathNodeSource cPathNodeSource =
+{
+	sizeof(Vec2i), AddTileNeighbors, AStarHeuristic, NULL, NULL
+};
+static int CountClearLines(
+	const Vec2i *from, const Vec2i *to, const int count)
+{
+	HasClearLineData data = { IsPosNoSee, NULL };
+	int clear = 0;
+	for (int i = 0; i < count; i++)
+	{
+		clear += HasClearLineXiaolinWu(from[i], to[i], &data);
+	}
+	return clear;
+}
+static int CountPathNodes(Vec2i *from, Vec2i *to, const int count)
+{
+	int nodes = 0;
+	for (int i = 0; i < count; i++)
+	{
+		ASPath path = ASPathCreate(
+			&cPathNodeSource, NULL, &from[i], &to[i]);
+		nodes += (int)ASPathGetCount(path);
+		ASPathDestroy(path);
+	}
+	return nodes;
+}
+// A floor tile within range of a tile
+static Vec2i RandomFloorNear(const uint8_t *walls, const Vec2i v, const int r)
+{
+	for (;;)
+	{
+		const int dx = rand() % (r * 2 + 1) - r;
+		const int dy = rand() % (r * 2 + 1) - r;
+		const Vec2i t = Vec2iNew(
+			CLAMP(v.x + dx, 0, gMap.Size.x - 1),
+			CLAMP(v.y + dy, 0, gMap.Size.y - 1));
+		if (!walls[t.y * gMap.Size.x + t.x])
+		{
+			return t;
+		}
+	}
+}
+static double Seconds(const clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+
+FEATURE(MapPreload, "Preload maps")
+	SCENARIO("Cancelling a preload leaves the current map's watches alone")
+		GIVEN("a loaded map with doors")
+			Mission m1;
+			struct MissionOptions mo1;
+			MissionInitTest(&m1, &mo1, 40);
+			MapLoad(&gMap, &mo1, &gCampaign, 1);
+			const int watches = (int)gMap.watches.size;
+		AND("the next map, with a different number of doors, preloading")
+			Mission m2;
+			struct MissionOptions mo2;
+			MissionInitTest(&m2, &mo2, 70);
+			MapPreloadStart(&gMapPreload, &mo2, &gCampaign, 2);
+		WHEN("I cancel the preload")
+			MapPreloadCancel(&gMapPreload);
+		THEN("the loaded map should have the same watches")
+			SHOULD_INT_EQUAL(watches, 4);
+			SHOULD_INT_EQUAL((int)gMap.watches.size, watches);
+			MapTerminate(&gMap);
+	SCENARIO_END
+
+	SCENARIO("Taking a preload with the wrong seed discards its watches")
+		GIVEN("a loaded map with doors")
+			Mission m1;
+			struct MissionOptions mo1;
+			MissionInitTest(&m1, &mo1, 40);
+			MapLoad(&gMap, &mo1, &gCampaign, 1);
+		AND("the next map preloading with one seed")
+			Mission m2;
+			struct MissionOptions mo2;
+			MissionInitTest(&m2, &mo2, 70);
+			MapPreloadStart(&gMapPreload, &mo2, &gCampaign, 2);
+		WHEN("I take it with another seed, and load it as usual")
+			const bool taken = MapPreloadTake(&gMapPreload, &gMap, &mo2, 3);
+			MapLoad(&gMap, &mo2, &gCampaign, 3);
+		THEN("the preload should not be used")
+			SHOULD_BE_FALSE(taken);
+		AND("the map should only have its own doors' watches")
+			SHOULD_INT_EQUAL((int)gMap.watches.size, 7);
+			MapTerminate(&gMap);
+	SCENARIO_END
+
+	SCENARIO("Taking a preload brings its watches")
+		GIVEN("a loaded map with doors")
+			Mission m1;
+			struct MissionOptions mo1;
+			MissionInitTest(&m1, &mo1, 40);
+			MapLoad(&gMap, &mo1, &gCampaign, 1);
+		AND("the next map preloading")
+			Mission m2;
+			struct MissionOptions mo2;
+			MissionInitTest(&m2, &mo2, 70);
+			MapPreloadStart(&gMapPreload, &mo2, &gCampaign, 2);
+		WHEN("I take it")
+			const bool taken = MapPreloadTake(&gMapPreload, &gMap, &mo2, 2);
+		THEN("the map should have the preloaded doors' watches")
+			SHOULD_BE_TRUE(taken);
+			SHOULD_INT_EQUAL((int)gMap.watches.size, 7);
+			MapTerminate(&gMap);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(MapTileBlockers, "Tile blockers")
+	SCENARIO("Blockers match a full recompute as things change")
+		GIVEN("a loaded map with doors")
+			Mission m;
+			struct MissionOptions mo;
+			MissionInitTest(&m, &mo, 40);
+			MapLoad(&gMap, &mo, &gCampaign, 1);
+			const Vec2i door = Vec2iNew(2, 2);
+			const Vec2i floor = Vec2iNew(3, 3);
+		AND("a plain object, a dangerous object and a character")
+			MapObject plain;
+			memset(&plain, 0, sizeof plain);
+			MapObject dangerous;
+			memset(&dangerous, 0, sizeof dangerous);
+			CArrayInit(&dangerous.DestroyGuns, sizeof(const void *));
+			const void *gun = NULL;
+			CArrayPushBack(&dangerous.DestroyGuns, &gun);
+			CArrayInit(&gObjs, sizeof(TObject));
+			for (int i = 0; i < 2; i++)
+			{
+				TObject o;
+				memset(&o, 0, sizeof o);
+				o.Class = i == 0 ? &plain : &dangerous;
+				AddThing(&o.tileItem, i, KIND_OBJECT);
+				CArrayPushBack(&gObjs, &o);
+			}
+			TObject *o1 = CArrayGet(&gObjs, 0);
+			TObject *o2 = CArrayGet(&gObjs, 1);
+			TTileItem character;
+			AddThing(&character, 0, KIND_CHARACTER);
+			TTileItem particle;
+			AddThing(&particle, 0, KIND_PARTICLE);
+
+		WHEN("I add them to the door, and the particle to the floor")
+			MoveThing(&o1->tileItem, door);
+			MoveThing(&o2->tileItem, door);
+			MoveThing(&character, door);
+			MoveThing(&particle, floor);
+		THEN("the door should have all blockers, the floor none")
+			SHOULD_INT_EQUAL(
+				MapGetTileBlockers(&gMap, door),
+				TILE_BLOCKER_OBJECT | TILE_BLOCKER_DANGEROUS |
+				TILE_BLOCKER_CHARACTER);
+			SHOULD_INT_EQUAL(MapGetTileBlockers(&gMap, floor), 0);
+			SHOULD_BE_TRUE(TileBlockersMatchRecompute(&gMap));
+
+		WHEN("I wreck the objects")
+			o1->tileItem.flags = TILEITEM_IS_WRECK;
+			MapUpdateTileBlockers(&gMap, door);
+			o2->tileItem.flags = TILEITEM_IS_WRECK;
+			MapUpdateTileBlockers(&gMap, door);
+		THEN("the wrecks should no longer block, but still be dangerous")
+			SHOULD_INT_EQUAL(
+				MapGetTileBlockers(&gMap, door),
+				TILE_BLOCKER_DANGEROUS | TILE_BLOCKER_CHARACTER);
+			SHOULD_BE_TRUE(TileBlockersMatchRecompute(&gMap));
+
+		WHEN("I close and open the door")
+			const int flags = MapGetTileFlags(&gMap, door);
+			MapSetTileFlags(&gMap, door, flags | MAPTILE_NO_WALK);
+			const bool matchClosed = TileBlockersMatchRecompute(&gMap);
+			MapSetTileFlags(&gMap, door, flags & ~MAPTILE_NO_WALK);
+		THEN("the blockers should be unchanged")
+			SHOULD_BE_TRUE(matchClosed);
+			SHOULD_INT_EQUAL(
+				MapGetTileBlockers(&gMap, door),
+				TILE_BLOCKER_DANGEROUS | TILE_BLOCKER_CHARACTER);
+			SHOULD_BE_TRUE(TileBlockersMatchRecompute(&gMap));
+
+		WHEN("I move the character off the door and remove the objects")
+			MoveThing(&character, floor);
+			MapRemoveTileItem(&gMap, &o2->tileItem);
+			const int afterDangerous = MapGetTileBlockers(&gMap, door);
+			MapRemoveTileItem(&gMap, &o1->tileItem);
+			MapRemoveTileItem(&gMap, &particle);
+		THEN("only the character's blocker should remain, on the floor")
+			SHOULD_INT_EQUAL(afterDangerous, 0);
+			SHOULD_INT_EQUAL(MapGetTileBlockers(&gMap, door), 0);
+			SHOULD_INT_EQUAL(
+				MapGetTileBlockers(&gMap, floor), TILE_BLOCKER_CHARACTER);
+			SHOULD_BE_TRUE(TileBlockersMatchRecompute(&gMap));
+			MapRemoveTileItem(&gMap, &character);
+			MapTerminate(&gMap);
+			CArrayTerminate(&gObjs);
+			CArrayTerminate(&dangerous.DestroyGuns);
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(MapTileFlags, "Packed tile flags")
+	SCENARIO("LOS and path finding on a large cave")
+		GIVEN("a 256x256 cave map")
+			Mission m;
+			struct MissionOptions mo;
+			MissionInitTest(&m, &mo, 256);
+			m.Size = Vec2iNew(256, 256);
+			MapLoad(&gMap, &mo, &gCampaign, 1);
+			const int numTiles = gMap.Size.x * gMap.Size.y;
+			srand(3);
+			uint8_t *walls;
+			CMALLOC(walls, numTiles);
+			for (int i = 0; i < numTiles; i++)
+			{
+				walls[i] = (uint8_t)(rand() % 100 < 45);
+			}
+			CaveCellularAutomaton(walls, gMap.Size, 5, 2, 4);
+		AND("the same flags in Tile-sized structs")
+			CCALLOC(flaggedTiles, numTiles * sizeof *flaggedTiles);
+			for (int i = 0; i < numTiles; i++)
+			{
+				const Vec2i pos = Vec2iNew(i % gMap.Size.x, i / gMap.Size.x);
+				const int flags = walls[i] ?
+					MAPTILE_NO_WALK | MAPTILE_NO_SEE | MAPTILE_IS_WALL :
+					MAPTILE_IS_NORMAL_FLOOR;
+				MapSetTileFlags(&gMap, pos, flags);
+				flaggedTiles[i].flags = flags;
+			}
+		AND("screen-range lines and paths of up to 40 tiles")
+			enum { NUM_LINES = 100000, NUM_PATHS = 200 };
+			Vec2i *lineFrom, *lineTo;
+			CMALLOC(lineFrom, NUM_LINES * sizeof *lineFrom);
+			CMALLOC(lineTo, NUM_LINES * sizeof *lineTo);
+			for (int i = 0; i < NUM_LINES; i++)
+			{
+				const Vec2i tile = Vec2iNew(
+					rand() % gMap.Size.x, rand() % gMap.Size.y);
+				const int dx = rand() % 41 - 20;
+				const int dy = rand() % 31 - 15;
+				lineFrom[i] = Vec2iCenterOfTile(tile);
+				lineTo[i] = Vec2iCenterOfTile(Vec2iNew(
+					CLAMP(tile.x + dx, 0, gMap.Size.x - 1),
+					CLAMP(tile.y + dy, 0, gMap.Size.y - 1)));
+			}
+			Vec2i pathFrom[NUM_PATHS], pathTo[NUM_PATHS];
+			for (int i = 0; i < NUM_PATHS; i++)
+			{
+				pathFrom[i] = RandomFloorNear(walls, Vec2iNew(
+					gMap.Size.x / 2, gMap.Size.y / 2), gMap.Size.x / 2);
+				pathTo[i] = RandomFloorNear(walls, pathFrom[i], 40);
+			}
+
+		WHEN("I check the lines and find the paths with both")
+			GetFlags = PackedTileFlags;
+			clock_t start = clock();
+			const int clear = CountClearLines(lineFrom, lineTo, NUM_LINES);
+			const double losTime = Seconds(start);
+			start = clock();
+			const int nodes = CountPathNodes(pathFrom, pathTo, NUM_PATHS);
+			const double pathTime = Seconds(start);
+			GetFlags = FlaggedTileFlags;
+			start = clock();
+			const int clearTiles =
+				CountClearLines(lineFrom, lineTo, NUM_LINES);
+			const double losTimeTiles = Seconds(start);
+			start = clock();
+			const int nodesTiles =
+				CountPathNodes(pathFrom, pathTo, NUM_PATHS);
+			const double pathTimeTiles = Seconds(start);
+			GetFlags = PackedTileFlags;
+			printf("256x256 cave: %d lines %.0fms (Tile flags %.0fms),"
+				" %d paths %.0fms (Tile flags %.0fms)\n",
+				NUM_LINES, losTime * 1000, losTimeTiles * 1000,
+				NUM_PATHS, pathTime * 1000, pathTimeTiles * 1000);
+
+		THEN("the results should be identical")
+			SHOULD_INT_GT(clear, 0);
+			SHOULD_INT_EQUAL(clear, clearTiles);
+			SHOULD_INT_GT(nodes, 0);
+			SHOULD_INT_EQUAL(nodes, nodesTiles);
+			CFREE(walls);
+			CFREE(flaggedTiles);
+			flaggedTiles = NULL;
+			CFREE(lineFrom);
+			CFREE(lineTo);
+			MapTerminate(&gMap);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Map features are:",
+	TEST_FEATURE(MapPreload),
+	TEST_FEATURE(MapTileBlockers),
+	TEST_FEATURE(MapTileFlags)
+)
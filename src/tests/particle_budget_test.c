@@ -0,0 +1,81 @@
+#include <cbehave/cbehave.h>
+
+#include <particle_budget.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+static int SpawnMany(
+	ParticleBudget *b, const ParticlePriority priority, const int n,
+	const int numParticles)
+{
+	int spawned = 0;
+	for (int i = 0; i < n; i++)
+	{
+		if (ParticleBudgetTrySpawn(b, priority, Vec2iZero(), numParticles))
+		{
+			spawned++;
+		}
+	}
+	return spawned;
+}
+
+
+FEATURE(ParticleBudgetTrySpawn, "Particle budget")
+	SCENARIO("Low priority spawns outside the views are culled")
+		GIVEN("a budget with one view")
+			ParticleBudget b;
+			ParticleBudgetInit(&b, 1000);
+			const Rect2i view = { { 0, 0 }, { 320, 240 } };
+			ParticleBudgetAddView(&b, view);
+
+		WHEN("I spawn particles inside and far outside the view")
+			const bool lowIn = ParticleBudgetTrySpawn(
+				&b, PARTICLE_PRIORITY_LOW, Vec2iNew(100, 100), 0);
+			const bool lowOut = ParticleBudgetTrySpawn(
+				&b, PARTICLE_PRIORITY_LOW, Vec2iNew(1000, 100), 0);
+			const bool normalOut = ParticleBudgetTrySpawn(
+				&b, PARTICLE_PRIORITY_NORMAL, Vec2iNew(1000, 100), 0);
+
+		THEN("only the low priority one outside should be culled")
+			SHOULD_BE_TRUE(lowIn);
+			SHOULD_BE_FALSE(lowOut);
+			SHOULD_BE_TRUE(normalOut);
+		AND("the counters should reflect that after the frame")
+			ParticleBudgetNextFrame(&b);
+			SHOULD_INT_EQUAL(b.LastSpawned, 2);
+			SHOULD_INT_EQUAL(b.LastCulled, 1);
+	SCENARIO_END
+
+	SCENARIO("Spawns thin out then stop as the budget fills")
+		GIVEN("a budget of 1000")
+			ParticleBudget b;
+			ParticleBudgetInit(&b, 1000);
+
+		WHEN("I spawn low priority particles at different fill levels")
+			const int empty = SpawnMany(&b, PARTICLE_PRIORITY_LOW, 10, 0);
+			const int nearLimit = SpawnMany(&b, PARTICLE_PRIORITY_LOW, 10, 400);
+			const int atLimit = SpawnMany(&b, PARTICLE_PRIORITY_LOW, 10, 500);
+
+		THEN("all, half and none should spawn")
+			SHOULD_INT_EQUAL(empty, 10);
+			SHOULD_INT_EQUAL(nearLimit, 5);
+			SHOULD_INT_EQUAL(atLimit, 0);
+		AND("high priority particles should still spawn up to the cap")
+			SHOULD_INT_EQUAL(SpawnMany(&b, PARTICLE_PRIORITY_HIGH, 10, 500), 10);
+			SHOULD_INT_EQUAL(SpawnMany(&b, PARTICLE_PRIORITY_HIGH, 10, 1000), 0);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Particle budget features are:",
+	TEST_FEATURE(ParticleBudgetTrySpawn)
+)
@@ -3,79 +3,119 @@
 
 #include <pic.h>
 
+#include <time.h>
+
 #include <SDL_image.h>
-#include <config.h>
+#include <tinydir/tinydir.h>
+#include <c_array.h>
 #include <grafx.h>
 
 
 // Stubs
-void BlitBackground(
-	GraphicsDevice *device,
-	const Pic *pic, Vec2i pos, const HSV *tint, const bool isTransparent)
+GraphicsDevice gGraphicsDevice;
+const char *JoyName(const int deviceIndex)
 {
-	UNUSED(device);
-	UNUSED(pic);
-	UNUSED(pos);
-	UNUSED(tint);
-	UNUSED(isTransparent);
+	UNUSED(deviceIndex);
+	return NULL;
 }
-void BlitMasked(
-	GraphicsDevice *device,
-	const Pic *pic,
-	Vec2i pos,
-	color_t mask,
-	int isTransparent)
+
+// Decode every png file under a dir, to load pics from
+static void DecodePics(const char *path, CArray *images)
 {
-	UNUSED(device);
-	UNUSED(pic);
-	UNUSED(pos);
-	UNUSED(mask);
-	UNUSED(isTransparent);
+	tinydir_dir dir;
+	if (tinydir_open(&dir, path) == -1)
+	{
+		return;
+	}
+	for (; dir.has_next; tinydir_next(&dir))
+	{
+		tinydir_file file;
+		tinydir_readfile(&dir, &file);
+		if (file.is_dir && file.name[0] != '.')
+		{
+			DecodePics(file.path, images);
+		}
+		else if (file.is_reg && strcmp(file.extension, "png") == 0)
+		{
+			SDL_Surface *image = IMG_Load(file.path);
+			if (image != NULL)
+			{
+				// Same as the format IMG_Load used to hand to PicLoad
+				SDL_Surface *abgr = SDL_ConvertSurfaceFormat(
+					image, SDL_PIXELFORMAT_ABGR8888, 0);
+				SDL_FreeSurface(image);
+				CArrayPushBack(images, &abgr);
+			}
+		}
+	}
+	tinydir_close(&dir);
 }
-const char *JoyName(const int deviceIndex)
+static void FreeImages(CArray *images)
 {
-	UNUSED(deviceIndex);
-	return NULL;
+	CA_FOREACH(SDL_Surface *, image, *images)
+		SDL_FreeSurface(*image);
+	CA_FOREACH_END()
+	CArrayTerminate(images);
 }
-color_t PaletteToColor(unsigned char idx)
+// Load a pic per image via the per-pixel conversion, as the pic manager
+// used to
+static void LoadPicsPerPixel(const CArray *images, CArray *pics)
 {
-	UNUSED(idx);
-	return colorBlack;
+	CA_FOREACH(SDL_Surface *, image, *images)
+		const Vec2i size = Vec2iNew((*image)->w, (*image)->h);
+		Pic p;
+		PicLoad(&p, size, Vec2iZero(), *image);
+		CArrayPushBack(pics, &p);
+	CA_FOREACH_END()
 }
-int ConfigGetJSONVersion(FILE *f)
+// Load a pic per image by converting it to the device format first, as the
+// pic manager does now
+static void LoadPicsFast(const CArray *images, CArray *pics)
 {
-	UNUSED(f);
-	return 0;
+	CA_FOREACH(SDL_Surface *, image, *images)
+		SDL_Surface *device = SDL_ConvertSurfaceFormat(
+			*image, gGraphicsDevice.Format->format, 0);
+		const Vec2i size = Vec2iNew((*image)->w, (*image)->h);
+		Pic p;
+		PicLoad(&p, size, Vec2iZero(), device);
+		SDL_FreeSurface(device);
+		CArrayPushBack(pics, &p);
+	CA_FOREACH_END()
 }
-bool ConfigIsOld(FILE *f)
+static int CountMismatches(const CArray *a, const CArray *b)
 {
-	UNUSED(f);
-	return false;
+	int mismatches = 0;
+	for (int i = 0; i < (int)a->size; i++)
+	{
+		const Pic *pa = CArrayGet(a, i);
+		const Pic *pb = CArrayGet(b, i);
+		if (memcmp(pa->Data, pb->Data,
+			pa->size.x * pa->size.y * sizeof *pa->Data))
+		{
+			mismatches++;
+		}
+	}
+	return mismatches;
 }
-void DrawRectangle(
-	GraphicsDevice *device, Vec2i pos, Vec2i size, color_t color, int flags)
+static void FreePics(CArray *pics)
 {
-	UNUSED(device);
-	UNUSED(pos);
-	UNUSED(size);
-	UNUSED(color);
-	UNUSED(flags);
+	CA_FOREACH(Pic, p, *pics)
+		PicFree(p);
+	CA_FOREACH_END()
+	CArrayTerminate(pics);
+}
+static double Seconds(const clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
 }
-
 
 FEATURE(PicLoad, "Pic load")
 	SCENARIO("Load png")
-		GIVEN("a graphics context")
-			if (SDL_Init(SDL_INIT_VIDEO) != 0)
-			{
-				printf("Failed to init SDL: %s\n", SDL_GetError());
-				ASSERT(false, 1);
-			}
-			gConfig = ConfigDefault();
-			ConfigResetDefault(ConfigGet(&gConfig, "Graphics"));
-			GraphicsInit(&gGraphicsDevice, &gConfig);
-			GraphicsInitialize(&gGraphicsDevice);
-			ASSERT(gGraphicsDevice.IsInitialized, 1);
+		GIVEN("the device pixel format")
+			// Same as the graphics device, which can't be created without
+			// a video device
+			gGraphicsDevice.Format =
+				SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
 		AND("a single pixel PNG")
 			SDL_RWops *rwops = SDL_RWFromFile("r64g128b192.png", "rb");
 			ASSERT(IMG_isPNG(rwops), 1);
@@ -93,9 +133,41 @@ FEATURE(PicLoad, "Pic load")
 			SHOULD_INT_EQUAL(c.r, 64);
 			SHOULD_INT_EQUAL(c.g, 128);
 			SHOULD_INT_EQUAL(c.b, 192);
+		PicFree(&p);
 		SDL_UnlockSurface(image);
 		SDL_FreeSurface(image);
 		rwops->close(rwops);
+		SDL_FreeFormat(gGraphicsDevice.Format);
+	SCENARIO_END
+
+	SCENARIO("Load all graphics with the fast path")
+		GIVEN("the device pixel format")
+			gGraphicsDevice.Format =
+				SDL_AllocFormat(SDL_PIXELFORMAT_ARGB8888);
+		AND("every pic in the graphics dir")
+			CArray images;
+			CArrayInit(&images, sizeof(SDL_Surface *));
+			// Note: relative to this dir
+			DecodePics("../../graphics", &images);
+		WHEN("I load them with both paths")
+			CArray slow, fast;
+			CArrayInit(&slow, sizeof(Pic));
+			CArrayInit(&fast, sizeof(Pic));
+			clock_t start = clock();
+			LoadPicsPerPixel(&images, &slow);
+			const double slowTime = Seconds(start);
+			start = clock();
+			LoadPicsFast(&images, &fast);
+			const double fastTime = Seconds(start);
+			printf("%d pics in graphics/: %.1fms (per-pixel %.1fms)\n",
+				(int)images.size, fastTime * 1000, slowTime * 1000);
+		THEN("the pics should be identical")
+			SHOULD_INT_GT((int)images.size, 0);
+			SHOULD_INT_EQUAL(CountMismatches(&slow, &fast), 0);
+		FreePics(&slow);
+		FreePics(&fast);
+		FreeImages(&images);
+		SDL_FreeFormat(gGraphicsDevice.Format);
 	SCENARIO_END
 FEATURE_END
 
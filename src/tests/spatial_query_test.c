@@ -0,0 +1,220 @@
+#include <cbehave/cbehave.h>
+
+#include <stdlib.h>
+
+#include <actors.h>
+#include <objs.h>
+#include <pickup.h>
+#include <spatial_query.h>
+
+// Stubs
+CArray gActors;
+CArray gMobObjs;
+CArray gObjs;
+CArray gPickups;
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+#define MAP_W 40
+#define MAP_H 30
+static Tile tiles[MAP_H][MAP_W];
+Tile *MapGetTile(Map *map, Vec2i pos)
+{
+	UNUSED(map);
+	return &tiles[pos.y][pos.x];
+}
+TTileItem *ThingIdGetTileItem(ThingId *tid)
+{
+	return &((TActor *)CArrayGet(&gActors, tid->Id))->tileItem;
+}
+
+// Place actors at random, with every fourth not in use and not on the map
+static void ActorsInitTest(Map *map, const int n)
+{
+	map->Size = Vec2iNew(MAP_W, MAP_H);
+	for (int y = 0; y < MAP_H; y++)
+	{
+		for (int x = 0; x < MAP_W; x++)
+		{
+			CArrayInit(&tiles[y][x].things, sizeof(ThingId));
+		}
+	}
+	CArrayInit(&gActors, sizeof(TActor));
+	CArrayInit(&gMobObjs, sizeof(TMobileObject));
+	CArrayInit(&gObjs, sizeof(TObject));
+	CArrayInit(&gPickups, sizeof(Pickup));
+	for (int i = 0; i < n; i++)
+	{
+		TActor a;
+		memset(&a, 0, sizeof a);
+		a.uid = i;
+		a.isInUse = i % 4 != 0;
+		a.Pos = Vec2iNew(
+			rand() % (MAP_W * TILE_WIDTH * 256),
+			rand() % (MAP_H * TILE_HEIGHT * 256));
+		a.tileItem.x = a.Pos.x >> 8;
+		a.tileItem.y = a.Pos.y >> 8;
+		a.tileItem.kind = KIND_CHARACTER;
+		a.tileItem.id = i;
+		CArrayPushBack(&gActors, &a);
+		if (a.isInUse)
+		{
+			const ThingId tid = { i, KIND_CHARACTER };
+			const Vec2i t = Vec2iToTile(Vec2iFull2Real(a.Pos));
+			CArrayPushBack(&tiles[t.y][t.x].things, &tid);
+		}
+	}
+}
+static void ActorsTerminateTest(void)
+{
+	for (int y = 0; y < MAP_H; y++)
+	{
+		for (int x = 0; x < MAP_W; x++)
+		{
+			CArrayTerminate(&tiles[y][x].things);
+		}
+	}
+	CArrayTerminate(&gActors);
+}
+
+static bool IsOddUID(const ThingId *tid, const TTileItem *ti, void *data)
+{
+	UNUSED(ti);
+	UNUSED(data);
+	return ((const TActor *)CArrayGet(&gActors, tid->Id))->uid & 1;
+}
+
+// Brute force nearest, in the same order as the query
+static int NearestBruteForce(
+	const SpatialQuery *q, SpatialQueryResult *results, const int k)
+{
+	int n = 0;
+	for (int found = 0; found < k; found++)
+	{
+		int best = -1;
+		int bestDistance = 0;
+		CA_FOREACH(const TActor, a, gActors)
+			if (!a->isInUse || !(a->uid & 1)) continue;
+			bool used = false;
+			for (int i = 0; i < n; i++)
+			{
+				used = used || results[i].Id.Id == _ca_index;
+			}
+			if (used) continue;
+			const int d = CHEBYSHEV_DISTANCE(
+				q->FullPos.x, q->FullPos.y, a->Pos.x, a->Pos.y);
+			if (best < 0 || d < bestDistance)
+			{
+				best = _ca_index;
+				bestDistance = d;
+			}
+		CA_FOREACH_END()
+		if (best < 0) break;
+		results[n].Id.Id = best;
+		results[n].Distance = bestDistance;
+		n++;
+	}
+	return n;
+}
+
+// Returns the number of queries that matched brute force
+static int QueryManyTest(Map *map)
+{
+	int matches = 0;
+	for (int i = 0; i < 100; i++)
+	{
+		SpatialQuery q = SpatialQueryNew(
+			Vec2iNew(
+				rand() % (MAP_W * TILE_WIDTH * 256),
+				rand() % (MAP_H * TILE_HEIGHT * 256)),
+			SPATIAL_QUERY_KIND(KIND_CHARACTER));
+		q.Filter = IsOddUID;
+		SpatialQueryResult expected[3];
+		SpatialQueryResult actual[3];
+		const int n = NearestBruteForce(&q, expected, 3);
+		bool match = SpatialQueryNearest(map, &q, actual, 3) == n;
+		for (int j = 0; j < n && match; j++)
+		{
+			match = actual[j].Id.Id == expected[j].Id.Id &&
+				actual[j].Distance == expected[j].Distance;
+		}
+		if (match)
+		{
+			matches++;
+		}
+	}
+	return matches;
+}
+
+
+FEATURE(SpatialQueryNearest, "Nearest query")
+	SCENARIO("Find the same nearest actors as a brute force search")
+		GIVEN("a map with many actors")
+			srand(1);
+			Map map;
+			ActorsInitTest(&map, 400);
+		WHEN("I query the nearest actors from many places")
+			const int matches = QueryManyTest(&map);
+		THEN("they should all match a brute force search")
+			SHOULD_INT_EQUAL(matches, 100);
+			ActorsTerminateTest();
+	SCENARIO_END
+
+	SCENARIO("Find the nearest actors when there are few")
+		GIVEN("a map with few actors")
+			srand(2);
+			Map map;
+			ActorsInitTest(&map, 8);
+		WHEN("I query the nearest actors from many places")
+			const int matches = QueryManyTest(&map);
+		THEN("they should all match a brute force search")
+			SHOULD_INT_EQUAL(matches, 100);
+			ActorsTerminateTest();
+	SCENARIO_END
+FEATURE_END
+
+FEATURE(SpatialQueryRadius, "Radius query")
+	SCENARIO("Find actors within a distance, closest first")
+		GIVEN("a map with many actors")
+			srand(3);
+			Map map;
+			ActorsInitTest(&map, 400);
+		WHEN("I query the actors within 3 tiles of the middle")
+			SpatialQuery q = SpatialQueryNew(
+				Vec2iNew(MAP_W * TILE_WIDTH * 128, MAP_H * TILE_HEIGHT * 128),
+				SPATIAL_QUERY_KIND(KIND_CHARACTER));
+			q.MaxDistance = 3 * TILE_WIDTH * 256;
+			CArray results;
+			CArrayInit(&results, sizeof(SpatialQueryResult));
+			SpatialQueryRadius(&map, &q, &results);
+		THEN("it should find all of them, in order")
+			int expected = 0;
+			CA_FOREACH(const TActor, a, gActors)
+				if (a->isInUse && CHEBYSHEV_DISTANCE(
+					q.FullPos.x, q.FullPos.y, a->Pos.x, a->Pos.y) <=
+					q.MaxDistance)
+				{
+					expected++;
+				}
+			CA_FOREACH_END()
+			SHOULD_INT_EQUAL((int)results.size, expected);
+			bool ordered = true;
+			for (int i = 1; i < (int)results.size; i++)
+			{
+				const SpatialQueryResult *r1 = CArrayGet(&results, i - 1);
+				const SpatialQueryResult *r2 = CArrayGet(&results, i);
+				ordered = ordered && r1->Distance <= r2->Distance;
+			}
+			SHOULD_BE_TRUE(ordered);
+			CArrayTerminate(&results);
+			ActorsTerminateTest();
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Spatial query features are:",
+	TEST_FEATURE(SpatialQueryNearest),
+	TEST_FEATURE(SpatialQueryRadius)
+)
@@ -47,4 +47,32 @@ FEATURE(path_funcs, "Path functions")
 	SCENARIO_END
 FEATURE_END
 
-CBEHAVE_RUN("Pic features are:", TEST_FEATURE(path_funcs))
+FEATURE(RandNext, "Private random sequences")
+	SCENARIO("Repeatable from a seed")
+		GIVEN("two sequences with the same seed")
+			unsigned int seed1 = 42;
+			unsigned int seed2 = 42;
+
+		WHEN("I take numbers from one and use rand() in between")
+			int first[16];
+			for (int i = 0; i < 16; i++)
+			{
+				first[i] = RandNext(&seed1);
+				srand((unsigned int)i);
+				(void)rand();
+			}
+
+		THEN("the other sequence should give the same numbers")
+			bool same = true;
+			for (int i = 0; i < 16; i++)
+			{
+				same = same && RandNext(&seed2) == first[i] && first[i] >= 0;
+			}
+			SHOULD_BE_TRUE(same);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Pic features are:",
+	TEST_FEATURE(path_funcs),
+	TEST_FEATURE(RandNext))
@@ -0,0 +1,147 @@
+#include <cbehave/cbehave.h>
+
+#include <stdlib.h>
+
+#include <ai_utils.h>
+#include <algorithms.h>
+#include <visibility_cache.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+#define MAP_W 40
+#define MAP_H 30
+static bool walls[MAP_H][MAP_W];
+bool MapIsTileIn(const Map *map, const Vec2i pos)
+{
+	UNUSED(map);
+	return pos.x >= 0 && pos.x < MAP_W && pos.y >= 0 && pos.y < MAP_H;
+}
+bool MapTileCanSee(const Map *map, const Vec2i pos)
+{
+	return !MapIsTileIn(map, pos) || !walls[pos.y][pos.x];
+}
+bool IsTileWalkable(Map *map, const Vec2i pos)
+{
+	return MapIsTileIn(map, pos) && !walls[pos.y][pos.x];
+}
+
+static void WallsInitTest(Map *map, const int percent)
+{
+	map->Size = Vec2iNew(MAP_W, MAP_H);
+	for (int y = 0; y < MAP_H; y++)
+	{
+		for (int x = 0; x < MAP_W; x++)
+		{
+			walls[y][x] = rand() % 100 < percent;
+		}
+	}
+}
+
+static Vec2i RandomPos(void)
+{
+	return Vec2iNew(
+		rand() % (MAP_W * TILE_WIDTH), rand() % (MAP_H * TILE_HEIGHT));
+}
+static Vec2i RandomPosNear(const Vec2i v, const int tiles)
+{
+	const Vec2i d = Vec2iNew(
+		rand() % (2 * tiles * TILE_WIDTH + 1) - tiles * TILE_WIDTH,
+		rand() % (2 * tiles * TILE_HEIGHT + 1) - tiles * TILE_HEIGHT);
+	return Vec2iNew(
+		CLAMP(v.x + d.x, 0, MAP_W * TILE_WIDTH - 1),
+		CLAMP(v.y + d.y, 0, MAP_H * TILE_HEIGHT - 1));
+}
+
+static bool IsPosNoSee(void *data, Vec2i pos)
+{
+	return !MapTileCanSee(data, Vec2iToTile(pos));
+}
+static bool HasClearLine(Map *map, const Vec2i from, const Vec2i to)
+{
+	HasClearLineData data;
+	data.IsBlocked = IsPosNoSee;
+	data.data = map;
+	return HasClearLineXiaolinWu(from, to, &data);
+}
+
+// Count lines the cache says are clear, and how many of those aren't
+static void CheckLinesTest(
+	VisibilityCache *vc, Map *map, int *clear, int *wrong)
+{
+	*clear = 0;
+	*wrong = 0;
+	for (int i = 0; i < 2000; i++)
+	{
+		const Vec2i from = RandomPos();
+		const Vec2i to = RandomPosNear(from, 1 + i % 8);
+		if (VisibilityCacheIsClear(vc, from, to, VISIBILITY_SEE))
+		{
+			(*clear)++;
+			if (!HasClearLine(map, from, to))
+			{
+				(*wrong)++;
+			}
+		}
+	}
+}
+
+
+FEATURE(VisibilityCacheIsClear, "Clear lines")
+	SCENARIO("Only say lines are clear if they are")
+		GIVEN("a map with scattered walls")
+			srand(1);
+			Map map;
+			WallsInitTest(&map, 8);
+			VisibilityCache vc;
+			VisibilityCacheInit(&vc, &map);
+		WHEN("I check many lines between random positions")
+			int clear, wrong;
+			CheckLinesTest(&vc, &map, &clear, &wrong);
+		THEN("some should be clear")
+			SHOULD_BE_TRUE(clear > 200);
+		AND("all of those should be clear when checked in full")
+			SHOULD_INT_EQUAL(wrong, 0);
+		AND("checking them again should find them in the cache")
+			const int lookups = SDL_AtomicGet(&vc.lookups);
+			const int hits = SDL_AtomicGet(&vc.hits);
+			int clearAgain;
+			srand(1);
+			WallsInitTest(&map, 8);
+			CheckLinesTest(&vc, &map, &clearAgain, &wrong);
+			SHOULD_INT_EQUAL(clearAgain, clear);
+			SHOULD_BE_TRUE(SDL_AtomicGet(&vc.hits) - hits > lookups / 2);
+			VisibilityCacheTerminate(&vc);
+	SCENARIO_END
+
+	SCENARIO("Forget clear lines when the map changes")
+		GIVEN("an empty map")
+			Map map;
+			WallsInitTest(&map, 0);
+			VisibilityCache vc;
+			VisibilityCacheInit(&vc, &map);
+		AND("a clear line that has been cached")
+			const Vec2i from = Vec2iNew(2 * TILE_WIDTH, 5 * TILE_HEIGHT);
+			const Vec2i to = Vec2iNew(20 * TILE_WIDTH, 5 * TILE_HEIGHT);
+			SHOULD_BE_TRUE(VisibilityCacheIsClear(
+				&vc, from, to, VISIBILITY_SEE));
+		WHEN("a wall is added across the line")
+			walls[5][10] = true;
+			VisibilityCacheInvalidate(&vc, VISIBILITY_SEE);
+		THEN("the line should no longer be clear")
+			SHOULD_BE_FALSE(VisibilityCacheIsClear(
+				&vc, from, to, VISIBILITY_SEE));
+		AND("nor in the other direction")
+			SHOULD_BE_FALSE(VisibilityCacheIsClear(
+				&vc, to, from, VISIBILITY_SEE));
+			VisibilityCacheTerminate(&vc);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"Visibility cache features are:",
+	TEST_FEATURE(VisibilityCacheIsClear)
+)
@@ -0,0 +1,251 @@
+#include <cbehave/cbehave.h>
+
+#include <stdio.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include <json/json.h>
+
+#include <yajl_utils.h>
+
+#include <SDL_joystick.h>
+
+#include <utils.h>
+
+// Stubs
+const char *JoyName(const int deviceIndex)
+{
+	UNUSED(deviceIndex);
+	return NULL;
+}
+
+
+#define TEST_FILE "yajl_stream_test.json"
+
+static void WriteFile(const char *s)
+{
+	FILE *f = fopen(TEST_FILE, "w");
+	fputs(s, f);
+	fclose(f);
+}
+
+// Record what the stream reports as text, to compare in one go
+typedef struct
+{
+	char headers[256];
+	char sections[256];
+	char fields[512];
+	int begins;
+	int ends;
+} StreamRecord;
+static bool RecordHeader(void *data, const char *key, const char *value)
+{
+	StreamRecord *r = data;
+	sprintf(r->headers + strlen(r->headers), "%s=%s;", key, value);
+	return true;
+}
+static void RecordBegin(void *data, const char *section)
+{
+	StreamRecord *r = data;
+	sprintf(r->sections + strlen(r->sections), "%s;", section);
+	r->begins++;
+}
+static void RecordField(
+	void *data, const char *key, const int index, const char *value)
+{
+	StreamRecord *r = data;
+	sprintf(r->fields + strlen(r->fields), "%s[%d]=%s;",
+		key, index, value != NULL ? value : "null");
+}
+static void RecordEnd(void *data)
+{
+	StreamRecord *r = data;
+	r->ends++;
+}
+static bool StreamRecordFile(StreamRecord *r, const char *section)
+{
+	memset(r, 0, sizeof *r);
+	const YAJLStreamHandler h =
+	{
+		r, RecordHeader, RecordBegin, RecordField, RecordEnd
+	};
+	return YAJLStreamFile(TEST_FILE, section, &h);
+}
+
+// Counts elements without keeping them, like the game's loaders
+typedef struct
+{
+	int elements;
+	int fields;
+} StreamCount;
+static void CountBegin(void *data, const char *section)
+{
+	UNUSED(section);
+	StreamCount *c = data;
+	c->elements++;
+}
+static void CountField(
+	void *data, const char *key, const int index, const char *value)
+{
+	UNUSED(key);
+	UNUSED(index);
+	UNUSED(value);
+	StreamCount *c = data;
+	c->fields++;
+}
+static void CountEnd(void *data)
+{
+	UNUSED(data);
+}
+
+// Synthetic campaign data: a "Missions" array of tile-heavy objects, about
+// the size of the largest user campaigns
+static int WriteLargeFile(const long size)
+{
+	FILE *f = fopen(TEST_FILE, "w");
+	int count = 0;
+	fputs("{\"Version\": 1, \"Missions\": [", f);
+	while (ftell(f) < size)
+	{
+		fprintf(f,
+			"%s{\"Title\": \"Mission %d\", \"Size\": [64, 64], "
+			"\"Objectives\": [{\"Description\": \"Kill\", \"Count\": %d}], "
+			"\"Tiles\": [",
+			count > 0 ? ", " : "", count, count % 10);
+		for (int i = 0; i < 64 * 64; i++)
+		{
+			fprintf(f, "%s%d", i > 0 ? "," : "", (i * 7 + count) % 5);
+		}
+		fputs("]}", f);
+		count++;
+	}
+	fputs("]}", f);
+	fclose(f);
+	return count;
+}
+static double Seconds(const clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+// Peak resident set size of the process so far, in KB
+static long PeakRSS(void)
+{
+#ifdef _WIN32
+	return 0;
+#else
+	struct rusage u;
+	getrusage(RUSAGE_SELF, &u);
+#ifdef __APPLE__
+	return u.ru_maxrss / 1024;
+#else
+	return u.ru_maxrss;
+#endif
+#endif
+}
+
+
+FEATURE(YAJLStreamFile, "Streaming JSON data files")
+	SCENARIO("Top-level objects and arrays are reported as sections")
+		GIVEN("a file with a default object and two arrays")
+			WriteFile(
+				"{\"Version\": 1,"
+				" \"DefaultGun\": {\"Name\": \"d\", \"Elevation\": 2},"
+				" \"Guns\": [{\"Name\": \"a\", \"Sound\": {\"Hit\": \"x\"},"
+				" \"Size\": [1, 2]}, {\"Name\": \"b\", \"CanDrop\": true}],"
+				" \"PseudoGuns\": [{\"Name\": \"p\", \"Icon\": null}],"
+				" \"Other\": 3}");
+
+		WHEN("I stream all of its sections")
+			StreamRecord r;
+			const bool ok = StreamRecordFile(&r, NULL);
+
+		THEN("each object should be reported in order with its section")
+			SHOULD_BE_TRUE(ok);
+			SHOULD_STR_EQUAL(r.headers, "Version=1;Other=3;");
+			SHOULD_STR_EQUAL(r.sections, "DefaultGun;Guns;Guns;PseudoGuns;");
+			SHOULD_STR_EQUAL(r.fields,
+				"Name[-1]=d;Elevation[-1]=2;"
+				"Name[-1]=a;Sound/Hit[-1]=x;Size[0]=1;Size[1]=2;"
+				"Name[-1]=b;CanDrop[-1]=true;"
+				"Name[-1]=p;Icon[-1]=null;");
+			SHOULD_INT_EQUAL(r.begins, 4);
+			SHOULD_INT_EQUAL(r.ends, 4);
+			remove(TEST_FILE);
+	SCENARIO_END
+
+	SCENARIO("Only the named section is reported")
+		GIVEN("a file with a default object and two arrays")
+			WriteFile(
+				"{\"Version\": 1,"
+				" \"DefaultGun\": {\"Name\": \"d\"},"
+				" \"Guns\": [{\"Name\": \"a\"}, {\"Name\": \"b\"}],"
+				" \"PseudoGuns\": [{\"Name\": \"p\"}]}");
+
+		WHEN("I stream the Guns section")
+			StreamRecord r;
+			const bool ok = StreamRecordFile(&r, "Guns");
+
+		THEN("only the objects in that array should be reported")
+			SHOULD_BE_TRUE(ok);
+			SHOULD_STR_EQUAL(r.sections, "Guns;Guns;");
+			SHOULD_STR_EQUAL(r.fields, "Name[-1]=a;Name[-1]=b;");
+			remove(TEST_FILE);
+	SCENARIO_END
+
+	SCENARIO("Load a large campaign")
+		GIVEN("a 50MB campaign file")
+			const int count = WriteLargeFile(50 * 1024 * 1024);
+
+		WHEN("I stream it")
+			StreamCount c;
+			memset(&c, 0, sizeof c);
+			const YAJLStreamHandler h =
+			{
+				&c, NULL, CountBegin, CountField, CountEnd
+			};
+			long rss = PeakRSS();
+			clock_t start = clock();
+			const bool ok = YAJLStreamFile(TEST_FILE, "Missions", &h);
+			const double streamTime = Seconds(start);
+			const long streamRSS = PeakRSS() - rss;
+
+			// The document tree takes ~50x the file size, so only parse a
+			// tenth of the data for reference
+			const int treeCount = WriteLargeFile(5 * 1024 * 1024);
+			rss = PeakRSS();
+			start = clock();
+			FILE *f = fopen(TEST_FILE, "r");
+			json_t *root = NULL;
+			const enum json_error e = json_stream_parse(f, &root);
+			fclose(f);
+			int treeMissions = 0;
+			if (e == JSON_OK)
+			{
+				json_t *missions = json_find_first_label(root, "Missions");
+				for (json_t *m = missions->child->child; m; m = m->next)
+				{
+					treeMissions++;
+				}
+			}
+			json_free_value(&root);
+			const double treeTime = Seconds(start);
+			const long treeRSS = PeakRSS() - rss;
+			printf("50MB campaign: stream %.0fms +%ldKB peak RSS"
+				" (5MB as document tree %.0fms +%ldKB)\n",
+				streamTime * 1000, streamRSS, treeTime * 1000, treeRSS);
+
+		THEN("every mission should be seen")
+			SHOULD_BE_TRUE(ok);
+			SHOULD_INT_EQUAL(c.elements, count);
+			SHOULD_INT_EQUAL(c.fields, count * (1 + 2 + 2 + 64 * 64));
+			SHOULD_INT_EQUAL(treeMissions, treeCount);
+			remove(TEST_FILE);
+	SCENARIO_END
+FEATURE_END
+
+CBEHAVE_RUN(
+	"YAJL stream features are:",
+	TEST_FEATURE(YAJLStreamFile)
+)